@@ -0,0 +1,68 @@
+#!/bin/bash
+# benchcrawl.sh - crawl the stand-in server and report throughput
+# Usage: bash benchcrawl.sh [tseserver options] [-- maxDepth [crawler options]]
+#
+# Starts ./tseserver on a free port with the given options, crawls it from
+# p0.html with ../crawler/crawler into a scratch pageDirectory (maxDepth 10
+# unless given), stops the server, and prints pages/s and bytes/s over the
+# crawl's wall-clock time along with the server's fetch latency
+# percentiles. Run by `make bench-crawl`, which builds both programs first.
+
+SERVER=./tseserver
+CRAWLER=../crawler/crawler
+
+serverArgs=()
+while [ $# -gt 0 ] && [ "$1" != "--" ]; do
+    serverArgs+=("$1")
+    shift
+done
+[ "$1" == "--" ] && shift
+depth=${1:-10}
+shift
+crawlerArgs=("$@")
+
+if [ ! -x "$SERVER" ] || [ ! -x "$CRAWLER" ]; then
+    echo "benchcrawl: build $SERVER and $CRAWLER first (make bench-crawl)" >&2
+    exit 1
+fi
+
+scratch=$(mktemp -d)
+trap 'kill "$server" 2>/dev/null; rm -rf "$scratch"' EXIT
+
+# start the server; its first line says where it listens
+"$SERVER" --port 0 "${serverArgs[@]}" > "$scratch/server.out" &
+server=$!
+for _ in $(seq 50); do
+    [ -s "$scratch/server.out" ] && break
+    sleep 0.1
+done
+seed=$(sed -n 's/^Listening: //p' "$scratch/server.out")
+if [ -z "$seed" ]; then
+    echo "benchcrawl: tseserver did not start" >&2
+    exit 1
+fi
+prefix=${seed%%/bench/*}/
+
+mkdir "$scratch/pages"
+start=$(date +%s.%N)
+"$CRAWLER" --rate 0 --internal "$prefix" "${crawlerArgs[@]}" \
+    "$seed" "$scratch/pages" "$depth" > "$scratch/crawler.out"
+status=$?
+end=$(date +%s.%N)
+
+kill -TERM "$server"
+wait "$server"
+
+fetched=$(grep -c '^Fetched:' "$scratch/crawler.out")
+bytes=$(sed -n 's/^Served: \([0-9]*\) bytes.*/\1/p' "$scratch/server.out")
+latency=$(sed -n 's/^Latency: //p' "$scratch/server.out")
+
+echo "Server: ${serverArgs[*]}"
+echo "Crawler: --rate 0 ${crawlerArgs[*]} (maxDepth $depth, exit status $status)"
+grep '^Requests:' "$scratch/server.out"
+awk -v pages="$fetched" -v bytes="${bytes:-0}" -v start="$start" -v end="$end" 'BEGIN {
+    secs = end - start
+    printf("Crawl: %d pages, %d bytes in %.3f s\n", pages, bytes, secs)
+    printf("Throughput: %.1f pages/s, %.2f MB/s\n", pages / secs, bytes / secs / 1e6)
+}'
+echo "Fetch latency (server side): $latency"
@@ -0,0 +1,331 @@
+/*
+ * filebench - time the libcs50 file readers on a large file
+ *
+ * Writes a file of about `--megabytes` MB in lines of about `--line`
+ * bytes, shaped like index lines ("word docID count docID count ..."),
+ * then reads it back several ways and prints the MB/s of each:
+ *
+ *   numLines      file_numLines
+ *   readLine      file_readLine, one malloc'd line per call
+ *   reader        file_reader_line, lines handed out in place
+ *   readFile      file_readFile, the whole file at once
+ *
+ * For comparison, the same jobs are also done the way file.c used to do
+ * them, a character at a time into a buffer grown one byte at a time
+ * (the "old" rows). Every way must agree on the number of lines and on
+ * a checksum of their bytes, or the run fails.
+ *
+ * usage: filebench [--megabytes n] [--line bytes] [--runs n]
+ *
+ * CS50 FA25 Final Project
+ */
+
+#define _POSIX_C_SOURCE 200809L   // mkstemp
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+#include <unistd.h>
+#include "../libcs50/file.h"
+
+/**************** local types ****************/
+/* what a way of reading found: lines and a checksum of their bytes */
+typedef struct result {
+    long lines;
+    uint64_t sum;
+} result_t;
+
+/* one way of reading the whole file */
+typedef struct method {
+    const char* name;
+    result_t (*run)(FILE* fp);
+    bool linesOnly;              // reports lines but no checksum
+} method_t;
+
+/**************** function prototypes ****************/
+static void makeFile(FILE* fp, const long bytes, const int lineLen);
+static result_t runNumLines(FILE* fp);
+static result_t runReadLine(FILE* fp);
+static result_t runReader(FILE* fp);
+static result_t runReadFile(FILE* fp);
+static result_t runOldNumLines(FILE* fp);
+static result_t runOldReadLine(FILE* fp);
+static result_t runOldReadFile(FILE* fp);
+static char* oldReadUntil(FILE* fp, const bool toNewline);
+static uint64_t checksum(uint64_t sum, const char* data, size_t len);
+static double seconds(void);
+
+/**************** main ****************/
+int main(const int argc, char* argv[])
+{
+    int megabytes = 64, lineLen = 80, runs = 3;
+    static const struct option longOptions[] = {
+        { "megabytes", required_argument, NULL, 'm' },
+        { "line",      required_argument, NULL, 'l' },
+        { "runs",      required_argument, NULL, 'r' },
+        { NULL, 0, NULL, 0 }
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "", longOptions, NULL)) != -1) {
+        int* target = (opt == 'm') ? &megabytes : (opt == 'l') ? &lineLen
+                      : (opt == 'r') ? &runs : NULL;
+        char extra;
+        if (target == NULL || sscanf(optarg, "%d%c", target, &extra) != 1 || *target < 1) {
+            fprintf(stderr, "Usage: %s [--megabytes n] [--line bytes] [--runs n]\n", argv[0]);
+            exit(1);
+        }
+    }
+
+    char path[] = "/tmp/filebench-XXXXXX";
+    int fd = mkstemp(path);
+    FILE* fp = (fd >= 0) ? fdopen(fd, "w+") : NULL;
+    if (fp == NULL) {
+        perror("filebench");
+        exit(2);
+    }
+    unlink(path);                // gone once we close it
+    makeFile(fp, (long)megabytes << 20, lineLen);
+    long bytes = ftell(fp);
+    printf("File: %.1f MB in lines of about %d bytes; best of %d runs\n",
+           bytes / 1048576.0, lineLen, runs);
+
+    // the fastest first, so the slow old ways run on a warm page cache too
+    const method_t methods[] = {
+        { "numLines",     runNumLines,    true },
+        { "old numLines", runOldNumLines, true },
+        { "reader",       runReader,      false },
+        { "readLine",     runReadLine,    false },
+        { "old readLine", runOldReadLine, false },
+        { "readFile",     runReadFile,    false },
+        { "old readFile", runOldReadFile, false },
+    };
+    const int numMethods = sizeof(methods) / sizeof(methods[0]);
+
+    result_t expected = { 0, 0 };
+    bool haveSum = false;
+    int status = 0;
+    for (int m = 0; m < numMethods; m++) {
+        double best = 0;
+        result_t result = { 0, 0 };
+        for (int r = 0; r < runs; r++) {
+            rewind(fp);
+            double start = seconds();
+            result = methods[m].run(fp);
+            double elapsed = seconds() - start;
+            if (r == 0 || elapsed < best) {
+                best = elapsed;
+            }
+        }
+
+        // every way must agree with the first that reports the same thing
+        if (m == 0) {
+            expected.lines = result.lines;
+        }
+        if (!methods[m].linesOnly && !haveSum) {
+            expected.sum = result.sum;
+            haveSum = true;
+        }
+        bool ok = result.lines == expected.lines
+                  && (methods[m].linesOnly || result.sum == expected.sum);
+        printf("%-14s %8.3f s %9.1f MB/s %10ld lines%s\n", methods[m].name, best,
+               bytes / 1048576.0 / best, result.lines, ok ? "" : "  MISMATCH");
+        if (!ok) {
+            status = 3;
+        }
+    }
+
+    fclose(fp);
+    return status;
+}
+
+/**************** makeFile ****************/
+/* Write about bytes of index-like lines of about lineLen bytes to fp. */
+static void
+makeFile(FILE* fp, const long bytes, const int lineLen)
+{
+    uint64_t state = 1;
+    long written = 0;
+    while (written < bytes) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        int len = fprintf(fp, "word%llu", (unsigned long long)(state >> 44));
+        // vary the lines from half to one and a half times lineLen
+        int target = lineLen / 2 + (int)((state >> 20) % (lineLen + 1));
+        while (len < target) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            len += fprintf(fp, " %d %d", (int)(state >> 50) + 1, (int)(state >> 59) + 1);
+        }
+        fputc('\n', fp);
+        written += len + 1;
+    }
+    fflush(fp);
+}
+
+/**************** runNumLines ****************/
+static result_t
+runNumLines(FILE* fp)
+{
+    return (result_t) { file_numLines(fp), 0 };
+}
+
+/**************** runReadLine ****************/
+static result_t
+runReadLine(FILE* fp)
+{
+    result_t result = { 0, 0 };
+    char* line;
+    while ((line = file_readLine(fp)) != NULL) {
+        result.lines++;
+        result.sum = checksum(result.sum, line, strlen(line));
+        free(line);
+    }
+    return result;
+}
+
+/**************** runReader ****************/
+static result_t
+runReader(FILE* fp)
+{
+    result_t result = { 0, 0 };
+    file_reader_t* reader = file_reader_new(fp);
+    char* line;
+    size_t len;
+    while ((line = file_reader_line(reader, &len)) != NULL) {
+        result.lines++;
+        result.sum = checksum(result.sum, line, len);
+    }
+    file_reader_delete(reader);
+    return result;
+}
+
+/**************** runReadFile ****************/
+/* Read the whole file, then split it into lines the way the others do. */
+static result_t
+runReadFile(FILE* fp)
+{
+    result_t result = { 0, 0 };
+    char* file = file_readFile(fp);
+    if (file == NULL) {
+        return result;
+    }
+    for (char* line = file; *line != '\0'; ) {
+        char* nl = strchr(line, '\n');
+        size_t len = (nl != NULL) ? (size_t)(nl - line) : strlen(line);
+        result.lines++;
+        result.sum = checksum(result.sum, line, len);
+        line += len + (nl != NULL);
+    }
+    free(file);
+    return result;
+}
+
+/**************** runOldNumLines ****************/
+static result_t
+runOldNumLines(FILE* fp)
+{
+    result_t result = { 0, 0 };
+    int c;
+    while ((c = fgetc(fp)) != EOF) {
+        if (c == '\n') {
+            result.lines++;
+        }
+    }
+    return result;
+}
+
+/**************** runOldReadLine ****************/
+static result_t
+runOldReadLine(FILE* fp)
+{
+    result_t result = { 0, 0 };
+    char* line;
+    while ((line = oldReadUntil(fp, true)) != NULL) {
+        result.lines++;
+        result.sum = checksum(result.sum, line, strlen(line));
+        free(line);
+    }
+    return result;
+}
+
+/**************** runOldReadFile ****************/
+static result_t
+runOldReadFile(FILE* fp)
+{
+    result_t result = { 0, 0 };
+    char* file = oldReadUntil(fp, false);
+    if (file == NULL) {
+        return result;
+    }
+    for (char* line = file; *line != '\0'; ) {
+        char* nl = strchr(line, '\n');
+        size_t len = (nl != NULL) ? (size_t)(nl - line) : strlen(line);
+        result.lines++;
+        result.sum = checksum(result.sum, line, len);
+        line += len + (nl != NULL);
+    }
+    free(file);
+    return result;
+}
+
+/**************** oldReadUntil ****************/
+/* file_readUntil as it was: fgetc per character, realloc per byte. */
+static char*
+oldReadUntil(FILE* fp, const bool toNewline)
+{
+    int len = 81;
+    char* buf = malloc(len);
+    if (buf == NULL) {
+        return NULL;
+    }
+    int pos;
+    int c;
+    for (pos = 0; (c = fgetc(fp)) != EOF && !(toNewline && c == '\n'); pos++) {
+        if (pos + 1 > len - 1) {
+            char* newbuf = realloc(buf, ++len);
+            if (newbuf == NULL) {
+                free(buf);
+                return NULL;
+            }
+            buf = newbuf;
+        }
+        buf[pos] = c;
+    }
+    if (pos == 0 && c == EOF) {
+        free(buf);
+        return NULL;
+    }
+    buf[pos] = '\0';
+    return buf;
+}
+
+/**************** checksum ****************/
+/* Fold a line of len bytes into sum, eight bytes per step, so checking
+ * costs little next to reading.
+ */
+static uint64_t
+checksum(uint64_t sum, const char* data, size_t len)
+{
+    const uint64_t prime = 0x100000001B3ULL;
+    uint64_t word;
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        memcpy(&word, data + i, 8);
+        sum = (sum ^ word) * prime;
+    }
+    word = 0;
+    memcpy(&word, data + i, len - i);
+    return (sum ^ word ^ len) * prime;
+}
+
+/**************** seconds ****************/
+/* Return a monotonic time in seconds. */
+static double
+seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
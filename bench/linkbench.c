@@ -0,0 +1,392 @@
+/*
+ * linkbench - time the libcs50 link scanners on a large, link-heavy page
+ *
+ * Builds a page of about `--megabytes` MB with about `--links` links per
+ * KB among other tags and text: relative and absolute links, quoted and
+ * not, with and without #fragments, empty ones (to the page's own
+ * directory), plus links to skip (mailto:, bare
+ * #fragments, <a name=...> with no href) and other tags that begin with
+ * 'a' (<abbr>, <aside>). Then finds its links several ways and prints the
+ * MB/s of each:
+ *
+ *   getNextURL        webpage_getNextURL, with each hrefscan kernel the
+ *                     CPU runs (avx2, sse2, scalar)
+ *   old getNextURL    webpage_getNextURL as it was, on strcasestr
+ *   hrefscan          hrefscan_next alone, finding but not resolving, on
+ *                     the page with its whitespace removed
+ *   linkscan          linkscan_feed, the crawler's streaming scanner
+ *
+ * The getNextURL rows (old and new) and linkscan must agree on the
+ * number of links and a checksum of the URLs, and the hrefscan rows on
+ * the number of hrefs, or the run fails.
+ *
+ * usage: linkbench [--megabytes n] [--links perKB] [--runs n]
+ *
+ * CS50 FA25 Final Project
+ */
+
+#define _GNU_SOURCE       // strcasestr, strdup
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include <getopt.h>
+#include <time.h>
+#include "../libcs50/webpage.h"
+#include "../libcs50/hrefscan.h"
+#include "../libcs50/linkscan.h"
+
+/**************** file-local global variables ****************/
+static const char* BASE = "http://cs50tse.cs.dartmouth.edu/tse/bench/dir/index.html";
+
+/**************** local types ****************/
+/* what a way of scanning found: links and a checksum of their URLs */
+typedef struct result {
+    long links;
+    uint64_t sum;
+} result_t;
+
+/* one way of scanning the page */
+typedef struct method {
+    char name[32];
+    const char* kernel;          // hrefscan kernel to use, or NULL
+    result_t (*run)(const char* html, const size_t len);
+    int group;                   // rows in a group must agree
+} method_t;
+
+/**************** function prototypes ****************/
+static char* makePage(const long bytes, const int linksPerKB, size_t* len);
+static result_t runGetNextURL(const char* html, const size_t len);
+static result_t runOldGetNextURL(const char* html, const size_t len);
+static result_t runHrefscan(const char* html, const size_t len);
+static result_t runLinkscan(const char* html, const size_t len);
+static void countLink(void* arg, char* url);
+static char* oldGetNextURL(char* html, const char* base, int* pos);
+static void squeeze(char* str);
+static uint64_t checksum(uint64_t sum, const char* data, size_t len);
+static double seconds(void);
+
+/**************** main ****************/
+int main(const int argc, char* argv[])
+{
+    int megabytes = 16, linksPerKB = 20, runs = 3;
+    static const struct option longOptions[] = {
+        { "megabytes", required_argument, NULL, 'm' },
+        { "links",     required_argument, NULL, 'l' },
+        { "runs",      required_argument, NULL, 'r' },
+        { NULL, 0, NULL, 0 }
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "", longOptions, NULL)) != -1) {
+        int* target = (opt == 'm') ? &megabytes : (opt == 'l') ? &linksPerKB
+                      : (opt == 'r') ? &runs : NULL;
+        char extra;
+        if (target == NULL || sscanf(optarg, "%d%c", target, &extra) != 1 || *target < 1) {
+            fprintf(stderr, "Usage: %s [--megabytes n] [--links perKB] [--runs n]\n", argv[0]);
+            exit(1);
+        }
+    }
+
+    size_t len = 0;
+    char* page = makePage((long)megabytes << 20, linksPerKB, &len);
+    char* squeezed = strdup(page);
+    if (page == NULL || squeezed == NULL) {
+        fprintf(stderr, "linkbench: out of memory\n");
+        exit(2);
+    }
+    squeeze(squeezed);
+    size_t squeezedLen = strlen(squeezed);
+    printf("Page: %.1f MB with about %d links per KB; best of %d runs; best kernel %s\n",
+           len / 1048576.0, linksPerKB, runs, hrefscan_kernel());
+
+    // the kernels this CPU runs, best first
+    const char* kernels[] = { "avx2", "sse2", "scalar" };
+    method_t methods[16];
+    int numMethods = 0;
+    for (int k = 0; k < 3; k++) {
+        if (hrefscan_setKernel(kernels[k])) {
+            methods[numMethods] = (method_t){ "", kernels[k], runGetNextURL, 0 };
+            snprintf(methods[numMethods++].name, 32, "getNextURL %s", kernels[k]);
+        }
+    }
+    methods[numMethods++] = (method_t){ "old getNextURL", NULL, runOldGetNextURL, 0 };
+    methods[numMethods++] = (method_t){ "linkscan", NULL, runLinkscan, 0 };
+    for (int k = 0; k < 3; k++) {
+        if (hrefscan_setKernel(kernels[k])) {
+            methods[numMethods] = (method_t){ "", kernels[k], runHrefscan, 1 };
+            snprintf(methods[numMethods++].name, 32, "hrefscan %s", kernels[k]);
+        }
+    }
+    hrefscan_setKernel("auto");
+
+    result_t expected[2];
+    bool have[2] = { false, false };
+    int status = 0;
+    for (int m = 0; m < numMethods; m++) {
+        if (methods[m].kernel != NULL) {
+            hrefscan_setKernel(methods[m].kernel);
+        }
+        // hrefscan reads the squeezed page; the others squeeze their own copy
+        const char* html = (methods[m].group == 1) ? squeezed : page;
+        size_t htmlLen = (methods[m].group == 1) ? squeezedLen : len;
+        double best = 0;
+        result_t result = { 0, 0 };
+        for (int r = 0; r < runs; r++) {
+            double start = seconds();
+            result = methods[m].run(html, htmlLen);
+            double elapsed = seconds() - start;
+            if (r == 0 || elapsed < best) {
+                best = elapsed;
+            }
+        }
+        hrefscan_setKernel("auto");
+
+        // every row must agree with the first of its group
+        int g = methods[m].group;
+        if (!have[g]) {
+            expected[g] = result;
+            have[g] = true;
+        }
+        bool ok = result.links == expected[g].links && result.sum == expected[g].sum;
+        printf("%-18s %8.3f s %9.1f MB/s %10ld links%s\n", methods[m].name, best,
+               len / 1048576.0 / best, result.links, ok ? "" : "  MISMATCH");
+        if (!ok) {
+            status = 3;
+        }
+    }
+
+    free(squeezed);
+    free(page);
+    return status;
+}
+
+/**************** makePage ****************/
+/* Return a malloc'd page of about bytes bytes with about linksPerKB
+ * anchor-ish tags per KB, and set *len to its length; NULL if out of
+ * memory. The page is the same for the same arguments.
+ */
+static char*
+makePage(const long bytes, const int linksPerKB, size_t* len)
+{
+    static const char* tags[] = {
+        "<a href=\"page%u.html\">a page</a>",
+        "<A HREF='http://cs50tse.cs.dartmouth.edu/tse/other/%u.html#part'>other</A>",
+        "<a class=\"nav\" href = \"../up/%u.html\" title=\"up\">up</a>",
+        "<a href=sub/%u.html>sub</a>",
+        "<a href=\"\" id=\"self%u\">this directory</a>",
+        "<a name=\"anchor%u\">here</a>",
+        "<a href=\"#section%u\">jump</a>",
+        "<a href=\"mailto:user%u@example.com\">mail</a>",
+        "<abbr title=\"abbreviation %u\">TSE</abbr>",
+        "<aside id=\"note%u\">note</aside>",
+    };
+    static const char* filler[] = {
+        "<p>The quick brown fox jumps over the lazy dog.</p>\n",
+        "<div class=\"row\"><span>Lorem ipsum dolor sit amet</span></div>\n",
+        "<img src=\"picture.png\" alt=\"a picture\">\n",
+        "consectetur adipiscing elit, sed do eiusmod tempor ",
+        "<li>incididunt ut labore</li>\n",
+    };
+    const int numTags = sizeof(tags) / sizeof(tags[0]);
+    const int numFiller = sizeof(filler) / sizeof(filler[0]);
+
+    char* page = malloc(bytes + 4096);
+    if (page == NULL) {
+        return NULL;
+    }
+    uint64_t state = 1;
+    long gap = 1024 / linksPerKB;        // bytes between tags, on average
+    long written = 0;
+    while (written < bytes) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        written += sprintf(page + written, tags[(state >> 33) % numTags],
+                           (unsigned)(state >> 45));
+        long text = (long)((state >> 20) % (2 * gap + 1));
+        while (text > 0 && written < bytes) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            int n = sprintf(page + written, "%s", filler[(state >> 33) % numFiller]);
+            written += n;
+            text -= n;
+        }
+    }
+    *len = written;
+    return page;
+}
+
+/**************** runGetNextURL ****************/
+static result_t
+runGetNextURL(const char* html, const size_t len)
+{
+    result_t result = { 0, 0 };
+    char* copy = malloc(len + 1);
+    char* url = strdup(BASE);
+    webpage_t* page = (copy != NULL && url != NULL)
+        ? webpage_new(url, 0, memcpy(copy, html, len + 1)) : NULL;
+    if (page == NULL) {
+        free(copy);
+        free(url);
+        return result;
+    }
+    int pos = 0;
+    char* link;
+    while ((link = webpage_getNextURL(page, &pos)) != NULL) {
+        countLink(&result, link);
+    }
+    webpage_delete(page);
+    return result;
+}
+
+/**************** runOldGetNextURL ****************/
+static result_t
+runOldGetNextURL(const char* html, const size_t len)
+{
+    result_t result = { 0, 0 };
+    char* copy = malloc(len + 1);
+    if (copy == NULL) {
+        return result;
+    }
+    memcpy(copy, html, len + 1);
+    int pos = 0;
+    char* link;
+    while ((link = oldGetNextURL(copy, BASE, &pos)) != NULL) {
+        countLink(&result, link);
+    }
+    free(copy);
+    return result;
+}
+
+/**************** runHrefscan ****************/
+/* Find every href in the (squeezed) page, as getNextURL would, but
+ * neither check nor resolve them.
+ */
+static result_t
+runHrefscan(const char* html, const size_t len)
+{
+    result_t result = { 0, 0 };
+    hrefscan_link_t link;
+    size_t pos = 0;
+    while (hrefscan_next(html, len, pos, &link)) {
+        result.links++;
+        result.sum = checksum(result.sum, html + link.start, link.len);
+        pos = link.end;
+    }
+    return result;
+}
+
+/**************** runLinkscan ****************/
+static result_t
+runLinkscan(const char* html, const size_t len)
+{
+    result_t result = { 0, 0 };
+    linkscan_t* ls = linkscan_new(BASE, countLink, &result);
+    linkscan_feed(ls, html, len);
+    linkscan_delete(ls);
+    return result;
+}
+
+/**************** countLink ****************/
+/* Count the link url in the result_t* arg, and free it. */
+static void
+countLink(void* arg, char* url)
+{
+    result_t* result = arg;
+    result->links++;
+    result->sum = checksum(result->sum, url, strlen(url));
+    free(url);
+}
+
+/**************** oldGetNextURL ****************/
+/* webpage_getNextURL as it was: strcasestr for each "<a" and "href=",
+ * moving on just two bytes past the last place it looked after a link
+ * it can't use. Resolves with resolveURL, which does what the old code
+ * did for the links that get that far.
+ */
+static char*
+oldGetNextURL(char* html, const char* base, int* pos)
+{
+    char* lnk;
+    char* href;
+    char* end;
+    char* ptr;
+    char* hash;
+    char delim;
+    bool bad;
+
+    if (*pos == 0) {
+        squeeze(html);
+    }
+    do {
+        bad = false;
+        lnk = strcasestr(&html[*pos], "<a");
+        if (lnk == NULL) {
+            return NULL;
+        }
+        href = strcasestr(lnk, "href=");
+        if (href == NULL) {
+            return NULL;
+        }
+        end = strchr(lnk, '>');
+        if (end != NULL && end < href) {
+            bad = true; (*pos) += 2; continue;
+        }
+        href += 5;
+        if (*href == '\'' || *href == '"') {
+            delim = *(href++);
+            end = strchr(href, delim);
+        } else {
+            end = strchr(href, '>');
+        }
+        hash = strchr(href, '#');
+        if (hash != NULL && hash < end) {
+            end = hash;
+        }
+        if (end == NULL || *href == '#') {
+            bad = true; (*pos) += 2; continue;
+        }
+        ptr = strpbrk(href, ":/?#");
+        if (ptr != NULL && *ptr == ':' && strncasecmp(href, "http", 4) != 0) {
+            bad = true; (*pos) += 2; continue;
+        }
+    } while (bad);
+
+    *pos = end - html;
+    return resolveURL(base, href, end - href);
+}
+
+/**************** squeeze ****************/
+/* Remove the whitespace from str, as webpage_getNextURL does. */
+static void
+squeeze(char* str)
+{
+    char* to = str;
+    for (char* from = str; *from != '\0'; from++) {
+        if (!isspace((unsigned char)*from)) {
+            *to++ = *from;
+        }
+    }
+    *to = '\0';
+}
+
+/**************** checksum ****************/
+/* Fold len bytes of data into sum (FNV-1a). */
+static uint64_t
+checksum(uint64_t sum, const char* data, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        sum = (sum ^ (unsigned char)data[i]) * 0x100000001B3ULL;
+    }
+    return (sum ^ len) * 0x100000001B3ULL;
+}
+
+/**************** seconds ****************/
+/* Return a monotonic time in seconds. */
+static double
+seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
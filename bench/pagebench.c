@@ -0,0 +1,305 @@
+/*
+ * pagebench - time saving and loading page files, a batch at a time
+ *
+ * Makes `--pages` pages of about `--size` bytes of HTML each, then saves
+ * them as page files in a fresh directory, and loads them back, with
+ * each kind of pagedir batch I/O, and prints the pages/s and the system
+ * calls per page of each:
+ *
+ *   sync       blocking calls, a file at a time: open, write, close to
+ *              save; open, fstat, read, close to load
+ *   io_uring   a batch of `--batch` files at a time: one io_uring_enter
+ *              opens them all, and another writes (or reads) and closes
+ *              them all
+ *   mmap       loading only, with pagedir_map: a view of each file in
+ *              place of a webpage copied out of it; open, fstat, mmap,
+ *              close, and munmap when done with it (or, under 16 KB,
+ *              open, fstat, read, close)
+ *
+ * The io_uring rows are missing if the build or the kernel has no
+ * io_uring. Loads come from the page cache, as they mostly do when the
+ * indexer follows the crawler, and each load's time includes reading
+ * every page once, for a checksum, as the indexer would. Every load must
+ * find every page as it was saved, or the run fails.
+ *
+ * usage: pagebench [--pages n] [--size bytes] [--batch n] [--runs n]
+ *
+ * CS50 FA25 Final Project
+ */
+
+#define _GNU_SOURCE       // mkdtemp, strdup
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+#include <unistd.h>
+#include "../libcs50/webpage.h"
+#include "../common/pagedir.h"
+
+/**************** function prototypes ****************/
+static webpage_t** makePages(const int numPages, const int size);
+static bool runBackend(const char* name, const pagedir_io_t io, const char* dir,
+                       webpage_t** pages, const int numPages, const int batchSize,
+                       const int runs);
+static bool runMapped(const char* dir, const int numPages, const int runs,
+                      const uint64_t expected);
+static uint64_t checksum(uint64_t sum, const char* data, size_t len);
+static uint64_t pageSum(webpage_t* const pages[], const int numPages, const bool loaded);
+static double seconds(void);
+
+/**************** main ****************/
+int main(const int argc, char* argv[])
+{
+    int numPages = 5000, size = 8192, batchSize = 64, runs = 3;
+    static const struct option longOptions[] = {
+        { "pages", required_argument, NULL, 'p' },
+        { "size",  required_argument, NULL, 's' },
+        { "batch", required_argument, NULL, 'b' },
+        { "runs",  required_argument, NULL, 'r' },
+        { NULL, 0, NULL, 0 }
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "", longOptions, NULL)) != -1) {
+        int* target = (opt == 'p') ? &numPages : (opt == 's') ? &size
+                      : (opt == 'b') ? &batchSize : (opt == 'r') ? &runs : NULL;
+        char extra;
+        if (target == NULL || sscanf(optarg, "%d%c", target, &extra) != 1 || *target < 1) {
+            fprintf(stderr, "Usage: %s [--pages n] [--size bytes] [--batch n] [--runs n]\n",
+                    argv[0]);
+            exit(1);
+        }
+    }
+
+    char dir[] = "/tmp/pagebench-XXXXXX";
+    webpage_t** pages = makePages(numPages, size);
+    if (mkdtemp(dir) == NULL || pages == NULL) {
+        perror("pagebench");
+        exit(2);
+    }
+    printf("Pages: %d of about %d bytes, %d to a batch; best of %d runs\n",
+           numPages, size, batchSize, runs);
+
+    bool ok = runBackend("sync", PAGEDIR_IO_SYNC, dir, pages, numPages, batchSize, runs);
+    ok = runBackend("io_uring", PAGEDIR_IO_URING, dir, pages, numPages, batchSize, runs) && ok;
+    ok = runMapped(dir, numPages, runs, pageSum(pages, numPages, false)) && ok;
+
+    // clean up
+    for (int docID = 1; docID <= numPages; docID++) {
+        char path[sizeof(dir) + 20];
+        snprintf(path, sizeof(path), "%s/%d", dir, docID);
+        unlink(path);
+    }
+    rmdir(dir);
+    for (int i = 0; i < numPages; i++) {
+        webpage_delete(pages[i]);
+    }
+    free(pages);
+    return ok ? 0 : 3;
+}
+
+/**************** makePages ****************/
+/* Return numPages new pages with about size bytes of HTML each, varied
+ * from half to one and a half times size; NULL if out of memory.
+ */
+static webpage_t**
+makePages(const int numPages, const int size)
+{
+    webpage_t** pages = calloc(numPages, sizeof(webpage_t*));
+    if (pages == NULL) {
+        return NULL;
+    }
+    uint64_t state = 1;
+    for (int i = 0; i < numPages; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        int len = size / 2 + (int)((state >> 20) % (size + 1));
+        char* html = malloc(len + 1);
+        char url[64];
+        snprintf(url, sizeof(url), "http://localhost/tse/bench/p%d.html", i);
+        char* urlCopy = strdup(url);
+        if (html == NULL || urlCopy == NULL) {
+            free(html);
+            free(urlCopy);
+            return NULL;
+        }
+        for (int j = 0; j < len; j++) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            html[j] = ((state >> 58) == 0) ? '\n' : "<a href=x.html>word text</a> "[(state >> 40) % 28];
+        }
+        html[len] = '\0';
+        pages[i] = webpage_new(urlCopy, i % 10, html);
+        if (pages[i] == NULL) {
+            return NULL;
+        }
+    }
+    return pages;
+}
+
+/**************** runBackend ****************/
+/* Save the pages as docIDs 1 on in dir with io, runs times, then load
+ * them back runs times, and print a row for each. Returns false if a
+ * page fails to save, or comes back other than it was saved.
+ */
+static bool
+runBackend(const char* name, const pagedir_io_t io, const char* dir,
+           webpage_t** pages, const int numPages, const int batchSize, const int runs)
+{
+    pagedir_batch_t* batch = pagedir_batchNew(batchSize, io);
+    int* docIDs = malloc(numPages * sizeof(int));
+    webpage_t** loaded = calloc(numPages, sizeof(webpage_t*));
+    if (batch == NULL || docIDs == NULL || loaded == NULL) {
+        fprintf(stderr, "pagebench: out of memory\n");
+        pagedir_batchDelete(batch);
+        free(docIDs);
+        free(loaded);
+        return false;
+    }
+    if (pagedir_batchIO(batch) != io) {
+        printf("%-9s not available\n", name);
+        pagedir_batchDelete(batch);
+        free(docIDs);
+        free(loaded);
+        return true;
+    }
+    for (int i = 0; i < numPages; i++) {
+        docIDs[i] = i + 1;
+    }
+
+    bool ok = true;
+    uint64_t expected = pageSum(pages, numPages, false);
+    for (int job = 0; job < 2; job++) {
+        double best = 0;
+        long calls = 0;
+        for (int r = 0; r < runs; r++) {
+            long before, after;
+            pagedir_batchStats(batch, &before, NULL);
+            double start = seconds();
+            int done = (job == 0)
+                ? pagedir_saveBatch(batch, dir, pages, docIDs, numPages, PAGEDIR_PLAIN,
+                                    false, NULL)
+                : pagedir_loadBatch(batch, dir, docIDs, numPages, loaded);
+            bool same = (job == 0) || pageSum(loaded, numPages, true) == expected;
+            double elapsed = seconds() - start;
+            pagedir_batchStats(batch, &after, NULL);
+            if (r == 0 || elapsed < best) {
+                best = elapsed;
+            }
+            calls = after - before;
+            ok = ok && same;
+            if (job == 1) {
+                for (int i = 0; i < numPages; i++) {
+                    webpage_delete(loaded[i]);
+                }
+            }
+            ok = ok && done == numPages;
+        }
+        printf("%-9s %-5s %8.3f s %10.0f pages/s %6.2f syscalls/page%s\n", name,
+               (job == 0) ? "save" : "load", best, numPages / best,
+               (double)calls / numPages, ok ? "" : "  MISMATCH");
+    }
+
+    pagedir_batchDelete(batch);
+    free(docIDs);
+    free(loaded);
+    return ok;
+}
+
+/**************** runMapped ****************/
+/* Map the pages saved as docIDs 1 on in dir, one at a time, runs times,
+ * and print a row. Returns false if a page comes back other than it was
+ * saved (expected is the pageSum of the pages saved).
+ */
+static bool
+runMapped(const char* dir, const int numPages, const int runs, const uint64_t expected)
+{
+    double best = 0;
+    bool ok = true;
+    long calls = 0;
+    for (int r = 0; r < runs; r++) {
+        uint64_t sum = 0;
+        int done = 0;
+        calls = 0;
+        double start = seconds();
+        for (int docID = 1; docID <= numPages; docID++) {
+            pagedir_view_t view;
+            if (!pagedir_map(dir, docID, &view)) {
+                sum = checksum(sum, "", 1);
+                continue;
+            }
+            // as pageSum sees a loaded page
+            size_t htmlLen = view.htmlLen;
+            if (htmlLen > 0 && view.html[htmlLen - 1] == '\n') {
+                htmlLen--;
+            }
+            sum = checksum(sum, view.url, view.urlLen);
+            sum = checksum(sum, (const char*)&view.depth, sizeof(view.depth));
+            sum = checksum(sum, view.html, htmlLen);
+            calls += (view.map != NULL) ? 5 : 4;
+            pagedir_unmap(&view);
+            done++;
+        }
+        double elapsed = seconds() - start;
+        if (r == 0 || elapsed < best) {
+            best = elapsed;
+        }
+        ok = ok && done == numPages && sum == expected;
+    }
+    printf("%-9s %-5s %8.3f s %10.0f pages/s %6.2f syscalls/page%s\n", "mmap", "load",
+           best, numPages / best, (double)calls / numPages, ok ? "" : "  MISMATCH");
+    return ok;
+}
+
+/**************** pageSum ****************/
+/* Return a checksum of the URL, depth, and HTML of each page, in order
+ * (a NULL page counts too). The HTML of a loaded page ends with the
+ * newline a page file adds, which does not count.
+ */
+static uint64_t
+pageSum(webpage_t* const pages[], const int numPages, const bool loaded)
+{
+    uint64_t sum = 0;
+    for (int i = 0; i < numPages; i++) {
+        if (pages[i] == NULL) {
+            sum = checksum(sum, "", 1);
+            continue;
+        }
+        const char* url = webpage_getURL(pages[i]);
+        const char* html = webpage_getHTML(pages[i]);
+        int depth = webpage_getDepth(pages[i]);
+        sum = checksum(sum, url, strlen(url));
+        sum = checksum(sum, (const char*)&depth, sizeof(depth));
+        size_t htmlLen = strlen(html);
+        if (loaded && htmlLen > 0 && html[htmlLen - 1] == '\n') {
+            htmlLen--;
+        }
+        sum = checksum(sum, html, htmlLen);
+    }
+    return sum;
+}
+
+/**************** checksum ****************/
+/* Fold len bytes of data into sum (FNV-1a). */
+static uint64_t
+checksum(uint64_t sum, const char* data, size_t len)
+{
+    if (sum == 0) {
+        sum = 14695981039346656037ULL;
+    }
+    for (size_t i = 0; i < len; i++) {
+        sum = (sum ^ (unsigned char)data[i]) * 1099511628211ULL;
+    }
+    return sum;
+}
+
+/**************** seconds ****************/
+/* Return a monotonic time in seconds. */
+static double
+seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
@@ -0,0 +1,609 @@
+/*
+ * tseserver - a stand-in web server for benchmarking the crawler
+ *
+ * Serves a generated site of `--pages` pages, /tse/bench/p0.html through
+ * p<pages-1>.html, over HTTP/1.1 with keep-alive. Everything about a page
+ * follows from --seed and its number, so every run serves the same site:
+ * its `--links` links to other pages, drawn at random, and its size,
+ * drawn from a log-normal distribution with median `--size` bytes and
+ * shape `--spread` (0 gives every page the same size). A `--missing`
+ * fraction of the pages (never p0) answer 404 every time; a `--errors`
+ * fraction of all requests answer 503, so a retry may succeed. A
+ * `--copies` fraction of the pages (never p0) repeat the page before them
+ * in all but their title, so a crawl has near-duplicates to find. Each
+ * response waits `--latency` ms plus up to `--jitter` ms more before it
+ * is sent. Pages carry an ETag and honour If-None-Match, so a recrawl can
+ * be measured too. With `--gzip` (when built with zlib), a page goes out
+ * gzip-encoded to a client that accepts it.
+ *
+ * Each connection gets its own thread. The server runs until SIGINT or
+ * SIGTERM, then prints what it served: request counts by outcome, bytes,
+ * requests per second, and the 50th and 99th percentile latency, which
+ * runs from the moment a whole request has arrived to the moment the
+ * last byte of its response has been written.
+ *
+ * usage: tseserver [--port n] [--pages n] [--links n] [--size bytes]
+ *                  [--spread sigma] [--latency ms] [--jitter ms]
+ *                  [--errors fraction] [--missing fraction] [--copies fraction]
+ *                  [--seed n] [--gzip]
+ *
+ * CS50 FA25 Final Project
+ */
+
+#define _GNU_SOURCE       // memmem
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <math.h>
+#include <errno.h>
+#include <getopt.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+/**************** local types ****************/
+/* command-line options, with their defaults set in main */
+typedef struct serveropts {
+    int port;                    // --port: 0 lets the system choose
+    int pages;                   // --pages: size of the site
+    int links;                   // --links: links on each page
+    int size;                    // --size: median page size, bytes
+    double spread;               // --spread: sigma of the log-normal size
+    int latency;                 // --latency: ms before each response
+    int jitter;                  // --jitter: up to this many ms more
+    double errors;               // --errors: fraction of requests answered 503
+    double missing;              // --missing: fraction of pages answered 404
+    double copies;               // --copies: fraction of pages copying the one before
+    uint64_t seed;               // --seed: which site to generate
+    bool gzip;                   // --gzip: compress pages for clients that accept it
+} serveropts_t;
+
+/* what the server has done so far; guarded by lock */
+typedef struct stats {
+    long ok, notModified, missing, errors;
+    long long bytes;             // every byte written, headers included
+    double* latencies;           // ms, one per response
+    long numLatencies, capLatencies;
+    struct timespec first;       // when the first request arrived
+    struct timespec last;        // when the last response was written
+    pthread_mutex_t lock;
+} stats_t;
+
+/**************** file-local global variables ****************/
+static serveropts_t opts;
+static stats_t stats = { .lock = PTHREAD_MUTEX_INITIALIZER };
+static uint64_t requestCount;            // drives the --errors draws
+static volatile sig_atomic_t stopping;
+static const size_t MAX_REQUEST = 8192;  // longest request we read
+static const char* WORDS[] = {
+    "search", "engine", "crawler", "index", "query", "page", "link", "word",
+    "tiny", "depth", "document", "score", "frontier", "politeness", "server",
+    "network", "fetch", "parse", "token", "stream", "buffer", "thread",
+};
+static const int NUM_WORDS = sizeof(WORDS) / sizeof(WORDS[0]);
+
+/**************** function prototypes ****************/
+static void parseArgs(const int argc, char* argv[]);
+static void* serveConnection(void* arg);
+static bool respond(const int fd, const char* request, bool* keepAlive);
+static char* makePage(const int page, size_t* len);
+static char* gzipPage(char* html, size_t* len);
+static bool acceptsGzip(const char* request);
+static bool pageMissing(const int page);
+static bool pageCopied(const int page);
+static bool writeAll(const int fd, const char* data, size_t len);
+static void record(const int status, const size_t bytes, const struct timespec* start);
+static void report(void);
+static int compareDoubles(const void* a, const void* b);
+static double elapsedMs(const struct timespec* from, const struct timespec* to);
+static uint64_t mix(uint64_t x);
+static double uniform(uint64_t* state);
+static void onSignal(int sig);
+
+/**************** main ****************/
+int main(const int argc, char* argv[])
+{
+    opts = (serveropts_t) {
+        .port = 8080,
+        .pages = 1000,
+        .links = 8,
+        .size = 8192,
+        .spread = 0.5,
+        .latency = 0,
+        .jitter = 0,
+        .errors = 0.0,
+        .missing = 0.0,
+        .copies = 0.0,
+        .seed = 1,
+        .gzip = false,
+    };
+    parseArgs(argc, argv);
+
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    struct sockaddr_in addr = { .sin_family = AF_INET,
+                                .sin_port = htons(opts.port),
+                                .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    socklen_t addrLen = sizeof(addr);
+    if (listener < 0
+        || setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) < 0
+        || bind(listener, (struct sockaddr*)&addr, sizeof(addr)) < 0
+        || listen(listener, 1024) < 0
+        || getsockname(listener, (struct sockaddr*)&addr, &addrLen) < 0) {
+        perror("tseserver");
+        exit(2);
+    }
+
+    // no SA_RESTART, so a signal interrupts accept and we can report
+    struct sigaction sa = { .sa_handler = onSignal };
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    printf("Listening: http://localhost:%d/tse/bench/p0.html\n", ntohs(addr.sin_port));
+    fflush(stdout);
+
+    while (!stopping) {
+        int fd = accept(listener, NULL, NULL);
+        if (fd < 0) {
+            if (errno != EINTR && errno != ECONNABORTED) {
+                perror("tseserver: accept");
+            }
+            continue;
+        }
+        // headers and body go out in separate writes; do not let Nagle
+        // hold the body back waiting for the client's delayed ACK
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, serveConnection, (void*)(intptr_t)fd) != 0) {
+            close(fd);
+            continue;
+        }
+        pthread_detach(thread);
+    }
+
+    close(listener);
+    report();
+    return 0;
+}
+
+/**************** parseArgs ****************/
+/* Fill in opts from the command line; on any error, print a message to
+ * stderr and exit non-zero.
+ */
+static void
+parseArgs(const int argc, char* argv[])
+{
+    static const struct option longOptions[] = {
+        { "port",    required_argument, NULL, 'p' },
+        { "pages",   required_argument, NULL, 'n' },
+        { "links",   required_argument, NULL, 'l' },
+        { "size",    required_argument, NULL, 's' },
+        { "spread",  required_argument, NULL, 'S' },
+        { "latency", required_argument, NULL, 't' },
+        { "jitter",  required_argument, NULL, 'J' },
+        { "errors",  required_argument, NULL, 'e' },
+        { "missing", required_argument, NULL, 'm' },
+        { "copies",  required_argument, NULL, 'c' },
+        { "seed",    required_argument, NULL, 'r' },
+        { "gzip",    no_argument,       NULL, 'g' },
+        { NULL, 0, NULL, 0 }
+    };
+    const char* usage = "Usage: %s [--port n] [--pages n] [--links n] [--size bytes] "
+        "[--spread sigma] [--latency ms] [--jitter ms] [--errors fraction] "
+        "[--missing fraction] [--copies fraction] [--seed n] [--gzip]\n";
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "", longOptions, NULL)) != -1) {
+        char extra;
+        int value = 0;
+        double fraction = 0;
+        bool ok;
+        switch (opt) {
+        case 'p': case 'n': case 'l': case 's': case 't': case 'J':
+            ok = sscanf(optarg, "%d%c", &value, &extra) == 1 && value >= 0
+                 && value <= 100000000;
+            break;
+        case 'S': case 'e': case 'm': case 'c':
+            ok = sscanf(optarg, "%lf%c", &fraction, &extra) == 1 && fraction >= 0
+                 && (opt == 'S' ? fraction <= 4 : fraction <= 1);
+            break;
+        case 'r':
+            ok = sscanf(optarg, "%d%c", &value, &extra) == 1;
+            break;
+        case 'g':
+#ifndef HAVE_ZLIB
+            fprintf(stderr, "Error: --gzip needs %s built with zlib\n", argv[0]);
+            exit(1);
+#endif
+            opts.gzip = true;
+            continue;
+        default:
+            fprintf(stderr, usage, argv[0]);
+            exit(1);
+        }
+        if (!ok) {
+            fprintf(stderr, "Error: bad value '%s' for an option\n", optarg);
+            exit(1);
+        }
+        switch (opt) {
+        case 'p': opts.port = value; break;
+        case 'n': opts.pages = value; break;
+        case 'l': opts.links = value; break;
+        case 's': opts.size = value; break;
+        case 't': opts.latency = value; break;
+        case 'J': opts.jitter = value; break;
+        case 'S': opts.spread = fraction; break;
+        case 'e': opts.errors = fraction; break;
+        case 'm': opts.missing = fraction; break;
+        case 'c': opts.copies = fraction; break;
+        case 'r': opts.seed = (uint64_t)value; break;
+        }
+    }
+    if (optind != argc || opts.pages < 1 || opts.port > 65535) {
+        fprintf(stderr, usage, argv[0]);
+        exit(1);
+    }
+}
+
+/**************** serveConnection ****************/
+/* Thread body for one connection (arg is its fd): answer requests until
+ * the client closes it, asks us to, or sends something we cannot parse.
+ */
+static void*
+serveConnection(void* arg)
+{
+    int fd = (int)(intptr_t)arg;
+    char* buf = malloc(MAX_REQUEST + 1);
+    size_t len = 0;
+    bool keepAlive = (buf != NULL);
+
+    while (keepAlive) {
+        // read until the blank line that ends the request's headers
+        char* end;
+        while ((end = memmem(buf, len, "\r\n\r\n", 4)) == NULL) {
+            ssize_t n = (len < MAX_REQUEST) ? read(fd, buf + len, MAX_REQUEST - len) : -1;
+            if (n <= 0) {
+                keepAlive = false;
+                break;
+            }
+            len += n;
+        }
+        if (end == NULL) {
+            break;
+        }
+        *end = '\0';
+        if (!respond(fd, buf, &keepAlive)) {
+            break;
+        }
+
+        // anything after the request is the start of the next one
+        size_t used = end + 4 - buf;
+        memmove(buf, buf + used, len - used);
+        len -= used;
+    }
+
+    free(buf);
+    close(fd);
+    return NULL;
+}
+
+/**************** respond ****************/
+/* Answer one request (its headers NUL-terminated, without the blank line)
+ * on fd, and set *keepAlive to whether the connection may carry another.
+ * Return false if the response could not be written.
+ */
+static bool
+respond(const int fd, const char* request, bool* keepAlive)
+{
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    // draw this request's fate before the delay, in arrival order
+    uint64_t draw = mix(opts.seed ^ __atomic_fetch_add(&requestCount, 1, __ATOMIC_RELAXED));
+    bool failed = uniform(&draw) < opts.errors;
+    int delay = opts.latency + (opts.jitter > 0 ? (int)(uniform(&draw) * opts.jitter) : 0);
+
+    int page = -1;
+    char extra;
+    if (sscanf(request, "GET /tse/bench/p%d.html HTTP/1.%c", &page, &extra) != 2
+        || page < 0 || page >= opts.pages) {
+        page = -1;
+    }
+    *keepAlive = strcasestr(request, "\r\nConnection: close") == NULL
+                 && strstr(request, "HTTP/1.0") == NULL;
+
+    char etag[32];
+    snprintf(etag, sizeof(etag), "\"%llx-%d\"", (unsigned long long)opts.seed, page);
+    const char* match = strcasestr(request, "\r\nIf-None-Match:");
+    bool unchanged = match != NULL && strstr(match, etag) != NULL;
+
+    int status;
+    char* body = NULL;
+    size_t bodyLen = 0;
+    const char* encoding = "";
+    if (failed) {
+        status = 503;
+    } else if (page < 0 || pageMissing(page)) {
+        status = 404;
+    } else if (unchanged) {
+        status = 304;
+    } else {
+        status = 200;
+        body = makePage(page, &bodyLen);
+        if (body != NULL && opts.gzip && acceptsGzip(request)) {
+            body = gzipPage(body, &bodyLen);
+            encoding = "Content-Encoding: gzip\r\n";
+        }
+        if (body == NULL) {
+            status = 503;
+        }
+    }
+    if (status == 404 || status == 503) {
+        body = strdup(status == 404 ? "<html><body>Not Found</body></html>\n"
+                                    : "<html><body>Try again later</body></html>\n");
+        bodyLen = (body != NULL) ? strlen(body) : 0;
+    }
+
+    char header[256];
+    const char* reason = (status == 200) ? "OK" : (status == 304) ? "Not Modified"
+                         : (status == 404) ? "Not Found" : "Service Unavailable";
+    int headerLen = snprintf(header, sizeof(header),
+                             "HTTP/1.1 %d %s\r\nContent-Type: text/html\r\n%s"
+                             "Content-Length: %zu\r\nETag: %s\r\nConnection: %s\r\n\r\n",
+                             status, reason, encoding, bodyLen, etag,
+                             *keepAlive ? "keep-alive" : "close");
+
+    if (delay > 0) {
+        struct timespec nap = { delay / 1000, (delay % 1000) * 1000000L };
+        while (nanosleep(&nap, &nap) != 0 && errno == EINTR) {
+        }
+    }
+    bool ok = writeAll(fd, header, headerLen) && writeAll(fd, body, bodyLen);
+    free(body);
+    if (ok) {
+        record(status, headerLen + bodyLen, &start);
+    }
+    return ok;
+}
+
+/**************** makePage ****************/
+/* Build the HTML of the given page, setting *len to its length; NULL if
+ * out of memory. A copied page gets the links and text of the first page
+ * before it that is not a copy. The caller frees it.
+ */
+static char*
+makePage(const int page, size_t* len)
+{
+    int source = page;
+    while (pageCopied(source)) {
+        source--;
+    }
+    uint64_t state = mix(opts.seed * 0x9E3779B97F4A7C15ULL + source);
+
+    // log-normal size around the median, by the Box-Muller transform
+    double u1 = uniform(&state), u2 = uniform(&state);
+    double z = sqrt(-2.0 * log(1.0 - u1)) * cos(2.0 * M_PI * u2);
+    double target = opts.size * exp(opts.spread * z);
+    size_t size = (target > 64.0 * opts.size) ? 64 * (size_t)opts.size : (size_t)target;
+    size_t linkRoom = 40 * (size_t)opts.links + 128;
+    size_t cap = (size > linkRoom ? size : linkRoom) + 256;
+
+    char* html = malloc(cap);
+    if (html == NULL) {
+        return NULL;
+    }
+    size_t n = snprintf(html, cap, "<html>\n<head><title>page %d</title></head>\n<body>\n",
+                        page);
+    for (int i = 0; i < opts.links; i++) {
+        int to = (int)(uniform(&state) * opts.pages);
+        n += snprintf(html + n, cap - n, "<a href=\"p%d.html\">page %d</a>\n", to, to);
+    }
+    // filler text up to the size drawn, leaving room for the closing tags
+    n += snprintf(html + n, cap - n, "<p>");
+    while (n + 32 < size) {
+        const char* word = WORDS[(int)(uniform(&state) * NUM_WORDS)];
+        n += snprintf(html + n, cap - n, "%s ", word);
+    }
+    n += snprintf(html + n, cap - n, "</p>\n</body>\n</html>\n");
+    *len = n;
+    return html;
+}
+
+/**************** gzipPage ****************/
+/* Return html, of *len bytes, gzip-encoded, setting *len to the new
+ * length; NULL if out of memory. Frees html either way.
+ */
+static char*
+gzipPage(char* html, size_t* len)
+{
+    char* gz = NULL;
+#ifdef HAVE_ZLIB
+    z_stream zs = { 0 };
+    if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8,
+                     Z_DEFAULT_STRATEGY) == Z_OK) {
+        size_t cap = deflateBound(&zs, *len);
+        gz = malloc(cap);
+        zs.next_in = (Bytef*)html;
+        zs.avail_in = *len;
+        zs.next_out = (Bytef*)gz;
+        zs.avail_out = cap;
+        if (gz != NULL && deflate(&zs, Z_FINISH) == Z_STREAM_END) {
+            *len = zs.total_out;
+        } else {
+            free(gz);
+            gz = NULL;
+        }
+        deflateEnd(&zs);
+    }
+#endif
+    free(html);
+    return gz;
+}
+
+/**************** acceptsGzip ****************/
+/* Does the request's Accept-Encoding line name gzip? */
+static bool
+acceptsGzip(const char* request)
+{
+    const char* line = strcasestr(request, "\r\nAccept-Encoding:");
+    if (line == NULL) {
+        return false;
+    }
+    line += 2;
+    const char* end = strchr(line, '\r');
+    const char* gzip = strcasestr(line, "gzip");
+    return gzip != NULL && (end == NULL || gzip < end);
+}
+
+/**************** pageMissing ****************/
+/* Is this one of the --missing fraction of pages that answer 404? */
+static bool
+pageMissing(const int page)
+{
+    uint64_t state = mix(opts.seed ^ (0xD1B54A32D192ED03ULL * (page + 1)));
+    return page != 0 && uniform(&state) < opts.missing;
+}
+
+/**************** pageCopied ****************/
+/* Is this one of the --copies fraction of pages that copy the one before? */
+static bool
+pageCopied(const int page)
+{
+    uint64_t state = mix(opts.seed ^ (0x8CB92BA72F3D8DD7ULL * (page + 1)));
+    return page != 0 && uniform(&state) < opts.copies;
+}
+
+/**************** writeAll ****************/
+/* Write len bytes to fd, however many calls it takes. */
+static bool
+writeAll(const int fd, const char* data, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+/**************** record ****************/
+/* Count a response of status and bytes, begun at start. */
+static void
+record(const int status, const size_t bytes, const struct timespec* start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    pthread_mutex_lock(&stats.lock);
+    if (stats.ok + stats.notModified + stats.missing + stats.errors == 0
+        || elapsedMs(start, &stats.first) > 0) {
+        stats.first = *start;
+    }
+    stats.last = now;
+    switch (status) {
+    case 200: stats.ok++; break;
+    case 304: stats.notModified++; break;
+    case 404: stats.missing++; break;
+    default:  stats.errors++; break;
+    }
+    stats.bytes += bytes;
+    if (stats.numLatencies == stats.capLatencies) {
+        long cap = (stats.capLatencies == 0) ? 4096 : 2 * stats.capLatencies;
+        double* latencies = realloc(stats.latencies, cap * sizeof(double));
+        if (latencies != NULL) {
+            stats.latencies = latencies;
+            stats.capLatencies = cap;
+        }
+    }
+    if (stats.numLatencies < stats.capLatencies) {
+        stats.latencies[stats.numLatencies++] = elapsedMs(start, &now);
+    }
+    pthread_mutex_unlock(&stats.lock);
+}
+
+/**************** report ****************/
+/* Print what the server has served, one "name: values" line each. */
+static void
+report(void)
+{
+    pthread_mutex_lock(&stats.lock);
+    long requests = stats.ok + stats.notModified + stats.missing + stats.errors;
+    double seconds = (requests > 0) ? elapsedMs(&stats.first, &stats.last) / 1000 : 0;
+    printf("Requests: %ld (%ld ok, %ld not modified, %ld not found, %ld errors)\n",
+           requests, stats.ok, stats.notModified, stats.missing, stats.errors);
+    printf("Served: %lld bytes in %.3f s (%.1f requests/s, %.2f MB/s)\n",
+           stats.bytes, seconds, seconds > 0 ? requests / seconds : 0.0,
+           seconds > 0 ? stats.bytes / seconds / 1e6 : 0.0);
+    if (stats.numLatencies > 0) {
+        qsort(stats.latencies, stats.numLatencies, sizeof(double), compareDoubles);
+        long n = stats.numLatencies;
+        printf("Latency: p50 %.2f ms, p99 %.2f ms, max %.2f ms\n",
+               stats.latencies[(n - 1) / 2], stats.latencies[(n - 1) * 99 / 100],
+               stats.latencies[n - 1]);
+    }
+    fflush(stdout);
+    pthread_mutex_unlock(&stats.lock);
+}
+
+/**************** compareDoubles ****************/
+/* qsort comparison for ascending doubles. */
+static int
+compareDoubles(const void* a, const void* b)
+{
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/**************** elapsedMs ****************/
+/* Return the milliseconds from `from` to `to` (negative if to is earlier). */
+static double
+elapsedMs(const struct timespec* from, const struct timespec* to)
+{
+    return (to->tv_sec - from->tv_sec) * 1e3 + (to->tv_nsec - from->tv_nsec) / 1e6;
+}
+
+/**************** mix ****************/
+/* The splitmix64 finalizer: a well-scrambled 64-bit hash of x. */
+static uint64_t
+mix(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+/**************** uniform ****************/
+/* Advance the splitmix64 generator at *state; return a double in [0,1). */
+static double
+uniform(uint64_t* state)
+{
+    *state += 0x9E3779B97F4A7C15ULL;
+    return (mix(*state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**************** onSignal ****************/
+/* SIGINT/SIGTERM: stop accepting connections, then report. */
+static void
+onSignal(int sig)
+{
+    (void)sig;
+    stopping = 1;
+}
@@ -2,6 +2,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 #include "index.h"
 #include "../libcs50/hashtable.h"
 #include "../libcs50/counters.h"
@@ -27,6 +28,90 @@ void index_add(index_t* index, const char* word, const int docID)
   counters_add(ctrs, docID);
 }
 
+void index_addPage(index_t* index, webpage_t* page, const int docID)
+{
+  if (index == NULL || page == NULL || docID < 1) {
+    return;
+  }
+
+  const char* html = webpage_getHTML(page);
+  if (html != NULL) {
+    index_addText(index, html, strlen(html), docID);
+  }
+}
+
+void index_addText(index_t* index, const char* text, const size_t len, const int docID)
+{
+  if (index == NULL || text == NULL || docID < 1) {
+    return;
+  }
+
+  // words as webpage_getNextWord finds them: runs of letters outside <...>,
+  // up to the first '\0'
+  const char* nul = memchr(text, '\0', len);
+  const char* end = (nul != NULL) ? nul : text + len;
+  char small[64];
+  const char* p = text;
+  while (p < end) {
+    if (*p == '<') {
+      const char* close = memchr(p, '>', end - p);
+      if (close == NULL || close + 1 == end) {
+        return;  // ran out of html
+      }
+      p = close + 1;
+    } else if (!isalpha((unsigned char)*p)) {
+      p++;
+    } else {
+      const char* beg = p;
+      while (p < end && isalpha((unsigned char)*p)) {
+        p++;
+      }
+      // Only consider words that have 3 or more characters
+      size_t wordLen = p - beg;
+      if (wordLen >= 3) {
+        // normalized in place of NormalizeWord, without a malloc for most
+        char* word = (wordLen < sizeof(small)) ? small : mem_malloc(wordLen + 1);
+        for (size_t i = 0; i < wordLen; i++) {
+          word[i] = tolower((unsigned char)beg[i]);
+        }
+        word[wordLen] = '\0';
+        index_add(index, word, docID);
+        if (word != small) {
+          free(word);
+        }
+      }
+    }
+  }
+}
+
+static void merge_count(void* arg, const int docID, const int count)
+{
+  counters_t* ctrs = arg;
+  counters_set(ctrs, docID, counters_get(ctrs, docID) + count);
+}
+
+static void merge_word(void* arg, const char* key, void* item)
+{
+  index_t* into = arg;
+  counters_t* ctrs = hashtable_find(into, key);
+  if (ctrs == NULL) {
+    ctrs = counters_new();
+    if (ctrs == NULL || !hashtable_insert(into, key, ctrs)) {
+      counters_delete(ctrs);
+      return;
+    }
+  }
+  counters_iterate(item, ctrs, merge_count);
+}
+
+void index_merge(index_t* into, index_t* from)
+{
+  if (into == NULL || from == NULL) {
+    return;
+  }
+  hashtable_iterate(from, into, merge_word);
+}
+
 static void save_helper(void* arg, const int docID, const int count)
 {
   FILE* fp = arg;
@@ -57,13 +142,19 @@ index_t* index_load(FILE* fp)
   }
 
   int num_lines = file_numLines(fp);
-  index_t* index = index_new(num_lines);
+  index_t* index = index_new(num_lines > 0 ? num_lines : 1);   // empty file: empty index
   if (index == NULL) {
     return NULL;
   }
 
+  file_reader_t* reader = file_reader_new(fp);
+  if (reader == NULL) {
+    index_delete(index);
+    return NULL;
+  }
+
   char* line;
-  while ((line = file_readLine(fp)) != NULL) {
+  while ((line = file_reader_line(reader, NULL)) != NULL) {
     char word[100];
     int pos = 0;
     int docID, count;
@@ -80,8 +171,8 @@ index_t* index_load(FILE* fp)
         rest += pos;
       }
     }
-    mem_free(line);
   }
+  file_reader_delete(reader);
   return index;
 }
 
@@ -4,6 +4,7 @@
 #include <stdio.h>
 #include "../libcs50/hashtable.h"
 #include "../libcs50/counters.h"
+#include "../libcs50/webpage.h"
 
 typedef hashtable_t index_t;
 
@@ -12,6 +13,16 @@ index_t* index_new(const int num_slots);
 
 void index_add(index_t* index, const char* word, const int docID);
 
+// add each word of 3 or more letters on the page, normalized, as docID
+void index_addPage(index_t* index, webpage_t* page, const int docID);
+
+// likewise for the len bytes of HTML at text, which need not end in '\0'
+// (words end at a '\0' all the same), such as a page mapped by pagedir_map
+void index_addText(index_t* index, const char* text, const size_t len, const int docID);
+
+// add every count in from to those in into
+void index_merge(index_t* into, index_t* from);
+
 void index_save(index_t* index, FILE* fp);
 
 index_t* index_load(FILE* fp);
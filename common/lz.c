@@ -0,0 +1,254 @@
+/*
+ * lz - a small, fast LZ77 block compressor for page files
+ *
+ * See lz.h for usage.
+ *
+ * The compressor is greedy: it hashes the 4 bytes at each position into
+ * a table of recent positions, and if the position found there starts
+ * the same 4 bytes (within 64 KB), it takes the longest match from it;
+ * otherwise the byte becomes a literal. Runs without matches are skipped
+ * faster the longer they get, so incompressible data costs little.
+ * As in LZ4, the last 5 bytes are always literals and no match starts in
+ * the last 12, which keeps the decoder's bounds checks simple.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "lz.h"
+
+/**************** file-local global variables ****************/
+#define HASH_BITS 14                   // 16K entries in the match table
+static const size_t MIN_MATCH = 4;
+static const size_t MAX_OFFSET = 65535;
+static const size_t LAST_LITERALS = 5; // bytes at the end always literal
+static const size_t MF_LIMIT = 12;     // no match starts this close to the end
+
+/**************** local functions ****************/
+static uint32_t read32(const char* p);
+static uint32_t hash4(const uint32_t v);
+static size_t matchLength(const char* a, const char* b, const char* limit);
+static char* putLength(char* op, size_t len);
+static char* putSequence(char* op, const char* lit, const size_t litLen,
+                         const size_t offset, const size_t matchLen);
+static bool getLength(const unsigned char** ip, const unsigned char* end, size_t* len);
+
+/**************** lz_bound ****************/
+size_t
+lz_bound(const size_t n)
+{
+    return n + n / 255 + 16;
+}
+
+/**************** lz_compress ****************/
+size_t
+lz_compress(const char* src, const size_t n, char* dst, const size_t cap)
+{
+    if (src == NULL || dst == NULL || cap < lz_bound(n)) {
+        return 0;
+    }
+
+    char* op = dst;
+    size_t anchor = 0;                 // first byte not yet emitted
+    if (n > MF_LIMIT) {
+        uint32_t* table = calloc((size_t)1 << HASH_BITS, sizeof(uint32_t));
+        if (table == NULL) {
+            return 0;
+        }
+        const char* limit = src + n - LAST_LITERALS;
+        size_t ip = 1;                 // position 0 is what empty slots hold
+        while (ip + MF_LIMIT <= n) {
+            uint32_t seq = read32(src + ip);
+            uint32_t h = hash4(seq);
+            size_t ref = table[h];
+            table[h] = (uint32_t)ip;
+
+            if (ref < ip && ip - ref <= MAX_OFFSET && read32(src + ref) == seq) {
+                size_t len = MIN_MATCH + matchLength(src + ip + MIN_MATCH,
+                                                     src + ref + MIN_MATCH, limit);
+                op = putSequence(op, src + anchor, ip - anchor, ip - ref, len);
+                ip += len;
+                anchor = ip;
+                if (ip + MF_LIMIT <= n) {
+                    // so the next match can start right behind this one
+                    table[hash4(read32(src + ip - 2))] = (uint32_t)(ip - 2);
+                }
+            } else {
+                ip += 1 + ((ip - anchor) >> 6);
+            }
+        }
+        free(table);
+    }
+
+    // the rest is literals, in a sequence with no match
+    size_t litLen = n - anchor;
+    *op++ = (char)((litLen < 15 ? litLen : 15) << 4);
+    if (litLen >= 15) {
+        op = putLength(op, litLen - 15);
+    }
+    memcpy(op, src + anchor, litLen);
+    op += litLen;
+    return op - dst;
+}
+
+/**************** lz_decompress ****************/
+bool
+lz_decompress(const char* src, const size_t n, char* dst, const size_t dstLen)
+{
+    if (src == NULL || dst == NULL) {
+        return false;
+    }
+
+    const unsigned char* ip = (const unsigned char*)src;
+    const unsigned char* end = ip + n;
+    size_t op = 0;
+    while (ip < end) {
+        unsigned token = *ip++;
+
+        // literals
+        size_t lit = token >> 4;
+        if (lit == 15 && !getLength(&ip, end, &lit)) {
+            return false;
+        }
+        if (lit > (size_t)(end - ip) || lit > dstLen - op) {
+            return false;
+        }
+        memcpy(dst + op, ip, lit);
+        ip += lit;
+        op += lit;
+        if (ip == end) {
+            break;                     // the last sequence has no match
+        }
+
+        // match
+        if (end - ip < 2) {
+            return false;
+        }
+        size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        size_t len = token & 15;
+        if (len == 15 && !getLength(&ip, end, &len)) {
+            return false;
+        }
+        len += MIN_MATCH;
+        if (offset == 0 || offset > op || len > dstLen - op) {
+            return false;
+        }
+        const char* from = dst + op - offset;
+        if (offset >= len) {
+            memcpy(dst + op, from, len);
+        } else {
+            for (size_t i = 0; i < len; i++) {   // overlapping: a repeat
+                dst[op + i] = from[i];
+            }
+        }
+        op += len;
+    }
+    return op == dstLen;
+}
+
+/**************** read32 ****************/
+/* Return the 4 bytes at p as an integer (in native byte order). */
+static uint32_t
+read32(const char* p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/**************** hash4 ****************/
+/* Hash 4 bytes to HASH_BITS bits (Knuth's multiplicative hash). */
+static uint32_t
+hash4(const uint32_t v)
+{
+    return (v * 2654435761U) >> (32 - HASH_BITS);
+}
+
+/**************** matchLength ****************/
+/* Return how many bytes from a on equal those from b, stopping at limit
+ * (a < limit; b < a). Compares 8 bytes at a time.
+ */
+static size_t
+matchLength(const char* a, const char* b, const char* limit)
+{
+    const char* start = a;
+    while (a + 8 <= limit) {
+        uint64_t x, y;
+        memcpy(&x, a, 8);
+        memcpy(&y, b, 8);
+        if (x != y) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            // the first differing byte is the lowest set byte of x ^ y
+            return (a - start) + (__builtin_ctzll(x ^ y) >> 3);
+#else
+            break;
+#endif
+        }
+        a += 8;
+        b += 8;
+    }
+    while (a < limit && *a == *b) {
+        a++;
+        b++;
+    }
+    return a - start;
+}
+
+/**************** putLength ****************/
+/* Write the extension bytes of a length that did not fit in its 4 bits:
+ * 255 as often as it takes, then the remainder.
+ */
+static char*
+putLength(char* op, size_t len)
+{
+    while (len >= 255) {
+        *op++ = (char)255;
+        len -= 255;
+    }
+    *op++ = (char)len;
+    return op;
+}
+
+/**************** putSequence ****************/
+/* Write one sequence: litLen literals from lit, then a match of matchLen
+ * (>= MIN_MATCH) bytes at offset back. Returns where the next one goes.
+ */
+static char*
+putSequence(char* op, const char* lit, const size_t litLen,
+            const size_t offset, const size_t matchLen)
+{
+    size_t ml = matchLen - MIN_MATCH;
+    char* token = op++;
+    *token = (char)(((litLen < 15 ? litLen : 15) << 4) | (ml < 15 ? ml : 15));
+    if (litLen >= 15) {
+        op = putLength(op, litLen - 15);
+    }
+    memcpy(op, lit, litLen);
+    op += litLen;
+    *op++ = (char)(offset & 0xff);
+    *op++ = (char)(offset >> 8);
+    if (ml >= 15) {
+        op = putLength(op, ml - 15);
+    }
+    return op;
+}
+
+/**************** getLength ****************/
+/* Read the extension bytes of a length whose 4 bits were all set, adding
+ * them to *len. Returns false if the input ends first.
+ */
+static bool
+getLength(const unsigned char** ip, const unsigned char* end, size_t* len)
+{
+    unsigned char b;
+    do {
+        if (*ip >= end) {
+            return false;
+        }
+        b = *(*ip)++;
+        *len += b;
+    } while (b == 255);
+    return true;
+}
@@ -0,0 +1,39 @@
+#ifndef __LZ_H
+#define __LZ_H
+
+/*
+ * lz - a small, fast LZ77 block compressor for page files
+ *
+ * The format is that of an LZ4 block: a run of sequences, each a token
+ * byte (4 bits of literal length, 4 bits of match length), the literals,
+ * and a 2-byte match offset back into what has been decoded already.
+ * It compresses HTML pages about 2-3:1 (zlib manages 4-5:1, much more
+ * slowly) at a few hundred MB/s, and decompresses faster still; the block
+ * carries no length or checksum of its own, so the caller stores the
+ * decompressed length.
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/* lz_bound
+ * Return the most bytes lz_compress can produce from n bytes of input.
+ */
+size_t lz_bound(const size_t n);
+
+/* lz_compress
+ * Compress the n bytes at src into dst, which has room for cap bytes.
+ * Returns the compressed length, or 0 if it does not fit
+ * (it always fits if cap >= lz_bound(n)).
+ */
+size_t lz_compress(const char* src, const size_t n, char* dst, const size_t cap);
+
+/* lz_decompress
+ * Decompress the n bytes at src, which lz_compress made from exactly
+ * dstLen bytes, into dst.
+ * Returns true on success; false if src is corrupt or does not decode to
+ * exactly dstLen bytes. Never reads or writes out of bounds.
+ */
+bool lz_decompress(const char* src, const size_t n, char* dst, const size_t dstLen);
+
+#endif // __LZ_H
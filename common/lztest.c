@@ -0,0 +1,195 @@
+/*
+ * lztest.c - unit test for the lz module
+ *
+ * Compresses and decompresses inputs that exercise each part of the
+ * block format (no matches, long literal runs, long and overlapping
+ * matches, matches near the 64 KB window edge), and checks that every
+ * corrupt or truncated block is refused without reading or writing out
+ * of bounds. Build it with -fsanitize=address to check the bounds too.
+ *
+ * usage: lztest
+ * Prints a line for each failed check, then a count; exits non-zero if
+ * any check failed.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "lz.h"
+
+/**************** file-local global variables ****************/
+static int checks = 0;
+static int failures = 0;
+
+/**************** local functions ****************/
+static void check(const bool ok, const char* what, const size_t n);
+static void roundTrip(const char* what, const char* src, const size_t n);
+static void corrupt(const char* what, const char* src, const size_t n);
+static char* makeText(const size_t n);
+static char* makeNoise(const size_t n, unsigned seed);
+
+/**************** main ****************/
+int main(void)
+{
+    char* text = makeText(200000);
+    char* noise = makeNoise(100000, 1);
+    char* run = malloc(70000);
+    if (text == NULL || noise == NULL || run == NULL) {
+        fprintf(stderr, "lztest: out of memory\n");
+        return 2;
+    }
+    memset(run, 'x', 70000);
+
+    roundTrip("empty", "", 0);
+    roundTrip("one byte", "a", 1);
+    roundTrip("shorter than a match can start", "<html></html>", 13);
+    for (size_t n = 14; n <= 300; n++) {            // literal length extension bytes
+        roundTrip("text prefix", text, n);
+    }
+    roundTrip("html text", text, 200000);
+    roundTrip("incompressible", noise, 100000);
+    roundTrip("a run (overlapping matches)", run, 70000);
+    // the same 4 KB again 65535 bytes on (the farthest a match reaches),
+    // then 65536 bytes on (too far)
+    char* far = makeNoise(4096 + 65536 + 4096, 2);
+    if (far != NULL) {
+        memcpy(far + 65535, far, 4096);
+        roundTrip("match at the window edge", far, 65535 + 4096);
+        memcpy(far + 4096 + 65536, far + 4096, 4096);
+        roundTrip("match past the window", far, 4096 + 65536 + 4096);
+        free(far);
+    }
+
+    // a destination smaller than lz_bound is refused
+    char small[64];
+    check(lz_compress(text, 100, small, sizeof(small)) == 0, "small destination", 100);
+
+    corrupt("html text", text, 5000);
+    corrupt("a run", run, 3000);
+
+    // a match before anything has been decoded, and one with offset 0
+    const char ahead[] = { 0x10, 'a', 0x02, 0x00 };
+    char out[64];
+    check(!lz_decompress(ahead, sizeof(ahead), out, 5), "offset past the output", 4);
+    const char zero[] = { 0x10, 'a', 0x00, 0x00 };
+    check(!lz_decompress(zero, sizeof(zero), out, 5), "offset 0", 4);
+    // a literal length whose extension bytes run off the end
+    const char longLit[] = { (char)0xf0, (char)0xff, (char)0xff };
+    check(!lz_decompress(longLit, sizeof(longLit), out, sizeof(out)),
+          "literal length past the end", 3);
+
+    free(text);
+    free(noise);
+    free(run);
+    printf("lztest: %d checks, %d failed\n", checks, failures);
+    return failures == 0 ? 0 : 1;
+}
+
+/**************** check ****************/
+/* Count one check, and report it if it failed. */
+static void
+check(const bool ok, const char* what, const size_t n)
+{
+    checks++;
+    if (!ok) {
+        failures++;
+        printf("FAIL: %s (%zu bytes)\n", what, n);
+    }
+}
+
+/**************** roundTrip ****************/
+/* Compress the n bytes at src, and check they decompress to the same n
+ * bytes, and to no other length.
+ */
+static void
+roundTrip(const char* what, const char* src, const size_t n)
+{
+    size_t cap = lz_bound(n);
+    char* packed = malloc(cap);
+    char* back = malloc(n + 1);
+    if (packed == NULL || back == NULL) {
+        check(false, "out of memory", n);
+        free(packed);
+        free(back);
+        return;
+    }
+    size_t len = lz_compress(src, n, packed, cap);
+    check(len > 0 && len <= cap, what, n);
+    check(lz_decompress(packed, len, back, n) && memcmp(src, back, n) == 0, what, n);
+    check(!lz_decompress(packed, len, back, n + 1), "decompressed length too long", n);
+    if (n > 0) {
+        check(!lz_decompress(packed, len, back, n - 1), "decompressed length too short", n);
+    }
+    free(packed);
+    free(back);
+}
+
+/**************** corrupt ****************/
+/* Compress the n bytes at src, then check that no truncation of the block
+ * decodes, and that flipping any one byte never decodes out of bounds (it
+ * may still decode, to something else, as LZ blocks have no checksum).
+ */
+static void
+corrupt(const char* what, const char* src, const size_t n)
+{
+    size_t cap = lz_bound(n);
+    char* packed = malloc(cap);
+    char* back = malloc(n);
+    if (packed == NULL || back == NULL) {
+        check(false, "out of memory", n);
+        free(packed);
+        free(back);
+        return;
+    }
+    size_t len = lz_compress(src, n, packed, cap);
+    bool refused = true;
+    for (size_t cut = 0; cut < len; cut++) {
+        refused = refused && !lz_decompress(packed, cut, back, n);
+    }
+    check(refused, what, n);
+    for (size_t i = 0; i < len; i++) {
+        packed[i] ^= 0x5a;
+        lz_decompress(packed, len, back, n);
+        packed[i] ^= 0x5a;
+    }
+    check(lz_decompress(packed, len, back, n), what, n);
+    free(packed);
+    free(back);
+}
+
+/**************** makeText ****************/
+/* Return n bytes of made-up HTML, which compresses about as a page does. */
+static char*
+makeText(const size_t n)
+{
+    static const char* words[] = {
+        "<a href=\"page.html\">", "</a>", "<p>", "</p>\n", "crawler ", "index ",
+        "search ", "engine ", "the ", "of ", "Dartmouth ", "<div class=\"x\">",
+    };
+    char* text = malloc(n);
+    unsigned state = 12345;
+    for (size_t i = 0; text != NULL && i < n; ) {
+        state = state * 1103515245 + 12345;
+        const char* word = words[(state >> 16) % (sizeof(words) / sizeof(words[0]))];
+        for (size_t j = 0; word[j] != '\0' && i < n; j++) {
+            text[i++] = word[j];
+        }
+    }
+    return text;
+}
+
+/**************** makeNoise ****************/
+/* Return n bytes that do not compress, drawn from seed. */
+static char*
+makeNoise(const size_t n, unsigned seed)
+{
+    char* noise = malloc(n);
+    for (size_t i = 0; noise != NULL && i < n; i++) {
+        seed = seed * 1103515245 + 12345;
+        noise[i] = (char)(seed >> 16);
+    }
+    return noise;
+}
@@ -0,0 +1,312 @@
+/*
+ * packtest.c - unit test for the pagepack module
+ *
+ * Builds a pack in a new directory under /tmp and checks that pages
+ * saved in any order, one at a time or in a batch, plain or compressed,
+ * load and map back as they were saved; that a page too big for the
+ * current segment starts the next one; that reopening the pack at a
+ * docID (as a resumed crawl does) drops the later pages and cuts the
+ * segments back to the pages still used; and that a damaged table is
+ * refused. The directory is removed at the end.
+ *
+ * usage: packtest
+ * Prints a line for each failed check, then a count; exits non-zero if
+ * any check failed.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#define _DEFAULT_SOURCE          // mkdtemp, strdup
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "../libcs50/webpage.h"
+#include "pagedir.h"
+#include "pagepack.h"
+
+/**************** file-local global variables ****************/
+static int checks = 0;
+static int failures = 0;
+static const size_t BIG = 30 << 20;      // two fill most of a 64 MB segment
+
+/**************** local functions ****************/
+static void check(const bool ok, const char* what, const int docID);
+static webpage_t* makePage(const int docID, const size_t htmlLen);
+static bool samePage(const webpage_t* loaded, const webpage_t* saved);
+static void checkLoad(pagepack_t* pack, const int docID, const size_t htmlLen);
+static void checkMap(pagepack_t* pack, const int docID, const size_t htmlLen);
+static long fileSize(const char* dir, const char* name);
+static size_t encodedLen(const int docID, const size_t htmlLen);
+static void removeDir(const char* dir);
+
+/**************** main ****************/
+int main(void)
+{
+    char dir[] = "/tmp/packtestXXXXXX";
+    if (mkdtemp(dir) == NULL) {
+        fprintf(stderr, "packtest: could not make a directory in /tmp\n");
+        return 2;
+    }
+
+    // docIDs 1-3 out of order, 7-9 in a batch, 10 compressed
+    pagepack_t* pack = pagepack_create(dir, 1);
+    check(pack != NULL, "create", 1);
+    if (pack == NULL) {
+        removeDir(dir);
+        return 1;
+    }
+    const int order[] = { 3, 1, 2 };
+    for (int i = 0; i < 3; i++) {
+        webpage_t* page = makePage(order[i], 100 * order[i]);
+        check(pagepack_save(pack, page, order[i], PAGEDIR_PLAIN), "save", order[i]);
+        webpage_delete(page);
+    }
+    char* files[3];
+    size_t fileLens[3];
+    const int batch[] = { 7, 8, 9 };
+    for (int i = 0; i < 3; i++) {
+        webpage_t* page = makePage(batch[i], 100 * batch[i]);
+        files[i] = pagedir_encode(page, PAGEDIR_PLAIN, &fileLens[i]);
+        webpage_delete(page);
+    }
+    check(pagepack_saveFiles(pack, 3, files, fileLens, batch), "saveFiles", 7);
+    for (int i = 0; i < 3; i++) {
+        free(files[i]);
+    }
+    webpage_t* packed = makePage(10, 5000);
+    check(pagepack_save(pack, packed, 10, PAGEDIR_LZ), "save compressed", 10);
+    webpage_delete(packed);
+    checkLoad(pack, 2, 200);                 // while the pack is being saved to
+    check(pagepack_sync(pack), "sync", 0);
+    pagepack_close(pack);
+
+    pack = pagepack_open(dir);
+    check(pack != NULL, "open", 0);
+    for (int docID = 1; pack != NULL && docID <= 10; docID++) {
+        bool saved = (docID <= 3 || docID >= 7);
+        size_t htmlLen = (docID == 10) ? 5000 : 100 * docID;
+        if (saved) {
+            checkLoad(pack, docID, htmlLen);
+            checkMap(pack, docID, htmlLen);
+        } else {
+            check(pagepack_load(pack, docID) == NULL, "load of a gap", docID);
+        }
+    }
+    check(pack == NULL || pagepack_load(pack, 11) == NULL, "load past the end", 11);
+    check(pack == NULL || pagepack_load(pack, 0) == NULL, "load of docID 0", 0);
+    pagepack_close(pack);
+
+    // reopen at 4 and save three big pages: the third starts segment 1
+    pack = pagepack_create(dir, 4);
+    check(pack != NULL, "create at 4", 4);
+    for (int docID = 4; pack != NULL && docID <= 6; docID++) {
+        webpage_t* page = makePage(docID, BIG);
+        check(page != NULL && pagepack_save(pack, page, docID, PAGEDIR_PLAIN), "save big", docID);
+        webpage_delete(page);
+    }
+    pagepack_close(pack);
+    check(fileSize(dir, ".pack.1") == (long)encodedLen(6, BIG), "segment roll-over", 6);
+
+    pack = pagepack_open(dir);
+    check(pack != NULL && pagepack_load(pack, 7) == NULL, "pages dropped at 4", 7);
+    for (int docID = 1; pack != NULL && docID <= 6; docID++) {
+        checkLoad(pack, docID, docID <= 3 ? 100 * docID : BIG);
+    }
+    pagepack_close(pack);
+
+    // reopen at 5: docIDs 5 and 6 go, segment 1 with them, and segment 0
+    // is cut back to the end of docID 4
+    pack = pagepack_create(dir, 5);
+    check(pack != NULL, "create at 5", 5);
+    check(fileSize(dir, ".pack.1") < 0, "later segment removed", 6);
+    long kept = 0;
+    for (int docID = 1; docID <= 4; docID++) {
+        kept += encodedLen(docID, docID <= 3 ? 100 * docID : BIG);
+    }
+    check(fileSize(dir, ".pack.0") == kept, "segment cut back", 5);
+    webpage_t* again = makePage(5, 50);
+    check(pack != NULL && pagepack_save(pack, again, 5, PAGEDIR_PLAIN), "save after cut", 5);
+    webpage_delete(again);
+    pagepack_close(pack);
+
+    pack = pagepack_open(dir);
+    check(pack != NULL, "open after cut", 0);
+    if (pack != NULL) {
+        checkLoad(pack, 4, BIG);
+        checkLoad(pack, 5, 50);
+        check(pagepack_load(pack, 6) == NULL, "page dropped at 5", 6);
+    }
+    pagepack_close(pack);
+
+    // reopen at 1: the pack starts out empty
+    pack = pagepack_create(dir, 1);
+    pagepack_close(pack);
+    pack = pagepack_open(dir);
+    check(pack != NULL && pagepack_load(pack, 1) == NULL, "create at 1 empties", 1);
+    pagepack_close(pack);
+    check(fileSize(dir, ".pack.0") == 0, "create at 1 empties the segment", 1);
+
+    // a table that is not ours is refused
+    char* table = pagedir_path(dir, ".pack");
+    FILE* fp = (table != NULL) ? fopen(table, "w") : NULL;
+    if (fp != NULL) {
+        fputs("not a pack table, but long enough for one", fp);
+        fclose(fp);
+    }
+    free(table);
+    pack = pagepack_open(dir);
+    check(pack == NULL, "damaged table", 0);
+    pagepack_close(pack);
+
+    // without a pack, pages come from their own files
+    pagepack_remove(dir);
+    webpage_t* page = makePage(1, 300);
+    pagedir_save(page, dir, 1);
+    webpage_delete(page);
+    pack = pagepack_open(dir);
+    check(pack != NULL, "open without a pack", 0);
+    if (pack != NULL) {
+        checkLoad(pack, 1, 300);
+        checkMap(pack, 1, 300);
+    }
+    pagepack_close(pack);
+
+    removeDir(dir);
+    printf("packtest: %d checks, %d failed\n", checks, failures);
+    return failures == 0 ? 0 : 1;
+}
+
+/**************** check ****************/
+/* Count one check, and report it if it failed. */
+static void
+check(const bool ok, const char* what, const int docID)
+{
+    checks++;
+    if (!ok) {
+        failures++;
+        printf("FAIL: %s (docID %d)\n", what, docID);
+    }
+}
+
+/**************** makePage ****************/
+/* Return a new page for docID: its URL and depth follow from docID, and
+ * its HTML is htmlLen bytes of text that also does. NULL if memory is
+ * exhausted.
+ */
+static webpage_t*
+makePage(const int docID, const size_t htmlLen)
+{
+    char* url = malloc(64);
+    char* html = malloc(htmlLen + 1);
+    if (url == NULL || html == NULL) {
+        free(url);
+        free(html);
+        return NULL;
+    }
+    snprintf(url, 64, "http://cs50tse.cs.dartmouth.edu/page%d.html", docID);
+    for (size_t i = 0; i < htmlLen; i++) {
+        html[i] = "<p>packtest</p>\n"[(i + docID) % 16];
+    }
+    html[htmlLen] = '\0';
+    webpage_t* page = webpage_new(url, docID % 5, html);
+    if (page == NULL) {
+        free(url);
+        free(html);
+    }
+    return page;
+}
+
+/**************** samePage ****************/
+/* Return true if loaded is saved as it comes back from a page file: the
+ * same URL and depth, and the same HTML with the newline that ends the file.
+ */
+static bool
+samePage(const webpage_t* loaded, const webpage_t* saved)
+{
+    if (loaded == NULL || saved == NULL) {
+        return false;
+    }
+    const char* html = webpage_getHTML(saved);
+    size_t htmlLen = strlen(html);
+    return strcmp(webpage_getURL(loaded), webpage_getURL(saved)) == 0
+           && webpage_getDepth(loaded) == webpage_getDepth(saved)
+           && strlen(webpage_getHTML(loaded)) == htmlLen + 1
+           && memcmp(webpage_getHTML(loaded), html, htmlLen) == 0
+           && webpage_getHTML(loaded)[htmlLen] == '\n';
+}
+
+/**************** checkLoad ****************/
+/* Check that docID loads as the page makePage makes for it. */
+static void
+checkLoad(pagepack_t* pack, const int docID, const size_t htmlLen)
+{
+    webpage_t* loaded = pagepack_load(pack, docID);
+    webpage_t* expected = makePage(docID, htmlLen);
+    check(samePage(loaded, expected), "load", docID);
+    webpage_delete(loaded);
+    webpage_delete(expected);
+}
+
+/**************** checkMap ****************/
+/* Check that docID maps as the page makePage makes for it. */
+static void
+checkMap(pagepack_t* pack, const int docID, const size_t htmlLen)
+{
+    pagedir_view_t view;
+    webpage_t* expected = makePage(docID, htmlLen);
+    bool ok = pagepack_map(pack, docID, &view);
+    check(ok && expected != NULL
+          && view.urlLen == strlen(webpage_getURL(expected))
+          && memcmp(view.url, webpage_getURL(expected), view.urlLen) == 0
+          && view.depth == webpage_getDepth(expected)
+          && view.htmlLen == htmlLen + 1
+          && memcmp(view.html, webpage_getHTML(expected), htmlLen) == 0
+          && view.html[htmlLen] == '\n', "map", docID);
+    if (ok) {
+        pagedir_unmap(&view);
+    }
+    webpage_delete(expected);
+}
+
+/**************** fileSize ****************/
+/* Return the size of dir/name, or -1 if there is no such file. */
+static long
+fileSize(const char* dir, const char* name)
+{
+    char* path = pagedir_path(dir, name);
+    struct stat st;
+    long size = (path != NULL && stat(path, &st) == 0) ? (long)st.st_size : -1;
+    free(path);
+    return size;
+}
+
+/**************** encodedLen ****************/
+/* Return the length of the plain page file for makePage(docID, htmlLen). */
+static size_t
+encodedLen(const int docID, const size_t htmlLen)
+{
+    webpage_t* page = makePage(docID, htmlLen);
+    size_t fileLen = 0;
+    char* file = pagedir_encode(page, PAGEDIR_PLAIN, &fileLen);
+    free(file);
+    webpage_delete(page);
+    return fileLen;
+}
+
+/**************** removeDir ****************/
+/* Remove the pack and page file packtest may have left in dir, then dir. */
+static void
+removeDir(const char* dir)
+{
+    pagepack_remove(dir);
+    char* path = pagedir_path(dir, "1");
+    if (path != NULL) {
+        unlink(path);
+        free(path);
+    }
+    rmdir(dir);
+}
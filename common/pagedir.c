@@ -1,18 +1,88 @@
+#define _POSIX_C_SOURCE 200809L  // strndup
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <limits.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
 
 #include "../libcs50/webpage.h"
 #include "pagedir.h"
+#include "lz.h"
+#include "uring.h"
 
-/**************** local helper ****************/
-/* buildPath: 
- * Allocate and return a new string "pageDirectory/docIDorName".
- * Caller is responsible for freeing the result.
- */
-static char*
-buildPath(const char* pageDirectory, const char* name)
+/**************** file-local global variables ****************/
+static const char MAGIC[4] = "\x89TSE";  // starts a compressed page file
+#define HEADER_LEN 12                      // magic, codec, 3 zeros, length
+static const int URING_DEPTH = 3;          // operations a page has queued at once, at most
+static const off_t MAP_MIN = 16 << 10;     // smaller page files cost less to read than to map
+
+/* the operations on a page's file, as tagged in a ring: tag = page * NUM_OPS + op */
+enum { OP_OPEN, OP_STAT, OP_IO, OP_SYNC, OP_CLOSE, NUM_OPS };
+
+/**************** global types ****************/
+/* a page file to write, in pieces; or a page file read */
+typedef struct pagefile {
+    struct iovec iov[4];
+    int count;
+    char depth[16];            // "\n<depth>\n", a piece of a plain file
+    char* file;                // an encoded file, or a file read (NULL: the pieces are the page's)
+    size_t len;                // of the whole file
+} pagefile_t;
+
+/* what became of one page of a batch */
+typedef struct batchresult {
+    bool ready;                // its path (and, to save, its file) is ready
+    int fd;                    // open on its file (-1: not)
+    bool statted;              // its size is in the batch's stats
+    long done;                 // bytes read or written
+    bool failed;               // an fsync or close failed
+    bool closed;
+    bool ok;                   // saved, or read in whole
+} batchresult_t;
+
+typedef struct pagedir_batch {
+    int capacity;              // pages handled at a time
+    uring_t* ring;             // NULL: blocking calls
+    long syscalls;             // made so far
+    long pages;                // handled so far
+    char** paths;              // of each page of the batch
+    pagefile_t* files;
+    batchresult_t* results;
+    uring_stat_t* stats;       // where a ring puts each file's size
+} pagedir_batch_t;
+
+/**************** local functions ****************/
+static char* pageText(const webpage_t* page, size_t* textLen);
+static char* compressText(const pagedir_codec_t codec, const char* text,
+                          const size_t textLen, size_t* fileLen);
+static bool decompressText(const int codec, const char* data, const size_t len,
+                           char* text, const size_t textLen);
+static bool isCompressed(const char* file, const size_t fileLen, size_t* textLen);
+static bool splitText(const char* text, const size_t textLen, pagedir_view_t* view);
+static char* readFile(FILE* fp, size_t* fileLen);
+static bool readAll(const int fd, char* buf, const size_t len);
+static bool writeAll(const int fd, struct iovec* iov, int count, long* syscalls);
+static bool pageFile(const webpage_t* page, const pagedir_codec_t codec, pagefile_t* pf);
+static bool writeFile(const char* path, pagefile_t* pf, const bool sync, long* syscalls);
+static char* readWhole(const char* path, size_t* fileLen, long* syscalls);
+static void uringSave(pagedir_batch_t* batch, const int m, const bool sync);
+static void uringLoad(pagedir_batch_t* batch, const int m);
+static void uringCollect(pagedir_batch_t* batch);
+
+/**************** pagedir_path ****************/
+char*
+pagedir_path(const char* pageDirectory, const char* name)
 {
     size_t lenDir  = strlen(pageDirectory);
     size_t lenName = strlen(name);
@@ -37,7 +107,7 @@ pagedir_init(const char* pageDirectory)
         return false;
     }
 
-    char* crawlerPath = buildPath(pageDirectory, ".crawler");
+    char* crawlerPath = pagedir_path(pageDirectory, ".crawler");
     if (crawlerPath == NULL) { // null path 
         return false;
     }
@@ -57,35 +127,7 @@ pagedir_init(const char* pageDirectory)
 void
 pagedir_save(const webpage_t* page, const char* pageDirectory, const int docID)
 {
-    if (page == NULL || pageDirectory == NULL) { // null arguments 
-        return;
-    }
-
-    char docName[20];
-    snprintf(docName, sizeof(docName), "%d", docID);
-
-    char* pagePath = buildPath(pageDirectory, docName);
-    if (pagePath == NULL) {
-        fprintf(stderr, "Error: could not allocate filepath for docID %d\n", docID);
-        return;
-    }
-
-    FILE* fp = fopen(pagePath, "w");
-    if (fp == NULL) {
-        fprintf(stderr, "Error: could not open file '%s' for writing\n", pagePath);
-        free(pagePath);
-        return;
-    }
-
-    // line 1: URL
-    fprintf(fp, "%s\n", webpage_getURL(page));
-    // line 2: depth
-    fprintf(fp, "%d\n", webpage_getDepth(page));
-    // remaining lines: HTML
-    fprintf(fp, "%s\n", webpage_getHTML(page));
-
-    fclose(fp);
-    free(pagePath);
+    pagedir_write(page, pageDirectory, docID, PAGEDIR_PLAIN, false);
 }
 
 
@@ -96,7 +138,7 @@ pagedir_validate(const char* pageDirectory)
         return false;
     }
 
-    char* crawlerPath = buildPath(pageDirectory, ".crawler");
+    char* crawlerPath = pagedir_path(pageDirectory, ".crawler");
     if (crawlerPath == NULL) {
         return false;
     }
@@ -112,6 +154,308 @@ pagedir_validate(const char* pageDirectory)
     return true;
 }
 
+/**************** pagedir_saveCompressed ****************/
+void
+pagedir_saveCompressed(const webpage_t* page, const char* pageDirectory,
+                       const int docID, const pagedir_codec_t codec)
+{
+    pagedir_write(page, pageDirectory, docID, codec, false);
+}
+
+/**************** pagedir_write ****************/
+bool
+pagedir_write(const webpage_t* page, const char* pageDirectory, const int docID,
+              const pagedir_codec_t codec, const bool sync)
+{
+    if (page == NULL || pageDirectory == NULL) { // null arguments
+        return false;
+    }
+
+    char docName[20];
+    snprintf(docName, sizeof(docName), "%d", docID);
+    char* pagePath = pagedir_path(pageDirectory, docName);
+
+    pagefile_t pf;
+    if (pagePath == NULL || !pageFile(page, codec, &pf)) {
+        fprintf(stderr, "Error: could not allocate page file for docID %d\n", docID);
+        free(pagePath);
+        return false;
+    }
+
+    long syscalls = 0;
+    bool ok = writeFile(pagePath, &pf, sync, &syscalls);
+    free(pagePath);
+    free(pf.file);
+    return ok;
+}
+
+/**************** pagedir_batchNew ****************/
+pagedir_batch_t*
+pagedir_batchNew(const int capacity, const pagedir_io_t io)
+{
+    if (capacity < 1) {
+        return NULL;
+    }
+    pagedir_batch_t* batch = calloc(1, sizeof(pagedir_batch_t));
+    if (batch == NULL) {
+        return NULL;
+    }
+    batch->capacity = capacity;
+    batch->paths = calloc(capacity, sizeof(char*));
+    batch->files = calloc(capacity, sizeof(pagefile_t));
+    batch->results = calloc(capacity, sizeof(batchresult_t));
+    if (io == PAGEDIR_IO_URING) {
+        batch->stats = calloc(capacity, sizeof(uring_stat_t));
+        batch->ring = uring_new(URING_DEPTH * capacity);   // NULL: do without
+    }
+    if (batch->paths == NULL || batch->files == NULL
+        || batch->results == NULL || (batch->ring != NULL && batch->stats == NULL)) {
+        pagedir_batchDelete(batch);
+        return NULL;
+    }
+    return batch;
+}
+
+/**************** pagedir_batchIO ****************/
+pagedir_io_t
+pagedir_batchIO(const pagedir_batch_t* batch)
+{
+    return (batch != NULL && batch->ring != NULL) ? PAGEDIR_IO_URING : PAGEDIR_IO_SYNC;
+}
+
+/**************** pagedir_saveBatch ****************/
+int
+pagedir_saveBatch(pagedir_batch_t* batch, const char* pageDirectory,
+                  webpage_t* const pages[], const int docIDs[], const int n,
+                  const pagedir_codec_t codec, const bool sync, bool ok[])
+{
+    if (batch == NULL || pageDirectory == NULL || pages == NULL || docIDs == NULL) {
+        return 0;
+    }
+
+    int saved = 0;
+    for (int first = 0; first < n; first += batch->capacity) {
+        int m = (n - first < batch->capacity) ? n - first : batch->capacity;
+
+        // the path and the pieces of each page file
+        for (int i = 0; i < m; i++) {
+            char docName[20];
+            snprintf(docName, sizeof(docName), "%d", docIDs[first + i]);
+            batch->paths[i] = pagedir_path(pageDirectory, docName);
+            batchresult_t* r = &batch->results[i];
+            memset(r, 0, sizeof(*r));
+            r->ready = pages[first + i] != NULL && batch->paths[i] != NULL
+                && pageFile(pages[first + i], codec, &batch->files[i]);
+            if (!r->ready && pages[first + i] != NULL) {
+                fprintf(stderr, "Error: could not allocate page file for docID %d\n",
+                        docIDs[first + i]);
+            }
+        }
+
+        if (batch->ring != NULL) {
+            uringSave(batch, m, sync);
+        } else {
+            for (int i = 0; i < m; i++) {
+                batchresult_t* r = &batch->results[i];
+                r->ok = r->ready && writeFile(batch->paths[i], &batch->files[i], sync,
+                                              &batch->syscalls);
+            }
+        }
+
+        for (int i = 0; i < m; i++) {
+            batchresult_t* r = &batch->results[i];
+            if (ok != NULL) {
+                ok[first + i] = r->ok;
+            }
+            saved += r->ok ? 1 : 0;
+            if (r->ready) {
+                free(batch->files[i].file);
+            }
+            free(batch->paths[i]);
+        }
+        batch->pages += m;
+    }
+    return saved;
+}
+
+/**************** pagedir_loadBatch ****************/
+int
+pagedir_loadBatch(pagedir_batch_t* batch, const char* pageDirectory,
+                  const int docIDs[], const int n, webpage_t* pages[])
+{
+    if (batch == NULL || pageDirectory == NULL || docIDs == NULL || pages == NULL) {
+        return 0;
+    }
+
+    int loaded = 0;
+    for (int first = 0; first < n; first += batch->capacity) {
+        int m = (n - first < batch->capacity) ? n - first : batch->capacity;
+
+        for (int i = 0; i < m; i++) {
+            char docName[20];
+            snprintf(docName, sizeof(docName), "%d", docIDs[first + i]);
+            batch->paths[i] = (docIDs[first + i] >= 1) ? pagedir_path(pageDirectory, docName) : NULL;
+            batchresult_t* r = &batch->results[i];
+            memset(r, 0, sizeof(*r));
+            r->ready = batch->paths[i] != NULL;
+            batch->files[i].file = NULL;
+        }
+
+        if (batch->ring != NULL) {
+            uringLoad(batch, m);
+        } else {
+            for (int i = 0; i < m; i++) {
+                batchresult_t* r = &batch->results[i];
+                if (r->ready) {
+                    batch->files[i].file = readWhole(batch->paths[i], &batch->files[i].len,
+                                                     &batch->syscalls);
+                    r->ok = batch->files[i].file != NULL;
+                }
+            }
+        }
+
+        // each file read in whole becomes a page
+        for (int i = 0; i < m; i++) {
+            pages[first + i] = batch->results[i].ok
+                ? pagedir_decode(batch->files[i].file, batch->files[i].len) : NULL;
+            if (!batch->results[i].ok) {
+                free(batch->files[i].file);
+            }
+            loaded += (pages[first + i] != NULL) ? 1 : 0;
+            free(batch->paths[i]);
+        }
+        batch->pages += m;
+    }
+    return loaded;
+}
+
+/**************** pagedir_batchStats ****************/
+void
+pagedir_batchStats(const pagedir_batch_t* batch, long* syscalls, long* pages)
+{
+    if (syscalls != NULL) {
+        *syscalls = (batch != NULL) ? batch->syscalls : 0;
+    }
+    if (pages != NULL) {
+        *pages = (batch != NULL) ? batch->pages : 0;
+    }
+}
+
+/**************** pagedir_batchDelete ****************/
+void
+pagedir_batchDelete(pagedir_batch_t* batch)
+{
+    if (batch == NULL) {
+        return;
+    }
+    uring_delete(batch->ring);
+    free(batch->paths);
+    free(batch->files);
+    free(batch->results);
+    free(batch->stats);
+    free(batch);
+}
+
+/**************** pagedir_codecAvailable ****************/
+bool
+pagedir_codecAvailable(const pagedir_codec_t codec)
+{
+    switch (codec) {
+    case PAGEDIR_PLAIN:
+    case PAGEDIR_LZ:
+        return true;
+    case PAGEDIR_ZLIB:
+#ifdef HAVE_ZLIB
+        return true;
+#else
+        return false;
+#endif
+    default:
+        return false;
+    }
+}
+
+/**************** pagedir_encode ****************/
+char*
+pagedir_encode(const webpage_t* page, const pagedir_codec_t codec, size_t* fileLen)
+{
+    if (page == NULL || fileLen == NULL) {
+        return NULL;
+    }
+
+    size_t textLen;
+    char* text = pageText(page, &textLen);
+    if (text == NULL) {
+        return NULL;
+    }
+    if (codec == PAGEDIR_PLAIN || !pagedir_codecAvailable(codec)) {
+        *fileLen = textLen;
+        return text;
+    }
+
+    // keep it plain if compressing fails or gains nothing
+    size_t packedLen = 0;
+    char* file = compressText(codec, text, textLen, &packedLen);
+    if (file == NULL || packedLen >= HEADER_LEN + textLen) {
+        free(file);
+        *fileLen = textLen;
+        return text;
+    }
+    free(text);
+    *fileLen = packedLen;
+    return file;
+}
+
+/**************** pagedir_decode ****************/
+webpage_t*
+pagedir_decode(char* file, const size_t fileLen)
+{
+    if (file == NULL) {
+        return NULL;
+    }
+
+    // decompress, if the header says to
+    char* text = file;
+    size_t textLen = fileLen;
+    if (isCompressed(file, fileLen, &textLen)) {
+        text = malloc(textLen + 1);
+        bool ok = (text != NULL)
+            && decompressText((unsigned char)file[4], file + HEADER_LEN,
+                              fileLen - HEADER_LEN, text, textLen);
+        free(file);
+        if (!ok) {
+            free(text);
+            return NULL;
+        }
+    }
+
+    pagedir_view_t view;
+    if (!splitText(text, textLen, &view)) {
+        free(text);
+        return NULL;
+    }
+    char* url = strndup(view.url, view.urlLen);
+    if (url == NULL) {
+        free(text);
+        return NULL;
+    }
+
+    // the HTML, moved to the front of the buffer it is in
+    memmove(text, view.html, view.htmlLen);
+    text[view.htmlLen] = '\0';
+    char* html = text;
+
+    webpage_t* page = webpage_new(url, view.depth, html);
+    if (page == NULL) {
+        free(url);
+        free(html);
+        return NULL;
+    }
+
+    return page;
+}
+
+/**************** pagedir_load ****************/
 webpage_t*
 pagedir_load(const char* pageDirectory, const int docID)
 {
@@ -122,7 +466,7 @@ pagedir_load(const char* pageDirectory, const int docID)
     char docName[20];
     snprintf(docName, sizeof(docName), "%d", docID);
 
-    char* pagePath = buildPath(pageDirectory, docName);
+    char* pagePath = pagedir_path(pageDirectory, docName);
     if (pagePath == NULL) {
         return NULL;
     }
@@ -134,52 +478,604 @@ pagedir_load(const char* pageDirectory, const int docID)
         return NULL;
     }
 
-    char* url = NULL;
-    size_t len = 0;
-    ssize_t read = getline(&url, &len, fp);
-    if (read <= 0) {
-        fclose(fp);
+    // the whole file in one read
+    size_t fileLen;
+    char* file = readFile(fp, &fileLen);
+    fclose(fp);
+    return pagedir_decode(file, fileLen);
+}
+
+/**************** pagedir_map ****************/
+bool
+pagedir_map(const char* pageDirectory, const int docID, pagedir_view_t* view)
+{
+    if (view == NULL) {
+        return false;
+    }
+    memset(view, 0, sizeof(*view));
+    if (pageDirectory == NULL || docID < 1) {
+        return false;
+    }
+
+    char docName[20];
+    snprintf(docName, sizeof(docName), "%d", docID);
+    char* pagePath = pagedir_path(pageDirectory, docName);
+    if (pagePath == NULL) {
+        return false;
+    }
+    int fd = open(pagePath, O_RDONLY);
+    free(pagePath);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return false;
+    }
+
+    // a small file is read into a buffer the view frees
+    if (st.st_size < MAP_MIN) {
+        char* file = malloc(st.st_size);
+        bool ok = file != NULL && readAll(fd, file, st.st_size)
+            && pagedir_viewFile(file, st.st_size, view);
+        close(fd);
+        if (!ok) {
+            free(file);
+            return false;
+        }
+        if (view->text == NULL) {
+            view->text = file;
+        } else {
+            free(file);                        // the view has it decompressed
+        }
+        return true;
+    }
+
+    // the mapping outlives the file descriptor
+    void* map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+    if (!pagedir_viewFile(map, st.st_size, view)) {
+        munmap(map, st.st_size);
+        return false;
+    }
+    view->map = map;
+    view->mapLen = st.st_size;
+    return true;
+}
+
+/**************** pagedir_viewFile ****************/
+bool
+pagedir_viewFile(const char* file, const size_t fileLen, pagedir_view_t* view)
+{
+    if (view == NULL) {
+        return false;
+    }
+    memset(view, 0, sizeof(*view));
+    if (file == NULL) {
+        return false;
+    }
+
+    // decompress, if the header says to
+    const char* text = file;
+    size_t textLen = fileLen;
+    if (isCompressed(file, fileLen, &textLen)) {
+        view->text = malloc(textLen + 1);
+        if (view->text == NULL
+            || !decompressText((unsigned char)file[4], file + HEADER_LEN,
+                               fileLen - HEADER_LEN, view->text, textLen)) {
+            pagedir_unmap(view);
+            return false;
+        }
+        text = view->text;
+    }
+
+    char* owned = view->text;
+    if (!splitText(text, textLen, view)) {
+        free(owned);
+        memset(view, 0, sizeof(*view));
+        return false;
+    }
+    view->text = owned;
+    return true;
+}
+
+/**************** pagedir_unmap ****************/
+void
+pagedir_unmap(pagedir_view_t* view)
+{
+    if (view == NULL) {
+        return;
+    }
+    if (view->map != NULL) {
+        munmap(view->map, view->mapLen);
+    }
+    free(view->text);
+    memset(view, 0, sizeof(*view));
+}
+
+/**************** isCompressed ****************/
+/* Return true if the fileLen bytes at file start with the header of a
+ * compressed page file, with the length of its text in *textLen.
+ */
+static bool
+isCompressed(const char* file, const size_t fileLen, size_t* textLen)
+{
+    if (fileLen < HEADER_LEN || memcmp(file, MAGIC, sizeof(MAGIC)) != 0) {
+        return false;
+    }
+    *textLen = 0;
+    for (int i = 0; i < 4; i++) {
+        *textLen |= (size_t)(unsigned char)file[8 + i] << (8 * i);
+    }
+    return true;
+}
+
+/**************** splitText ****************/
+/* Fill in the URL, depth, and HTML of *view from the textLen bytes of a
+ * page file's text, which need not end in '\0': line 1 is the URL, line
+ * 2 the depth (read as sscanf's "%d" would), and the rest the HTML.
+ * Returns false if there is no URL or no depth.
+ */
+static bool
+splitText(const char* text, const size_t textLen, pagedir_view_t* view)
+{
+    const char* end = text + textLen;
+
+    // line 1: URL
+    const char* urlEnd = memchr(text, '\n', textLen);
+    if (urlEnd == NULL || urlEnd == text) {
+        return false;
+    }
+
+    // line 2: depth
+    const char* depthLine = urlEnd + 1;
+    const char* p = depthLine;
+    while (p < end && isspace((unsigned char)*p)) {
+        p++;
+    }
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = (*p++ == '-');
+    }
+    if (p == end || !isdigit((unsigned char)*p)) {
+        return false;
+    }
+    long depth = 0;
+    for (; p < end && isdigit((unsigned char)*p); p++) {
+        depth = depth * 10 + (*p - '0');
+        if (depth > INT_MAX) {
+            depth = INT_MAX;
+        }
+    }
+    const char* depthEnd = memchr(depthLine, '\n', end - depthLine);
+
+    // remaining lines: HTML
+    view->url = text;
+    view->urlLen = urlEnd - text;
+    view->depth = (int)(negative ? -depth : depth);
+    view->html = (depthEnd != NULL) ? depthEnd + 1 : end;
+    view->htmlLen = end - view->html;
+    return true;
+}
+/**************** pageText ****************/
+/* Allocate and return the text pagedir_save writes for page, with its
+ * length in *textLen; NULL if out of memory.
+ */
+static char*
+pageText(const webpage_t* page, size_t* textLen)
+{
+    const char* format = "%s\n%d\n%s\n";
+    const char* url = webpage_getURL(page);
+    const char* html = webpage_getHTML(page);
+    int depth = webpage_getDepth(page);
+
+    int len = snprintf(NULL, 0, format, url, depth, html);
+    char* text = (len >= 0) ? malloc(len + 1) : NULL;
+    if (text == NULL) {
+        return NULL;
+    }
+    snprintf(text, len + 1, format, url, depth, html);
+    *textLen = len;
+    return text;
+}
+
+/**************** compressText ****************/
+/* Allocate and return a compressed page file holding text, with its
+ * length in *fileLen; NULL if out of memory or the codec fails.
+ */
+static char*
+compressText(const pagedir_codec_t codec, const char* text, const size_t textLen,
+             size_t* fileLen)
+{
+    if (textLen > UINT32_MAX) {
         return NULL;
     }
-    if (url[read - 1] == '\n') {
-        url[read - 1] = '\0';
+
+    size_t bound = lz_bound(textLen);
+#ifdef HAVE_ZLIB
+    if (codec == PAGEDIR_ZLIB) {
+        bound = compressBound(textLen);
+    }
+#endif
+    char* file = malloc(HEADER_LEN + bound);
+    if (file == NULL) {
+        return NULL;
     }
 
-    int depth;
-    if (fscanf(fp, "%d\n", &depth) != 1) {
-        free(url);
-        fclose(fp);
+    size_t packedLen = 0;
+    if (codec == PAGEDIR_LZ) {
+        packedLen = lz_compress(text, textLen, file + HEADER_LEN, bound);
+    }
+#ifdef HAVE_ZLIB
+    if (codec == PAGEDIR_ZLIB) {
+        uLongf destLen = bound;
+        if (compress2((Bytef*)file + HEADER_LEN, &destLen, (const Bytef*)text,
+                      textLen, Z_DEFAULT_COMPRESSION) == Z_OK) {
+            packedLen = destLen;
+        }
+    }
+#endif
+    if (packedLen == 0) {
+        free(file);
         return NULL;
     }
 
-    fseek(fp, 0, SEEK_END);
+    memcpy(file, MAGIC, sizeof(MAGIC));
+    file[4] = (codec == PAGEDIR_LZ) ? 1 : 2;
+    file[5] = file[6] = file[7] = 0;
+    for (int i = 0; i < 4; i++) {
+        file[8 + i] = (char)((textLen >> (8 * i)) & 0xff);
+    }
+    *fileLen = HEADER_LEN + packedLen;
+    return file;
+}
+
+/**************** decompressText ****************/
+/* Decompress the len bytes at data, stored with codec (the header's
+ * number for it), into the textLen bytes at text.
+ * Returns false if the codec is unknown or unavailable, or data is corrupt.
+ */
+static bool
+decompressText(const int codec, const char* data, const size_t len,
+               char* text, const size_t textLen)
+{
+    if (codec == 1) {
+        return lz_decompress(data, len, text, textLen);
+    }
+#ifdef HAVE_ZLIB
+    if (codec == 2) {
+        uLongf destLen = textLen;
+        return uncompress((Bytef*)text, &destLen, (const Bytef*)data, len) == Z_OK
+            && destLen == textLen;
+    }
+#endif
+    return false;
+}
+
+/**************** readFile ****************/
+/* Read all of the file fp into a new buffer, with room for a '\0' after it.
+ * Returns the buffer, with the file's length in *fileLen, for the caller
+ * to free; NULL on any error.
+ */
+static char*
+readFile(FILE* fp, size_t* fileLen)
+{
+    if (fseek(fp, 0, SEEK_END) != 0) {
+        return NULL;
+    }
     long fileSize = ftell(fp);
-    fseek(fp, 0, SEEK_SET);
-    
-    getline(&url, &len, fp); 
-    char depthLine[20];
-    fgets(depthLine, sizeof(depthLine), fp);  
-    long htmlStart = ftell(fp);
-    long htmlSize = fileSize - htmlStart;
-    
-    char* html = malloc(htmlSize + 1);
-    if (html == NULL) {
-        free(url);
-        fclose(fp);
+    rewind(fp);
+    if (fileSize < 0) {
         return NULL;
     }
-    
-    size_t bytesRead = fread(html, 1, htmlSize, fp);
-    html[bytesRead] = '\0';
-    
-    fclose(fp);
 
-    webpage_t* page = webpage_new(url, depth, html);
-    if (page == NULL) {
-        free(url);
-        free(html);
+    char* file = malloc(fileSize + 1);
+    if (file == NULL) {
         return NULL;
     }
+    if (fread(file, 1, fileSize, fp) != (size_t)fileSize) {
+        free(file);
+        return NULL;
+    }
+    *fileLen = fileSize;
+    return file;
+}
 
-    return page;
+/**************** readAll ****************/
+/* Read len bytes from fd into buf, resuming after a short read.
+ * Returns false on error, or if the file ends first.
+ */
+static bool
+readAll(const int fd, char* buf, const size_t len)
+{
+    size_t done = 0;
+    while (done < len) {
+        ssize_t n = read(fd, buf + done, len - done);
+        if (n <= 0) {
+            return false;
+        }
+        done += n;
+    }
+    return true;
+}
+
+/**************** writeAll ****************/
+/* Write all of the count buffers in iov to fd, in order, resuming after a
+ * short write. Returns false on error. iov is used up along the way.
+ */
+static bool
+writeAll(const int fd, struct iovec* iov, int count, long* syscalls)
+{
+    while (count > 0) {
+        ssize_t n = writev(fd, iov, count);
+        (*syscalls)++;
+        if (n < 0 || (n == 0 && iov->iov_len > 0)) {
+            return false;
+        }
+        while (count > 0 && (size_t)n >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (char*)iov->iov_base + n;
+            iov->iov_len -= n;
+        }
+    }
+    return true;
+}
+
+/**************** pageFile ****************/
+/* Fill in *pf with the pieces of the file for page, stored with codec: a
+ * plain file straight from the page (URL, depth, HTML), or an encoded one
+ * in pf->file, for the caller to free. Returns false if out of memory.
+ */
+static bool
+pageFile(const webpage_t* page, const pagedir_codec_t codec, pagefile_t* pf)
+{
+    pf->count = 0;
+    pf->file = NULL;
+    if (codec == PAGEDIR_PLAIN || !pagedir_codecAvailable(codec)) {
+        const char* url = webpage_getURL(page);
+        const char* html = webpage_getHTML(page);
+        snprintf(pf->depth, sizeof(pf->depth), "\n%d\n", webpage_getDepth(page));
+        pf->iov[pf->count++] = (struct iovec){ (char*)url, strlen(url) };
+        pf->iov[pf->count++] = (struct iovec){ pf->depth, strlen(pf->depth) };
+        if (html != NULL) {
+            pf->iov[pf->count++] = (struct iovec){ (char*)html, strlen(html) };
+        }
+        pf->iov[pf->count++] = (struct iovec){ "\n", 1 };
+    } else {
+        size_t fileLen;
+        pf->file = pagedir_encode(page, codec, &fileLen);
+        if (pf->file == NULL) {
+            return false;
+        }
+        pf->iov[pf->count++] = (struct iovec){ pf->file, fileLen };
+    }
+
+    pf->len = 0;
+    for (int i = 0; i < pf->count; i++) {
+        pf->len += pf->iov[i].iov_len;
+    }
+    return true;
+}
+
+/**************** writeFile ****************/
+/* Write the file pf to path, replacing whatever was there, and fsync it
+ * if sync; with blocking calls, counted in *syscalls. Returns false, with
+ * a message, on error. pf's pieces are used up along the way.
+ */
+static bool
+writeFile(const char* path, pagefile_t* pf, const bool sync, long* syscalls)
+{
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    (*syscalls)++;
+    if (fd < 0) {
+        fprintf(stderr, "Error: could not open file '%s' for writing\n", path);
+        return false;
+    }
+
+    bool ok = writeAll(fd, pf->iov, pf->count, syscalls);
+    if (ok && sync) {
+        ok = fsync(fd) == 0;
+        (*syscalls)++;
+    }
+    ok = (close(fd) == 0) && ok;
+    (*syscalls)++;
+    if (!ok) {
+        fprintf(stderr, "Error: could not write file '%s'\n", path);
+    }
+    return ok;
+}
+
+/**************** readWhole ****************/
+/* Read all of the file at path into a new buffer, with room for a '\0'
+ * after it, with blocking calls, counted in *syscalls. Returns the
+ * buffer, with the file's length in *fileLen, for the caller to free;
+ * NULL on any error.
+ */
+static char*
+readWhole(const char* path, size_t* fileLen, long* syscalls)
+{
+    int fd = open(path, O_RDONLY);
+    (*syscalls)++;
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat st;
+    char* file = NULL;
+    (*syscalls)++;
+    if (fstat(fd, &st) == 0 && (file = malloc(st.st_size + 1)) != NULL) {
+        size_t len = 0;
+        ssize_t n = 1;
+        while (len < (size_t)st.st_size
+               && (n = read(fd, file + len, st.st_size - len)) > 0) {
+            (*syscalls)++;
+            len += n;
+        }
+        if (len < (size_t)st.st_size) {  // an error, or the file shrank
+            (*syscalls) += (n <= 0) ? 1 : 0;
+            free(file);
+            file = NULL;
+        }
+        *fileLen = len;
+    }
+    close(fd);
+    (*syscalls)++;
+    return file;
+}
+
+/**************** uringSave ****************/
+/* Save the first m page files of batch that are ready, through its ring:
+ * one submission opens them all; a second writes each, fsyncs it if sync,
+ * and closes it, in a chain of its own. Sets each page's ok.
+ */
+static void
+uringSave(pagedir_batch_t* batch, const int m, const bool sync)
+{
+    for (int i = 0; i < m; i++) {
+        batch->results[i].fd = -1;
+        if (batch->results[i].ready) {
+            uring_open(batch->ring, batch->paths[i], O_WRONLY | O_CREAT | O_TRUNC, 0666,
+                       i * NUM_OPS + OP_OPEN);
+        }
+    }
+    uringCollect(batch);
+
+    for (int i = 0; i < m && batch->ring != NULL; i++) {
+        batchresult_t* r = &batch->results[i];
+        if (r->fd >= 0) {
+            pagefile_t* pf = &batch->files[i];
+            uring_writev(batch->ring, r->fd, pf->iov, pf->count, i * NUM_OPS + OP_IO, true);
+            if (sync) {
+                uring_fsync(batch->ring, r->fd, i * NUM_OPS + OP_SYNC, true);
+            }
+            uring_close(batch->ring, r->fd, i * NUM_OPS + OP_CLOSE);
+        }
+    }
+    uringCollect(batch);
+
+    for (int i = 0; i < m; i++) {
+        batchresult_t* r = &batch->results[i];
+        if (r->fd >= 0 && !r->closed) {    // the ring gave out
+            close(r->fd);
+            batch->syscalls++;
+        }
+        if (!r->ready) {
+            continue;
+        }
+        if (r->fd < 0 && batch->ring == NULL) {
+            // the ring gave out before opening it
+            r->ok = writeFile(batch->paths[i], &batch->files[i], sync, &batch->syscalls);
+        } else if (r->fd < 0) {
+            fprintf(stderr, "Error: could not open file '%s' for writing\n", batch->paths[i]);
+        } else if (!r->failed && r->done >= 0 && (size_t)r->done < batch->files[i].len) {
+            // a short write: write it all again, the slow way
+            r->ok = writeFile(batch->paths[i], &batch->files[i], sync, &batch->syscalls);
+        } else if (r->failed || r->done < 0) {
+            fprintf(stderr, "Error: could not write file '%s'\n", batch->paths[i]);
+        } else {
+            r->ok = true;
+        }
+    }
+}
+
+/**************** uringLoad ****************/
+/* Read the first m page files of batch that are ready, through its ring:
+ * one submission opens and sizes them all; a second reads each whole and
+ * closes it. Sets each page's ok, and its file and len.
+ */
+static void
+uringLoad(pagedir_batch_t* batch, const int m)
+{
+    for (int i = 0; i < m; i++) {
+        batch->results[i].fd = -1;
+        if (batch->results[i].ready) {
+            uring_open(batch->ring, batch->paths[i], O_RDONLY, 0, i * NUM_OPS + OP_OPEN);
+            uring_stat(batch->ring, batch->paths[i], &batch->stats[i], i * NUM_OPS + OP_STAT);
+        }
+    }
+    uringCollect(batch);
+
+    for (int i = 0; i < m && batch->ring != NULL; i++) {
+        batchresult_t* r = &batch->results[i];
+        pagefile_t* pf = &batch->files[i];
+        if (r->fd >= 0) {
+            if (r->statted) {
+                pf->len = uring_statSize(&batch->stats[i]);
+                pf->file = malloc(pf->len + 1);
+            }
+            if (pf->file != NULL) {
+                uring_read(batch->ring, r->fd, pf->file, pf->len, i * NUM_OPS + OP_IO, true);
+            }
+            uring_close(batch->ring, r->fd, i * NUM_OPS + OP_CLOSE);
+        }
+    }
+    uringCollect(batch);
+
+    for (int i = 0; i < m; i++) {
+        batchresult_t* r = &batch->results[i];
+        pagefile_t* pf = &batch->files[i];
+        if (r->fd >= 0 && !r->closed) {    // the ring gave out
+            close(r->fd);
+            batch->syscalls++;
+        }
+        r->ok = pf->file != NULL && r->done >= 0 && (size_t)r->done == pf->len;
+        if (r->ready && !r->ok && (r->fd >= 0 || batch->ring == NULL)) {
+            // a short read, no room for it, or the ring gave out: the slow way
+            free(pf->file);
+            pf->file = readWhole(batch->paths[i], &pf->len, &batch->syscalls);
+            r->ok = pf->file != NULL;
+        }
+    }
+}
+
+/**************** uringCollect ****************/
+/* Run the operations queued on batch's ring, and note each result. If
+ * the ring fails, whatever did not run counts as failed, and the batch
+ * does without the ring from then on.
+ */
+static void
+uringCollect(pagedir_batch_t* batch)
+{
+    if (batch->ring == NULL) {
+        return;
+    }
+    bool failed = uring_run(batch->ring, &batch->syscalls) < 0;
+
+    uint64_t tag;
+    int res;
+    while (uring_result(batch->ring, &tag, &res)) {
+        batchresult_t* r = &batch->results[tag / NUM_OPS];
+        switch (tag % NUM_OPS) {
+        case OP_OPEN:
+            r->fd = (res >= 0) ? res : -1;
+            break;
+        case OP_STAT:
+            r->statted = (res == 0);
+            break;
+        case OP_IO:
+            r->done = res;
+            break;
+        case OP_SYNC:
+            r->failed = r->failed || res < 0;
+            break;
+        case OP_CLOSE:
+            r->closed = true;
+            r->failed = r->failed || res < 0;
+            break;
+        }
+    }
+
+    if (failed) {
+        uring_delete(batch->ring);
+        batch->ring = NULL;
+    }
 }
@@ -2,8 +2,37 @@
 #define __PAGEDIR_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include "../libcs50/webpage.h"
 
+/* how pagedir_saveCompressed stores a page file */
+typedef enum {
+    PAGEDIR_PLAIN,     // the text format of pagedir_save
+    PAGEDIR_LZ,        // built-in LZ codec (see lz.h): fast
+    PAGEDIR_ZLIB       // zlib: smaller, slower; only if built with HAVE_ZLIB
+} pagedir_codec_t;
+
+/* how a batch of page files is read and written */
+typedef enum {
+    PAGEDIR_IO_SYNC,   // blocking calls, one file at a time
+    PAGEDIR_IO_URING   // io_uring, many files per call; only if built with HAVE_IO_URING
+} pagedir_io_t;
+
+typedef struct pagedir_batch pagedir_batch_t;  // opaque to users of the module
+
+/* a page as pagedir_map finds it: spans of its page file, read-only and
+ * not '\0'-terminated, valid until pagedir_unmap */
+typedef struct pagedir_view {
+    const char* url;
+    size_t urlLen;
+    int depth;
+    const char* html;  // the rest of the file, as pagedir_load's HTML
+    size_t htmlLen;
+    void* map;         // the mapping to undo (NULL: none)
+    size_t mapLen;
+    char* text;        // a buffer of the view's own to free (NULL: none)
+} pagedir_view_t;
+
 /* pagedir_init
  * Mark the given directory as a crawler-produced pageDirectory by
  * creating a '.crawler' file inside it.
@@ -11,6 +40,14 @@
  */
 bool pagedir_init(const char* pageDirectory);
 
+/* pagedir_path
+ * Allocate and return a new string "pageDirectory/name": the path of a
+ * page file, or of another file kept in the pageDirectory.
+ * Returns NULL if out of memory.
+ * Caller is responsible for freeing the result.
+ */
+char* pagedir_path(const char* pageDirectory, const char* name);
+
 /* pagedir_save
  * Save the given webpage to a file named by docID in the given directory.
  * File format:
@@ -20,6 +57,94 @@ bool pagedir_init(const char* pageDirectory);
  */
 void pagedir_save(const webpage_t* page, const char* pageDirectory, const int docID);
 
+/* pagedir_saveCompressed
+ * Like pagedir_save, but store the file with the given codec.
+ * A compressed file holds the same text as pagedir_save writes, behind a
+ * 12-byte header: the bytes "\x89TSE", the codec (1 = LZ, 2 = zlib),
+ * three zero bytes, and the text's length (4 bytes, little-endian).
+ * pagedir_load reads either kind of file.
+ * If the codec is unavailable, or the page does not compress, the file
+ * is saved plain.
+ */
+void pagedir_saveCompressed(const webpage_t* page, const char* pageDirectory,
+                            const int docID, const pagedir_codec_t codec);
+
+/* pagedir_write
+ * Like pagedir_saveCompressed, but say whether it worked, and with sync,
+ * return only once the file is on disk (fsync). A plain file is written
+ * with a single writev, straight from the page.
+ * Returns true on success; on error, prints a message and returns false.
+ */
+bool pagedir_write(const webpage_t* page, const char* pageDirectory, const int docID,
+                   const pagedir_codec_t codec, const bool sync);
+
+/* pagedir_batchNew
+ * Return a new batch, which saves and loads up to capacity page files at
+ * a time with the given kind of I/O: with PAGEDIR_IO_URING, the files of
+ * a batch are opened with one system call, and read or written (and
+ * closed) with another, where PAGEDIR_IO_SYNC makes three or more calls
+ * for each file. If io_uring is not there (not built with HAVE_IO_URING,
+ * or refused by the kernel), or gives out later, the batch falls back to
+ * blocking calls; files come out the same either way.
+ * A batch is for one thread at a time. Returns NULL if out of memory.
+ * Caller is responsible for calling pagedir_batchDelete.
+ */
+pagedir_batch_t* pagedir_batchNew(const int capacity, const pagedir_io_t io);
+
+/* pagedir_batchIO
+ * Return the kind of I/O the batch is using now.
+ */
+pagedir_io_t pagedir_batchIO(const pagedir_batch_t* batch);
+
+/* pagedir_saveBatch
+ * Like pagedir_write, for each of the n pages, as docIDs[i], a batch at a
+ * time; a NULL page is skipped. With ok, sets ok[i] to whether pages[i]
+ * was saved. Returns the number saved; prints a message for each failure.
+ */
+int pagedir_saveBatch(pagedir_batch_t* batch, const char* pageDirectory,
+                      webpage_t* const pages[], const int docIDs[], const int n,
+                      const pagedir_codec_t codec, const bool sync, bool ok[]);
+
+/* pagedir_loadBatch
+ * Like pagedir_load, for each of the n docIDs, a batch at a time: sets
+ * pages[i] to the page saved as docIDs[i], or NULL. Returns the number
+ * loaded. Caller is responsible for calling webpage_delete on each page.
+ */
+int pagedir_loadBatch(pagedir_batch_t* batch, const char* pageDirectory,
+                      const int docIDs[], const int n, webpage_t* pages[]);
+
+/* pagedir_batchStats
+ * Report the system calls the batch has made, and the pages it has
+ * handled (saved or loaded, or tried to), so far.
+ */
+void pagedir_batchStats(const pagedir_batch_t* batch, long* syscalls, long* pages);
+
+/* pagedir_batchDelete
+ * Free the batch. NULL is ignored.
+ */
+void pagedir_batchDelete(pagedir_batch_t* batch);
+
+/* pagedir_codecAvailable
+ * Returns true if pagedir_saveCompressed and pagedir_load support codec
+ * in this build (PAGEDIR_ZLIB needs HAVE_ZLIB); false otherwise.
+ */
+bool pagedir_codecAvailable(const pagedir_codec_t codec);
+
+/* pagedir_encode
+ * Return the contents of the file pagedir_saveCompressed would write for
+ * page (newly allocated), with its length in *fileLen; NULL if out of
+ * memory. For stores that keep page files somewhere else (see pagepack.h).
+ */
+char* pagedir_encode(const webpage_t* page, const pagedir_codec_t codec, size_t* fileLen);
+
+/* pagedir_decode
+ * Return a new webpage from the fileLen bytes at file, which hold a page
+ * file of either kind; NULL if they are not one.
+ * file must be malloc'd with room for fileLen + 1 bytes; we take it over,
+ * and free it or keep it as the page's HTML.
+ */
+webpage_t* pagedir_decode(char* file, const size_t fileLen);
+
 /* pagedir_validate
  * Verify that the given directory is a crawler-produced pageDirectory
  * by checking for the '.crawler' file.
@@ -28,10 +153,38 @@ void pagedir_save(const webpage_t* page, const char* pageDirectory, const int do
 bool pagedir_validate(const char* pageDirectory);
 
 /* pagedir_load
- * Load a webpage from a file in the given pageDirectory.
- * Returns a newly allocated webpage, or NULL on error.
+ * Load a webpage from a file in the given pageDirectory, saved plain or
+ * compressed (the file's header tells which).
+ * Returns a newly allocated webpage, or NULL on error (including a
+ * compressed file this build cannot decompress).
  * Caller is responsible for calling webpage_delete on the result.
  */
 webpage_t* pagedir_load(const char* pageDirectory, const int docID);
 
+/* pagedir_map
+ * Like pagedir_load, without copying the page: map its file into memory
+ * (mmap) and fill in *view with where its URL, depth, and HTML are. A
+ * file under 16 KB, which costs less to read than to map, is read whole
+ * into a buffer of the view's own instead; so is a compressed file,
+ * decompressed.
+ * Returns true on success; false if there is no such page, or it cannot
+ * be read (*view is then empty, and need not be unmapped).
+ * Caller is responsible for calling pagedir_unmap on the view.
+ */
+bool pagedir_map(const char* pageDirectory, const int docID, pagedir_view_t* view);
+
+/* pagedir_viewFile
+ * Fill in *view with where the URL, depth, and HTML are in the fileLen
+ * bytes at file, which hold a page file of either kind and must outlive
+ * the view; for stores that keep page files somewhere else (see
+ * pagepack.h). Returns false if they are not a page file, or out of memory.
+ * Caller is responsible for calling pagedir_unmap on the view.
+ */
+bool pagedir_viewFile(const char* file, const size_t fileLen, pagedir_view_t* view);
+
+/* pagedir_unmap
+ * Release what the view holds, and empty it. NULL is ignored.
+ */
+void pagedir_unmap(pagedir_view_t* view);
+
 #endif // __PAGEDIR_H
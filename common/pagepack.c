@@ -0,0 +1,670 @@
+/*
+ * pagepack - a page directory's pages, packed into a few large files
+ *
+ * See pagepack.h for usage and the file format.
+ *
+ * The writer keeps the table and the current segment open, and appends
+ * under a mutex: it takes the segment's end as the page's offset, writes
+ * the page there and its entry at 16 * docID, and moves the end along.
+ * Both are plain write calls with no buffering of our own, so once they
+ * return the page is as safe as a page file just closed (and pagepack_sync
+ * puts it on disk). An entry is written only after its page.
+ * pagepack_saveFiles writes a batch of pages the same way, with one
+ * pwritev for all those bound for the current segment, and one pwrite
+ * for each run of consecutive docIDs among their entries.
+ * A resumed crawl reopens the pack at its checkpoint's next docID, which
+ * drops later entries and cuts the segments back to the pages still used.
+ *
+ * A pack being saved to loads a page by reading its entry from the table
+ * file and the page from its segment, opened just for that, since it
+ * holds neither in memory.
+ *
+ * The reader loads the whole table into memory, and opens and maps every
+ * segment once. pagepack_load then reads a page with one pread and
+ * decodes it into a new webpage; pagepack_map hands back a view of the
+ * page where it lies in the segment's mapping, with nothing read or
+ * copied unless the page is compressed (or the segment would not map,
+ * when it too falls back to a pread).
+ */
+
+#define _DEFAULT_SOURCE          // pread, pwrite, pwritev, strdup
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+
+#include "../libcs50/webpage.h"
+#include "pagedir.h"
+#include "pagepack.h"
+
+/**************** file-local global variables ****************/
+static const char MAGIC[8] = "\x89TSEPACK";
+static const uint32_t VERSION = 1;
+#define HEADER_LEN 16                      // magic, version, 4 zeros
+#define ENTRY_LEN 16                       // segment, length, offset
+static const uint64_t SEGMENT_SIZE = (uint64_t)64 << 20;  // start a new one past this
+#define BATCH_MAX 64                       // pages pagepack_saveFiles writes at once
+
+/**************** global types ****************/
+typedef struct pagepack {
+    char* dir;                 // pageDirectory
+    // writer
+    int tableFd;               // .pack (-1 in a reader)
+    int segFd;                 // the segment being appended to
+    uint32_t segment;          // its number
+    uint64_t end;              // its length
+    uint32_t syncedSegment;    // the segment at the last pagepack_sync
+    pthread_mutex_t lock;      // guards the four above
+    // reader
+    unsigned char* table;      // all of .pack (NULL: no pack; read page files)
+    int numEntries;            // entries after the header
+    int* segFds;               // every segment, open for reading
+    char** segMaps;            // and mapped into memory (NULL: not)
+    size_t* segLens;           // the length of each mapping
+    uint32_t numSegments;
+} pagepack_t;
+
+/**************** local functions ****************/
+static pagepack_t* newPack(const char* pageDirectory);
+static char* segmentPath(const char* pageDirectory, const uint32_t segment);
+static bool readTable(const int fd, unsigned char** table, int* numEntries);
+static void getEntry(const unsigned char* entry, uint32_t* segment, uint32_t* length,
+                     uint64_t* offset);
+static void putLE(unsigned char* p, uint64_t v, const int n);
+static uint64_t getLE(const unsigned char* p, const int n);
+static bool nextSegment(pagepack_t* pack);
+static bool writeAll(const int fd, const void* buf, size_t len, off_t offset);
+static bool writevAll(const int fd, struct iovec* iov, int count, off_t offset);
+static bool readAll(const int fd, void* buf, size_t len, off_t offset);
+static webpage_t* loadSaved(pagepack_t* pack, const int docID);
+
+/**************** pagepack_create ****************/
+pagepack_t*
+pagepack_create(const char* pageDirectory, const int firstDocID)
+{
+    if (pageDirectory == NULL || firstDocID < 1) {
+        return NULL;
+    }
+
+    pagepack_t* pack = newPack(pageDirectory);
+    char* path = pagedir_path(pageDirectory, ".pack");
+    if (pack == NULL || path == NULL
+        || (pack->tableFd = open(path, O_RDWR | O_CREAT, 0644)) < 0) {
+        free(path);
+        pagepack_close(pack);
+        return NULL;
+    }
+    free(path);
+
+    // keep the entries before firstDocID, if the table is one of ours
+    unsigned char* table = NULL;
+    int keep = 0;
+    if (firstDocID > 1 && readTable(pack->tableFd, &table, &keep)) {
+        keep = (keep < firstDocID - 1) ? keep : firstDocID - 1;
+    } else {
+        unsigned char header[HEADER_LEN] = { 0 };
+        memcpy(header, MAGIC, sizeof(MAGIC));
+        putLE(header + 8, VERSION, 4);
+        keep = 0;
+        if (ftruncate(pack->tableFd, 0) != 0
+            || !writeAll(pack->tableFd, header, HEADER_LEN, 0)) {
+            free(table);
+            pagepack_close(pack);
+            return NULL;
+        }
+    }
+    bool ok = ftruncate(pack->tableFd, HEADER_LEN + (off_t)keep * ENTRY_LEN) == 0;
+
+    // go on appending to the last segment they use, just past their pages
+    for (int i = 0; i < keep; i++) {
+        uint32_t segment, length;
+        uint64_t offset;
+        getEntry(table + HEADER_LEN + (size_t)i * ENTRY_LEN, &segment, &length, &offset);
+        if (length > 0 && segment > pack->segment) {
+            pack->segment = segment;
+            pack->end = 0;
+        }
+        if (length > 0 && segment == pack->segment && offset + length > pack->end) {
+            pack->end = offset + length;
+        }
+    }
+    free(table);
+
+    // later segments hold only dropped pages
+    for (uint32_t s = pack->segment + 1; ; s++) {
+        char* later = segmentPath(pageDirectory, s);
+        bool gone = (later == NULL || unlink(later) != 0);
+        free(later);
+        if (gone) {
+            break;
+        }
+    }
+
+    char* segPath = segmentPath(pageDirectory, pack->segment);
+    if (segPath != NULL) {
+        pack->segFd = open(segPath, O_WRONLY | O_CREAT, 0644);
+        free(segPath);
+    }
+    if (!ok || pack->segFd < 0 || ftruncate(pack->segFd, pack->end) != 0) {
+        pagepack_close(pack);
+        return NULL;
+    }
+    pack->syncedSegment = UINT32_MAX;        // its directory entry may be new
+    return pack;
+}
+
+/**************** pagepack_save ****************/
+bool
+pagepack_save(pagepack_t* pack, const webpage_t* page, const int docID,
+              const pagedir_codec_t codec)
+{
+    if (pack == NULL || pack->tableFd < 0 || page == NULL || docID < 1) {
+        return false;
+    }
+
+    size_t fileLen;
+    char* file = pagedir_encode(page, codec, &fileLen);
+    if (file == NULL) {
+        fprintf(stderr, "Error: could not encode docID %d\n", docID);
+        return false;
+    }
+    bool ok = pagepack_saveFiles(pack, 1, &file, &fileLen, &docID);
+    free(file);
+    return ok;
+}
+
+/**************** pagepack_saveFiles ****************/
+bool
+pagepack_saveFiles(pagepack_t* pack, const int n, char* const files[],
+                   const size_t fileLens[], const int docIDs[])
+{
+    if (pack == NULL || pack->tableFd < 0 || n < 0
+        || files == NULL || fileLens == NULL || docIDs == NULL) {
+        return false;
+    }
+    for (int i = 0; i < n; i++) {
+        if (files[i] == NULL || fileLens[i] > UINT32_MAX || docIDs[i] < 1) {
+            fprintf(stderr, "Error: could not encode docID %d\n", docIDs[i]);
+            return false;
+        }
+    }
+
+    pthread_mutex_lock(&pack->lock);
+    bool ok = true;
+    int i = 0;
+    while (ok && i < n) {
+        if (pack->end > 0 && pack->end + fileLens[i] > SEGMENT_SIZE) {
+            ok = nextSegment(pack);          // this one is full: start the next
+            continue;
+        }
+
+        // the pages from i on that fit in this segment, up to BATCH_MAX
+        struct iovec iov[BATCH_MAX];
+        unsigned char entries[BATCH_MAX * ENTRY_LEN];
+        uint64_t len = 0;
+        int count = 0;
+        while (i + count < n && count < BATCH_MAX
+               && (count == 0 || pack->end + len + fileLens[i + count] <= SEGMENT_SIZE)) {
+            iov[count].iov_base = files[i + count];
+            iov[count].iov_len = fileLens[i + count];
+            unsigned char* entry = entries + count * ENTRY_LEN;
+            putLE(entry, pack->segment, 4);
+            putLE(entry + 4, fileLens[i + count], 4);
+            putLE(entry + 8, pack->end + len, 8);
+            len += fileLens[i + count];
+            count++;
+        }
+        ok = writevAll(pack->segFd, iov, count, pack->end);
+
+        // then their entries, one write for each run of consecutive docIDs
+        for (int run = 0; ok && run < count; ) {
+            int runLen = 1;
+            while (run + runLen < count
+                   && docIDs[i + run + runLen] == docIDs[i + run] + runLen) {
+                runLen++;
+            }
+            ok = writeAll(pack->tableFd, entries + run * ENTRY_LEN,
+                          (size_t)runLen * ENTRY_LEN, (off_t)docIDs[i + run] * ENTRY_LEN);
+            run += runLen;
+        }
+        if (ok) {
+            pack->end += len;
+            i += count;
+        }
+    }
+    pthread_mutex_unlock(&pack->lock);
+
+    if (!ok) {
+        fprintf(stderr, "Error: could not save docID %d in '%s/.pack'\n",
+                docIDs[i], pack->dir);
+    }
+    return ok;
+}
+
+/**************** pagepack_sync ****************/
+bool
+pagepack_sync(pagepack_t* pack)
+{
+    if (pack == NULL || pack->tableFd < 0) {
+        return false;
+    }
+
+    pthread_mutex_lock(&pack->lock);
+    bool ok = fdatasync(pack->segFd) == 0 && fdatasync(pack->tableFd) == 0;
+    if (ok && pack->syncedSegment != pack->segment) {
+        // a segment begun since: its directory entry too
+        int dirFd = open(pack->dir, O_RDONLY);
+        ok = dirFd >= 0 && fsync(dirFd) == 0;
+        if (dirFd >= 0) {
+            close(dirFd);
+        }
+    }
+    if (ok) {
+        pack->syncedSegment = pack->segment;
+    }
+    pthread_mutex_unlock(&pack->lock);
+    return ok;
+}
+
+/**************** pagepack_open ****************/
+pagepack_t*
+pagepack_open(const char* pageDirectory)
+{
+    if (pageDirectory == NULL) {
+        return NULL;
+    }
+
+    pagepack_t* pack = newPack(pageDirectory);
+    char* path = pagedir_path(pageDirectory, ".pack");
+    if (pack == NULL || path == NULL) {
+        free(path);
+        pagepack_close(pack);
+        return NULL;
+    }
+
+    int fd = open(path, O_RDONLY);
+    free(path);
+    if (fd < 0) {
+        return pack;                         // no pack: one file per page
+    }
+    bool ok = readTable(fd, &pack->table, &pack->numEntries);
+    close(fd);
+    if (!ok) {
+        pagepack_close(pack);
+        return NULL;
+    }
+
+    // open every segment an entry names
+    for (int i = 0; i < pack->numEntries; i++) {
+        uint32_t segment, length;
+        uint64_t offset;
+        getEntry(pack->table + HEADER_LEN + (size_t)i * ENTRY_LEN, &segment, &length, &offset);
+        if (length > 0 && segment >= pack->numSegments) {
+            pack->numSegments = segment + 1;
+        }
+    }
+    pack->segFds = malloc((pack->numSegments + 1) * sizeof(int));
+    pack->segMaps = calloc(pack->numSegments + 1, sizeof(char*));
+    pack->segLens = calloc(pack->numSegments + 1, sizeof(size_t));
+    if (pack->segFds == NULL || pack->segMaps == NULL || pack->segLens == NULL) {
+        free(pack->segFds);
+        pack->segFds = NULL;
+        pack->numSegments = 0;
+        pagepack_close(pack);
+        return NULL;
+    }
+    for (uint32_t s = 0; s < pack->numSegments; s++) {
+        char* segPath = segmentPath(pageDirectory, s);
+        pack->segFds[s] = (segPath != NULL) ? open(segPath, O_RDONLY) : -1;
+        free(segPath);
+
+        // a segment that cannot be mapped is still read with pread
+        struct stat st;
+        if (pack->segFds[s] >= 0 && fstat(pack->segFds[s], &st) == 0 && st.st_size > 0) {
+            void* map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, pack->segFds[s], 0);
+            if (map != MAP_FAILED) {
+                pack->segMaps[s] = map;
+                pack->segLens[s] = st.st_size;
+            }
+        }
+    }
+    return pack;
+}
+
+/**************** pagepack_load ****************/
+webpage_t*
+pagepack_load(pagepack_t* pack, const int docID)
+{
+    if (pack == NULL || docID < 1) {
+        return NULL;
+    }
+    if (pack->tableFd >= 0) {
+        return loadSaved(pack, docID);
+    }
+    if (pack->table == NULL) {
+        return pagedir_load(pack->dir, docID);
+    }
+    if (docID > pack->numEntries) {
+        return NULL;
+    }
+
+    uint32_t segment, length;
+    uint64_t offset;
+    getEntry(pack->table + (size_t)docID * ENTRY_LEN, &segment, &length, &offset);
+    if (length == 0 || segment >= pack->numSegments || pack->segFds[segment] < 0) {
+        return NULL;
+    }
+
+    char* file = malloc((size_t)length + 1);
+    if (file == NULL || !readAll(pack->segFds[segment], file, length, offset)) {
+        free(file);
+        return NULL;
+    }
+    return pagedir_decode(file, length);
+}
+
+/**************** pagepack_map ****************/
+bool
+pagepack_map(pagepack_t* pack, const int docID, pagedir_view_t* view)
+{
+    if (view == NULL) {
+        return false;
+    }
+    if (pack != NULL && pack->table == NULL) {
+        return pagedir_map(pack->dir, docID, view);
+    }
+    memset(view, 0, sizeof(*view));
+    if (pack == NULL || docID < 1 || docID > pack->numEntries) {
+        return false;
+    }
+
+    uint32_t segment, length;
+    uint64_t offset;
+    getEntry(pack->table + (size_t)docID * ENTRY_LEN, &segment, &length, &offset);
+    if (length == 0 || segment >= pack->numSegments || pack->segFds[segment] < 0) {
+        return false;
+    }
+    if (pack->segMaps[segment] != NULL && offset + length <= pack->segLens[segment]) {
+        return pagedir_viewFile(pack->segMaps[segment] + offset, length, view);
+    }
+
+    // no mapping: read the page file, and let the view free it
+    char* file = malloc(length);
+    if (file == NULL || !readAll(pack->segFds[segment], file, length, offset)
+        || !pagedir_viewFile(file, length, view)) {
+        free(file);
+        return false;
+    }
+    if (view->text == NULL) {
+        view->text = file;
+    } else {
+        free(file);                            // the view has it decompressed
+    }
+    return true;
+}
+
+/**************** pagepack_close ****************/
+void
+pagepack_close(pagepack_t* pack)
+{
+    if (pack == NULL) {
+        return;
+    }
+    if (pack->tableFd >= 0) {
+        close(pack->tableFd);
+    }
+    if (pack->segFd >= 0) {
+        close(pack->segFd);
+    }
+    for (uint32_t s = 0; s < pack->numSegments; s++) {
+        if (pack->segFds[s] >= 0) {
+            close(pack->segFds[s]);
+        }
+        if (pack->segMaps[s] != NULL) {
+            munmap(pack->segMaps[s], pack->segLens[s]);
+        }
+    }
+    free(pack->segFds);
+    free(pack->segMaps);
+    free(pack->segLens);
+    free(pack->table);
+    free(pack->dir);
+    pthread_mutex_destroy(&pack->lock);
+    free(pack);
+}
+
+/**************** pagepack_remove ****************/
+void
+pagepack_remove(const char* pageDirectory)
+{
+    if (pageDirectory == NULL) {
+        return;
+    }
+    char* path = pagedir_path(pageDirectory, ".pack");
+    if (path != NULL) {
+        unlink(path);
+        free(path);
+    }
+    for (uint32_t s = 0; ; s++) {
+        char* segPath = segmentPath(pageDirectory, s);
+        bool gone = (segPath == NULL || unlink(segPath) != 0);
+        free(segPath);
+        if (gone) {
+            break;
+        }
+    }
+}
+
+/**************** newPack ****************/
+/* Allocate an empty pack for pageDirectory, with no files open;
+ * NULL if out of memory.
+ */
+static pagepack_t*
+newPack(const char* pageDirectory)
+{
+    pagepack_t* pack = calloc(1, sizeof(pagepack_t));
+    if (pack == NULL) {
+        return NULL;
+    }
+    if ((pack->dir = strdup(pageDirectory)) == NULL) {
+        free(pack);
+        return NULL;
+    }
+    pack->tableFd = -1;
+    pack->segFd = -1;
+    pthread_mutex_init(&pack->lock, NULL);
+    return pack;
+}
+
+/**************** segmentPath ****************/
+/* Allocate and return "pageDirectory/.pack.segment"; the caller frees it. */
+static char*
+segmentPath(const char* pageDirectory, const uint32_t segment)
+{
+    char name[20];
+    snprintf(name, sizeof(name), ".pack.%u", (unsigned)segment);
+    return pagedir_path(pageDirectory, name);
+}
+
+/**************** readTable ****************/
+/* Read all of the table file fd into a new buffer, header included, and
+ * count its entries. Returns false if it is not a table of ours.
+ */
+static bool
+readTable(const int fd, unsigned char** table, int* numEntries)
+{
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < HEADER_LEN
+        || (st.st_size - HEADER_LEN) / ENTRY_LEN > INT32_MAX) {
+        return false;
+    }
+    unsigned char* buf = malloc(st.st_size);
+    if (buf == NULL || !readAll(fd, buf, st.st_size, 0)
+        || memcmp(buf, MAGIC, sizeof(MAGIC)) != 0 || getLE(buf + 8, 4) != VERSION) {
+        free(buf);
+        return false;
+    }
+    *table = buf;
+    *numEntries = (st.st_size - HEADER_LEN) / ENTRY_LEN;
+    return true;
+}
+
+/**************** getEntry ****************/
+/* Decode the table entry at entry. */
+static void
+getEntry(const unsigned char* entry, uint32_t* segment, uint32_t* length,
+         uint64_t* offset)
+{
+    *segment = getLE(entry, 4);
+    *length = getLE(entry + 4, 4);
+    *offset = getLE(entry + 8, 8);
+}
+
+/**************** putLE ****************/
+/* Store the low n bytes of v at p, little-endian. */
+static void
+putLE(unsigned char* p, uint64_t v, const int n)
+{
+    for (int i = 0; i < n; i++) {
+        p[i] = (v >> (8 * i)) & 0xff;
+    }
+}
+
+/**************** getLE ****************/
+/* Return the n-byte little-endian integer at p. */
+static uint64_t
+getLE(const unsigned char* p, const int n)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < n; i++) {
+        v |= (uint64_t)p[i] << (8 * i);
+    }
+    return v;
+}
+
+/**************** nextSegment ****************/
+/* Start the segment after the current one, syncing the current one first
+ * (once in 64 MB), since pagepack_sync sees only the last. The caller
+ * holds the lock. Returns false on error.
+ */
+static bool
+nextSegment(pagepack_t* pack)
+{
+    char* segPath = segmentPath(pack->dir, pack->segment + 1);
+    int fd = (segPath != NULL) ? open(segPath, O_WRONLY | O_CREAT | O_TRUNC, 0644) : -1;
+    free(segPath);
+    if (fd < 0) {
+        return false;
+    }
+    fdatasync(pack->segFd);
+    close(pack->segFd);
+    pack->segFd = fd;
+    pack->segment++;
+    pack->end = 0;
+    return true;
+}
+
+/**************** writeAll ****************/
+/* Write all len bytes of buf to fd at offset. Returns false on error. */
+static bool
+writeAll(const int fd, const void* buf, size_t len, off_t offset)
+{
+    const char* p = buf;
+    while (len > 0) {
+        ssize_t n = pwrite(fd, p, len, offset);
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        len -= n;
+        offset += n;
+    }
+    return true;
+}
+
+/**************** readAll ****************/
+/* Read exactly len bytes from fd at offset into buf. Returns false on
+ * error or if the file ends first.
+ */
+static bool
+readAll(const int fd, void* buf, size_t len, off_t offset)
+{
+    char* p = buf;
+    while (len > 0) {
+        ssize_t n = pread(fd, p, len, offset);
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        len -= n;
+        offset += n;
+    }
+    return true;
+}
+
+/**************** loadSaved ****************/
+/* pagepack_load for a pack being saved to: read docID's entry from the
+ * table file, then the page from its segment. An entry is written only
+ * after its page, so a page with an entry is there to read.
+ */
+static webpage_t*
+loadSaved(pagepack_t* pack, const int docID)
+{
+    unsigned char entry[ENTRY_LEN];
+    if (!readAll(pack->tableFd, entry, ENTRY_LEN, (off_t)docID * ENTRY_LEN)) {
+        return NULL;                           // past the end of the table
+    }
+    uint32_t segment, length;
+    uint64_t offset;
+    getEntry(entry, &segment, &length, &offset);
+    char* segPath = segmentPath(pack->dir, segment);
+    int fd = (length > 0 && segPath != NULL) ? open(segPath, O_RDONLY) : -1;
+    free(segPath);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    char* file = malloc((size_t)length + 1);
+    bool ok = (file != NULL && readAll(fd, file, length, offset));
+    close(fd);
+    if (!ok) {
+        free(file);
+        return NULL;
+    }
+    return pagedir_decode(file, length);
+}
+
+/**************** writevAll ****************/
+/* Write all of the count buffers in iov to fd at offset, one after the
+ * other, resuming after a short write. Returns false on error. iov is
+ * used up along the way.
+ */
+static bool
+writevAll(const int fd, struct iovec* iov, int count, off_t offset)
+{
+    while (count > 0) {
+        ssize_t n = pwritev(fd, iov, count, offset);
+        if (n <= 0) {
+            return false;
+        }
+        offset += n;
+        while (count > 0 && (size_t)n >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (char*)iov->iov_base + n;
+            iov->iov_len -= n;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,102 @@
+#ifndef __PAGEPACK_H
+#define __PAGEPACK_H
+
+/*
+ * pagepack - a page directory's pages, packed into a few large files
+ *
+ * Instead of one file per docID, a pack appends each page file (the bytes
+ * pagedir_saveCompressed would write, compressed or not) to a segment
+ * file, pageDirectory/.pack.0, .pack.1, and so on, each up to 64 MB.
+ * The table in pageDirectory/.pack says where each page went: after a
+ * 16-byte header ("\x89TSEPACK", a 4-byte version, 4 zero bytes), the
+ * 16-byte entry for docID d sits at 16 * d and holds the page's segment
+ * and length (4 bytes each) and its offset in the segment (8 bytes), all
+ * little-endian. An entry of zeros means there is no such page.
+ *
+ * So saving a page costs two writes to files already open, and loading
+ * one a single read, where one file per page costs an open, a close, and
+ * a directory entry each. A reader also maps every segment into memory,
+ * so pagepack_map finds a page where it lies, without reading it at all.
+ */
+
+#include <stdbool.h>
+#include "../libcs50/webpage.h"
+#include "pagedir.h"
+
+typedef struct pagepack pagepack_t;  // opaque to users of the module
+
+/* pagepack_create
+ * Open the pack in pageDirectory for saving pages from firstDocID on,
+ * creating it if need be. Entries for docIDs from firstDocID up are
+ * dropped, and so are the segment bytes that only they used; with
+ * firstDocID 1 the pack starts out empty.
+ * Returns the pack, or NULL on error. A pack opened this way saves
+ * pages, and loads only those it holds on disk (pagepack_load); close it
+ * with pagepack_close.
+ */
+pagepack_t* pagepack_create(const char* pageDirectory, const int firstDocID);
+
+/* pagepack_save
+ * Append page to the pack as docID, stored with codec as by
+ * pagedir_saveCompressed. Pages may be saved in any order, and by
+ * several threads at once.
+ * Returns true on success; on error, prints a message and returns false.
+ */
+bool pagepack_save(pagepack_t* pack, const webpage_t* page, const int docID,
+                   const pagedir_codec_t codec);
+
+/* pagepack_saveFiles
+ * Append n page files, already encoded (see pagedir_encode), to the pack:
+ * files[i], fileLens[i] bytes long, as docIDs[i]. Those that fit in the
+ * current segment go there with a single write, and so do the entries
+ * of consecutive docIDs.
+ * Returns true on success; on error, prints a message and returns false,
+ * with only some of the pages saved.
+ */
+bool pagepack_saveFiles(pagepack_t* pack, const int n, char* const files[],
+                        const size_t fileLens[], const int docIDs[]);
+
+/* pagepack_sync
+ * Put every page saved so far on disk (fdatasync), table entry and all.
+ * Returns true on success; false on error.
+ */
+bool pagepack_sync(pagepack_t* pack);
+
+/* pagepack_open
+ * Open pageDirectory for loading pages. If it holds a pack, pages come
+ * from there; otherwise from their own files, as pagedir_load reads them.
+ * Returns the reader, or NULL on error (including a damaged table).
+ * Close it with pagepack_close.
+ */
+pagepack_t* pagepack_open(const char* pageDirectory);
+
+/* pagepack_load
+ * Return a new webpage for docID, or NULL if there is none or it cannot
+ * be read. Safe to call from several threads at once, and, on a pack
+ * being saved to, while pages are saved.
+ * Caller is responsible for calling webpage_delete on the result.
+ */
+webpage_t* pagepack_load(pagepack_t* pack, const int docID);
+
+/* pagepack_map
+ * Like pagepack_load, without copying the page: fill in *view with where
+ * the page for docID lies in the pack's mapping of its segment, or in the
+ * page file's own mapping (see pagedir_map). Safe to call from several
+ * threads at once. Returns true on success; false if there is no such
+ * page or it cannot be read.
+ * Caller is responsible for calling pagedir_unmap on the view, before
+ * pagepack_close.
+ */
+bool pagepack_map(pagepack_t* pack, const int docID, pagedir_view_t* view);
+
+/* pagepack_close
+ * Close the pack and free it. NULL is ignored.
+ */
+void pagepack_close(pagepack_t* pack);
+
+/* pagepack_remove
+ * Delete any pack in pageDirectory: its table and all its segments.
+ */
+void pagepack_remove(const char* pageDirectory);
+
+#endif // __PAGEPACK_H
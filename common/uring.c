@@ -0,0 +1,345 @@
+/*
+ * uring - a minimal io_uring ring, for batches of file operations
+ *
+ * See uring.h for usage.
+ *
+ * The ring is the kernel's pair of queues, mapped into our memory: we
+ * fill submission entries and move the submission tail along; the kernel
+ * moves the completion tail as operations finish, and we move the
+ * completion head as we take their results. The tails and heads the other
+ * side moves are read with acquire loads, and ours stored with release
+ * stores, so an entry is seen whole. Linked operations use
+ * IOSQE_IO_HARDLINK, which keeps the chain going even when one fails.
+ * The completion queue is twice the size of the submission queue, so a
+ * full batch of results always fits.
+ *
+ * Without HAVE_IO_URING, uring_new always returns NULL, and the rest is
+ * never reached.
+ */
+
+#define _GNU_SOURCE       // syscall, struct statx
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include "uring.h"
+
+#ifdef HAVE_IO_URING
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+_Static_assert(sizeof(struct statx) <= sizeof(uring_stat_t), "uring_stat_t is too small");
+
+/**************** global types ****************/
+typedef struct uring {
+    int fd;                        // from io_uring_setup
+    unsigned entries;              // submission queue entries
+    unsigned queued;               // operations queued since the last uring_run
+    // the mappings
+    void* sqRing;
+    size_t sqRingLen;
+    void* cqRing;                  // the same as sqRing, if the kernel maps both at once
+    size_t cqRingLen;
+    struct io_uring_sqe* sqes;
+    size_t sqesLen;
+    // in the submission queue
+    unsigned* sqHead;
+    unsigned* sqTail;
+    unsigned sqMask;
+    unsigned* sqArray;
+    // in the completion queue
+    unsigned* cqHead;
+    unsigned* cqTail;
+    unsigned cqMask;
+    struct io_uring_cqe* cqes;
+} uring_t;
+
+/**************** local functions ****************/
+static struct io_uring_sqe* nextEntry(uring_t* ring);
+static void queueEntry(uring_t* ring, struct io_uring_sqe* sqe, const uint64_t tag,
+                       const bool linked);
+
+/**************** uring_new ****************/
+uring_t*
+uring_new(const unsigned entries)
+{
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = 2 * entries;
+    int fd = syscall(__NR_io_uring_setup, entries, &params);
+    if (fd < 0) {
+        return NULL;
+    }
+    uring_t* ring = calloc(1, sizeof(uring_t));
+    if (ring == NULL) {
+        close(fd);
+        return NULL;
+    }
+    ring->fd = fd;
+    ring->entries = params.sq_entries;
+
+    ring->sqRingLen = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cqRingLen = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single && ring->cqRingLen > ring->sqRingLen) {
+        ring->sqRingLen = ring->cqRingLen;
+    }
+    ring->sqesLen = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqRing = mmap(NULL, ring->sqRingLen, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    ring->cqRing = single ? ring->sqRing
+        : mmap(NULL, ring->cqRingLen, PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    ring->sqes = mmap(NULL, ring->sqesLen, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (ring->sqRing == MAP_FAILED || ring->cqRing == MAP_FAILED || ring->sqes == MAP_FAILED) {
+        uring_delete(ring);
+        return NULL;
+    }
+
+    char* sq = ring->sqRing;
+    ring->sqHead = (unsigned*)(sq + params.sq_off.head);
+    ring->sqTail = (unsigned*)(sq + params.sq_off.tail);
+    ring->sqMask = *(unsigned*)(sq + params.sq_off.ring_mask);
+    ring->sqArray = (unsigned*)(sq + params.sq_off.array);
+    char* cq = ring->cqRing;
+    ring->cqHead = (unsigned*)(cq + params.cq_off.head);
+    ring->cqTail = (unsigned*)(cq + params.cq_off.tail);
+    ring->cqMask = *(unsigned*)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+    return ring;
+}
+
+/**************** uring_open ****************/
+bool
+uring_open(uring_t* ring, const char* path, const int flags, const int mode,
+           const uint64_t tag)
+{
+    struct io_uring_sqe* sqe = nextEntry(ring);
+    if (sqe == NULL) {
+        return false;
+    }
+    sqe->opcode = IORING_OP_OPENAT;
+    sqe->fd = AT_FDCWD;
+    sqe->addr = (uintptr_t)path;
+    sqe->len = mode;
+    sqe->open_flags = flags;
+    queueEntry(ring, sqe, tag, false);
+    return true;
+}
+
+/**************** uring_stat ****************/
+bool
+uring_stat(uring_t* ring, const char* path, uring_stat_t* st, const uint64_t tag)
+{
+    struct io_uring_sqe* sqe = nextEntry(ring);
+    if (sqe == NULL) {
+        return false;
+    }
+    sqe->opcode = IORING_OP_STATX;
+    sqe->fd = AT_FDCWD;
+    sqe->addr = (uintptr_t)path;
+    sqe->len = STATX_SIZE;
+    sqe->off = (uintptr_t)st;          // where the struct statx goes
+    queueEntry(ring, sqe, tag, false);
+    return true;
+}
+
+/**************** uring_read ****************/
+bool
+uring_read(uring_t* ring, const int fd, void* buf, const size_t len,
+           const uint64_t tag, const bool linked)
+{
+    struct io_uring_sqe* sqe = nextEntry(ring);
+    if (sqe == NULL) {
+        return false;
+    }
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = (uintptr_t)buf;
+    sqe->len = len;
+    sqe->off = 0;
+    queueEntry(ring, sqe, tag, linked);
+    return true;
+}
+
+/**************** uring_writev ****************/
+bool
+uring_writev(uring_t* ring, const int fd, const struct iovec* iov, const int count,
+             const uint64_t tag, const bool linked)
+{
+    struct io_uring_sqe* sqe = nextEntry(ring);
+    if (sqe == NULL) {
+        return false;
+    }
+    sqe->opcode = IORING_OP_WRITEV;
+    sqe->fd = fd;
+    sqe->addr = (uintptr_t)iov;
+    sqe->len = count;
+    sqe->off = 0;
+    queueEntry(ring, sqe, tag, linked);
+    return true;
+}
+
+/**************** uring_fsync ****************/
+bool
+uring_fsync(uring_t* ring, const int fd, const uint64_t tag, const bool linked)
+{
+    struct io_uring_sqe* sqe = nextEntry(ring);
+    if (sqe == NULL) {
+        return false;
+    }
+    sqe->opcode = IORING_OP_FSYNC;
+    sqe->fd = fd;
+    queueEntry(ring, sqe, tag, linked);
+    return true;
+}
+
+/**************** uring_close ****************/
+bool
+uring_close(uring_t* ring, const int fd, const uint64_t tag)
+{
+    struct io_uring_sqe* sqe = nextEntry(ring);
+    if (sqe == NULL) {
+        return false;
+    }
+    sqe->opcode = IORING_OP_CLOSE;
+    sqe->fd = fd;
+    queueEntry(ring, sqe, tag, false);
+    return true;
+}
+
+/**************** uring_statSize ****************/
+uint64_t
+uring_statSize(const uring_stat_t* st)
+{
+    const struct statx* stx = (const struct statx*)st;
+    return stx->stx_size;
+}
+
+/**************** uring_run ****************/
+int
+uring_run(uring_t* ring, long* syscalls)
+{
+    unsigned toSubmit = ring->queued;
+    unsigned target = toSubmit + (__atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE) - *ring->cqHead);
+    while (true) {
+        unsigned ready = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE) - *ring->cqHead;
+        if (toSubmit == 0 && ready >= target) {
+            break;
+        }
+        int n = syscall(__NR_io_uring_enter, ring->fd, toSubmit, target,
+                        IORING_ENTER_GETEVENTS, NULL, 0);
+        (*syscalls)++;
+        if (n < 0 && errno != EINTR) {
+            ring->queued = toSubmit;
+            return -1;
+        }
+        if (n > 0) {
+            toSubmit -= n;
+        }
+    }
+    ring->queued = 0;
+    return target;
+}
+
+/**************** uring_result ****************/
+bool
+uring_result(uring_t* ring, uint64_t* tag, int* res)
+{
+    unsigned head = *ring->cqHead;
+    if (head == __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    struct io_uring_cqe* cqe = &ring->cqes[head & ring->cqMask];
+    *tag = cqe->user_data;
+    *res = cqe->res;
+    __atomic_store_n(ring->cqHead, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+/**************** uring_delete ****************/
+void
+uring_delete(uring_t* ring)
+{
+    if (ring == NULL) {
+        return;
+    }
+    if (ring->sqes != NULL && ring->sqes != MAP_FAILED) {
+        munmap(ring->sqes, ring->sqesLen);
+    }
+    if (ring->cqRing != NULL && ring->cqRing != MAP_FAILED && ring->cqRing != ring->sqRing) {
+        munmap(ring->cqRing, ring->cqRingLen);
+    }
+    if (ring->sqRing != NULL && ring->sqRing != MAP_FAILED) {
+        munmap(ring->sqRing, ring->sqRingLen);
+    }
+    close(ring->fd);
+    free(ring);
+}
+
+/**************** nextEntry ****************/
+/* Return the next free submission entry, cleared; NULL if the queue is
+ * full. It is not the kernel's until queueEntry.
+ */
+static struct io_uring_sqe*
+nextEntry(uring_t* ring)
+{
+    if (ring == NULL) {
+        return NULL;
+    }
+    unsigned head = __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE);
+    unsigned tail = *ring->sqTail;
+    if (tail - head >= ring->entries) {
+        return NULL;
+    }
+    struct io_uring_sqe* sqe = &ring->sqes[tail & ring->sqMask];
+    memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+/**************** queueEntry ****************/
+/* Tag the entry nextEntry returned, link it to the next if linked, and
+ * hand it to the kernel, to start at the next uring_run.
+ */
+static void
+queueEntry(uring_t* ring, struct io_uring_sqe* sqe, const uint64_t tag, const bool linked)
+{
+    unsigned tail = *ring->sqTail;
+    unsigned index = tail & ring->sqMask;
+    sqe->user_data = tag;
+    sqe->flags = linked ? IOSQE_IO_HARDLINK : 0;
+    ring->sqArray[index] = index;
+    __atomic_store_n(ring->sqTail, tail + 1, __ATOMIC_RELEASE);
+    ring->queued++;
+}
+
+#else // no HAVE_IO_URING: there is never a ring
+
+uring_t* uring_new(const unsigned entries) { return NULL; }
+bool uring_open(uring_t* ring, const char* path, const int flags, const int mode,
+                const uint64_t tag) { return false; }
+bool uring_stat(uring_t* ring, const char* path, uring_stat_t* st,
+                const uint64_t tag) { return false; }
+bool uring_read(uring_t* ring, const int fd, void* buf, const size_t len,
+                const uint64_t tag, const bool linked) { return false; }
+bool uring_writev(uring_t* ring, const int fd, const struct iovec* iov, const int count,
+                  const uint64_t tag, const bool linked) { return false; }
+bool uring_fsync(uring_t* ring, const int fd, const uint64_t tag,
+                 const bool linked) { return false; }
+bool uring_close(uring_t* ring, const int fd, const uint64_t tag) { return false; }
+uint64_t uring_statSize(const uring_stat_t* st) { return 0; }
+int uring_run(uring_t* ring, long* syscalls) { return -1; }
+bool uring_result(uring_t* ring, uint64_t* tag, int* res) { return false; }
+void uring_delete(uring_t* ring) { }
+
+#endif // HAVE_IO_URING
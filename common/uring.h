@@ -0,0 +1,83 @@
+#ifndef __URING_H
+#define __URING_H
+
+/*
+ * uring - a minimal io_uring ring, for batches of file operations
+ *
+ * A ring takes a batch of operations (open, stat, read, write, fsync,
+ * close), each tagged with a number of the caller's, and performs them
+ * all on one io_uring_enter call, handing back each one's result as the
+ * system call would have returned it (a negative errno on error). An
+ * operation may be *linked* to the next one queued, which then starts
+ * only once it has finished, whatever its result; so a close linked
+ * after a write always happens, and after the write.
+ *
+ * It talks to the kernel directly, without liburing, and is there only
+ * if built with HAVE_IO_URING (the Makefiles define it when the kernel
+ * headers have io_uring); otherwise, or if the kernel refuses,
+ * uring_new returns NULL and the caller does without.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/uio.h>
+
+typedef struct uring uring_t;  // opaque to users of the module
+
+/* room for what uring_stat fills in */
+typedef struct uring_stat {
+    uint64_t words[32];
+} uring_stat_t;
+
+/* uring_new
+ * Return a new ring with room for `entries` operations queued at once,
+ * or NULL if io_uring is not available.
+ * Close it with uring_delete.
+ */
+uring_t* uring_new(const unsigned entries);
+
+/* uring_open, uring_stat, uring_read, uring_writev, uring_fsync, uring_close
+ * Queue an openat(AT_FDCWD, path, flags, mode); a statx of path, into
+ * *st (see uring_statSize); a read of len bytes from the start of fd into
+ * buf; a writev of iov[count] to fd; an fsync of fd; or a close of fd.
+ * tag comes back with the result. With linked, the next operation queued
+ * waits for this one. path, st, buf, and iov must stay put until
+ * uring_run returns.
+ * Each returns false if the ring is full.
+ */
+bool uring_open(uring_t* ring, const char* path, const int flags, const int mode,
+                const uint64_t tag);
+bool uring_stat(uring_t* ring, const char* path, uring_stat_t* st, const uint64_t tag);
+bool uring_read(uring_t* ring, const int fd, void* buf, const size_t len,
+                const uint64_t tag, const bool linked);
+bool uring_writev(uring_t* ring, const int fd, const struct iovec* iov, const int count,
+                  const uint64_t tag, const bool linked);
+bool uring_fsync(uring_t* ring, const int fd, const uint64_t tag, const bool linked);
+bool uring_close(uring_t* ring, const int fd, const uint64_t tag);
+
+/* uring_statSize
+ * Return the file size a completed uring_stat put in *st.
+ */
+uint64_t uring_statSize(const uring_stat_t* st);
+
+/* uring_run
+ * Start every operation queued, and wait until all of them are done.
+ * Adds the number of system calls that took to *syscalls.
+ * Returns the number of results to collect with uring_result, or -1 on
+ * error (in which case some of them may have run).
+ */
+int uring_run(uring_t* ring, long* syscalls);
+
+/* uring_result
+ * Take the next result of the last uring_run: its tag in *tag, and its
+ * result in *res. Returns false if there are no more.
+ */
+bool uring_result(uring_t* ring, uint64_t* tag, int* res);
+
+/* uring_delete
+ * Close the ring and free it. NULL is ignored.
+ */
+void uring_delete(uring_t* ring);
+
+#endif // __URING_H
@@ -0,0 +1,311 @@
+/*
+ * asynccrawl.c - the crawler's event-driven (-a) crawl
+ *
+ * see asynccrawl.h for more information.
+ *
+ * A page taken from the frontier waits in `waiting` until its slot comes,
+ * and is submitted to the fetcher then; pageFetched, the fetcher's
+ * completion callback, saves it, or puts it back in `waiting` for a
+ * retry. Every page waiting or in flight is also on the `live` list, for
+ * the checkpoints.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "../libcs50/webpage.h"
+#include "../libcs50/fetcher.h"
+#include "../libcs50/linkscan.h"
+#include "asynccrawl.h"
+#include "seqcrawl.h"
+#include "pagescan.h"
+#include "recrawl.h"
+#include "pagestore.h"
+#include "crawlstart.h"
+#include "simhash.h"
+#include "metrics.h"
+
+/**************** local types ****************/
+/* state of an event-driven (-a) crawl; the fetcher calls back into it */
+typedef struct asynccrawl {
+    seqcrawl_t base;             // frontier and seen-set (see seqcrawl.h)
+    const char* pageDirectory;
+    pagestore_t store;           // where pages are saved
+    pagepack_t* oldPages;        // pages saved before (NULL: no --recrawl)
+    int maxDepth;
+    int docID;                   // next docID to hand out
+    politeness_t* polite;        // when each host may be fetched again
+    simindex_t* nearDups;        // fingerprints of pages saved (NULL: --near-dup off)
+    struct asyncpage** waiting;  // pages scheduled for a later slot
+    int numWaiting;              // ... at most 2 * maxInFlight of them
+    int maxInFlight;
+    struct asyncpage* live;      // every page waiting or in flight
+    int checkpointEvery;         // pages between checkpoints (0: none)
+    bool checkpointDue;          // take one when the fetcher next returns
+} asynccrawl_t;
+
+/* a page taken from the frontier by an async crawl, until fetched or given up */
+typedef struct asyncpage {
+    webpage_t* page;
+    int known;                   // docID it was saved as before, or 0
+    int attempt;                 // fetches tried so far
+    long readyAt;                // when its host's slot comes (politeness clock)
+    pagescan_t scan;             // its links, found while it arrives
+    asynccrawl_t* state;
+    struct asyncpage* prev;      // neighbours in state->live
+    struct asyncpage* next;
+} asyncpage_t;
+
+/**************** local functions ****************/
+static void asyncSchedule(asynccrawl_t* state, asyncpage_t* ap);
+static long asyncSubmitReady(asynccrawl_t* state, fetcher_t* fetcher);
+static void pageFetched(void* arg, webpage_t* page, const bool fetched);
+static void asyncTrack(asynccrawl_t* state, asyncpage_t* ap);
+static void asyncUntrack(asynccrawl_t* state, asyncpage_t* ap);
+static void asyncCheckpoint(asynccrawl_t* state);
+
+/**************** asynccrawl_run() ****************/
+/* see asynccrawl.h for description */
+void
+asynccrawl_run(char* seedURL, char* pageDirectory, const int maxDepth,
+               const crawlopts_t* opts, politeness_t* polite, const crawlpart_t* part)
+{
+    asynccrawl_t state;
+    procmesh_t* mesh = (part != NULL) ? part->mesh : NULL;
+    state.base.mesh = mesh;
+    state.pageDirectory = pageDirectory;
+    state.maxDepth = maxDepth;
+    state.docID = 1;
+    state.polite = polite;
+    state.maxInFlight = opts->maxInFlight;
+    state.numWaiting = 0;
+    state.live = NULL;
+    state.checkpointEvery = opts->checkpointEvery;
+    state.checkpointDue = false;
+
+    // each in-flight page may need a retry on top of a full waiting list
+    state.waiting = calloc(2 * opts->maxInFlight, sizeof(asyncpage_t*));
+    state.base.pagesSeen = seenset_new(opts->expectedURLs);
+    state.base.linkMemo = linkmemo_new(CRAWL_LINK_MEMO);
+    state.base.pagesToCrawl = frontier_new(opts->priority);
+    fetcher_t* fetcher = fetcher_new(opts->maxInFlight, opts->connectTimeout,
+                                     opts->readTimeout);
+    if (state.waiting == NULL || state.base.pagesSeen == NULL || state.base.linkMemo == NULL
+        || state.base.pagesToCrawl == NULL || fetcher == NULL) {
+        fprintf(stderr, "Error: could not allocate crawler state\n");
+        exit(2);
+    }
+    state.docID = (part != NULL)
+        ? crawlstart_part(seedURL, mesh, state.base.pagesSeen, &state.base,
+                          seqcrawl_queue)
+        : crawlstart_seed(seedURL, pageDirectory, opts, state.base.pagesSeen,
+                          &state.base, seqcrawl_queue);
+    pagestore_open(&state.store, opts, pageDirectory, &state.docID, part);
+    state.oldPages = recrawl_open(opts, pageDirectory);
+    state.nearDups = pagestore_nearDups(opts, pageDirectory, state.docID);
+
+    // keep the fetcher full until nothing is left in the frontier, waiting,
+    // or in flight; with a budget, take only as many pages as could still
+    // be saved if every outstanding one succeeds (with --procs, counting
+    // the pages every process saved, but only this one's outstanding)
+    while (true) {
+        webpage_t* page;
+        procmesh_receive(mesh, 0, seqcrawl_add, &state.base);
+        int saved = (mesh != NULL) ? procmesh_pages(mesh) : state.docID - 1;
+        while (state.numWaiting < state.maxInFlight
+               && (opts->maxPages == 0 || saved + state.numWaiting
+                   + fetcher_active(fetcher) < opts->maxPages)
+               && (mesh == NULL || !procmesh_done(mesh))
+               && (page = frontier_pop(state.base.pagesToCrawl)) != NULL) {
+            metrics_dequeued(webpage_getDepth(page));
+            asyncpage_t* ap = malloc(sizeof(asyncpage_t));
+            if (ap == NULL) {
+                fprintf(stderr, "Error: could not allocate crawler state\n");
+                exit(2);
+            }
+            ap->page = page;
+            ap->known = recrawl_recall(state.store.meta, state.oldPages, page);
+            ap->attempt = 0;
+            ap->state = &state;
+            pagescan_begin(&ap->scan, page, maxDepth, state.base.linkMemo, &state.base,
+                           seqcrawl_add, seqcrawl_dup);
+            asyncTrack(&state, ap);
+            asyncSchedule(&state, ap);
+        }
+        long timeout = asyncSubmitReady(&state, fetcher);
+        if (fetcher_active(fetcher) == 0 && state.numWaiting == 0) {
+            // with --procs, another process may yet send pages
+            if (mesh == NULL || procmesh_done(mesh)) {
+                break;
+            }
+            procmesh_receive(mesh, CRAWL_MESH_WAIT, seqcrawl_add, &state.base);
+            continue;
+        }
+        if (mesh != NULL && (timeout < 0 || timeout > CRAWL_MESH_WAIT)) {
+            timeout = CRAWL_MESH_WAIT;      // look for pages sent meanwhile
+        }
+        fetcher_poll(fetcher, (int)timeout);
+        if (state.checkpointDue) {
+            asyncCheckpoint(&state);
+            state.checkpointDue = false;
+        }
+    }
+    if (state.checkpointEvery > 0) {
+        asyncCheckpoint(&state);
+    }
+
+    // clean up
+    fetcher_delete(fetcher);
+    free(state.waiting);
+    seenset_delete(state.base.pagesSeen);
+    linkmemo_delete(state.base.linkMemo);
+    frontier_delete(state.base.pagesToCrawl, webpage_delete);
+    simindex_delete(state.nearDups);
+    pagepack_close(state.oldPages);
+    pagestore_close(&state.store, opts);
+}
+
+/**************** asyncSchedule ****************/
+/* Reserve the next politeness slot for ap's host and put ap on the
+ * waiting list until it comes.
+ */
+static void
+asyncSchedule(asynccrawl_t* state, asyncpage_t* ap)
+{
+    long delay = politeness_reserve(state->polite, webpage_getURL(ap->page));
+    ap->readyAt = politeness_now() + delay;
+    state->waiting[state->numWaiting++] = ap;
+}
+
+/**************** asyncSubmitReady ****************/
+/* Submit every waiting page whose slot has come, as far as the fetcher
+ * has room. Return how long fetcher_poll may sleep: until the next slot
+ * comes, or -1 (until network activity) if nothing else is scheduled.
+ */
+static long
+asyncSubmitReady(asynccrawl_t* state, fetcher_t* fetcher)
+{
+    long now = politeness_now();
+    long timeout = -1;
+    for (int i = 0; i < state->numWaiting; ) {
+        asyncpage_t* ap = state->waiting[i];
+        if (ap->readyAt <= now) {
+            linkscan_reset(ap->scan.links);     // a retry starts the page over
+            if (fetcher_capacity(fetcher) > 0
+                && fetcher_submitStream(fetcher, ap->page, pagescan_chunk, &ap->scan,
+                                        pageFetched, ap)) {
+                // remove it, filling the hole with the last entry
+                state->waiting[i] = state->waiting[--state->numWaiting];
+                continue;
+            }
+            // ready, but the fetcher is full: a completion will wake us
+        } else if (timeout < 0 || ap->readyAt - now < timeout) {
+            timeout = ap->readyAt - now;
+        }
+        i++;
+    }
+    return timeout;
+}
+
+/**************** pageFetched ****************/
+/* Fetcher completion callback for asynccrawl_run: arg is the asyncpage_t*.
+ * Save the page if it was fetched (its links are in the frontier
+ * already), or keep its old copy if --recrawl found it unchanged, then
+ * delete it; after a transient failure, back off and schedule a retry
+ * instead.
+ */
+static void
+pageFetched(void* arg, webpage_t* page, const bool fetched)
+{
+    asyncpage_t* ap = arg;
+    asynccrawl_t* state = ap->state;
+
+    metrics_fetch(page, fetched);
+    if (fetched && ap->known != 0) {
+        // changed since it was saved: replace that copy
+        printf("Fetched: %s\n", webpage_getURL(page));
+        pagestore_save(&state->store, page, ap->known);
+    } else if (fetched) {
+        printf("Fetched: %s\n", webpage_getURL(page));
+        uint64_t fp = (state->nearDups != NULL) ? simhash_page(page) : 0;
+        bool saved = pagestore_findNearDup(state->nearDups, page, fp, &state->store) == 0;
+        int docID = saved ? seqcrawl_newDocID(state->base.mesh, &state->docID) : 0;
+        if (docID != 0) {
+            pagestore_save(&state->store, page, docID);
+            simindex_add(state->nearDups, fp, docID);
+        }
+        if (saved && state->checkpointEvery > 0
+            && (state->docID - 1) % state->checkpointEvery == 0) {
+            state->checkpointDue = true;
+        }
+    } else if (webpage_getStatus(page) == 304) {
+        if (!recrawl_keep(state->oldPages, ap->known, page, &ap->scan)) {
+            // the saved copy is gone: fetch the page in full after all
+            webpage_setValidators(page, NULL, NULL);
+            asyncSchedule(state, ap);
+            return;
+        }
+    } else if (pagescan_isTransient(page)) {
+        politeness_backoff(state->polite, webpage_getURL(page), ap->attempt);
+        if (++ap->attempt < PAGESCAN_MAX_TRY) {
+            asyncSchedule(state, ap);
+            return;
+        }
+        fprintf(stderr, "Warning: failed to fetch %s\n", webpage_getURL(page));
+    } else {
+        fprintf(stderr, "Warning: failed to fetch %s\n", webpage_getURL(page));
+    }
+
+    asyncUntrack(state, ap);
+    pagescan_end(&ap->scan);
+    webpage_delete(page);
+    free(ap);
+    procmesh_release(state->base.mesh);
+}
+
+/**************** asyncTrack ****************/
+/* Add ap to the crawl's list of live pages. */
+static void
+asyncTrack(asynccrawl_t* state, asyncpage_t* ap)
+{
+    ap->prev = NULL;
+    ap->next = state->live;
+    if (state->live != NULL) {
+        state->live->prev = ap;
+    }
+    state->live = ap;
+}
+
+/**************** asyncUntrack ****************/
+/* Remove ap from the crawl's list of live pages. */
+static void
+asyncUntrack(asynccrawl_t* state, asyncpage_t* ap)
+{
+    if (ap->prev != NULL) {
+        ap->prev->next = ap->next;
+    } else {
+        state->live = ap->next;
+    }
+    if (ap->next != NULL) {
+        ap->next->prev = ap->prev;
+    }
+}
+
+/**************** asyncCheckpoint ****************/
+/* Take a checkpoint of an event-driven crawl: pages waiting for a slot or
+ * in flight are still to be fetched, as far as a resumed crawl is concerned.
+ */
+static void
+asyncCheckpoint(asynccrawl_t* state)
+{
+    checkpoint_t* cp = pagestore_checkpointBegin(&state->store, state->docID,
+                                                 state->base.pagesSeen);
+    frontier_iterate(state->base.pagesToCrawl, cp, pagestore_checkpointPage);
+    for (asyncpage_t* ap = state->live; ap != NULL; ap = ap->next) {
+        pagestore_checkpointPage(cp, ap->page);
+    }
+    pagestore_checkpointEnd(cp, &state->store);
+}
@@ -0,0 +1,36 @@
+/*
+ * asynccrawl.h - header file for the crawler's event-driven (-a) crawl
+ *
+ * With -a, one thread keeps many requests in flight at once through the
+ * event-driven fetcher (see ../libcs50/fetcher.h), and handles each page
+ * as it completes.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#ifndef __ASYNCCRAWL_H
+#define __ASYNCCRAWL_H
+
+#include "crawlopts.h"
+#include "politeness.h"
+
+/**************** functions ****************/
+
+/**************** asynccrawl_run ****************/
+/* Crawl with the event-driven fetcher, keeping up to opts->maxInFlight
+ * requests in flight from this one thread. The frontier and pagesSeen
+ * work as in seqcrawl_run(). Each page taken from the frontier first gets
+ * a slot from the politeness scheduler and waits until that slot comes.
+ * The fetcher feeds each page to its link scan as it arrives, so its
+ * links reach the frontier before it is complete; each page is saved as
+ * it completes, or a retry is scheduled. The loop sleeps in fetcher_poll
+ * until the next network event or the next slot, whichever is sooner.
+ * Checkpoints are taken between polls, when no callback is halfway
+ * through a page; pages waiting or in flight go into them along with the
+ * frontier.
+ */
+void asynccrawl_run(char* seedURL, char* pageDirectory, const int maxDepth,
+                    const crawlopts_t* opts, politeness_t* polite,
+                    const crawlpart_t* part);
+
+#endif // __ASYNCCRAWL_H
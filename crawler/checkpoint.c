@@ -0,0 +1,307 @@
+/*
+ * checkpoint.c - crash-consistent crawl checkpoints
+ *
+ * see checkpoint.h for more information.
+ *
+ * Writing follows the usual recipe for replacing a file atomically:
+ * write a temporary file in the same directory, force it to disk, rename
+ * it over the real name (atomic within a directory), and fsync the
+ * directory so the rename itself survives a power loss. The log of
+ * fingerprints is forced to disk first, since the new checkpoint counts
+ * on them. Each is synced with fdatasync on its own file, so a
+ * checkpoint waits for nothing else the kernel has to write.
+ *
+ * Every line of the log is the same length, so the number of
+ * fingerprints in it is its size over LOG_LINE, and trimming it to a
+ * checkpoint's count is a truncate.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#define _GNU_SOURCE       // getline, fileno, fdatasync
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "../common/pagedir.h"
+#include "checkpoint.h"
+
+/**************** file-local global variables ****************/
+static const char* CHECKPOINT = ".checkpoint";
+static const char* CHECKPOINT_TMP = ".checkpoint.tmp";
+static const char* CHECKPOINT_LOG = ".checkpoint.seen";
+static const char* MAGIC = "tse-checkpoint 3";
+static const long LOG_LINE = 17;          // 16 hex digits and a newline
+
+/**************** global types ****************/
+typedef struct checkpoint {
+    FILE* fp;                 // the temporary file, while writing one
+    FILE* log;                // the log of fingerprints, for appending
+    long numSeen;             // fingerprints in the log
+    bool logFailed;           // a write to the log failed; counts are off
+    char* path;               // pageDirectory/.checkpoint
+    char* tmpPath;            // pageDirectory/.checkpoint.tmp
+    char* dir;                // pageDirectory
+} checkpoint_t;
+
+/**************** local functions ****************/
+static bool syncFile(FILE* fp);
+static bool loadSeen(const char* pageDirectory, const long count, void* arg,
+                     void (*seen)(void* arg, const uint64_t fp));
+
+/**************** checkpoint_new() ****************/
+/* see checkpoint.h for description */
+checkpoint_t*
+checkpoint_new(const char* pageDirectory)
+{
+    if (pageDirectory == NULL) {
+        return NULL;
+    }
+
+    checkpoint_t* cp = calloc(1, sizeof(checkpoint_t));
+    if (cp == NULL) {
+        return NULL;
+    }
+    cp->path = pagedir_path(pageDirectory, CHECKPOINT);
+    cp->tmpPath = pagedir_path(pageDirectory, CHECKPOINT_TMP);
+    cp->dir = pagedir_path(pageDirectory, "");
+    char* logPath = pagedir_path(pageDirectory, CHECKPOINT_LOG);
+    if (logPath != NULL) {
+        cp->log = fopen(logPath, "a");
+        free(logPath);
+    }
+    struct stat st;
+    if (cp->path == NULL || cp->tmpPath == NULL || cp->dir == NULL || cp->log == NULL
+        || fstat(fileno(cp->log), &st) != 0) {
+        checkpoint_delete(cp);
+        return NULL;
+    }
+    cp->numSeen = st.st_size / LOG_LINE;
+    return cp;
+}
+
+/**************** checkpoint_begin() ****************/
+/* see checkpoint.h for description */
+bool
+checkpoint_begin(checkpoint_t* cp, const int nextDocID)
+{
+    if (cp == NULL) {
+        return false;
+    }
+    if (cp->fp != NULL) {
+        fclose(cp->fp);           // one begun and never committed
+    }
+    if ((cp->fp = fopen(cp->tmpPath, "w")) == NULL) {
+        return false;
+    }
+    fprintf(cp->fp, "%s\nnext %d\n", MAGIC, nextDocID);
+    return true;
+}
+
+/**************** checkpoint_seen() ****************/
+/* see checkpoint.h for description */
+void
+checkpoint_seen(checkpoint_t* cp, const uint64_t fp)
+{
+    if (cp != NULL) {
+        // logged even if the checkpoint could not begin, for the next one
+        if (fprintf(cp->log, "%016" PRIx64 "\n", fp) != LOG_LINE) {
+            cp->logFailed = true;
+        }
+        cp->numSeen++;
+    }
+}
+
+/**************** checkpoint_page() ****************/
+/* see checkpoint.h for description */
+void
+checkpoint_page(checkpoint_t* cp, const char* url, const int depth)
+{
+    if (cp != NULL && cp->fp != NULL && url != NULL) {
+        fprintf(cp->fp, "F %d %s\n", depth, url);
+    }
+}
+
+/**************** checkpoint_commit() ****************/
+/* see checkpoint.h for description */
+bool
+checkpoint_commit(checkpoint_t* cp)
+{
+    if (cp == NULL || cp->fp == NULL) {
+        return false;
+    }
+
+    // the fingerprints first, since the checkpoint counts them
+    bool ok = syncFile(cp->log) && !cp->logFailed;
+    fprintf(cp->fp, "seen %ld\nend\n", cp->numSeen);
+    ok = syncFile(cp->fp) && ok;
+    ok = (fclose(cp->fp) == 0) && ok;
+    cp->fp = NULL;
+    if (ok) {
+        ok = (rename(cp->tmpPath, cp->path) == 0);
+    }
+
+    if (ok) {
+        // make the rename durable too, and the log's entry if it is new
+        int dirfd = open(cp->dir, O_RDONLY);
+        if (dirfd >= 0) {
+            fsync(dirfd);
+            close(dirfd);
+        }
+    } else {
+        unlink(cp->tmpPath);
+    }
+    return ok;
+}
+
+/**************** checkpoint_delete() ****************/
+/* see checkpoint.h for description */
+void
+checkpoint_delete(checkpoint_t* cp)
+{
+    if (cp != NULL) {
+        if (cp->fp != NULL) {
+            fclose(cp->fp);
+            unlink(cp->tmpPath);
+        }
+        if (cp->log != NULL) {
+            fclose(cp->log);
+        }
+        free(cp->path);
+        free(cp->tmpPath);
+        free(cp->dir);
+        free(cp);
+    }
+}
+
+/**************** checkpoint_load() ****************/
+/* see checkpoint.h for description */
+bool
+checkpoint_load(const char* pageDirectory, int* nextDocID, void* arg,
+                void (*seen)(void* arg, const uint64_t fp),
+                void (*page)(void* arg, const char* url, const int depth))
+{
+    if (pageDirectory == NULL || nextDocID == NULL) {
+        return false;
+    }
+    char* path = pagedir_path(pageDirectory, CHECKPOINT);
+    if (path == NULL) {
+        return false;
+    }
+    FILE* fp = fopen(path, "r");
+    free(path);
+    if (fp == NULL) {
+        return false;
+    }
+
+    char* line = NULL;
+    size_t size = 0;
+    ssize_t len;
+    int lineNum = 0;
+    long count = -1;
+    bool complete = false;
+    bool ok = true;
+    while (ok && !complete && (len = getline(&line, &size, fp)) > 0) {
+        if (line[len - 1] == '\n') {
+            line[--len] = '\0';
+        }
+        lineNum++;
+
+        int depth, offset;
+        if (lineNum == 1) {
+            ok = (strcmp(line, MAGIC) == 0);
+        } else if (lineNum == 2) {
+            ok = (sscanf(line, "next %d", nextDocID) == 1 && *nextDocID >= 1);
+        } else if (sscanf(line, "F %d %n", &depth, &offset) == 1 && line[offset] != '\0') {
+            if (page != NULL) {
+                (*page)(arg, line + offset, depth);
+            }
+        } else if (count < 0 && sscanf(line, "seen %ld", &count) == 1) {
+            ok = (count >= 0);
+        } else if (count >= 0 && strcmp(line, "end") == 0) {
+            complete = true;
+        } else {
+            ok = false;
+        }
+    }
+
+    free(line);
+    fclose(fp);
+    return ok && complete && loadSeen(pageDirectory, count, arg, seen);
+}
+
+/**************** checkpoint_exists() ****************/
+/* see checkpoint.h for description */
+bool
+checkpoint_exists(const char* pageDirectory)
+{
+    char* path = pagedir_path(pageDirectory, CHECKPOINT);
+    if (path == NULL) {
+        return false;
+    }
+    bool exists = (access(path, F_OK) == 0);
+    free(path);
+    return exists;
+}
+
+/**************** checkpoint_remove() ****************/
+/* see checkpoint.h for description */
+void
+checkpoint_remove(const char* pageDirectory)
+{
+    const char* names[] = { CHECKPOINT, CHECKPOINT_TMP, CHECKPOINT_LOG };
+    for (int i = 0; i < 3; i++) {
+        char* path = pagedir_path(pageDirectory, names[i]);
+        if (path != NULL) {
+            unlink(path);
+            free(path);
+        }
+    }
+}
+
+/**************** loadSeen ****************/
+/* Hand the first count fingerprints of pageDirectory's log to
+ * seen(arg, fp), and cut the log off after them. Returns false if the
+ * log is missing, short, or malformed.
+ */
+static bool
+loadSeen(const char* pageDirectory, const long count, void* arg,
+         void (*seen)(void* arg, const uint64_t fp))
+{
+    char* path = pagedir_path(pageDirectory, CHECKPOINT_LOG);
+    if (path == NULL) {
+        return false;
+    }
+    FILE* fp = fopen(path, "r");
+    bool ok = (fp != NULL);
+    char line[32];
+    for (long i = 0; ok && i < count; i++) {
+        uint64_t fingerprint;
+        int end = 0;
+        ok = (fgets(line, sizeof(line), fp) != NULL
+              && sscanf(line, "%16" SCNx64 "%n", &fingerprint, &end) == 1
+              && end == LOG_LINE - 1 && line[end] == '\n');
+        if (ok && seen != NULL) {
+            (*seen)(arg, fingerprint);
+        }
+    }
+    if (fp != NULL) {
+        fclose(fp);
+    }
+    ok = ok && truncate(path, count * LOG_LINE) == 0;
+    free(path);
+    return ok;
+}
+
+/**************** syncFile ****************/
+/* Flush fp's buffer and put its data on disk; true if both worked. */
+static bool
+syncFile(FILE* fp)
+{
+    return fflush(fp) == 0 && !ferror(fp) && fdatasync(fileno(fp)) == 0;
+}
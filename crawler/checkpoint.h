@@ -0,0 +1,111 @@
+/*
+ * checkpoint.h - header file for the crawler's checkpoint module
+ *
+ * A *checkpoint* records enough of a crawl's state to continue it after a
+ * crash: the next docID to hand out, every URL seen so far (by its
+ * seenset fingerprint), and the pages still waiting to be fetched (with
+ * their depths). It lives in two files in the pageDirectory. The
+ * fingerprints go in `.checkpoint.seen`, a log that each checkpoint only
+ * appends to, one per line in hex:
+ *
+ *   <fingerprint>        16 hex digits
+ *
+ * and the rest in `.checkpoint`, in this line-oriented text format:
+ *
+ *   tse-checkpoint 3
+ *   next <docID>
+ *   F <depth> <url>      one per page waiting to be fetched
+ *   seen <count>         how many fingerprints of the log are its own
+ *   end
+ *
+ * So a checkpoint writes the URLs seen since the last one, and the pages
+ * waiting now, rather than everything seen since the crawl began.
+ *
+ * A new checkpoint appends to the log, and writes `.checkpoint.tmp`;
+ * both are forced to disk, and the temporary file is renamed over the
+ * old checkpoint, so after a crash the file is always either the
+ * complete old checkpoint or the complete new one. Fingerprints past the
+ * count it names were appended by a checkpoint that never finished, and
+ * loading it drops them. The pages it counts are saved by then, but they
+ * are on disk only as the page writer's sync policy says (see
+ * pagewriter.h).
+ *
+ * CS50 FA25 Final Project
+ */
+
+#ifndef __CHECKPOINT_H
+#define __CHECKPOINT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**************** global types ****************/
+typedef struct checkpoint checkpoint_t;  // opaque to users of the module
+
+/**************** functions ****************/
+
+/**************** checkpoint_new ****************/
+/* Open pageDirectory's checkpoints for a crawl, which has just loaded
+ * the last one (checkpoint_load) or removed it (checkpoint_remove).
+ *
+ * We return:
+ *   pointer to a new checkpoint_t, or NULL on error.
+ * Caller is responsible for:
+ *   later calling checkpoint_delete.
+ */
+checkpoint_t* checkpoint_new(const char* pageDirectory);
+
+/**************** checkpoint_begin ****************/
+/* Begin writing a new checkpoint, with the next docID the crawl would
+ * hand out. The caller then adds every URL seen since the last
+ * checkpoint and every waiting page, and calls checkpoint_commit. We
+ * return false on error; the commit then fails too.
+ */
+bool checkpoint_begin(checkpoint_t* cp, const int nextDocID);
+
+/**************** checkpoint_seen ****************/
+/* Record that the URL with fingerprint fp has been seen. */
+void checkpoint_seen(checkpoint_t* cp, const uint64_t fp);
+
+/**************** checkpoint_page ****************/
+/* Record that url, found at depth, is waiting to be fetched. */
+void checkpoint_page(checkpoint_t* cp, const char* url, const int depth);
+
+/**************** checkpoint_commit ****************/
+/* Finish the checkpoint, force it to disk (fdatasync), and atomically
+ * replace the previous one. We return true on success; on failure the
+ * previous checkpoint (if any) is left as it was.
+ */
+bool checkpoint_commit(checkpoint_t* cp);
+
+/**************** checkpoint_delete ****************/
+/* Close the checkpoint files; NULL is ignored. */
+void checkpoint_delete(checkpoint_t* cp);
+
+/**************** checkpoint_load ****************/
+/* Read the checkpoint in pageDirectory.
+ *
+ * Caller provides:
+ *   pageDirectory; seen, called as seen(arg, fp) with the fingerprint of
+ *   each seen URL; page, called as page(arg, url, depth) for each waiting
+ *   page. The url strings belong to us; callbacks must copy what they keep.
+ * We return:
+ *   true, with *nextDocID filled in, if a complete checkpoint was read;
+ *   false if there is none, or it is malformed (callbacks may have been
+ *   called for part of it).
+ * We also:
+ *   drop any fingerprints logged after the checkpoint's own.
+ */
+bool checkpoint_load(const char* pageDirectory, int* nextDocID, void* arg,
+                     void (*seen)(void* arg, const uint64_t fp),
+                     void (*page)(void* arg, const char* url, const int depth));
+
+/**************** checkpoint_exists ****************/
+/* Return true iff pageDirectory holds a checkpoint file. */
+bool checkpoint_exists(const char* pageDirectory);
+
+/**************** checkpoint_remove ****************/
+/* Delete the checkpoint in pageDirectory, and its log, if any. */
+void checkpoint_remove(const char* pageDirectory);
+
+#endif // __CHECKPOINT_H
@@ -0,0 +1,229 @@
+/*
+ * checkpointtest.c - unit test for the checkpoint module
+ *
+ * Writes checkpoints in a new directory under /tmp and checks that each
+ * loads back with its next docID, its waiting pages, and every
+ * fingerprint logged up to it; that one begun and never committed (as
+ * when the crawler dies partway) leaves the last one in force, and
+ * loading it cuts the log back to that one's fingerprints; and that a
+ * torn or malformed checkpoint file is refused. The directory is removed
+ * at the end.
+ *
+ * usage: checkpointtest
+ * Prints a line for each failed check, then a count; exits non-zero if
+ * any check failed.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#define _DEFAULT_SOURCE          // mkdtemp
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "../common/pagedir.h"
+#include "checkpoint.h"
+
+/**************** file-local global variables ****************/
+static int checks = 0;
+static int failures = 0;
+#define MAX_SEEN 16
+
+/**************** local types ****************/
+typedef struct loaded {
+    int nextDocID;
+    uint64_t seen[MAX_SEEN];
+    int numSeen;
+    int numPages;
+    char lastURL[64];         // the last waiting page, and its depth
+    int lastDepth;
+} loaded_t;
+
+/**************** local functions ****************/
+static void check(const bool ok, const char* what);
+static bool load(const char* dir, loaded_t* got);
+static void seenOne(void* arg, const uint64_t fp);
+static void pageOne(void* arg, const char* url, const int depth);
+static bool seenInOrder(const loaded_t* got, const int count);
+static bool writeFile(const char* dir, const char* name, const char* text);
+static long fileSize(const char* dir, const char* name);
+
+/**************** main ****************/
+int main(void)
+{
+    char dir[] = "/tmp/checkpointtestXXXXXX";
+    if (mkdtemp(dir) == NULL) {
+        fprintf(stderr, "checkpointtest: could not make a directory in /tmp\n");
+        return 2;
+    }
+    loaded_t got;
+
+    check(!checkpoint_exists(dir) && !load(dir, &got), "no checkpoint yet");
+
+    // a first checkpoint: 3 fingerprints and 2 pages waiting
+    checkpoint_t* cp = checkpoint_new(dir);
+    check(cp != NULL, "new");
+    check(checkpoint_begin(cp, 5), "begin");
+    for (uint64_t fp = 1; fp <= 3; fp++) {
+        checkpoint_seen(cp, fp);
+    }
+    checkpoint_page(cp, "http://cs50tse.cs.dartmouth.edu/a.html", 0);
+    checkpoint_page(cp, "http://cs50tse.cs.dartmouth.edu/b.html", 2);
+    check(checkpoint_commit(cp), "commit");
+    check(checkpoint_exists(dir), "exists");
+    check(load(dir, &got) && got.nextDocID == 5 && seenInOrder(&got, 3)
+          && got.numPages == 2 && got.lastDepth == 2
+          && strcmp(got.lastURL, "http://cs50tse.cs.dartmouth.edu/b.html") == 0,
+          "first checkpoint loads");
+
+    // a second appends 2 more fingerprints, and replaces the pages
+    check(checkpoint_begin(cp, 8), "begin again");
+    checkpoint_seen(cp, 4);
+    checkpoint_seen(cp, 5);
+    checkpoint_page(cp, "http://cs50tse.cs.dartmouth.edu/c.html", 1);
+    check(checkpoint_commit(cp), "commit again");
+    check(load(dir, &got) && got.nextDocID == 8 && seenInOrder(&got, 5)
+          && got.numPages == 1 && got.lastDepth == 1,
+          "second checkpoint loads");
+    check(fileSize(dir, ".checkpoint.seen") == 5 * 17, "log holds 5 fingerprints");
+
+    // a third never committed: the second still holds, and loading it
+    // drops the third's fingerprints from the log
+    check(checkpoint_begin(cp, 9), "begin a third");
+    checkpoint_seen(cp, 6);
+    checkpoint_seen(cp, 7);
+    checkpoint_page(cp, "http://cs50tse.cs.dartmouth.edu/d.html", 3);
+    checkpoint_delete(cp);
+    check(fileSize(dir, ".checkpoint.tmp") < 0, "uncommitted file removed");
+    check(fileSize(dir, ".checkpoint.seen") == 7 * 17, "log holds 7 fingerprints");
+    check(load(dir, &got) && got.nextDocID == 8 && seenInOrder(&got, 5),
+          "uncommitted checkpoint ignored");
+    check(fileSize(dir, ".checkpoint.seen") == 5 * 17, "log cut back on load");
+
+    // a crawl resumed from it counts on from 5, and so does its next one
+    cp = checkpoint_new(dir);
+    check(cp != NULL && checkpoint_begin(cp, 12), "begin after resume");
+    checkpoint_seen(cp, 6);
+    check(checkpoint_commit(cp), "commit after resume");
+    checkpoint_delete(cp);
+    check(load(dir, &got) && got.nextDocID == 12 && seenInOrder(&got, 6)
+          && got.numPages == 0, "checkpoint after resume loads");
+
+    // a stray temporary file from a crash is not read
+    writeFile(dir, ".checkpoint.tmp", "tse-checkpoint 3\nnext 99\n");
+    check(load(dir, &got) && got.nextDocID == 12, "temporary file ignored");
+
+    // torn and malformed checkpoints are refused
+    writeFile(dir, ".checkpoint", "tse-checkpoint 3\nnext 12\nseen 6\n");
+    check(!load(dir, &got), "no end line");
+    writeFile(dir, ".checkpoint", "tse-checkpoint 2\nnext 12\nseen 6\nend\n");
+    check(!load(dir, &got), "old version");
+    writeFile(dir, ".checkpoint", "tse-checkpoint 3\nnext 0\nseen 6\nend\n");
+    check(!load(dir, &got), "next docID 0");
+    writeFile(dir, ".checkpoint", "tse-checkpoint 3\nnext 12\nF x url\nseen 6\nend\n");
+    check(!load(dir, &got), "bad page line");
+    writeFile(dir, ".checkpoint", "tse-checkpoint 3\nnext 12\nseen 7\nend\n");
+    check(!load(dir, &got), "more fingerprints than the log holds");
+    writeFile(dir, ".checkpoint.seen", "0000000000000001\n00000000000002\n");
+    writeFile(dir, ".checkpoint", "tse-checkpoint 3\nnext 12\nseen 2\nend\n");
+    check(!load(dir, &got), "short log line");
+
+    checkpoint_remove(dir);
+    check(!checkpoint_exists(dir) && fileSize(dir, ".checkpoint.seen") < 0
+          && fileSize(dir, ".checkpoint.tmp") < 0, "remove");
+
+    rmdir(dir);
+    printf("checkpointtest: %d checks, %d failed\n", checks, failures);
+    return failures == 0 ? 0 : 1;
+}
+
+/**************** check ****************/
+/* Count one check, and report it if it failed. */
+static void
+check(const bool ok, const char* what)
+{
+    checks++;
+    if (!ok) {
+        failures++;
+        printf("FAIL: %s\n", what);
+    }
+}
+
+/**************** load ****************/
+/* Load the checkpoint in dir into *got; return what checkpoint_load does. */
+static bool
+load(const char* dir, loaded_t* got)
+{
+    memset(got, 0, sizeof(loaded_t));
+    return checkpoint_load(dir, &got->nextDocID, got, seenOne, pageOne);
+}
+
+/**************** seenOne ****************/
+/* checkpoint_load's seen callback: keep the fingerprint. */
+static void
+seenOne(void* arg, const uint64_t fp)
+{
+    loaded_t* got = arg;
+    if (got->numSeen < MAX_SEEN) {
+        got->seen[got->numSeen] = fp;
+    }
+    got->numSeen++;
+}
+
+/**************** pageOne ****************/
+/* checkpoint_load's page callback: count the page, and keep the last. */
+static void
+pageOne(void* arg, const char* url, const int depth)
+{
+    loaded_t* got = arg;
+    got->numPages++;
+    snprintf(got->lastURL, sizeof(got->lastURL), "%s", url);
+    got->lastDepth = depth;
+}
+
+/**************** seenInOrder ****************/
+/* Return true if got holds exactly the fingerprints 1..count, in order. */
+static bool
+seenInOrder(const loaded_t* got, const int count)
+{
+    if (got->numSeen != count) {
+        return false;
+    }
+    for (int i = 0; i < count; i++) {
+        if (got->seen[i] != (uint64_t)(i + 1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**************** writeFile ****************/
+/* Replace dir/name with text; return false on error. */
+static bool
+writeFile(const char* dir, const char* name, const char* text)
+{
+    char* path = pagedir_path(dir, name);
+    FILE* fp = (path != NULL) ? fopen(path, "w") : NULL;
+    free(path);
+    if (fp == NULL) {
+        return false;
+    }
+    fputs(text, fp);
+    return fclose(fp) == 0;
+}
+
+/**************** fileSize ****************/
+/* Return the size of dir/name, or -1 if there is no such file. */
+static long
+fileSize(const char* dir, const char* name)
+{
+    char* path = pagedir_path(dir, name);
+    struct stat st;
+    long size = (path != NULL && stat(path, &st) == 0) ? (long)st.st_size : -1;
+    free(path);
+    return size;
+}
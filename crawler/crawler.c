@@ -2,16 +2,32 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <string.h>
+#include <getopt.h>
 
 #include "../libcs50/webpage.h"
-#include "../libcs50/hashtable.h"
-#include "../libcs50/bag.h"
+#include "../libcs50/connpool.h"
 #include "../common/pagedir.h"
+#include "crawlopts.h"
+#include "seqcrawl.h"
+#include "parcrawl.h"
+#include "asynccrawl.h"
+#include "meshcrawl.h"
+#include "crawlstats.h"
+#include "politeness.h"
+#include "frontier.h"
+#include "simhash.h"
+#include "metrics.h"
+#include "pagewriter.h"
+
+/**************** file-local global variables ****************/
+static const int MAX_PROCS = 64;         // upper bound for --procs
+static const int MAX_IN_FLIGHT = 1000;   // upper bound for -a
 
 /**************** function prototypes ****************/
-static void parseArgs(const int argc, char* argv[], char** seedURL, char** pageDirectory, int* maxDepth);
-static void crawl(char* seedURL, char* pageDirectory, const int maxDepth);
-static void pageScan(webpage_t* page, bag_t* pagesToCrawl, hashtable_t* pagesSeen);
+static void parseArgs(const int argc, char* argv[], char** seedURL, char** pageDirectory,
+                      int* maxDepth, crawlopts_t* opts);
+static int parseInt(const char* name, const char* str, const int min, const int max);
+static double parseRate(const char* str);
 
 /**************** main ****************/
 int main(const int argc, char* argv[])
@@ -19,35 +35,296 @@ int main(const int argc, char* argv[])
     char* seedURL = NULL;
     char* pageDirectory = NULL;
     int maxDepth = 0;
+    crawlopts_t opts = {
+        .numThreads = 1,
+        .numProcs = 1,
+        .maxInFlight = 0,
+        .connectTimeout = 5000,
+        .readTimeout = 30000,
+        .rate = 1.0,
+        .burst = 1,
+        .priority = FRONTIER_DEPTH,
+        .maxPages = 0,
+        .checkpointEvery = 100,
+        .resume = false,
+        .expectedURLs = 10000,
+        .nearDup = -1,
+        .codec = PAGEDIR_PLAIN,
+        .pack = false,
+        .fsync = PAGEWRITER_NONE,
+        .io = PAGEDIR_IO_SYNC,
+        .recrawl = false,
+        .indexFile = NULL,
+        .keepPages = true,
+        .metricsFile = NULL,
+        .metricsEvery = 1000,
+    };
 
     // will exit non-zero on error
-    parseArgs(argc, argv, &seedURL, &pageDirectory, &maxDepth);
+    parseArgs(argc, argv, &seedURL, &pageDirectory, &maxDepth, &opts);
 
-    crawl(seedURL, pageDirectory, maxDepth);
+    politeness_t* polite = politeness_new(opts.rate, opts.burst);
+    if (polite == NULL) {
+        fprintf(stderr, "Error: could not allocate politeness scheduler\n");
+        exit(2);
+    }
+    if (opts.metricsFile != NULL) {
+        // each run starts the file afresh; snapshots are appended to it
+        FILE* fp = fopen(opts.metricsFile, "w");
+        if (fp == NULL) {
+            fprintf(stderr, "Error: could not start writing metrics to '%s'\n",
+                    opts.metricsFile);
+            exit(2);
+        }
+        fclose(fp);
+    }
 
-    // seedURL is owned by the webpage_t created in crawl and is freed there
+    if (opts.numProcs > 1) {
+        // each process keeps its own politeness and reports its own stats
+        meshcrawl_run(seedURL, pageDirectory, maxDepth, &opts);
+        politeness_delete(polite);
+        return 0;
+    }
+    if (opts.metricsFile != NULL
+        && !metrics_start(opts.metricsFile, opts.metricsEvery, -1)) {
+        fprintf(stderr, "Error: could not start writing metrics to '%s'\n",
+                opts.metricsFile);
+        exit(2);
+    }
+    if (opts.maxInFlight > 0) {
+        asynccrawl_run(seedURL, pageDirectory, maxDepth, &opts, polite, NULL);
+    } else if (opts.numThreads > 1) {
+        parcrawl_run(seedURL, pageDirectory, maxDepth, &opts, polite);
+    } else {
+        seqcrawl_run(seedURL, pageDirectory, maxDepth, &opts, polite, NULL);
+    }
+    politeness_delete(polite);
+    connpool_closeAll();        // idle keep-alive connections
+    crawlstats_print();
+    metrics_stop();
+
+    // seedURL is owned by the webpage_t the crawl mode created and is freed there
+    // (or freed at once when resuming from a checkpoint)
     return 0;
 }
 
 /**************** parseArgs ****************/
-/* Given command-line arguments, extract seedURL, pageDirectory, maxDepth.
+/* Given command-line arguments, extract seedURL, pageDirectory, maxDepth,
+ * and any options into *opts (which holds the defaults on entry).
  * On any error, print a message to stderr and exit non-zero.
  * Only returns if arguments are valid.
  */
 static void
-parseArgs(const int argc, char* argv[], char** seedURL, char** pageDirectory, int* maxDepth)
+parseArgs(const int argc, char* argv[], char** seedURL, char** pageDirectory,
+          int* maxDepth, crawlopts_t* opts)
 {
+    enum { OPT_CONNECT_TIMEOUT = 256, OPT_READ_TIMEOUT, OPT_RATE, OPT_BURST,
+           OPT_PRIORITY, OPT_MAX_PAGES, OPT_CHECKPOINT, OPT_RESUME, OPT_EXPECTED_URLS,
+           OPT_NEAR_DUP, OPT_COMPRESS, OPT_PACK, OPT_RECRAWL, OPT_INTERNAL,
+           OPT_INDEX, OPT_NO_PAGES, OPT_PROCS, OPT_METRICS, OPT_METRICS_EVERY,
+           OPT_FSYNC, OPT_IO };
+    static const struct option longOptions[] = {
+        { "threads",         required_argument, NULL, 'j' },
+        { "async",           required_argument, NULL, 'a' },
+        { "connect-timeout", required_argument, NULL, OPT_CONNECT_TIMEOUT },
+        { "read-timeout",    required_argument, NULL, OPT_READ_TIMEOUT },
+        { "rate",            required_argument, NULL, OPT_RATE },
+        { "burst",           required_argument, NULL, OPT_BURST },
+        { "priority",        required_argument, NULL, OPT_PRIORITY },
+        { "max-pages",       required_argument, NULL, OPT_MAX_PAGES },
+        { "checkpoint",      required_argument, NULL, OPT_CHECKPOINT },
+        { "resume",          no_argument,       NULL, OPT_RESUME },
+        { "expected-urls",   required_argument, NULL, OPT_EXPECTED_URLS },
+        { "near-dup",        required_argument, NULL, OPT_NEAR_DUP },
+        { "compress",        required_argument, NULL, OPT_COMPRESS },
+        { "pack",            no_argument,       NULL, OPT_PACK },
+        { "fsync",           required_argument, NULL, OPT_FSYNC },
+        { "io",              required_argument, NULL, OPT_IO },
+        { "recrawl",         no_argument,       NULL, OPT_RECRAWL },
+        { "internal",        required_argument, NULL, OPT_INTERNAL },
+        { "index",           required_argument, NULL, OPT_INDEX },
+        { "no-pages",        no_argument,       NULL, OPT_NO_PAGES },
+        { "procs",           required_argument, NULL, OPT_PROCS },
+        { "metrics",         required_argument, NULL, OPT_METRICS },
+        { "metrics-every",   required_argument, NULL, OPT_METRICS_EVERY },
+        { NULL, 0, NULL, 0 }
+    };
+    const char* usage = "Usage: %s [-j threads | -a inflight] [--procs n] "
+        "[--connect-timeout ms] [--read-timeout ms] "
+        "[--rate perSecond] [--burst n] [--priority depth|inlinks|host] "
+        "[--max-pages n] [--checkpoint n] [--resume] [--expected-urls n] [--near-dup bits] "
+        "[--compress none|lz|zlib] [--pack] [--fsync none|batch|page] [--io sync|uring] "
+        "[--recrawl] "
+        "[--internal prefix] "
+        "[--index indexFilename [--no-pages]] [--metrics file [--metrics-every ms]] "
+        "seedURL pageDirectory maxDepth\n";
+
+    // options come first; '+' stops at the first positional argument,
+    // so a negative maxDepth like "-1" is not mistaken for an option
+    int opt;
+    while ((opt = getopt_long(argc, argv, "+j:a:", longOptions, NULL)) != -1) {
+        switch (opt) {
+        case 'j':
+            opts->numThreads = parseInt("threads", optarg, 1, CRAWL_MAX_THREADS);
+            break;
+        case 'a':
+            opts->maxInFlight = parseInt("inflight", optarg, 1, MAX_IN_FLIGHT);
+            break;
+        case OPT_CONNECT_TIMEOUT:
+            opts->connectTimeout = parseInt("connect-timeout", optarg, 1, 3600000);
+            break;
+        case OPT_READ_TIMEOUT:
+            opts->readTimeout = parseInt("read-timeout", optarg, 1, 3600000);
+            break;
+        case OPT_RATE:
+            opts->rate = parseRate(optarg);
+            break;
+        case OPT_BURST:
+            opts->burst = parseInt("burst", optarg, 1, 1000);
+            break;
+        case OPT_PRIORITY:
+            if (!frontier_policy(optarg, &opts->priority)) {
+                fprintf(stderr, "Error: priority '%s' is not depth, inlinks, or host\n",
+                        optarg);
+                exit(1);
+            }
+            break;
+        case OPT_MAX_PAGES:
+            opts->maxPages = parseInt("max-pages", optarg, 0, 100000000);
+            break;
+        case OPT_CHECKPOINT:
+            opts->checkpointEvery = parseInt("checkpoint", optarg, 0, 100000000);
+            break;
+        case OPT_RESUME:
+            opts->resume = true;
+            break;
+        case OPT_EXPECTED_URLS:
+            opts->expectedURLs = parseInt("expected-urls", optarg, 1, 100000000);
+            break;
+        case OPT_NEAR_DUP:
+            opts->nearDup = parseInt("near-dup", optarg, 0, SIMHASH_MAX_DISTANCE);
+            break;
+        case OPT_COMPRESS:
+            if (strcmp(optarg, "none") == 0) {
+                opts->codec = PAGEDIR_PLAIN;
+            } else if (strcmp(optarg, "lz") == 0) {
+                opts->codec = PAGEDIR_LZ;
+            } else if (strcmp(optarg, "zlib") == 0) {
+                opts->codec = PAGEDIR_ZLIB;
+            } else {
+                fprintf(stderr, "Error: compress '%s' is not none, lz, or zlib\n", optarg);
+                exit(1);
+            }
+            if (!pagedir_codecAvailable(opts->codec)) {
+                fprintf(stderr, "Error: this crawler was built without %s\n", optarg);
+                exit(1);
+            }
+            break;
+        case OPT_PACK:
+            opts->pack = true;
+            break;
+        case OPT_FSYNC:
+            if (!pagewriter_policy(optarg, &opts->fsync)) {
+                fprintf(stderr, "Error: fsync '%s' is not none, batch, or page\n", optarg);
+                exit(1);
+            }
+            break;
+        case OPT_IO:
+            if (strcmp(optarg, "sync") == 0) {
+                opts->io = PAGEDIR_IO_SYNC;
+            } else if (strcmp(optarg, "uring") == 0) {
+                opts->io = PAGEDIR_IO_URING;
+            } else {
+                fprintf(stderr, "Error: io '%s' is not sync or uring\n", optarg);
+                exit(1);
+            }
+            break;
+        case OPT_RECRAWL:
+            opts->recrawl = true;
+            break;
+        case OPT_INTERNAL:
+            // before the seed is checked, which the new prefix applies to
+            if (strncmp(optarg, "http://", 7) != 0 || optarg[7] == '\0') {
+                fprintf(stderr, "Error: internal prefix '%s' is not an http:// URL\n",
+                        optarg);
+                exit(1);
+            }
+            setInternalPrefix(optarg);
+            break;
+        case OPT_INDEX:
+            opts->indexFile = optarg;
+            break;
+        case OPT_NO_PAGES:
+            opts->keepPages = false;
+            break;
+        case OPT_PROCS:
+            opts->numProcs = parseInt("procs", optarg, 1, MAX_PROCS);
+            break;
+        case OPT_METRICS:
+            opts->metricsFile = optarg;
+            break;
+        case OPT_METRICS_EVERY:
+            opts->metricsEvery = parseInt("metrics-every", optarg, 1, 3600000);
+            break;
+        default:
+            fprintf(stderr, usage, argv[0]);
+            exit(1);
+        }
+    }
+    if (opts->numThreads > 1 && opts->maxInFlight > 0) {
+        fprintf(stderr, "Error: -j and -a cannot be used together\n");
+        exit(1);
+    }
+    if (opts->numThreads > 1 && opts->priority != FRONTIER_DEPTH) {
+        // the worker threads take pages from their deques, not a frontier
+        fprintf(stderr, "Error: -j cannot be used with --priority inlinks or host\n");
+        exit(1);
+    }
+    if (opts->recrawl && opts->maxPages > 0) {
+        // the budget counts docIDs, and a recrawl starts past the old ones
+        fprintf(stderr, "Error: --recrawl and --max-pages cannot be used together\n");
+        exit(1);
+    }
+    if (opts->recrawl && opts->indexFile != NULL) {
+        // unchanged pages are not saved again, so would not be indexed
+        fprintf(stderr, "Error: --recrawl and --index cannot be used together\n");
+        exit(1);
+    }
+    if (!opts->keepPages) {
+        // a resumed crawl reads back the pages saved before its checkpoint
+        if (opts->indexFile == NULL || opts->resume) {
+            fprintf(stderr, "Error: --no-pages needs --index, and cannot be used "
+                    "with --resume\n");
+            exit(1);
+        }
+        opts->checkpointEvery = 0;    // nothing to resume from
+    }
+    if (!opts->keepPages && opts->nearDup >= 0) {
+        // a near-duplicate is confirmed against the saved copy of its match
+        fprintf(stderr, "Error: --near-dup cannot be used with --no-pages\n");
+        exit(1);
+    }
+    if (opts->numProcs > 1) {
+        // each of these needs one process to see the whole crawl
+        if (opts->numThreads > 1 || opts->resume || opts->pack || opts->recrawl
+            || opts->nearDup >= 0) {
+            fprintf(stderr, "Error: --procs cannot be used with -j, --resume, --pack, "
+                    "--recrawl, or --near-dup\n");
+            exit(1);
+        }
+        opts->checkpointEvery = 0;    // no one process knows the whole frontier
+    }
+
     // check valid number of args
-    if (argc != 4) {
-        fprintf(stderr, "Usage: %s seedURL pageDirectory maxDepth\n", argv[0]);
+    if (argc - optind != 3) {
+        fprintf(stderr, usage, argv[0]);
         exit(1);
     }
 
     // extract arguments
-    char* rawURL = argv[1];
-    char* dir    = argv[2];
-    char* depthStr = argv[3];
-
+    char* rawURL = argv[optind];
+    char* dir    = argv[optind + 1];
+    char* depthStr = argv[optind + 2];
     // normalize URL and validate it is internal
     char* normURL = normalizeURL(rawURL);
     if (normURL == NULL) {
@@ -81,128 +358,61 @@ parseArgs(const int argc, char* argv[], char** seedURL, char** pageDirectory, in
         exit(1);
     }
 
+    // check indexFilename and the metrics file are writable, without
+    // truncating them: neither is written until the crawl starts
+    if (opts->indexFile != NULL) {
+        FILE* fp = fopen(opts->indexFile, "a");
+        if (fp == NULL) {
+            fprintf(stderr, "Error: indexFilename '%s' is not writable\n", opts->indexFile);
+            free(normURL);
+            exit(1);
+        }
+        fclose(fp);
+    }
+    if (opts->metricsFile != NULL) {
+        FILE* fp = fopen(opts->metricsFile, "a");
+        if (fp == NULL) {
+            fprintf(stderr, "Error: metrics file '%s' is not writable\n", opts->metricsFile);
+            free(normURL);
+            exit(1);
+        }
+        fclose(fp);
+    }
+
     // success: fill out parameters
     *seedURL       = normURL;  // caller (via webpage) will free this
     *pageDirectory = dir;      // pointer into argv, don't need to free
     *maxDepth      = depth;
 }
 
-/**************** crawl ****************/
-/* Initialize hashtable of seen URLs and bag of pages to crawl; 
- * add seedURL as depth 0; 
- * repeatedly fetch, save, and scan pages until bag is empty
+/**************** parseInt ****************/
+/* Parse str as an integer option value in [min,max]; on error print a
+ * message naming the option and exit non-zero.
  */
-static void
-crawl(char* seedURL, char* pageDirectory, const int maxDepth)
+static int
+parseInt(const char* name, const char* str, const int min, const int max)
 {
-    // hashtable of seen URLs
-    hashtable_t* pagesSeen = hashtable_new(200);
-    if (pagesSeen == NULL) {
-        fprintf(stderr, "Error: could not allocate pagesSeen hashtable\n");
-        exit(2); // non-zero exit 
-    }
-
-    // record the seed URL as seen
-    hashtable_insert(pagesSeen, seedURL, "");  // value is unused
-
-    // bag of pages to crawl
-    bag_t* pagesToCrawl = bag_new();
-    if (pagesToCrawl == NULL) {
-        fprintf(stderr, "Error: could not allocate pagesToCrawl bag\n");
-        hashtable_delete(pagesSeen, NULL);
-        exit(2); // non-zero exit 
-    }
-
-    // create first webpage and insert into bag
-    webpage_t* seedPage = webpage_new(seedURL, 0, NULL);
-    if (seedPage == NULL) {
-        fprintf(stderr, "Error: could not allocate seed webpage\n");
-        hashtable_delete(pagesSeen, NULL);
-        bag_delete(pagesToCrawl, NULL);
-        exit(2); // non-zero exit 
-    }
-    bag_insert(pagesToCrawl, seedPage);
-
-    int docID = 1;
-    webpage_t* page;
-
-    // main crawl loop
-    while ((page = bag_extract(pagesToCrawl)) != NULL ) {
-
-        if (webpage_fetch(page)) {
-            // fetched successfully
-            printf("Fetched: %s\n", webpage_getURL(page));
-
-            // save the page to pageDirectory/docID
-            pagedir_save(page, pageDirectory, docID);
-            docID++;
-
-            // if not at maxDepth, scan for links
-            if (webpage_getDepth(page) < maxDepth) {
-                printf("Scanning: %s\n", webpage_getURL(page));
-                pageScan(page, pagesToCrawl, pagesSeen);
-            }
-        } else {
-            fprintf(stderr, "Warning: failed to fetch %s\n", webpage_getURL(page));
-        }
-
-        webpage_delete(page); // frees URL and HTML
+    int value;
+    char extra;
+    if (sscanf(str, "%d%c", &value, &extra) != 1 || value < min || value > max) {
+        fprintf(stderr, "Error: %s '%s' is not in [%d,%d]\n", name, str, min, max);
+        exit(1);
     }
-
-    // clean up
-    hashtable_delete(pagesSeen, NULL); 
-    bag_delete(pagesToCrawl, NULL);
+    return value;
 }
 
-/**************** pageScan ****************/
-/* Given a fetched webpage, scan for URLs.
- * For each internal URL not yet seen, insert into hashtable pagesSeen and create a new webpage_t at depth+1 and insert into bag pagesToCrawl
+/**************** parseRate ****************/
+/* Parse str as a --rate value: requests per second, 0 (no limit) up to
+ * 1000; on error print a message and exit non-zero.
  */
-static void
-pageScan(webpage_t* page, bag_t* pagesToCrawl, hashtable_t* pagesSeen)
+static double
+parseRate(const char* str)
 {
-    int pos = 0;
-    char* rawURL;
-    int nextDepth = webpage_getDepth(page) + 1;
-
-    while ((rawURL = webpage_getNextURL(page, &pos)) != NULL) {
-        // normalize rawURL without freeing it yet
-        char* url = normalizeURL(rawURL);
-
-        if (url == NULL) {
-            printf("IgnUnNormal: %s\n", rawURL);
-            free(rawURL);
-            continue;
-        }
-
-        printf("Found: %s\n", url);
-
-        if (!isInternalURL(url)) {
-            printf("IgnExtrn: %s\n", url);
-            free(url);
-            free(rawURL);
-            continue;
-        }
-
-        // internal URL
-        if (hashtable_insert(pagesSeen, url, "")) {
-            // url is new -> create a webpage_t that takes ownership of `url`
-            webpage_t* newPage = webpage_new(url, nextDepth, NULL);
-            if (newPage != NULL) {
-                bag_insert(pagesToCrawl, newPage);
-                printf("Added: %s\n", url);
-                // DO NOT free(url); webpage_delete(newPage) will free it later
-            } else {
-                // allocation failed -> avoid leak
-                free(url);
-            }
-        } 
-        else {
-            // duplicate URL
-            printf("IgnDupl: %s\n", url);
-            free(url);
-        }
-
-        free(rawURL);  // free here to be safe 
+    double value;
+    char extra;
+    if (sscanf(str, "%lf%c", &value, &extra) != 1 || !(value >= 0 && value <= 1000)) {
+        fprintf(stderr, "Error: rate '%s' is not in [0,1000]\n", str);
+        exit(1);
     }
-}
\ No newline at end of file
+    return value;
+}
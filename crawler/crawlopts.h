@@ -0,0 +1,61 @@
+/*
+ * crawlopts.h - header file for what the crawler's crawl modes are given
+ *
+ * The crawler parses its command line into a *crawlopts_t* and hands it
+ * to one of its crawl modes: single-threaded (seqcrawl.h), parallel
+ * (parcrawl.h), event-driven (asynccrawl.h), or multi-process
+ * (meshcrawl.h), where each process is handed its *crawlpart_t* as well.
+ * The limits every mode shares are here too.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#ifndef __CRAWLOPTS_H
+#define __CRAWLOPTS_H
+
+#include <stdbool.h>
+#include "../common/pagedir.h"
+#include "frontier.h"
+#include "pagewriter.h"
+#include "pagemeta.h"
+#include "procmesh.h"
+
+/**************** global types ****************/
+/* command-line options, with their defaults set in main */
+typedef struct crawlopts {
+    int numThreads;              // -j: worker threads
+    int numProcs;                // --procs: crawler processes
+    int maxInFlight;             // -a: requests in flight (0: don't use fetcher)
+    int connectTimeout;          // --connect-timeout, ms (fetcher only)
+    int readTimeout;             // --read-timeout, ms (fetcher only)
+    double rate;                 // --rate: requests per second to each host
+    int burst;                   // --burst: back-to-back requests to a host
+    frontier_policy_t priority;  // --priority: which pages to fetch first
+    int maxPages;                // --max-pages: page budget (0: no limit)
+    int checkpointEvery;         // --checkpoint: pages between checkpoints (0: none)
+    bool resume;                 // --resume: continue from the last checkpoint
+    int expectedURLs;            // --expected-urls: what to size pagesSeen for
+    int nearDup;                 // --near-dup: most bits near-duplicates differ in (-1: off)
+    pagedir_codec_t codec;       // --compress: how page files are stored
+    bool pack;                   // --pack: save pages in a pack, not a file each
+    pagewriter_sync_t fsync;     // --fsync: when saved pages are put on disk
+    pagedir_io_t io;             // --io: how page files are written, a batch at a time
+    bool recrawl;                // --recrawl: fetch pages saved before only if changed
+    const char* indexFile;       // --index: where to write the index (NULL: none)
+    bool keepPages;              // false with --no-pages: save no pages, only the index
+    const char* metricsFile;     // --metrics: where to write snapshots (NULL: none)
+    int metricsEvery;            // --metrics-every: ms between snapshots
+} crawlopts_t;
+
+/* a process's part of a --procs crawl, set up before it was forked */
+typedef struct crawlpart {
+    procmesh_t* mesh;            // the processes, and this one's place among them
+    pagemeta_t* meta;            // the log they all append to (NULL: --no-pages)
+} crawlpart_t;
+
+/**************** global constants ****************/
+#define CRAWL_MAX_THREADS 64     // upper bound for -j
+#define CRAWL_MESH_WAIT 10       // ms between looks at the other processes
+#define CRAWL_LINK_MEMO 4096     // links each link memo holds
+
+#endif // __CRAWLOPTS_H
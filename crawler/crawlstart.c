@@ -0,0 +1,148 @@
+/*
+ * crawlstart.c - how the crawler starts a crawl
+ *
+ * see crawlstart.h for more information.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#define _GNU_SOURCE       // strdup
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include "../common/pagedir.h"
+#include "crawlstart.h"
+#include "checkpoint.h"
+#include "metrics.h"
+
+/**************** local types ****************/
+/* where checkpoint_load delivers a checkpoint's contents */
+typedef struct restore {
+    seenset_t* pagesSeen;
+    void* arg;                   // passed to queue
+    bool (*queue)(void* arg, webpage_t* page);
+    bool ok;                     // false once anything could not be queued
+} restore_t;
+
+/**************** local functions ****************/
+static void restoreSeen(void* arg, const uint64_t fp);
+static void restorePage(void* arg, const char* url, const int depth);
+static void discardFrom(const char* pageDirectory, const int docID);
+
+/**************** crawlstart_seed() ****************/
+/* see crawlstart.h for description */
+int
+crawlstart_seed(char* seedURL, const char* pageDirectory, const crawlopts_t* opts,
+                seenset_t* pagesSeen, void* arg,
+                bool (*queue)(void* arg, webpage_t* page))
+{
+    if (opts->resume && checkpoint_exists(pageDirectory)) {
+        restore_t restore = { pagesSeen, arg, queue, true };
+        int docID;
+        if (!checkpoint_load(pageDirectory, &docID, &restore, restoreSeen, restorePage)
+            || !restore.ok) {
+            fprintf(stderr, "Error: could not resume from the checkpoint in '%s'\n",
+                    pageDirectory);
+            exit(2);
+        }
+        free(seedURL);
+        discardFrom(pageDirectory, docID);
+        if (opts->checkpointEvery > 0) {
+            seenset_trackNew(pagesSeen);    // for the next checkpoint to log
+        }
+        printf("Resumed: next docID %d\n", docID);
+        return docID;
+    }
+    if (opts->resume) {
+        fprintf(stderr, "Warning: no checkpoint in '%s'; starting from the seed\n",
+                pageDirectory);
+    }
+    // an earlier crawl's checkpoint would have --resume pick up that crawl
+    // if this one stops before its first checkpoint
+    checkpoint_remove(pageDirectory);
+
+    // record the seed URL as seen
+    if (opts->checkpointEvery > 0) {
+        seenset_trackNew(pagesSeen);
+    }
+    seenset_insert(pagesSeen, seedURL);
+    metrics_seen();
+
+    // create first webpage and queue it
+    webpage_t* seedPage = webpage_new(seedURL, 0, NULL);
+    if (seedPage == NULL || !(*queue)(arg, seedPage)) {
+        fprintf(stderr, "Error: could not allocate seed webpage\n");
+        exit(2);
+    }
+    return 1;
+}
+
+/**************** crawlstart_part() ****************/
+/* see crawlstart.h for description */
+int
+crawlstart_part(char* seedURL, procmesh_t* mesh, seenset_t* pagesSeen, void* arg,
+                bool (*queue)(void* arg, webpage_t* page))
+{
+    if (!procmesh_owns(mesh, seedURL)) {
+        free(seedURL);
+        return 1;
+    }
+    seenset_insert(pagesSeen, seedURL);
+    metrics_seen();
+    webpage_t* seedPage = webpage_new(seedURL, 0, NULL);
+    if (seedPage == NULL || !(*queue)(arg, seedPage)) {
+        fprintf(stderr, "Error: could not allocate seed webpage\n");
+        exit(2);
+    }
+    return 1;
+}
+
+/**************** restoreSeen ****************/
+/* checkpoint_load callback: arg is a restore_t*; record the URL with
+ * fingerprint fp as seen.
+ */
+static void
+restoreSeen(void* arg, const uint64_t fp)
+{
+    restore_t* restore = arg;
+    seenset_insertFingerprint(restore->pagesSeen, fp);
+    metrics_seen();
+}
+
+/**************** restorePage ****************/
+/* checkpoint_load callback: arg is a restore_t*; queue a page for url. */
+static void
+restorePage(void* arg, const char* url, const int depth)
+{
+    restore_t* restore = arg;
+    char* copy = strdup(url);
+    webpage_t* page = (copy != NULL) ? webpage_new(copy, depth, NULL) : NULL;
+    if (page == NULL || !(*restore->queue)(restore->arg, page)) {
+        if (page != NULL) {
+            webpage_delete(page);
+        } else {
+            free(copy);
+        }
+        restore->ok = false;
+    }
+}
+
+/**************** discardFrom ****************/
+/* Remove the page files numbered docID and up. A parallel crawl can leave
+ * a gap for each page a worker was saving, so stop only after
+ * CRAWL_MAX_THREADS missing files in a row.
+ */
+static void
+discardFrom(const char* pageDirectory, const int docID)
+{
+    for (int id = docID, missing = 0; missing < CRAWL_MAX_THREADS; id++) {
+        char name[20];
+        snprintf(name, sizeof(name), "%d", id);
+        char* path = pagedir_path(pageDirectory, name);
+        missing = (path != NULL && unlink(path) == 0) ? 0 : missing + 1;
+        free(path);
+    }
+}
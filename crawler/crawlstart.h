@@ -0,0 +1,48 @@
+/*
+ * crawlstart.h - header file for how the crawler starts a crawl
+ *
+ * Every crawl mode starts the same way: with the seed page at depth 0
+ * and docID 1, or with --resume, wherever the last checkpoint left off;
+ * a process of a --procs crawl starts with the seed only if it owns it.
+ * The mode supplies the queue its first pages go on.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#ifndef __CRAWLSTART_H
+#define __CRAWLSTART_H
+
+#include <stdbool.h>
+#include "../libcs50/webpage.h"
+#include "crawlopts.h"
+#include "seenset.h"
+#include "procmesh.h"
+
+/**************** functions ****************/
+
+/**************** crawlstart_seed ****************/
+/* Put the first pages of a crawl in place, handing them to queue(arg, page)
+ * and recording their URLs in pagesSeen, and return the first docID to use.
+ * Normally that is just the seed page at depth 0, and docID 1. With
+ * --resume, and a checkpoint in pageDirectory, it is the checkpoint's
+ * frontier, seen-set, and next docID instead; seedURL is then freed, and
+ * pages saved after the checkpoint was taken are removed, since the
+ * frontier still holds them. A fresh start removes any old checkpoint.
+ * Exits non-zero on error.
+ */
+int crawlstart_seed(char* seedURL, const char* pageDirectory, const crawlopts_t* opts,
+                    seenset_t* pagesSeen, void* arg,
+                    bool (*queue)(void* arg, webpage_t* page));
+
+/**************** crawlstart_part ****************/
+/* Put the first page of process self's part of a --procs crawl in place:
+ * the seed page, handed to queue(arg, page), if this process owns its
+ * URL (the mesh has counted it already); otherwise just free seedURL.
+ * Return the first docID to use, which is always 1, though the docIDs
+ * really come from the mesh (see seqcrawl_newDocID). Exits non-zero on
+ * error.
+ */
+int crawlstart_part(char* seedURL, procmesh_t* mesh, seenset_t* pagesSeen, void* arg,
+                    bool (*queue)(void* arg, webpage_t* page));
+
+#endif // __CRAWLSTART_H
@@ -0,0 +1,31 @@
+/*
+ * crawlstats.c - the crawler's end-of-crawl stats
+ *
+ * see crawlstats.h for more information.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#include <stdio.h>
+#include "../libcs50/resolver.h"
+#include "crawlstats.h"
+#include "linkmemo.h"
+#include "pagewriter.h"
+
+/**************** crawlstats_print() ****************/
+/* see crawlstats.h for description */
+void
+crawlstats_print(void)
+{
+    long lookups, hits;
+    resolver_stats(&lookups, &hits);
+    printf("Resolver: %ld lookups, %ld cache hits (%.1f%%)\n",
+           lookups, hits, lookups > 0 ? 100.0 * hits / lookups : 0.0);
+    linkmemo_stats(&lookups, &hits);
+    printf("Link memo: %ld lookups, %ld hits (%.1f%%)\n",
+           lookups, hits, lookups > 0 ? 100.0 * hits / lookups : 0.0);
+    long pages, batches, waits;
+    pagewriter_stats(&pages, &batches, &waits);
+    printf("Page writer: %ld pages in %ld batches, %ld waits for room\n",
+           pages, batches, waits);
+}
@@ -0,0 +1,22 @@
+/*
+ * crawlstats.h - header file for the crawler's end-of-crawl stats
+ *
+ * When a crawl is done, each crawler process prints how much work the
+ * fetch-path caches saved it: the resolver's cache (resolver.h), the
+ * link memos (linkmemo.h), and the page writer (pagewriter.h).
+ *
+ * CS50 FA25 Final Project
+ */
+
+#ifndef __CRAWLSTATS_H
+#define __CRAWLSTATS_H
+
+/**************** functions ****************/
+
+/**************** crawlstats_print ****************/
+/* Print this process's resolver, link memo, and page writer stats to
+ * stdout, one line each. Call once every crawl thread has finished.
+ */
+void crawlstats_print(void);
+
+#endif // __CRAWLSTATS_H
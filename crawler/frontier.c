@@ -0,0 +1,473 @@
+/*
+ * frontier.c - priority-ordered frontier for the crawler
+ *
+ * see frontier.h for more information.
+ *
+ * The heap holds small entries (page, score, sequence number) by value;
+ * higher scores come out first, and among equal scores the lower sequence
+ * number (the earlier push). Each policy is one scoring function.
+ *
+ * Scores can change while a page waits, and the two dynamic policies
+ * handle that without searching the heap:
+ *
+ *   FRONTIER_HOST scores only go down (a host's count of pages taken only
+ *   grows). Every stored score is therefore an upper bound, so when the
+ *   top entry's stored score is still right, it really is the best; if
+ *   not, we fix it in place, sift it down, and look again.
+ *
+ *   FRONTIER_INLINKS scores only go up, so an upper bound won't do.
+ *   Instead each entry keeps its page's in-link count, and an open-
+ *   addressing index (one array of URL hash and heap position, kept up to
+ *   date as entries move) finds a waiting page's entry by URL, so
+ *   frontier_link raises its count and sifts it up in place. A page
+ *   leaves the index when it is popped, so the index grows with the pages
+ *   waiting, not with every URL ever linked to.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <limits.h>
+#include "../libcs50/hashtable.h"
+#include "../libcs50/hash.h"
+#include "frontier.h"
+
+/**************** file-local global variables ****************/
+static const int INITIAL_CAPACITY = 64;   // entries in a new heap, slots in a new index
+static const int TABLE_SLOTS = 200;       // hashtable slots for hosts
+static const long DEPTH_SPAN = 1000;      // depths are below this
+static const int EMPTY = -1;              // index slot never used
+static const int GONE = -2;               // index slot whose page was popped
+
+/**************** local types ****************/
+/* one heap entry */
+typedef struct entry {
+    webpage_t* page;
+    long score;               // higher is better
+    unsigned long seq;        // lower is better, among equal scores
+    int inLinks;              // FRONTIER_INLINKS: links to it found so far
+    int slot;                 // FRONTIER_INLINKS: its slot in the index, else -1
+} entry_t;
+
+/* one slot of the FRONTIER_INLINKS index */
+typedef struct slot {
+    unsigned long hash;       // of the page's URL
+    int pos;                  // its entry's place in the heap, or EMPTY or GONE
+} slot_t;
+
+/**************** global types ****************/
+typedef struct frontier {
+    frontier_policy_t policy;
+    entry_t* heap;            // heap[0] is the best entry
+    int count;                // entries in the heap
+    int capacity;             // slots in heap
+    unsigned long nextSeq;    // sequence number for the next push
+    slot_t* index;            // URL -> heap position (FRONTIER_INLINKS)
+    int indexSize;            // slots in index, a power of 2
+    int indexUsed;            // slots not EMPTY
+    hashtable_t* hosts;       // host -> int pages taken (FRONTIER_HOST)
+} frontier_t;
+
+/**************** local functions ****************/
+static long score(frontier_t* fr, const entry_t* entry);
+static int* hostTaken(frontier_t* fr, const char* url);
+static bool better(const entry_t* a, const entry_t* b);
+static bool makeRoom(frontier_t* fr);
+static int findSlot(frontier_t* fr, const char* url, const unsigned long hash);
+static int freeSlot(const slot_t* index, const int size, const unsigned long hash);
+static bool rebuildIndex(frontier_t* fr, const int size);
+static void place(frontier_t* fr, const int i, const entry_t* entry);
+static void removeTop(frontier_t* fr);
+static void siftUp(frontier_t* fr, int i);
+static void siftDown(frontier_t* fr, int i);
+
+/**************** frontier_new() ****************/
+/* see frontier.h for description */
+frontier_t*
+frontier_new(const frontier_policy_t policy)
+{
+    frontier_t* fr = calloc(1, sizeof(frontier_t));
+    if (fr == NULL) {
+        return NULL;
+    }
+
+    fr->policy = policy;
+    fr->heap = malloc(INITIAL_CAPACITY * sizeof(entry_t));
+    fr->capacity = INITIAL_CAPACITY;
+    if (policy == FRONTIER_HOST) {
+        fr->hosts = hashtable_new(TABLE_SLOTS);
+    }
+    if (fr->heap == NULL
+        || (policy == FRONTIER_INLINKS && !rebuildIndex(fr, INITIAL_CAPACITY))
+        || (policy == FRONTIER_HOST && fr->hosts == NULL)) {
+        frontier_delete(fr, NULL);
+        return NULL;
+    }
+    return fr;
+}
+
+/**************** frontier_policy() ****************/
+/* see frontier.h for description */
+bool
+frontier_policy(const char* name, frontier_policy_t* policy)
+{
+    if (name == NULL || policy == NULL) {
+        return false;
+    } else if (strcmp(name, "depth") == 0) {
+        *policy = FRONTIER_DEPTH;
+    } else if (strcmp(name, "inlinks") == 0) {
+        *policy = FRONTIER_INLINKS;
+    } else if (strcmp(name, "host") == 0) {
+        *policy = FRONTIER_HOST;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**************** frontier_push() ****************/
+/* see frontier.h for description */
+bool
+frontier_push(frontier_t* fr, webpage_t* page)
+{
+    if (fr == NULL || page == NULL || webpage_getURL(page) == NULL) {
+        return false;
+    }
+    if (!makeRoom(fr)) {
+        return false;
+    }
+
+    entry_t entry = { page, 0, fr->nextSeq, 1, -1 };   // the link that found it
+    if (fr->policy == FRONTIER_INLINKS) {
+        unsigned long hash = hash_jenkins(webpage_getURL(page), ULONG_MAX);
+        entry.slot = freeSlot(fr->index, fr->indexSize, hash);
+        if (fr->index[entry.slot].pos == EMPTY) {
+            fr->indexUsed++;
+        }
+        fr->index[entry.slot].hash = hash;
+    }
+    entry.score = score(fr, &entry);
+    fr->nextSeq++;
+    fr->count++;
+    place(fr, fr->count - 1, &entry);
+    siftUp(fr, fr->count - 1);
+    return true;
+}
+
+/**************** frontier_link() ****************/
+/* see frontier.h for description */
+void
+frontier_link(frontier_t* fr, const char* url)
+{
+    if (fr == NULL || url == NULL || fr->policy != FRONTIER_INLINKS) {
+        return;
+    }
+
+    int slot = findSlot(fr, url, hash_jenkins(url, ULONG_MAX));
+    if (slot >= 0) {
+        // scores only go up: raise it in place
+        int pos = fr->index[slot].pos;
+        fr->heap[pos].inLinks++;
+        fr->heap[pos].score = score(fr, &fr->heap[pos]);
+        siftUp(fr, pos);
+    }
+}
+
+/**************** frontier_pop() ****************/
+/* see frontier.h for description */
+webpage_t*
+frontier_pop(frontier_t* fr)
+{
+    if (fr == NULL) {
+        return NULL;
+    }
+
+    while (fr->count > 0) {
+        entry_t* top = &fr->heap[0];
+
+        if (fr->policy == FRONTIER_HOST) {
+            // the stored score may be too high; fix it and look again
+            long now = score(fr, top);
+            if (now < top->score) {
+                top->score = now;
+                siftDown(fr, 0);
+                continue;
+            }
+            int* taken = hostTaken(fr, webpage_getURL(top->page));
+            if (taken != NULL) {
+                (*taken)++;
+            }
+        }
+
+        webpage_t* page = top->page;
+        if (top->slot >= 0) {
+            fr->index[top->slot].pos = GONE;
+        }
+        removeTop(fr);
+        return page;
+    }
+    return NULL;
+}
+
+/**************** frontier_size() ****************/
+/* see frontier.h for description */
+int
+frontier_size(frontier_t* fr)
+{
+    return fr ? fr->count : 0;
+}
+
+/**************** frontier_iterate() ****************/
+/* see frontier.h for description */
+void
+frontier_iterate(frontier_t* fr, void* arg,
+                 void (*itemfunc)(void* arg, webpage_t* page))
+{
+    if (fr == NULL || itemfunc == NULL) {
+        return;
+    }
+
+    for (int i = 0; i < fr->count; i++) {
+        (*itemfunc)(arg, fr->heap[i].page);
+    }
+}
+
+/**************** frontier_delete() ****************/
+/* see frontier.h for description */
+void
+frontier_delete(frontier_t* fr, void (*itemdelete)(void* item))
+{
+    if (fr == NULL) {
+        return;
+    }
+
+    if (itemdelete != NULL) {
+        for (int i = 0; i < fr->count; i++) {
+            (*itemdelete)(fr->heap[i].page);
+        }
+    }
+    hashtable_delete(fr->hosts, free);
+    free(fr->index);
+    free(fr->heap);
+    free(fr);
+}
+
+/**************** score ****************/
+/* Return the entry's current score under the frontier's policy.
+ * The depth term breaks ties.
+ */
+static long
+score(frontier_t* fr, const entry_t* entry)
+{
+    long depth = webpage_getDepth(entry->page);
+
+    switch (fr->policy) {
+    case FRONTIER_INLINKS:
+        return entry->inLinks * DEPTH_SPAN - depth;
+    case FRONTIER_HOST: {
+        int* taken = hostTaken(fr, webpage_getURL(entry->page));
+        return -(taken ? *taken : 0) * DEPTH_SPAN - depth;
+    }
+    default:
+        return -depth;
+    }
+}
+
+/**************** hostTaken ****************/
+/* Return the counter of pages taken from url's host ("hostname[:port]",
+ * everything between "//" and the next "/"), creating it on first sight;
+ * NULL if memory is exhausted.
+ */
+static int*
+hostTaken(frontier_t* fr, const char* url)
+{
+    char host[256];
+    const char* start = strstr(url, "//");
+    start = (start != NULL) ? start + 2 : url;
+    size_t len = strcspn(start, "/");
+    if (len >= sizeof(host)) {
+        len = sizeof(host) - 1;
+    }
+    memcpy(host, start, len);
+    host[len] = '\0';
+
+    int* taken = hashtable_find(fr->hosts, host);
+    if (taken == NULL) {
+        taken = malloc(sizeof(int));
+        if (taken == NULL) {
+            return NULL;
+        }
+        *taken = 0;
+        if (!hashtable_insert(fr->hosts, host, taken)) {
+            free(taken);
+            return NULL;
+        }
+    }
+    return taken;
+}
+
+/**************** better ****************/
+/* Should entry a come out of the frontier before entry b? */
+static bool
+better(const entry_t* a, const entry_t* b)
+{
+    return a->score > b->score || (a->score == b->score && a->seq < b->seq);
+}
+
+/**************** makeRoom ****************/
+/* Make sure the heap, and under FRONTIER_INLINKS the index, have room for
+ * one more page: the heap doubles when full, and the index is rebuilt at
+ * four times the pages waiting once half its slots are used, which also
+ * clears out the slots of pages popped. Returns false if memory is
+ * exhausted; the frontier is then unchanged.
+ */
+static bool
+makeRoom(frontier_t* fr)
+{
+    if (fr->count == fr->capacity) {
+        entry_t* heap = realloc(fr->heap, 2 * fr->capacity * sizeof(entry_t));
+        if (heap == NULL) {
+            return false;
+        }
+        fr->heap = heap;
+        fr->capacity *= 2;
+    }
+    if (fr->policy == FRONTIER_INLINKS && (fr->indexUsed + 1) * 2 > fr->indexSize) {
+        int size = INITIAL_CAPACITY;
+        while (size < 4 * (fr->count + 1)) {
+            size *= 2;
+        }
+        return rebuildIndex(fr, size);
+    }
+    return true;
+}
+
+/**************** findSlot ****************/
+/* Return the index slot of the waiting page whose URL is url (with the
+ * given hash), or -1 if there is none.
+ */
+static int
+findSlot(frontier_t* fr, const char* url, const unsigned long hash)
+{
+    int mask = fr->indexSize - 1;
+    for (int i = hash & mask; fr->index[i].pos != EMPTY; i = (i + 1) & mask) {
+        int pos = fr->index[i].pos;
+        if (pos >= 0 && fr->index[i].hash == hash
+            && strcmp(webpage_getURL(fr->heap[pos].page), url) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**************** freeSlot ****************/
+/* Return the first slot not holding a waiting page on hash's probe
+ * sequence in index[size]; there is always one, as the index is never
+ * more than half used.
+ */
+static int
+freeSlot(const slot_t* index, const int size, const unsigned long hash)
+{
+    int mask = size - 1;
+    int i = hash & mask;
+    while (index[i].pos >= 0) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+/**************** rebuildIndex ****************/
+/* Replace the index with one of size slots (a power of 2) holding just
+ * the pages waiting. Returns false if memory is exhausted; the old index
+ * is then kept.
+ */
+static bool
+rebuildIndex(frontier_t* fr, const int size)
+{
+    slot_t* index = malloc(size * sizeof(slot_t));
+    if (index == NULL) {
+        return false;
+    }
+    for (int i = 0; i < size; i++) {
+        index[i].pos = EMPTY;
+    }
+    for (int pos = 0; pos < fr->count; pos++) {
+        unsigned long hash = fr->index[fr->heap[pos].slot].hash;
+        int slot = freeSlot(index, size, hash);
+        index[slot].hash = hash;
+        index[slot].pos = pos;
+        fr->heap[pos].slot = slot;
+    }
+    free(fr->index);
+    fr->index = index;
+    fr->indexSize = size;
+    fr->indexUsed = fr->count;
+    return true;
+}
+
+/**************** place ****************/
+/* Put entry at heap[i], and tell the index where it is now. */
+static void
+place(frontier_t* fr, const int i, const entry_t* entry)
+{
+    fr->heap[i] = *entry;
+    if (entry->slot >= 0) {
+        fr->index[entry->slot].pos = i;
+    }
+}
+
+/**************** removeTop ****************/
+/* Remove heap[0], moving the last entry into its place. */
+static void
+removeTop(frontier_t* fr)
+{
+    fr->count--;
+    if (fr->count > 0) {
+        entry_t last = fr->heap[fr->count];
+        place(fr, 0, &last);
+        siftDown(fr, 0);
+    }
+}
+
+/**************** siftUp ****************/
+/* Move heap[i] up until its parent is better. */
+static void
+siftUp(frontier_t* fr, int i)
+{
+    entry_t entry = fr->heap[i];
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!better(&entry, &fr->heap[parent])) {
+            break;
+        }
+        place(fr, i, &fr->heap[parent]);
+        i = parent;
+    }
+    place(fr, i, &entry);
+}
+
+/**************** siftDown ****************/
+/* Move heap[i] down until it is better than both children. */
+static void
+siftDown(frontier_t* fr, int i)
+{
+    entry_t entry = fr->heap[i];
+    while (true) {
+        int child = 2 * i + 1;
+        if (child >= fr->count) {
+            break;
+        }
+        if (child + 1 < fr->count && better(&fr->heap[child + 1], &fr->heap[child])) {
+            child++;
+        }
+        if (!better(&fr->heap[child], &entry)) {
+            break;
+        }
+        place(fr, i, &fr->heap[child]);
+        i = child;
+    }
+    place(fr, i, &entry);
+}
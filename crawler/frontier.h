@@ -0,0 +1,101 @@
+/*
+ * frontier.h - header file for the crawler's priority-ordered frontier
+ *
+ * A *frontier* holds the pages waiting to be fetched and hands them out
+ * best first, so a crawl cut short by a page budget has fetched the most
+ * valuable pages. What "best" means is the frontier's *policy*:
+ *
+ *   FRONTIER_DEPTH    shallowest first: a breadth-first crawl
+ *   FRONTIER_INLINKS  most links pointing at it first (links found so far)
+ *   FRONTIER_HOST     host fairness: pages from the host we have taken the
+ *                     fewest pages from first, so no one site hogs the crawl
+ *
+ * Under every policy, ties go to the shallower page, and then to the page
+ * pushed first, so the order never depends on hashing or memory layout.
+ *
+ * The frontier is a binary heap in one array that doubles when full:
+ * pushes cost O(log n) comparisons and no allocation per page (amortized).
+ * Under FRONTIER_INLINKS, a second array indexes the waiting pages by URL,
+ * so its memory too grows with the pages waiting, not the links seen.
+ * It is not thread-safe; the single-threaded and event-driven crawls use it.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#ifndef __FRONTIER_H
+#define __FRONTIER_H
+
+#include <stdbool.h>
+#include "../libcs50/webpage.h"
+
+/**************** global types ****************/
+typedef struct frontier frontier_t;  // opaque to users of the module
+
+typedef enum {
+    FRONTIER_DEPTH,
+    FRONTIER_INLINKS,
+    FRONTIER_HOST
+} frontier_policy_t;
+
+/**************** functions ****************/
+
+/**************** frontier_new ****************/
+/* Create a new (empty) frontier ordered by policy.
+ *
+ * We return:
+ *   pointer to a new frontier, or NULL if error.
+ * Caller is responsible for:
+ *   later calling frontier_delete.
+ */
+frontier_t* frontier_new(const frontier_policy_t policy);
+
+/**************** frontier_policy ****************/
+/* Return the policy named by name ("depth", "inlinks", or "host") in
+ * *policy, and true; or false if there is no such policy.
+ */
+bool frontier_policy(const char* name, frontier_policy_t* policy);
+
+/**************** frontier_push ****************/
+/* Add a page to the frontier; the frontier holds it until popped.
+ *
+ * Caller provides:
+ *   valid frontier pointer, and a page whose URL is not yet in the
+ *   frontier (the crawler's pagesSeen guarantees that).
+ * We return:
+ *   true if the page was added;
+ *   false if any parameter is NULL or memory is exhausted.
+ */
+bool frontier_push(frontier_t* fr, webpage_t* page);
+
+/**************** frontier_link ****************/
+/* Note that another link to url was found. Under FRONTIER_INLINKS this
+ * raises the page's priority if it is still waiting; otherwise it does
+ * nothing.
+ */
+void frontier_link(frontier_t* fr, const char* url);
+
+/**************** frontier_pop ****************/
+/* Remove and return the best page under the frontier's policy.
+ *
+ * We return:
+ *   pointer to a page, now owned by the caller, or
+ *   NULL if the frontier is NULL or empty.
+ */
+webpage_t* frontier_pop(frontier_t* fr);
+
+/**************** frontier_size ****************/
+/* Return the number of pages waiting in the frontier (0 if NULL). */
+int frontier_size(frontier_t* fr);
+
+/**************** frontier_iterate ****************/
+/* Call itemfunc(arg, page) once for each page waiting in the frontier,
+ * in no particular order. The frontier must not change meanwhile.
+ */
+void frontier_iterate(frontier_t* fr, void* arg,
+                      void (*itemfunc)(void* arg, webpage_t* page));
+
+/**************** frontier_delete ****************/
+/* Delete the frontier, calling itemdelete (if not NULL) on each page left. */
+void frontier_delete(frontier_t* fr, void (*itemdelete)(void* item));
+
+#endif // __FRONTIER_H
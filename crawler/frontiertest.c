@@ -0,0 +1,188 @@
+/*
+ * frontiertest.c - unit test for the frontier module
+ *
+ * Pushes pages into a frontier under each policy and checks the order
+ * they pop in: shallowest first under depth, most links first under
+ * inlinks, the host taken from least first under host, and in every case
+ * ties to the shallower page and then the one pushed first. Also checks
+ * that the heap grows, and that frontier_iterate sees every page waiting.
+ *
+ * usage: frontiertest
+ * Prints a line for each failed check, then a count; exits non-zero if
+ * any check failed.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#define _GNU_SOURCE              // strdup
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "../libcs50/webpage.h"
+#include "frontier.h"
+
+/**************** file-local global variables ****************/
+static int checks = 0;
+static int failures = 0;
+static const int NUM_PAGES = 1000;       // many times a new heap's room
+
+/**************** local functions ****************/
+static void check(const bool ok, const char* what);
+static bool push(frontier_t* fr, const char* url, const int depth);
+static bool popOrder(frontier_t* fr, const char* const urls[], const int n);
+static void countOne(void* arg, webpage_t* page);
+
+/**************** main ****************/
+int main(void)
+{
+    frontier_policy_t policy;
+    check(frontier_policy("depth", &policy) && policy == FRONTIER_DEPTH
+          && frontier_policy("inlinks", &policy) && policy == FRONTIER_INLINKS
+          && frontier_policy("host", &policy) && policy == FRONTIER_HOST
+          && !frontier_policy("bogus", &policy), "policy names");
+    check(frontier_pop(NULL) == NULL && frontier_size(NULL) == 0
+          && !frontier_push(NULL, NULL), "NULL frontier");
+
+    // depth: shallowest first, then first pushed
+    frontier_t* fr = frontier_new(FRONTIER_DEPTH);
+    check(fr != NULL, "new (depth)");
+    push(fr, "http://a/p0", 2);
+    push(fr, "http://a/p1", 0);
+    push(fr, "http://a/p2", 1);
+    push(fr, "http://a/p3", 0);
+    push(fr, "http://a/p4", 2);
+    check(frontier_size(fr) == 5, "size");
+    const char* const byDepth[] = { "http://a/p1", "http://a/p3", "http://a/p2",
+                                    "http://a/p0", "http://a/p4" };
+    check(popOrder(fr, byDepth, 5), "depth order");
+    check(frontier_pop(fr) == NULL && frontier_size(fr) == 0, "pop when empty");
+
+    // many pages: the heap grows, and the order holds
+    bool pushed = true;
+    for (int i = 0; i < NUM_PAGES; i++) {
+        char url[32];
+        snprintf(url, sizeof(url), "http://a/%d", i);
+        pushed = push(fr, url, (i * 7) % 10) && pushed;
+    }
+    check(pushed && frontier_size(fr) == NUM_PAGES, "push past the initial room");
+    int waiting = 0;
+    frontier_iterate(fr, &waiting, countOne);
+    check(waiting == NUM_PAGES, "iterate sees every page");
+    bool ordered = true;
+    int lastDepth = -1;
+    int lastIndex = -1;
+    for (int i = 0; i < NUM_PAGES; i++) {
+        webpage_t* page = frontier_pop(fr);
+        if (page == NULL) {
+            ordered = false;
+            break;
+        }
+        int depth = webpage_getDepth(page);
+        int index = atoi(webpage_getURL(page) + strlen("http://a/"));
+        ordered = ordered && (depth > lastDepth || (depth == lastDepth && index > lastIndex));
+        lastDepth = depth;
+        lastIndex = index;
+        webpage_delete(page);
+    }
+    check(ordered, "depth order of many pages");
+    frontier_delete(fr, webpage_delete);
+
+    // inlinks: most links first, then first pushed
+    fr = frontier_new(FRONTIER_INLINKS);
+    check(fr != NULL, "new (inlinks)");
+    push(fr, "http://a/x", 1);
+    push(fr, "http://a/y", 1);
+    push(fr, "http://a/z", 1);
+    push(fr, "http://a/w", 0);
+    frontier_link(fr, "http://a/z");
+    frontier_link(fr, "http://a/z");
+    frontier_link(fr, "http://a/y");
+    frontier_link(fr, "http://a/x");
+    frontier_link(fr, "http://a/nowhere");
+    const char* const byLinks[] = { "http://a/z", "http://a/x", "http://a/y" };
+    check(popOrder(fr, byLinks, 3), "inlinks order");
+    frontier_link(fr, "http://a/z");          // no longer waiting
+    const char* const last[] = { "http://a/w" };
+    check(popOrder(fr, last, 1), "link to a page already popped");
+    frontier_delete(fr, webpage_delete);
+
+    // host: the host taken from least first, then first pushed
+    fr = frontier_new(FRONTIER_HOST);
+    check(fr != NULL, "new (host)");
+    push(fr, "http://h1/1", 1);
+    push(fr, "http://h1/2", 1);
+    push(fr, "http://h1/3", 1);
+    push(fr, "http://h2:8080/1", 1);
+    push(fr, "http://h2:8080/2", 1);
+    push(fr, "http://h3/1", 1);
+    const char* const byHost[] = { "http://h1/1", "http://h2:8080/1", "http://h3/1",
+                                   "http://h1/2", "http://h2:8080/2", "http://h1/3" };
+    check(popOrder(fr, byHost, 6), "host order");
+    frontier_delete(fr, webpage_delete);
+
+    // pages left are deleted with the frontier
+    fr = frontier_new(FRONTIER_DEPTH);
+    push(fr, "http://a/left", 0);
+    frontier_delete(fr, webpage_delete);
+
+    printf("frontiertest: %d checks, %d failed\n", checks, failures);
+    return failures == 0 ? 0 : 1;
+}
+
+/**************** check ****************/
+/* Count one check, and report it if it failed. */
+static void
+check(const bool ok, const char* what)
+{
+    checks++;
+    if (!ok) {
+        failures++;
+        printf("FAIL: %s\n", what);
+    }
+}
+
+/**************** push ****************/
+/* Push a new page for url at depth; return what frontier_push does. */
+static bool
+push(frontier_t* fr, const char* url, const int depth)
+{
+    char* copy = strdup(url);
+    webpage_t* page = (copy != NULL) ? webpage_new(copy, depth, NULL) : NULL;
+    if (page == NULL) {
+        free(copy);
+        return false;
+    }
+    if (!frontier_push(fr, page)) {
+        webpage_delete(page);
+        return false;
+    }
+    return true;
+}
+
+/**************** popOrder ****************/
+/* Pop n pages, and return true if their URLs are urls, in order. */
+static bool
+popOrder(frontier_t* fr, const char* const urls[], const int n)
+{
+    bool ok = true;
+    for (int i = 0; i < n; i++) {
+        webpage_t* page = frontier_pop(fr);
+        if (page == NULL || strcmp(webpage_getURL(page), urls[i]) != 0) {
+            printf("popped %s, expected %s\n",
+                   page != NULL ? webpage_getURL(page) : "nothing", urls[i]);
+            ok = false;
+        }
+        webpage_delete(page);
+    }
+    return ok;
+}
+
+/**************** countOne ****************/
+/* frontier_iterate's itemfunc: count the page. */
+static void
+countOne(void* arg, webpage_t* page)
+{
+    (*(int*)arg)++;
+}
@@ -0,0 +1,214 @@
+/*
+ * indexpipe.c - the crawler's index pipeline
+ *
+ * see indexpipe.h for more information.
+ *
+ * The queue is a circular array guarded by one mutex, with one condition
+ * variable for "not empty" (index threads wait on it) and one for "not
+ * full" (the crawler waits on it). Each index thread builds its own part
+ * of the index, so adding words takes no lock; a page is indexed by one
+ * thread only, so no docID appears in two parts, and indexpipe_finish
+ * merges the parts into one.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#define _GNU_SOURCE       // strdup
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "indexpipe.h"
+
+/**************** file-local global variables ****************/
+static const int INDEX_SLOTS = 500;       // hashtable slots of each part
+
+/**************** global types ****************/
+/* a page waiting to be indexed */
+typedef struct pipeitem {
+    webpage_t* page;          // the pipeline's own copy
+    int docID;
+} pipeitem_t;
+
+/* one index thread and the part of the index it builds */
+typedef struct indexer {
+    pthread_t thread;
+    index_t* part;
+    struct indexpipe* pipe;
+} indexer_t;
+
+typedef struct indexpipe {
+    pipeitem_t* items;        // circular array of items[capacity]
+    int capacity;
+    int head;                 // index of the oldest item
+    int count;                // number of items waiting
+    bool closing;             // no more will come; set by indexpipe_finish
+    pthread_mutex_t lock;     // protects all of the above
+    pthread_cond_t notEmpty;  // signaled when an item arrives or closing is set
+    pthread_cond_t notFull;   // signaled when an item is taken
+    int numThreads;
+    indexer_t* indexers;      // indexers[numThreads]
+} indexpipe_t;
+
+/**************** local functions ****************/
+static void* indexRun(void* arg);
+static webpage_t* copyPage(const webpage_t* page);
+
+/**************** indexpipe_new() ****************/
+/* see indexpipe.h for description */
+indexpipe_t*
+indexpipe_new(const int numThreads, const int capacity)
+{
+    if (numThreads < 1 || capacity < 1) {
+        return NULL;
+    }
+    indexpipe_t* pipe = calloc(1, sizeof(indexpipe_t));
+    if (pipe == NULL) {
+        return NULL;
+    }
+    pipe->items = calloc(capacity, sizeof(pipeitem_t));
+    pipe->indexers = calloc(numThreads, sizeof(indexer_t));
+    if (pipe->items == NULL || pipe->indexers == NULL) {
+        free(pipe->items);
+        free(pipe->indexers);
+        free(pipe);
+        return NULL;
+    }
+    pipe->capacity = capacity;
+    pthread_mutex_init(&pipe->lock, NULL);
+    pthread_cond_init(&pipe->notEmpty, NULL);
+    pthread_cond_init(&pipe->notFull, NULL);
+
+    // start as many threads as we can; finish stops those that started
+    for (int i = 0; i < numThreads; i++) {
+        indexer_t* indexer = &pipe->indexers[i];
+        indexer->pipe = pipe;
+        indexer->part = index_new(INDEX_SLOTS);
+        if (indexer->part == NULL
+            || pthread_create(&indexer->thread, NULL, indexRun, indexer) != 0) {
+            index_delete(indexer->part);
+            break;
+        }
+        pipe->numThreads++;
+    }
+    if (pipe->numThreads == 0) {
+        index_delete(indexpipe_finish(pipe));
+        return NULL;
+    }
+    return pipe;
+}
+
+/**************** indexpipe_add() ****************/
+/* see indexpipe.h for description */
+bool
+indexpipe_add(indexpipe_t* pipe, const webpage_t* page, const int docID)
+{
+    if (pipe == NULL || page == NULL) {
+        return false;
+    }
+    // copy outside the lock, so other threads may queue meanwhile
+    webpage_t* copy = copyPage(page);
+    if (copy == NULL) {
+        return false;
+    }
+
+    pthread_mutex_lock(&pipe->lock);
+    while (pipe->count == pipe->capacity) {
+        pthread_cond_wait(&pipe->notFull, &pipe->lock);
+    }
+    pipeitem_t* item = &pipe->items[(pipe->head + pipe->count) % pipe->capacity];
+    item->page = copy;
+    item->docID = docID;
+    pipe->count++;
+    pthread_cond_signal(&pipe->notEmpty);
+    pthread_mutex_unlock(&pipe->lock);
+    return true;
+}
+
+/**************** indexpipe_finish() ****************/
+/* see indexpipe.h for description */
+index_t*
+indexpipe_finish(indexpipe_t* pipe)
+{
+    if (pipe == NULL) {
+        return NULL;
+    }
+    // the index threads drain the queue before they see closing
+    pthread_mutex_lock(&pipe->lock);
+    pipe->closing = true;
+    pthread_cond_broadcast(&pipe->notEmpty);
+    pthread_mutex_unlock(&pipe->lock);
+
+    index_t* index = NULL;
+    for (int i = 0; i < pipe->numThreads; i++) {
+        indexer_t* indexer = &pipe->indexers[i];
+        pthread_join(indexer->thread, NULL);
+        if (index == NULL) {
+            index = indexer->part;
+        } else {
+            index_merge(index, indexer->part);
+            index_delete(indexer->part);
+        }
+    }
+
+    pthread_cond_destroy(&pipe->notFull);
+    pthread_cond_destroy(&pipe->notEmpty);
+    pthread_mutex_destroy(&pipe->lock);
+    free(pipe->indexers);
+    free(pipe->items);
+    free(pipe);
+    return index;
+}
+
+/**************** indexRun ****************/
+/* Thread body of an index thread (arg is its indexer_t): index pages from
+ * the queue into its part until the queue is empty and closing.
+ */
+static void*
+indexRun(void* arg)
+{
+    indexer_t* indexer = arg;
+    indexpipe_t* pipe = indexer->pipe;
+
+    while (true) {
+        pthread_mutex_lock(&pipe->lock);
+        while (pipe->count == 0 && !pipe->closing) {
+            pthread_cond_wait(&pipe->notEmpty, &pipe->lock);
+        }
+        if (pipe->count == 0) {
+            pthread_mutex_unlock(&pipe->lock);
+            return NULL;            // closing, and nothing left
+        }
+        pipeitem_t item = pipe->items[pipe->head];
+        pipe->head = (pipe->head + 1) % pipe->capacity;
+        pipe->count--;
+        pthread_cond_signal(&pipe->notFull);
+        pthread_mutex_unlock(&pipe->lock);
+
+        index_addPage(indexer->part, item.page, item.docID);
+        webpage_delete(item.page);
+    }
+}
+
+/**************** copyPage ****************/
+/* Return a new webpage with copies of page's URL, depth, and HTML; NULL
+ * if out of memory.
+ */
+static webpage_t*
+copyPage(const webpage_t* page)
+{
+    char* url = strdup(webpage_getURL(page));
+    const char* html = webpage_getHTML(page);
+    char* htmlCopy = (html != NULL) ? strdup(html) : NULL;
+    webpage_t* copy = NULL;
+    if (url != NULL && (html == NULL || htmlCopy != NULL)) {
+        copy = webpage_new(url, webpage_getDepth(page), htmlCopy);
+    }
+    if (copy == NULL) {
+        free(url);
+        free(htmlCopy);
+    }
+    return copy;
+}
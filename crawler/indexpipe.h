@@ -0,0 +1,56 @@
+/*
+ * indexpipe.h - header file for the crawler's index pipeline
+ *
+ * An *index pipeline* builds the index of a crawl while the crawl runs,
+ * so it is ready as soon as the crawl ends, without the indexer reading
+ * back every page the crawler saved. The crawler hands each page to the
+ * pipeline as it saves it; a bounded queue carries a copy of the page to
+ * a few index threads, which tokenize it and add its words to the index
+ * (as index_addPage does for the indexer). When the queue is full,
+ * handing over a page waits for room, so a crawl that outruns indexing
+ * slows down rather than filling memory.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#ifndef __INDEXPIPE_H
+#define __INDEXPIPE_H
+
+#include <stdbool.h>
+#include "../libcs50/webpage.h"
+#include "../common/index.h"
+
+/**************** global types ****************/
+typedef struct indexpipe indexpipe_t;  // opaque to users of the module
+
+/**************** functions ****************/
+
+/**************** indexpipe_new ****************/
+/* Start a pipeline with numThreads index threads and room for capacity
+ * pages waiting to be indexed.
+ *
+ * We return:
+ *   the pipeline, or NULL on error.
+ * Caller is responsible for:
+ *   later calling indexpipe_finish.
+ */
+indexpipe_t* indexpipe_new(const int numThreads, const int capacity);
+
+/**************** indexpipe_add ****************/
+/* Queue a copy of page to be indexed as docID, waiting while the queue is
+ * full. The caller keeps page. Safe to call from several threads at once.
+ * We return true on success; false if out of memory.
+ */
+bool indexpipe_add(indexpipe_t* pipe, const webpage_t* page, const int docID);
+
+/**************** indexpipe_finish ****************/
+/* Wait until every page queued is indexed, stop the index threads, and
+ * free the pipeline.
+ *
+ * We return:
+ *   the index of every page queued, or NULL if out of memory;
+ *   the caller is responsible for calling index_delete on it.
+ */
+index_t* indexpipe_finish(indexpipe_t* pipe);
+
+#endif // __INDEXPIPE_H
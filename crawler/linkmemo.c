@@ -0,0 +1,213 @@
+/*
+ * linkmemo.c - the crawler's memo of links it has handled
+ *
+ * see linkmemo.h for more information.
+ *
+ * The table is direct-mapped: an href's slot comes from a hash of its
+ * key, and holds at most one entry, so a lookup compares one key and an
+ * insertion never probes. Each entry is one allocation holding its key
+ * (directory, then href) and its URL. The whole key is compared, not
+ * just its hash, since a wrong hit would queue a URL the page never
+ * linked to.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include "linkmemo.h"
+
+/**************** file-local global variables ****************/
+static atomic_long totalLookups;          // of memos deleted so far
+static atomic_long totalHits;
+
+/**************** global types ****************/
+typedef struct entry {
+    uint64_t hash;              // of the key
+    size_t dirLen;              // the key is text[0, dirLen + hrefLen)
+    size_t hrefLen;
+    linkmemo_kind_t kind;
+    char text[];                // dir, href, then url and its '\0'
+} entry_t;
+
+typedef struct linkmemo {
+    entry_t** slots;            // NULL where empty
+    size_t mask;                // number of slots - 1
+    long lookups;
+    long hits;
+} linkmemo_t;
+
+/**************** local functions ****************/
+static size_t keyDirLen(const size_t dirLen, const char* href, const size_t hrefLen);
+static uint64_t hashKey(const char* dir, const size_t dirLen,
+                        const char* href, const size_t hrefLen);
+
+/**************** linkmemo_new() ****************/
+/* see linkmemo.h for description */
+linkmemo_t*
+linkmemo_new(const int slots)
+{
+    if (slots < 1) {
+        return NULL;
+    }
+
+    linkmemo_t* lm = malloc(sizeof(linkmemo_t));
+    if (lm == NULL) {
+        return NULL;
+    }
+    size_t size = 1;
+    while (size < (size_t)slots) {
+        size *= 2;
+    }
+    lm->slots = calloc(size, sizeof(entry_t*));
+    if (lm->slots == NULL) {
+        free(lm);
+        return NULL;
+    }
+    lm->mask = size - 1;
+    lm->lookups = lm->hits = 0;
+    return lm;
+}
+
+/**************** linkmemo_dirLen() ****************/
+/* see linkmemo.h for description */
+size_t
+linkmemo_dirLen(const char* pageURL)
+{
+    if (pageURL == NULL) {
+        return 0;
+    }
+    size_t end = strcspn(pageURL, "?#");
+    while (end > 0 && pageURL[end - 1] != '/') {
+        end--;
+    }
+    return end;
+}
+
+/**************** linkmemo_find() ****************/
+/* see linkmemo.h for description */
+const char*
+linkmemo_find(linkmemo_t* lm, const char* dir, const size_t dirLen,
+              const char* href, const size_t hrefLen, linkmemo_kind_t* kind)
+{
+    if (lm == NULL || dir == NULL || href == NULL || kind == NULL) {
+        return NULL;
+    }
+
+    lm->lookups++;
+    size_t keyDir = keyDirLen(dirLen, href, hrefLen);
+    uint64_t hash = hashKey(dir, keyDir, href, hrefLen);
+    entry_t* entry = lm->slots[hash & lm->mask];
+    if (entry == NULL || entry->hash != hash || entry->dirLen != keyDir
+        || entry->hrefLen != hrefLen
+        || memcmp(entry->text, dir, keyDir) != 0
+        || memcmp(entry->text + keyDir, href, hrefLen) != 0) {
+        return NULL;
+    }
+    lm->hits++;
+    *kind = entry->kind;
+    return entry->text + keyDir + hrefLen;
+}
+
+/**************** linkmemo_add() ****************/
+/* see linkmemo.h for description */
+void
+linkmemo_add(linkmemo_t* lm, const char* dir, const size_t dirLen,
+             const char* href, const size_t hrefLen,
+             const char* url, const linkmemo_kind_t kind)
+{
+    if (lm == NULL || dir == NULL || href == NULL || url == NULL) {
+        return;
+    }
+
+    size_t keyDir = keyDirLen(dirLen, href, hrefLen);
+    size_t urlLen = strlen(url);
+    entry_t* entry = malloc(sizeof(entry_t) + keyDir + hrefLen + urlLen + 1);
+    if (entry == NULL) {
+        return;
+    }
+    entry->hash = hashKey(dir, keyDir, href, hrefLen);
+    entry->dirLen = keyDir;
+    entry->hrefLen = hrefLen;
+    entry->kind = kind;
+    memcpy(entry->text, dir, keyDir);
+    memcpy(entry->text + keyDir, href, hrefLen);
+    memcpy(entry->text + keyDir + hrefLen, url, urlLen + 1);
+
+    entry_t** slot = &lm->slots[entry->hash & lm->mask];
+    free(*slot);
+    *slot = entry;
+}
+
+/**************** linkmemo_stats() ****************/
+/* see linkmemo.h for description */
+void
+linkmemo_stats(long* lookups, long* hits)
+{
+    if (lookups != NULL) {
+        *lookups = atomic_load(&totalLookups);
+    }
+    if (hits != NULL) {
+        *hits = atomic_load(&totalHits);
+    }
+}
+
+/**************** linkmemo_delete() ****************/
+/* see linkmemo.h for description */
+void
+linkmemo_delete(linkmemo_t* lm)
+{
+    if (lm != NULL) {
+        atomic_fetch_add(&totalLookups, lm->lookups);
+        atomic_fetch_add(&totalHits, lm->hits);
+        for (size_t i = 0; i <= lm->mask; i++) {
+            free(lm->slots[i]);
+        }
+        free(lm->slots);
+        free(lm);
+    }
+}
+
+/**************** keyDirLen ****************/
+/* Return how much of the directory goes into the key for href: none if
+ * href is absolute (a ':' before any '/', '?', or '#', as resolveURL
+ * judges it), else all dirLen characters.
+ */
+static size_t
+keyDirLen(const size_t dirLen, const char* href, const size_t hrefLen)
+{
+    for (size_t i = 0; i < hrefLen; i++) {
+        if (href[i] == ':') {
+            return 0;
+        }
+        if (href[i] == '/' || href[i] == '?' || href[i] == '#') {
+            break;
+        }
+    }
+    return dirLen;
+}
+
+/**************** hashKey ****************/
+/* Return a hash of the key dir + href: FNV-1a, then the MurmurHash3
+ * finalizer, as in seenset_fingerprint.
+ */
+static uint64_t
+hashKey(const char* dir, const size_t dirLen, const char* href, const size_t hrefLen)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < dirLen; i++) {
+        h = (h ^ (unsigned char)dir[i]) * 0x100000001b3ULL;
+    }
+    for (size_t i = 0; i < hrefLen; i++) {
+        h = (h ^ (unsigned char)href[i]) * 0x100000001b3ULL;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
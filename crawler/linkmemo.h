@@ -0,0 +1,91 @@
+/*
+ * linkmemo.h - header file for the crawler's memo of links it has handled
+ *
+ * Sites repeat the same hrefs on every page: nav bars, "../index.html",
+ * a site-wide footer. A *linkmemo* remembers what became of each href
+ * found in pages of one directory: the URL it resolved and normalized to,
+ * and whether that URL was internal and is in the seen-set already. The
+ * next time the href turns up in a page of that directory, the crawler
+ * can skip resolving and normalizing it, and, once it is seen, the
+ * seen-set as well: the link is a duplicate.
+ *
+ * An href is keyed by the *directory* of the page it was found in (the
+ * page's URL up to the last '/' of its path), since that is all the
+ * resolution of a relative href depends on; an absolute href is keyed by
+ * itself alone.
+ *
+ * The memo is bounded: a fixed table of slots, each href having one
+ * slot, so a new href replaces whatever was in its slot. It is not
+ * thread-safe; each thread that scans pages keeps its own.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#ifndef __LINKMEMO_H
+#define __LINKMEMO_H
+
+#include <stddef.h>
+
+/**************** global types ****************/
+typedef struct linkmemo linkmemo_t;  // opaque to users of the module
+
+/* what became of a link */
+typedef enum {
+    LINKMEMO_UNNORMAL,        // resolved, but could not be normalized
+    LINKMEMO_EXTERNAL,        // normalized, but not internal
+    LINKMEMO_SEEN             // internal, and in the seen-set now
+} linkmemo_kind_t;
+
+/**************** functions ****************/
+
+/**************** linkmemo_new ****************/
+/* Create a new (empty) memo of about `slots` links (rounded up to a
+ * power of two).
+ *
+ * We return:
+ *   pointer to a new memo, or NULL if slots < 1 or memory is exhausted.
+ * Caller is responsible for:
+ *   later calling linkmemo_delete.
+ */
+linkmemo_t* linkmemo_new(const int slots);
+
+/**************** linkmemo_dirLen ****************/
+/* Return the length of the directory of pageURL, a normalized URL: up to
+ * and including the last '/' before any query or fragment.
+ */
+size_t linkmemo_dirLen(const char* pageURL);
+
+/**************** linkmemo_find ****************/
+/* Look for the link href (hrefLen characters, as written) found in a page
+ * whose URL begins with its directory dir (dirLen characters; see
+ * linkmemo_dirLen).
+ *
+ * We return:
+ *   the URL it became, setting *kind (see linkmemo_kind_t), if we have
+ *   it; it stays valid until the next linkmemo_add or linkmemo_delete;
+ *   NULL if not, or if any pointer is NULL.
+ */
+const char* linkmemo_find(linkmemo_t* lm, const char* dir, const size_t dirLen,
+                          const char* href, const size_t hrefLen,
+                          linkmemo_kind_t* kind);
+
+/**************** linkmemo_add ****************/
+/* Remember that the link href found in a page of directory dir became
+ * url, of the given kind, replacing whatever was in its slot. We keep a
+ * copy of url. If memory is exhausted, the link is just not remembered.
+ */
+void linkmemo_add(linkmemo_t* lm, const char* dir, const size_t dirLen,
+                  const char* href, const size_t hrefLen,
+                  const char* url, const linkmemo_kind_t kind);
+
+/**************** linkmemo_stats ****************/
+/* Report the lookups and hits of all the memos this process has deleted
+ * so far.
+ */
+void linkmemo_stats(long* lookups, long* hits);
+
+/**************** linkmemo_delete ****************/
+/* Delete the memo, adding its lookups and hits to linkmemo_stats. */
+void linkmemo_delete(linkmemo_t* lm);
+
+#endif // __LINKMEMO_H
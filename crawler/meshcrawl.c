@@ -0,0 +1,168 @@
+/*
+ * meshcrawl.c - the crawler's multi-process (--procs) crawl
+ *
+ * see meshcrawl.h for more information.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include "../libcs50/connpool.h"
+#include "../common/index.h"
+#include "meshcrawl.h"
+#include "seqcrawl.h"
+#include "asynccrawl.h"
+#include "pagestore.h"
+#include "checkpoint.h"
+#include "procmesh.h"
+#include "politeness.h"
+#include "metrics.h"
+#include "crawlstats.h"
+
+/**************** local functions ****************/
+static void crawlPart(char* seedURL, char* pageDirectory, const int maxDepth,
+                      const crawlopts_t* opts, const crawlpart_t* part, const int self);
+static char* indexPartName(const char* indexFile, const int self);
+static void mergeIndexParts(const char* indexFile, const int numProcs);
+
+/**************** meshcrawl_run() ****************/
+/* see meshcrawl.h for description */
+void
+meshcrawl_run(char* seedURL, char* pageDirectory, const int maxDepth,
+              const crawlopts_t* opts)
+{
+    // whole lines, so the processes' output does not mix within a line
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    // always a fresh crawl (no --resume)
+    checkpoint_remove(pageDirectory);
+    pagestore_openPack(opts, pageDirectory, 1);
+    int docID = 1;
+    crawlpart_t part;
+    part.meta = opts->keepPages ? pagestore_openMeta(opts, pageDirectory, &docID) : NULL;
+    part.mesh = procmesh_new(opts->numProcs, opts->maxPages);
+    if (part.mesh == NULL) {
+        fprintf(stderr, "Error: could not set up %d crawler processes\n", opts->numProcs);
+        exit(2);
+    }
+
+    int self;
+    if (!procmesh_spawn(part.mesh, &self)) {
+        fprintf(stderr, "Error: could not start %d crawler processes\n", opts->numProcs);
+        exit(2);
+    }
+    if (self >= 0) {
+        crawlPart(seedURL, pageDirectory, maxDepth, opts, &part, self);    // does not return
+    }
+    free(seedURL);              // each process has its own copy
+
+    bool ok = procmesh_wait(part.mesh);
+    int pages = procmesh_pages(part.mesh);
+    procmesh_delete(part.mesh);
+    pagemeta_close(part.meta);
+    if (!ok) {
+        fprintf(stderr, "Error: a crawler process failed\n");
+        exit(2);
+    }
+    if (opts->indexFile != NULL) {
+        mergeIndexParts(opts->indexFile, opts->numProcs);
+    }
+    printf("Procs: %d processes saved %d pages\n", opts->numProcs, pages);
+}
+
+/**************** crawlPart ****************/
+/* Process number self of a --procs crawl: start its metrics, crawl its
+ * share, report its stats, and exit.
+ */
+static void
+crawlPart(char* seedURL, char* pageDirectory, const int maxDepth, const crawlopts_t* opts,
+          const crawlpart_t* part, const int self)
+{
+    crawlopts_t partOpts = *opts;
+    char* indexPart = NULL;
+    if (opts->indexFile != NULL) {
+        indexPart = indexPartName(opts->indexFile, self);
+        partOpts.indexFile = indexPart;
+    }
+    politeness_t* polite = politeness_new(opts->rate / opts->numProcs, opts->burst);
+    if (polite == NULL || (opts->indexFile != NULL && indexPart == NULL)) {
+        fprintf(stderr, "Error: could not allocate crawler process %d\n", self);
+        exit(2);
+    }
+    if (opts->metricsFile != NULL
+        && !metrics_start(opts->metricsFile, opts->metricsEvery, self)) {
+        fprintf(stderr, "Error: could not start writing metrics to '%s'\n",
+                opts->metricsFile);
+        exit(2);
+    }
+
+    if (opts->maxInFlight > 0) {
+        asynccrawl_run(seedURL, pageDirectory, maxDepth, &partOpts, polite, part);
+    } else {
+        seqcrawl_run(seedURL, pageDirectory, maxDepth, &partOpts, polite, part);
+    }
+    politeness_delete(polite);
+    connpool_closeAll();
+    crawlstats_print();
+    metrics_stop();
+    procmesh_delete(part->mesh);
+    free(indexPart);
+    exit(0);
+}
+
+/**************** indexPartName ****************/
+/* Return "indexFile.self", where process self of a --procs crawl writes
+ * its part of the index; NULL if out of memory. Caller frees it.
+ */
+static char*
+indexPartName(const char* indexFile, const int self)
+{
+    size_t len = strlen(indexFile) + 20;
+    char* name = malloc(len);
+    if (name != NULL) {
+        snprintf(name, len, "%s.%d", indexFile, self);
+    }
+    return name;
+}
+
+/**************** mergeIndexParts ****************/
+/* Merge the parts of the index that the numProcs processes of a --procs
+ * crawl wrote into indexFile, and remove them. Exits non-zero on error.
+ */
+static void
+mergeIndexParts(const char* indexFile, const int numProcs)
+{
+    index_t* index = NULL;
+    for (int i = 0; i < numProcs; i++) {
+        char* name = indexPartName(indexFile, i);
+        FILE* fp = (name != NULL) ? fopen(name, "r") : NULL;
+        index_t* part = index_load(fp);
+        if (part == NULL) {
+            fprintf(stderr, "Error: could not read index part '%s'\n", name);
+            exit(2);
+        }
+        fclose(fp);
+        unlink(name);
+        free(name);
+        if (index == NULL) {
+            index = part;
+        } else {
+            index_merge(index, part);
+            index_delete(part);
+        }
+    }
+
+    FILE* fp = fopen(indexFile, "w");
+    if (fp == NULL) {
+        fprintf(stderr, "Error: could not write the index to '%s'\n", indexFile);
+        exit(2);
+    }
+    index_save(index, fp);
+    fclose(fp);
+    index_delete(index);
+    printf("Indexed: %s\n", indexFile);
+}
@@ -0,0 +1,34 @@
+/*
+ * meshcrawl.h - header file for the crawler's multi-process (--procs) crawl
+ *
+ * With --procs, several processes crawl at once, each owning a share of
+ * the URLs and sending the others the links it finds to theirs (see
+ * procmesh.h). Each crawls its share as the single-threaded or
+ * event-driven crawl would.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#ifndef __MESHCRAWL_H
+#define __MESHCRAWL_H
+
+#include "crawlopts.h"
+
+/**************** functions ****************/
+
+/**************** meshcrawl_run ****************/
+/* Crawl with opts->numProcs processes (see procmesh.h), each crawling its
+ * share of the URLs as seqcrawl_run() would, or asynccrawl_run() with -a.
+ * The parent sets up what they share, forks them, and waits for them: it
+ * clears out an earlier crawl's checkpoint and pack, and opens the page
+ * metadata log, which every process appends to. Each process gets
+ * 1/numProcs of --rate, so the site sees about the rate asked for, and
+ * with --metrics, writes its own snapshots. With --index, each process
+ * writes its part of the index, and the parent merges them. Each process
+ * prints its own stats and exits when its part is done; the parent
+ * returns once they all are. Exits non-zero if any process fails.
+ */
+void meshcrawl_run(char* seedURL, char* pageDirectory, const int maxDepth,
+                   const crawlopts_t* opts);
+
+#endif // __MESHCRAWL_H
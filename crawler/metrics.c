@@ -0,0 +1,426 @@
+/*
+ * metrics.c - the crawler's metrics
+ *
+ * see metrics.h for more information.
+ *
+ * Every counter, gauge, and histogram bucket is an atomic long, so any
+ * thread may record without a lock, and the snapshot thread may read
+ * them while they change; a snapshot is thus not one instant, but each
+ * number in it is one that was true. The snapshot thread sleeps on a
+ * condition variable, so metrics_stop can wake it at once.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#define _GNU_SOURCE       // pthread_condattr_setclock
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "metrics.h"
+
+/**************** file-local global variables ****************/
+#define SUB_BUCKETS 16        // buckets for each power of two
+#define MAX_BITS 40           // values go up to 2^40 us (12 days)
+#define NUM_BUCKETS ((MAX_BITS - 3) * SUB_BUCKETS)
+#define MAX_DEPTH 10          // deepest depth counted apart (deeper: with it)
+#define LINE_SIZE 8192        // bytes in one snapshot line, at most
+
+/**************** global types ****************/
+/* a latency histogram */
+typedef struct histogram {
+    const char* name;
+    atomic_long count;
+    atomic_long sum;
+    atomic_long max;
+    atomic_long buckets[NUM_BUCKETS];
+} histogram_t;
+
+enum { H_DNS, H_CONNECT, H_FIRST_BYTE, H_BODY, H_SAVE, NUM_HISTOGRAMS };
+
+/* everything counted, and the snapshot thread */
+typedef struct metrics {
+    bool enabled;               // set by metrics_start
+    atomic_long fetched;
+    atomic_long notModified;
+    atomic_long failed;
+    atomic_long saved;
+    atomic_long bytes;
+    atomic_long seen;
+    atomic_long duplicates;
+    atomic_long queued[MAX_DEPTH + 1];
+    histogram_t histograms[NUM_HISTOGRAMS];
+
+    int fd;                     // the snapshot file
+    int proc;                   // process number for each line, or -1
+    int everyMs;
+    long started;               // when metrics_start was called (us)
+    pthread_t thread;
+    bool stopping;              // guarded by lock
+    pthread_mutex_t lock;
+    pthread_cond_t wake;        // signaled when stopping is set
+} metrics_t;
+
+static metrics_t metrics = {
+    .histograms = {
+        [H_DNS] = { .name = "dns" },
+        [H_CONNECT] = { .name = "connect" },
+        [H_FIRST_BYTE] = { .name = "firstByte" },
+        [H_BODY] = { .name = "body" },
+        [H_SAVE] = { .name = "save" },
+    },
+};
+
+/**************** local functions ****************/
+static void* snapshotRun(void* arg);
+static void snapshot(const char* type);
+static void record(histogram_t* h, long micros);
+static int bucketOf(long micros);
+static long bucketTop(const int bucket);
+static long percentile(histogram_t* h, const long count, const double p);
+static void put(char* line, size_t* len, const char* fmt, ...);
+
+/**************** metrics_start() ****************/
+/* see metrics.h for description */
+bool
+metrics_start(const char* filename, const int everyMs, const int proc)
+{
+    if (filename == NULL || everyMs < 1) {
+        return false;
+    }
+    metrics.fd = open(filename, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (metrics.fd < 0) {
+        return false;
+    }
+    metrics.proc = proc;
+    metrics.everyMs = everyMs;
+    metrics.started = metrics_clock();
+    metrics.stopping = false;
+    pthread_mutex_init(&metrics.lock, NULL);
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&metrics.wake, &attr);
+    pthread_condattr_destroy(&attr);
+
+    metrics.enabled = true;
+    if (pthread_create(&metrics.thread, NULL, snapshotRun, NULL) != 0) {
+        metrics.enabled = false;
+        pthread_cond_destroy(&metrics.wake);
+        pthread_mutex_destroy(&metrics.lock);
+        close(metrics.fd);
+        return false;
+    }
+    return true;
+}
+
+/**************** metrics_stop() ****************/
+/* see metrics.h for description */
+void
+metrics_stop(void)
+{
+    if (!metrics.enabled) {
+        return;
+    }
+    pthread_mutex_lock(&metrics.lock);
+    metrics.stopping = true;
+    pthread_cond_signal(&metrics.wake);
+    pthread_mutex_unlock(&metrics.lock);
+    pthread_join(metrics.thread, NULL);
+    snapshot("final");
+    close(metrics.fd);
+    pthread_cond_destroy(&metrics.wake);
+    pthread_mutex_destroy(&metrics.lock);
+    metrics.enabled = false;
+
+    double elapsed = (metrics_clock() - metrics.started) / 1e6;
+    printf("Metrics: %ld fetched, %ld not modified, %ld failed, %ld saved, "
+           "%ld bytes in %.3f s\n",
+           atomic_load(&metrics.fetched), atomic_load(&metrics.notModified),
+           atomic_load(&metrics.failed), atomic_load(&metrics.saved),
+           atomic_load(&metrics.bytes), elapsed);
+    printf("Metrics: %-10s %8s %9s %9s %9s %9s %9s  (us)\n",
+           "latency", "count", "mean", "p50", "p90", "p99", "max");
+    for (int i = 0; i < NUM_HISTOGRAMS; i++) {
+        histogram_t* h = &metrics.histograms[i];
+        long count = atomic_load(&h->count);
+        printf("Metrics: %-10s %8ld %9ld %9ld %9ld %9ld %9ld\n", h->name, count,
+               count > 0 ? atomic_load(&h->sum) / count : 0,
+               percentile(h, count, 0.50), percentile(h, count, 0.90),
+               percentile(h, count, 0.99), atomic_load(&h->max));
+    }
+}
+
+/**************** metrics_fetch() ****************/
+/* see metrics.h for description */
+void
+metrics_fetch(const webpage_t* page, const bool fetched)
+{
+    if (!metrics.enabled) {
+        return;
+    }
+    if (fetched) {
+        atomic_fetch_add(&metrics.fetched, 1);
+    } else if (webpage_getStatus(page) == 304) {
+        atomic_fetch_add(&metrics.notModified, 1);
+    } else {
+        atomic_fetch_add(&metrics.failed, 1);
+    }
+
+    // a phase that did not happen (0) is not a latency
+    webpage_timing_t timing = webpage_getTiming(page);
+    atomic_fetch_add(&metrics.bytes, timing.bytes);
+    const long phases[] = {
+        [H_DNS] = timing.dns, [H_CONNECT] = timing.connect,
+        [H_FIRST_BYTE] = timing.firstByte, [H_BODY] = timing.body,
+    };
+    for (int i = H_DNS; i <= H_BODY; i++) {
+        if (phases[i] > 0) {
+            record(&metrics.histograms[i], phases[i]);
+        }
+    }
+}
+
+/**************** metrics_clock() ****************/
+/* see metrics.h for description */
+long
+metrics_clock(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000L + ts.tv_nsec / 1000L;
+}
+
+/**************** metrics_saved() ****************/
+/* see metrics.h for description */
+void
+metrics_saved(const long micros)
+{
+    if (metrics.enabled) {
+        atomic_fetch_add(&metrics.saved, 1);
+        record(&metrics.histograms[H_SAVE], micros);
+    }
+}
+
+/**************** metrics_seen() ****************/
+/* see metrics.h for description */
+void
+metrics_seen(void)
+{
+    if (metrics.enabled) {
+        atomic_fetch_add(&metrics.seen, 1);
+    }
+}
+
+/**************** metrics_duplicate() ****************/
+/* see metrics.h for description */
+void
+metrics_duplicate(void)
+{
+    if (metrics.enabled) {
+        atomic_fetch_add(&metrics.duplicates, 1);
+    }
+}
+
+/**************** metrics_queued() ****************/
+/* see metrics.h for description */
+void
+metrics_queued(const int depth)
+{
+    if (metrics.enabled && depth >= 0) {
+        atomic_fetch_add(&metrics.queued[depth < MAX_DEPTH ? depth : MAX_DEPTH], 1);
+    }
+}
+
+/**************** metrics_dequeued() ****************/
+/* see metrics.h for description */
+void
+metrics_dequeued(const int depth)
+{
+    if (metrics.enabled && depth >= 0) {
+        atomic_fetch_sub(&metrics.queued[depth < MAX_DEPTH ? depth : MAX_DEPTH], 1);
+    }
+}
+
+/**************** snapshotRun ****************/
+/* Thread body of the snapshot thread: write a snapshot every everyMs ms
+ * until metrics_stop.
+ */
+static void*
+snapshotRun(void* arg)
+{
+    struct timespec due;
+    clock_gettime(CLOCK_MONOTONIC, &due);
+    pthread_mutex_lock(&metrics.lock);
+    while (true) {
+        due.tv_sec += metrics.everyMs / 1000;
+        due.tv_nsec += (metrics.everyMs % 1000) * 1000000L;
+        if (due.tv_nsec >= 1000000000L) {
+            due.tv_sec++;
+            due.tv_nsec -= 1000000000L;
+        }
+        while (!metrics.stopping
+               && pthread_cond_timedwait(&metrics.wake, &metrics.lock, &due) == 0) {
+            // woken early, but not to stop; wait out the rest
+        }
+        if (metrics.stopping) {
+            break;
+        }
+        pthread_mutex_unlock(&metrics.lock);
+        snapshot("snapshot");
+        pthread_mutex_lock(&metrics.lock);
+    }
+    pthread_mutex_unlock(&metrics.lock);
+    return NULL;
+}
+
+/**************** snapshot ****************/
+/* Append one line of JSON with every metric to the file, marked type. */
+static void
+snapshot(const char* type)
+{
+    char line[LINE_SIZE];
+    size_t len = 0;
+    put(line, &len, "{\"type\":\"%s\"", type);
+    if (metrics.proc >= 0) {
+        put(line, &len, ",\"proc\":%d", metrics.proc);
+    }
+    put(line, &len, ",\"elapsed\":%.3f", (metrics_clock() - metrics.started) / 1e6);
+    put(line, &len, ",\"fetched\":%ld,\"notModified\":%ld,\"failed\":%ld,\"saved\":%ld",
+        atomic_load(&metrics.fetched), atomic_load(&metrics.notModified),
+        atomic_load(&metrics.failed), atomic_load(&metrics.saved));
+    put(line, &len, ",\"bytes\":%ld,\"seen\":%ld,\"duplicates\":%ld",
+        atomic_load(&metrics.bytes), atomic_load(&metrics.seen),
+        atomic_load(&metrics.duplicates));
+
+    // queued at each depth, up to the deepest with any
+    long queued[MAX_DEPTH + 1];
+    int depths = 0;
+    for (int d = 0; d <= MAX_DEPTH; d++) {
+        queued[d] = atomic_load(&metrics.queued[d]);
+        if (queued[d] != 0) {
+            depths = d + 1;
+        }
+    }
+    put(line, &len, ",\"queuedByDepth\":[");
+    for (int d = 0; d < depths; d++) {
+        put(line, &len, "%s%ld", d > 0 ? "," : "", queued[d]);
+    }
+    put(line, &len, "]");
+
+    put(line, &len, ",\"latency\":{");
+    for (int i = 0; i < NUM_HISTOGRAMS; i++) {
+        histogram_t* h = &metrics.histograms[i];
+        long count = atomic_load(&h->count);
+        put(line, &len, "%s\"%s\":{\"count\":%ld,\"mean\":%ld,\"p50\":%ld,\"p90\":%ld,"
+            "\"p99\":%ld,\"max\":%ld}", i > 0 ? "," : "", h->name, count,
+            count > 0 ? atomic_load(&h->sum) / count : 0, percentile(h, count, 0.50),
+            percentile(h, count, 0.90), percentile(h, count, 0.99), atomic_load(&h->max));
+    }
+    put(line, &len, "}}\n");
+
+    // one write, so lines from several processes do not mix
+    if (write(metrics.fd, line, len) != (ssize_t)len) {
+        fprintf(stderr, "Warning: could not write metrics\n");
+    }
+}
+
+/**************** record ****************/
+/* Count micros in histogram h. */
+static void
+record(histogram_t* h, long micros)
+{
+    if (micros < 0) {
+        micros = 0;
+    }
+    atomic_fetch_add(&h->count, 1);
+    atomic_fetch_add(&h->sum, micros);
+    atomic_fetch_add(&h->buckets[bucketOf(micros)], 1);
+    long max = atomic_load(&h->max);
+    while (micros > max && !atomic_compare_exchange_weak(&h->max, &max, micros)) {
+        // max now holds the latest; try again if we are still bigger
+    }
+}
+
+/**************** bucketOf ****************/
+/* Return the bucket for micros: micros itself below 32; above, the power
+ * of two it falls in, and which sixteenth of that it is in.
+ */
+static int
+bucketOf(long micros)
+{
+    if (micros < 2 * SUB_BUCKETS) {
+        return micros;
+    }
+    if (micros >= (1L << MAX_BITS)) {
+        return NUM_BUCKETS - 1;
+    }
+    int msb = 63 - __builtin_clzl(micros);
+    return (msb - 3) * SUB_BUCKETS + (int)(micros >> (msb - 4)) - SUB_BUCKETS;
+}
+
+/**************** bucketTop ****************/
+/* Return the largest value that falls in bucket (see bucketOf). */
+static long
+bucketTop(const int bucket)
+{
+    if (bucket < 2 * SUB_BUCKETS) {
+        return bucket;
+    }
+    int msb = bucket / SUB_BUCKETS + 3;
+    long low = (long)(bucket % SUB_BUCKETS + SUB_BUCKETS) << (msb - 4);
+    return low + (1L << (msb - 4)) - 1;
+}
+
+/**************** percentile ****************/
+/* Return the value at fraction p of histogram h's count values (counting
+ * from the smallest), as the top of its bucket but no more than the max;
+ * 0 if h is empty.
+ */
+static long
+percentile(histogram_t* h, const long count, const double p)
+{
+    if (count == 0) {
+        return 0;
+    }
+    long rank = (long)(p * count + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    }
+    long seen = 0;
+    long max = atomic_load(&h->max);
+    for (int b = 0; b < NUM_BUCKETS; b++) {
+        seen += atomic_load(&h->buckets[b]);
+        if (seen >= rank) {
+            long top = bucketTop(b);
+            return top < max ? top : max;
+        }
+    }
+    return max;
+}
+
+/**************** put ****************/
+/* Append printf-style output to line, which holds len bytes of
+ * LINE_SIZE; output that does not fit is cut off.
+ */
+static void
+put(char* line, size_t* len, const char* fmt, ...)
+{
+    if (*len >= LINE_SIZE - 1) {
+        return;
+    }
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(line + *len, LINE_SIZE - *len, fmt, args);
+    va_end(args);
+    if (n > 0) {
+        *len += ((size_t)n < LINE_SIZE - *len) ? (size_t)n : LINE_SIZE - 1 - *len;
+    }
+}
@@ -0,0 +1,78 @@
+/*
+ * metrics.h - header file for the crawler's metrics
+ *
+ * The crawler counts what it does as it goes: pages fetched, found
+ * unchanged, failed, and saved; bytes fetched; duplicate links; URLs
+ * seen; and pages queued, at each depth. It also keeps a latency
+ * histogram of each phase of a fetch (DNS lookup, connect, first byte,
+ * body) and of saving a page. With --metrics, a thread writes all of it
+ * to a file as one line of JSON every so often, and again at the end,
+ * when a summary is also printed.
+ *
+ * The metrics are process-wide, like the resolver's cache. Every function
+ * but metrics_start and metrics_stop may be called from any thread, and
+ * does nothing until metrics_start is called.
+ *
+ * A histogram has a bucket for each value below 32 us; above that, 16
+ * buckets for each power of two, so any value reported (a percentile) is
+ * within 1/16 of one actually recorded.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#ifndef __METRICS_H
+#define __METRICS_H
+
+#include <stdbool.h>
+#include "../libcs50/webpage.h"
+
+/**************** functions ****************/
+
+/**************** metrics_start ****************/
+/* Start collecting metrics, and a thread that appends a snapshot of them
+ * to filename every everyMs ms. Processes may share the file: each line
+ * goes out in one write, and is marked with proc unless proc is -1.
+ * Call before starting any threads that record metrics.
+ * We return true on success; false if the file cannot be opened or the
+ * thread cannot start.
+ */
+bool metrics_start(const char* filename, const int everyMs, const int proc);
+
+/**************** metrics_stop ****************/
+/* Stop the snapshot thread, append a final snapshot, close the file, and
+ * print a summary to stdout. Call after every thread recording metrics
+ * has finished. Does nothing if metrics_start was not called.
+ */
+void metrics_stop(void);
+
+/**************** metrics_fetch ****************/
+/* Record one attempt to fetch page: fetched (true) or not, its status,
+ * and its timing (see webpage_getTiming).
+ */
+void metrics_fetch(const webpage_t* page, const bool fetched);
+
+/**************** metrics_clock ****************/
+/* Return a monotonic clock reading in microseconds, for metrics_saved. */
+long metrics_clock(void);
+
+/**************** metrics_saved ****************/
+/* Record one page saved, which took micros us. */
+void metrics_saved(const long micros);
+
+/**************** metrics_seen ****************/
+/* Record one more URL in the seen-set. */
+void metrics_seen(void);
+
+/**************** metrics_duplicate ****************/
+/* Record one link to a URL seen already. */
+void metrics_duplicate(void);
+
+/**************** metrics_queued ****************/
+/* Record one page queued at depth. */
+void metrics_queued(const int depth);
+
+/**************** metrics_dequeued ****************/
+/* Record one page at depth taken from the queue. */
+void metrics_dequeued(const int depth);
+
+#endif // __METRICS_H
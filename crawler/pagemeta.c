@@ -0,0 +1,338 @@
+/*
+ * pagemeta.c - the crawler's page metadata log
+ *
+ * see pagemeta.h for more information.
+ *
+ * Opening reads every line of the log into an array, then walks it
+ * backwards: the first line met for a URL, or for a docID, is the last
+ * one written. A line holds only if it is the last for both its URL and
+ * its docID; the others were overtaken by a later save (or, after a
+ * resumed crawl reused a docID, point at a page that is gone). The lines
+ * that hold are written to `.meta.tmp`, which is renamed over the log,
+ * and the log is then reopened for appending.
+ *
+ * Lookups go to a hashtable built at open and never changed after, so
+ * any number of threads may search it; appends are single fprintf calls,
+ * which stdio makes atomic with respect to each other.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#define _GNU_SOURCE       // getline, strdup
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "pagemeta.h"
+#include "../common/pagedir.h"
+#include "../libcs50/hashtable.h"
+
+/**************** file-local global variables ****************/
+static const char* META = ".meta";
+static const char* META_TMP = ".meta.tmp";
+static const char* MAGIC = "tse-pagemeta 1";
+static const char* NONE = "-";            // stands for a validator not sent
+
+/**************** global types ****************/
+/* one line of the log */
+typedef struct metarec {
+    int docID;
+    char* url;
+    char* etag;               // NULL if not sent
+    char* lastModified;       // NULL if not sent
+    bool holds;               // still true: see above
+} metarec_t;
+
+typedef struct pagemeta {
+    FILE* fp;                 // the log, open for appending
+    metarec_t* recs;          // every line read at open, in order
+    int numRecs;
+    hashtable_t* byURL;       // url -> its last metarec_t
+    int maxDocID;             // highest docID among the lines that hold
+} pagemeta_t;
+
+/**************** local functions ****************/
+static bool readLog(pagemeta_t* meta, const char* path, const int nextDocID);
+static bool parseLine(char* line, metarec_t* rec);
+static char* parseField(char** rest);
+static bool settle(pagemeta_t* meta);
+static bool writeLog(pagemeta_t* meta, const char* path, const char* tmpPath);
+static const char* field(const char* validator);
+
+/**************** pagemeta_open() ****************/
+/* see pagemeta.h for description */
+pagemeta_t*
+pagemeta_open(const char* pageDirectory, const int nextDocID)
+{
+    if (pageDirectory == NULL) {
+        return NULL;
+    }
+    pagemeta_t* meta = calloc(1, sizeof(pagemeta_t));
+    char* path = pagedir_path(pageDirectory, META);
+    char* tmpPath = pagedir_path(pageDirectory, META_TMP);
+    bool ok = (meta != NULL && path != NULL && tmpPath != NULL);
+
+    ok = ok && readLog(meta, path, nextDocID) && settle(meta);
+    ok = ok && writeLog(meta, path, tmpPath);
+    if (ok) {
+        meta->fp = fopen(path, "a");
+        ok = (meta->fp != NULL);
+    }
+    free(path);
+    free(tmpPath);
+    if (!ok) {
+        pagemeta_close(meta);
+        return NULL;
+    }
+    return meta;
+}
+
+/**************** pagemeta_find() ****************/
+/* see pagemeta.h for description */
+int
+pagemeta_find(pagemeta_t* meta, const char* url,
+              const char** etag, const char** lastModified)
+{
+    if (meta == NULL || url == NULL) {
+        return 0;
+    }
+    metarec_t* rec = hashtable_find(meta->byURL, url);
+    if (rec == NULL || !rec->holds) {
+        return 0;
+    }
+    if (etag != NULL) {
+        *etag = rec->etag;
+    }
+    if (lastModified != NULL) {
+        *lastModified = rec->lastModified;
+    }
+    return rec->docID;
+}
+
+/**************** pagemeta_maxDocID() ****************/
+/* see pagemeta.h for description */
+int
+pagemeta_maxDocID(pagemeta_t* meta)
+{
+    return (meta != NULL) ? meta->maxDocID : 0;
+}
+
+/**************** pagemeta_record() ****************/
+/* see pagemeta.h for description */
+bool
+pagemeta_record(pagemeta_t* meta, const int docID, const webpage_t* page)
+{
+    if (meta == NULL || page == NULL) {
+        return false;
+    }
+    // one call, so lines from different threads never interleave
+    int n = fprintf(meta->fp, "%d\t%s\t%s\t%s\n", docID, webpage_getURL(page),
+                    field(webpage_getETag(page)), field(webpage_getLastModified(page)));
+    return n > 0 && fflush(meta->fp) == 0;
+}
+
+/**************** pagemeta_close() ****************/
+/* see pagemeta.h for description */
+void
+pagemeta_close(pagemeta_t* meta)
+{
+    if (meta == NULL) {
+        return;
+    }
+    if (meta->fp != NULL) {
+        fclose(meta->fp);
+    }
+    hashtable_delete(meta->byURL, NULL);   // items point into recs
+    for (int i = 0; i < meta->numRecs; i++) {
+        free(meta->recs[i].url);
+        free(meta->recs[i].etag);
+        free(meta->recs[i].lastModified);
+    }
+    free(meta->recs);
+    free(meta);
+}
+
+/**************** readLog ****************/
+/* Read the lines of the log at path for docIDs below nextDocID into
+ * meta->recs, skipping any that are malformed (as a line cut short by a
+ * crash would be) or cannot be copied: a page without a record is only
+ * fetched in full. A missing log reads as empty. Returns false if out of
+ * memory, or if the file is not a log at all.
+ */
+static bool
+readLog(pagemeta_t* meta, const char* path, const int nextDocID)
+{
+    FILE* fp = (nextDocID > 1) ? fopen(path, "r") : NULL;
+    if (fp == NULL) {
+        return true;
+    }
+
+    char* line = NULL;
+    size_t size = 0;
+    ssize_t len;
+    int cap = 0;
+    bool ok = true;
+    for (int lineNum = 1; ok && (len = getline(&line, &size, fp)) > 0; lineNum++) {
+        if (line[len - 1] != '\n') {
+            break;                              // the last line, unfinished
+        }
+        line[--len] = '\0';
+        if (lineNum == 1) {
+            ok = (strcmp(line, MAGIC) == 0);
+            continue;
+        }
+
+        if (meta->numRecs == cap) {
+            cap = (cap == 0) ? 1024 : 2 * cap;
+            metarec_t* recs = realloc(meta->recs, cap * sizeof(metarec_t));
+            if (recs == NULL) {
+                ok = false;
+                break;
+            }
+            meta->recs = recs;
+        }
+        metarec_t* rec = &meta->recs[meta->numRecs];
+        if (parseLine(line, rec) && rec->docID < nextDocID) {
+            meta->numRecs++;
+        } else {
+            free(rec->url);
+            free(rec->etag);
+            free(rec->lastModified);
+        }
+    }
+    free(line);
+    fclose(fp);
+    return ok;
+}
+
+/**************** parseLine ****************/
+/* Parse one line of the log (without its newline) into rec, with copies
+ * of its strings. Returns false if it is malformed or out of memory;
+ * rec then holds whatever was copied (or NULLs), for the caller to free.
+ */
+static bool
+parseLine(char* line, metarec_t* rec)
+{
+    rec->url = rec->etag = rec->lastModified = NULL;
+    rec->holds = true;
+
+    char* rest = line;
+    char* docID = parseField(&rest);
+    char* url = parseField(&rest);
+    char* etag = parseField(&rest);
+    char* lastModified = parseField(&rest);
+    char extra;
+    if (lastModified == NULL || rest != NULL
+        || sscanf(docID, "%d%c", &rec->docID, &extra) != 1 || rec->docID < 1
+        || *url == '\0') {
+        return false;
+    }
+    rec->url = strdup(url);
+    if (strcmp(etag, NONE) != 0) {
+        rec->etag = strdup(etag);
+    }
+    if (strcmp(lastModified, NONE) != 0) {
+        rec->lastModified = strdup(lastModified);
+    }
+    return rec->url != NULL
+      && (rec->etag != NULL || strcmp(etag, NONE) == 0)
+      && (rec->lastModified != NULL || strcmp(lastModified, NONE) == 0);
+}
+
+/**************** parseField ****************/
+/* Return the next tab-separated field of *rest, terminating it, and
+ * advance *rest past its tab (to NULL after the last field); NULL if
+ * *rest is NULL already.
+ */
+static char*
+parseField(char** rest)
+{
+    char* start = *rest;
+    if (start == NULL) {
+        return NULL;
+    }
+    char* tab = strchr(start, '\t');
+    if (tab != NULL) {
+        *tab = '\0';
+        *rest = tab + 1;
+    } else {
+        *rest = NULL;
+    }
+    return start;
+}
+
+/**************** settle ****************/
+/* Decide which of meta->recs still hold (see above), index those by URL,
+ * and find the highest docID among them. Returns false if out of memory.
+ */
+static bool
+settle(pagemeta_t* meta)
+{
+    int maxDocID = 0;
+    for (int i = 0; i < meta->numRecs; i++) {
+        if (meta->recs[i].docID > maxDocID) {
+            maxDocID = meta->recs[i].docID;
+        }
+    }
+    bool* docIDTaken = calloc(maxDocID + 1, sizeof(bool));
+    meta->byURL = hashtable_new(meta->numRecs / 2 + 1);
+    if (docIDTaken == NULL || meta->byURL == NULL) {
+        free(docIDTaken);
+        return false;
+    }
+
+    // backwards, so the first line met for a URL or a docID is its last
+    for (int i = meta->numRecs - 1; i >= 0; i--) {
+        metarec_t* rec = &meta->recs[i];
+        bool lastForURL = hashtable_insert(meta->byURL, rec->url, rec);
+        rec->holds = lastForURL && !docIDTaken[rec->docID];
+        docIDTaken[rec->docID] = true;
+        if (rec->holds && rec->docID > meta->maxDocID) {
+            meta->maxDocID = rec->docID;
+        }
+    }
+    free(docIDTaken);
+    return true;
+}
+
+/**************** writeLog ****************/
+/* Write the lines of meta->recs that hold to tmpPath, and rename it over
+ * path. Returns false on error, leaving the log at path as it was.
+ */
+static bool
+writeLog(pagemeta_t* meta, const char* path, const char* tmpPath)
+{
+    FILE* fp = fopen(tmpPath, "w");
+    if (fp == NULL) {
+        return false;
+    }
+    fprintf(fp, "%s\n", MAGIC);
+    for (int i = 0; i < meta->numRecs; i++) {
+        metarec_t* rec = &meta->recs[i];
+        if (rec->holds) {
+            fprintf(fp, "%d\t%s\t%s\t%s\n", rec->docID, rec->url,
+                    field(rec->etag), field(rec->lastModified));
+        }
+    }
+    bool ok = (fflush(fp) == 0 && !ferror(fp));
+    ok = (fclose(fp) == 0) && ok;
+    ok = ok && rename(tmpPath, path) == 0;
+    if (!ok) {
+        remove(tmpPath);
+    }
+    return ok;
+}
+
+/**************** field ****************/
+/* Return how a validator is written in the log: as itself, or as NONE if
+ * it was not sent (or holds a tab or newline, which no server should send).
+ */
+static const char*
+field(const char* validator)
+{
+    if (validator == NULL || *validator == '\0' || strpbrk(validator, "\t\n") != NULL) {
+        return NONE;
+    }
+    return validator;
+}
@@ -0,0 +1,71 @@
+/*
+ * pagemeta.h - header file for the crawler's page metadata log
+ *
+ * For each page it saves, the crawler records the validators the server
+ * sent with it (its ETag and Last-Modified headers), so a later --recrawl
+ * can ask for the page only if it has changed and keep its docID if not.
+ * The records live in the file `.meta` in the pageDirectory, next to the
+ * page files, one line per save, with tabs between the fields:
+ *
+ *   tse-pagemeta 1
+ *   <docID> <url> <etag> <lastModified>     "-" for a validator not sent
+ *
+ * Saves only ever append; when the same URL or docID appears again, the
+ * later line wins. Opening the log rewrites it with just the lines that
+ * still hold, so it does not grow from one recrawl to the next.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#ifndef __PAGEMETA_H
+#define __PAGEMETA_H
+
+#include <stdbool.h>
+#include "../libcs50/webpage.h"
+
+/**************** global types ****************/
+typedef struct pagemeta pagemeta_t;  // opaque to users of the module
+
+/**************** functions ****************/
+
+/**************** pagemeta_open ****************/
+/* Open the log in pageDirectory, creating it if need be.
+ *
+ * Caller provides:
+ *   the pageDirectory, and the docID the crawl will hand out next:
+ *   records of docIDs from nextDocID up are dropped (with nextDocID 1
+ *   the log starts out empty).
+ * We return:
+ *   the log, or NULL on error.
+ * Caller is responsible for:
+ *   later calling pagemeta_close.
+ */
+pagemeta_t* pagemeta_open(const char* pageDirectory, const int nextDocID);
+
+/**************** pagemeta_find ****************/
+/* Return the docID the page for url was saved as when the log was
+ * opened, or 0 if none; if found, set *etag and *lastModified to its
+ * validators (NULL if not sent), which belong to the log. Records added
+ * since the open are not seen. Safe to call from several threads at once,
+ * and alongside pagemeta_record.
+ */
+int pagemeta_find(pagemeta_t* meta, const char* url,
+                  const char** etag, const char** lastModified);
+
+/**************** pagemeta_maxDocID ****************/
+/* Return the highest docID recorded when the log was opened, or 0. */
+int pagemeta_maxDocID(pagemeta_t* meta);
+
+/**************** pagemeta_record ****************/
+/* Record that page, with its current validators, was saved as docID.
+ * Safe to call from several threads at once, and from several processes
+ * that inherited the log across fork(): each record is one append.
+ * We return true on success; false on a write error.
+ */
+bool pagemeta_record(pagemeta_t* meta, const int docID, const webpage_t* page);
+
+/**************** pagemeta_close ****************/
+/* Close the log and free it. NULL is ignored. */
+void pagemeta_close(pagemeta_t* meta);
+
+#endif // __PAGEMETA_H
@@ -0,0 +1,217 @@
+/*
+ * pagemetatest.c - unit test for the pagemeta module
+ *
+ * Records pages in a log in a new directory under /tmp and checks that
+ * reopening it finds each URL's last docID and validators; that a later
+ * record for a URL, or for a docID, overtakes the earlier one and the
+ * log is rewritten without it; that records from the docID a resumed
+ * crawl goes on from are dropped; and that a line cut short by a crash
+ * is skipped, while a file that is not a log is refused. The directory
+ * is removed at the end.
+ *
+ * usage: pagemetatest
+ * Prints a line for each failed check, then a count; exits non-zero if
+ * any check failed.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#define _GNU_SOURCE              // mkdtemp, strdup
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include "../common/pagedir.h"
+#include "../libcs50/webpage.h"
+#include "pagemeta.h"
+
+/**************** file-local global variables ****************/
+static int checks = 0;
+static int failures = 0;
+static const char* A = "http://cs50tse.cs.dartmouth.edu/tse/a.html";
+static const char* B = "http://cs50tse.cs.dartmouth.edu/tse/b.html";
+static const char* C = "http://cs50tse.cs.dartmouth.edu/tse/c.html";
+static const char* D = "http://cs50tse.cs.dartmouth.edu/tse/d.html";
+static const char* E = "http://cs50tse.cs.dartmouth.edu/tse/e.html";
+
+/**************** local functions ****************/
+static void check(const bool ok, const char* what);
+static bool record(pagemeta_t* meta, const int docID, const char* url,
+                   const char* etag, const char* lastModified);
+static bool found(pagemeta_t* meta, const char* url, const int docID,
+                  const char* etag, const char* lastModified);
+static bool sameField(const char* got, const char* expected);
+static bool append(const char* dir, const char* text, const char* mode);
+static int countLines(const char* dir);
+
+/**************** main ****************/
+int main(void)
+{
+    char dir[] = "/tmp/pagemetatestXXXXXX";
+    if (mkdtemp(dir) == NULL) {
+        fprintf(stderr, "pagemetatest: could not make a directory in /tmp\n");
+        return 2;
+    }
+
+    // a first crawl saves three pages
+    pagemeta_t* meta = pagemeta_open(dir, 1);
+    check(meta != NULL, "open a new log");
+    check(pagemeta_maxDocID(meta) == 0 && pagemeta_find(meta, A, NULL, NULL) == 0,
+          "a new log is empty");
+    check(record(meta, 1, A, "\"e1\"", "Mon, 01 Dec 2025 10:00:00 GMT")
+          && record(meta, 2, B, NULL, NULL)
+          && record(meta, 3, C, "\"e3\"", NULL), "record");
+    pagemeta_close(meta);
+    check(countLines(dir) == 4, "log holds 3 records");
+
+    // a recrawl finds them, but not what it records itself
+    meta = pagemeta_open(dir, 4);
+    check(meta != NULL, "reopen");
+    check(found(meta, A, 1, "\"e1\"", "Mon, 01 Dec 2025 10:00:00 GMT")
+          && found(meta, B, 2, NULL, NULL) && found(meta, C, 3, "\"e3\"", NULL),
+          "find each page's docID and validators");
+    check(pagemeta_maxDocID(meta) == 3, "maxDocID");
+    check(pagemeta_find(meta, D, NULL, NULL) == 0, "find of a page never saved");
+    check(record(meta, 4, D, NULL, "Tue, 02 Dec 2025 10:00:00 GMT"), "record a new page");
+    check(pagemeta_find(meta, D, NULL, NULL) == 0, "records since the open unseen");
+    // A changed and is saved over; C moves to docID 5; docID 2 is reused for E
+    check(record(meta, 1, A, "\"e1b\"", NULL) && record(meta, 5, C, "\"e5\"", NULL)
+          && record(meta, 2, E, NULL, NULL), "record again");
+    pagemeta_close(meta);
+
+    meta = pagemeta_open(dir, 6);
+    check(meta != NULL, "reopen after overtaking records");
+    check(found(meta, A, 1, "\"e1b\"", NULL), "later record for a URL wins");
+    check(found(meta, C, 5, "\"e5\"", NULL), "a URL saved under a new docID");
+    check(pagemeta_find(meta, B, NULL, NULL) == 0 && found(meta, E, 2, NULL, NULL),
+          "later record for a docID wins");
+    check(found(meta, D, 4, NULL, "Tue, 02 Dec 2025 10:00:00 GMT"), "new page found");
+    check(pagemeta_maxDocID(meta) == 5, "maxDocID after overtaking");
+    pagemeta_close(meta);
+    check(countLines(dir) == 5, "log rewritten with the 4 records that hold");
+
+    // a resumed crawl going on from docID 5 drops the record of C
+    meta = pagemeta_open(dir, 5);
+    check(meta != NULL && pagemeta_find(meta, C, NULL, NULL) == 0
+          && pagemeta_maxDocID(meta) == 4, "records from nextDocID on dropped");
+    pagemeta_close(meta);
+    check(countLines(dir) == 4, "log rewritten without them");
+
+    // a malformed line, and a last line a crash cut short, are skipped
+    append(dir, "x\tnot a docID\t-\t-\n7\thttp://cs50tse.cs.dartmouth.edu/tse/f", "a");
+    meta = pagemeta_open(dir, 10);
+    check(meta != NULL && pagemeta_maxDocID(meta) == 4 && found(meta, D, 4, NULL,
+          "Tue, 02 Dec 2025 10:00:00 GMT"), "bad lines skipped");
+    pagemeta_close(meta);
+
+    // a file that is not a log is refused
+    append(dir, "not a log\n", "w");
+    check(pagemeta_open(dir, 10) == NULL, "not a log");
+
+    // a crawl from the seed starts the log afresh
+    meta = pagemeta_open(dir, 1);
+    check(meta != NULL && pagemeta_maxDocID(meta) == 0, "open at 1 empties the log");
+    pagemeta_close(meta);
+    check(countLines(dir) == 1, "log holds no records");
+
+    char* path = pagedir_path(dir, ".meta");
+    if (path != NULL) {
+        unlink(path);
+        free(path);
+    }
+    rmdir(dir);
+    printf("pagemetatest: %d checks, %d failed\n", checks, failures);
+    return failures == 0 ? 0 : 1;
+}
+
+/**************** check ****************/
+/* Count one check, and report it if it failed. */
+static void
+check(const bool ok, const char* what)
+{
+    checks++;
+    if (!ok) {
+        failures++;
+        printf("FAIL: %s\n", what);
+    }
+}
+
+/**************** record ****************/
+/* Record a page for url with the given validators (NULL: not sent) as
+ * docID; return what pagemeta_record does.
+ */
+static bool
+record(pagemeta_t* meta, const int docID, const char* url,
+       const char* etag, const char* lastModified)
+{
+    char* copy = strdup(url);
+    webpage_t* page = (copy != NULL) ? webpage_new(copy, 0, NULL) : NULL;
+    if (page == NULL) {
+        free(copy);
+        return false;
+    }
+    bool ok = webpage_setValidators(page, etag, lastModified)
+              && pagemeta_record(meta, docID, page);
+    webpage_delete(page);
+    return ok;
+}
+
+/**************** found ****************/
+/* Return true if meta finds url as docID, with the given validators. */
+static bool
+found(pagemeta_t* meta, const char* url, const int docID,
+      const char* etag, const char* lastModified)
+{
+    const char* gotETag = "unset";
+    const char* gotLastModified = "unset";
+    return pagemeta_find(meta, url, &gotETag, &gotLastModified) == docID
+           && sameField(gotETag, etag) && sameField(gotLastModified, lastModified);
+}
+
+/**************** sameField ****************/
+/* Return true if both are NULL, or both are the same string. */
+static bool
+sameField(const char* got, const char* expected)
+{
+    if (got == NULL || expected == NULL) {
+        return got == expected;
+    }
+    return strcmp(got, expected) == 0;
+}
+
+/**************** append ****************/
+/* Write text to dir/.meta, opened with mode; return false on error. */
+static bool
+append(const char* dir, const char* text, const char* mode)
+{
+    char* path = pagedir_path(dir, ".meta");
+    FILE* fp = (path != NULL) ? fopen(path, mode) : NULL;
+    free(path);
+    if (fp == NULL) {
+        return false;
+    }
+    fputs(text, fp);
+    return fclose(fp) == 0;
+}
+
+/**************** countLines ****************/
+/* Return the number of lines in dir/.meta, or -1 if it cannot be read. */
+static int
+countLines(const char* dir)
+{
+    char* path = pagedir_path(dir, ".meta");
+    FILE* fp = (path != NULL) ? fopen(path, "r") : NULL;
+    free(path);
+    if (fp == NULL) {
+        return -1;
+    }
+    int lines = 0;
+    int c;
+    while ((c = getc(fp)) != EOF) {
+        lines += (c == '\n');
+    }
+    fclose(fp);
+    return lines;
+}
@@ -0,0 +1,158 @@
+/*
+ * pagescan.c - the crawler's link scan of arriving pages
+ *
+ * see pagescan.h for more information.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include "pagescan.h"
+#include "metrics.h"
+
+/**************** local functions ****************/
+static void scanLink(void* arg, const char* href, size_t len);
+
+/**************** pagescan_begin() ****************/
+/* see pagescan.h for description */
+void
+pagescan_begin(pagescan_t* scan, webpage_t* page, const int maxDepth,
+               linkmemo_t* memo, void* arg,
+               bool (*addURL)(void* arg, char* url, const int depth),
+               void (*dupURL)(void* arg, const char* url))
+{
+    scan->page = page;
+    scan->links = NULL;
+    scan->started = false;
+    scan->memo = memo;
+    scan->dirLen = linkmemo_dirLen(webpage_getURL(page));
+    scan->arg = arg;
+    scan->addURL = addURL;
+    scan->dupURL = dupURL;
+    if (webpage_getDepth(page) < maxDepth) {
+        scan->links = linkscan_newRaw(scanLink, scan);
+        if (scan->links == NULL) {
+            fprintf(stderr, "Error: could not allocate link scanner\n");
+            exit(2);
+        }
+    }
+}
+
+/**************** pagescan_chunk() ****************/
+/* see pagescan.h for description */
+void
+pagescan_chunk(void* arg, const char* data, size_t len)
+{
+    pagescan_t* scan = arg;
+    if (scan->links == NULL) {
+        return;
+    }
+    if (!scan->started) {
+        printf("Scanning: %s\n", webpage_getURL(scan->page));
+        scan->started = true;
+    }
+    linkscan_feed(scan->links, data, len);
+}
+
+/**************** scanLink ****************/
+/* Link callback for a raw linkscan: arg is the pagescan_t*, and href
+ * (len characters) the link as written. If the memo has the link from a
+ * page in this directory, take what became of it from there: the same
+ * messages, and, for an internal URL, a duplicate, without resolving,
+ * normalizing, or looking in pagesSeen again. Otherwise resolve and
+ * normalize it, and if it is internal, hand it to addURL, which owns it
+ * from then on: addURL queues a new page if the URL has not been seen
+ * yet (printing "Added"), or frees it as a duplicate (printing "IgnDupl").
+ * Either way it is in pagesSeen now, and so noted in the memo.
+ */
+static void
+scanLink(void* arg, const char* href, size_t len)
+{
+    pagescan_t* scan = arg;
+    const char* base = webpage_getURL(scan->page);
+
+    linkmemo_kind_t kind;
+    const char* known = linkmemo_find(scan->memo, base, scan->dirLen, href, len, &kind);
+    if (known != NULL) {
+        if (kind == LINKMEMO_UNNORMAL) {
+            printf("IgnUnNormal: %s\n", known);
+        } else {
+            printf("Found: %s\n", known);
+            if (kind == LINKMEMO_EXTERNAL) {
+                printf("IgnExtrn: %s\n", known);
+            } else {
+                scan->dupURL(scan->arg, known);
+            }
+        }
+        return;
+    }
+
+    char* url = resolveURL(base, href, len);
+    if (url == NULL) {
+        return;
+    }
+
+    // normalize url in place; it is left as it was if that fails
+    if (!normalizeURLInto(url, url, strlen(url) + 1)) {
+        printf("IgnUnNormal: %s\n", url);
+        linkmemo_add(scan->memo, base, scan->dirLen, href, len, url, LINKMEMO_UNNORMAL);
+        free(url);
+        return;
+    }
+
+    printf("Found: %s\n", url);
+
+    if (!isInternalURL(url)) {
+        printf("IgnExtrn: %s\n", url);
+        linkmemo_add(scan->memo, base, scan->dirLen, href, len, url, LINKMEMO_EXTERNAL);
+        free(url);
+        return;
+    }
+
+    // internal URL; addURL prints Added/IgnDupl and owns url from here on
+    linkmemo_add(scan->memo, base, scan->dirLen, href, len, url, LINKMEMO_SEEN);
+    scan->addURL(scan->arg, url, webpage_getDepth(scan->page) + 1);
+}
+
+/**************** pagescan_end() ****************/
+/* see pagescan.h for description */
+void
+pagescan_end(pagescan_t* scan)
+{
+    linkscan_delete(scan->links);
+    scan->links = NULL;
+}
+
+/**************** pagescan_fetch() ****************/
+/* see pagescan.h for description */
+bool
+pagescan_fetch(politeness_t* polite, webpage_t* page, pagescan_t* scan)
+{
+    const char* url = webpage_getURL(page);
+    for (int attempt = 0; attempt < PAGESCAN_MAX_TRY; attempt++) {
+        politeness_wait(polite, url);
+        linkscan_reset(scan->links);
+        bool fetched = webpage_fetchStream(page, pagescan_chunk, scan);
+        metrics_fetch(page, fetched);
+        if (fetched) {
+            return true;
+        }
+        if (!pagescan_isTransient(page)) {
+            return false;
+        }
+        politeness_backoff(polite, url, attempt);
+    }
+    return false;
+}
+
+/**************** pagescan_isTransient() ****************/
+/* see pagescan.h for description */
+bool
+pagescan_isTransient(const webpage_t* page)
+{
+    int status = webpage_getStatus(page);
+    return status == 0 || status == 429 || status >= 500;
+}
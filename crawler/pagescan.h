@@ -0,0 +1,82 @@
+/*
+ * pagescan.h - header file for the crawler's link scan of arriving pages
+ *
+ * A *pagescan* follows one page while it is being fetched: the fetch
+ * hands it each piece of the body as it is parsed (pagescan_chunk), and
+ * it feeds them to a link scanner, which finds each link as soon as it
+ * is complete. An internal URL goes to the crawl mode's addURL, which
+ * queues it if it is new; one the memo knows is seen already goes to its
+ * dupURL. pagescan_fetch fetches a page into its scan politely, with
+ * retries. Each crawl mode supplies its own addURL and dupURL.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#ifndef __PAGESCAN_H
+#define __PAGESCAN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "../libcs50/webpage.h"
+#include "../libcs50/linkscan.h"
+#include "politeness.h"
+#include "linkmemo.h"
+
+/**************** global types ****************/
+/* a page's link scan, fed the page while it is being fetched */
+typedef struct pagescan {
+    webpage_t* page;
+    linkscan_t* links;           // NULL if the page is at maxDepth
+    bool started;                // "Scanning" printed already
+    linkmemo_t* memo;            // links handled before, by this thread
+    size_t dirLen;               // of the page's directory, for the memo
+    void* arg;                   // passed to addURL and dupURL
+    bool (*addURL)(void* arg, char* url, const int depth);
+    void (*dupURL)(void* arg, const char* url);
+} pagescan_t;
+
+/**************** global constants ****************/
+#define PAGESCAN_MAX_TRY 3       // fetch attempts per page
+
+/**************** functions ****************/
+
+/**************** pagescan_begin ****************/
+/* Set scan up for page, which is about to be fetched: unless the page is
+ * at maxDepth, each internal URL in it will be handed to
+ * addURL(arg, url, depth+1) as soon as it arrives, or, if memo knows it
+ * is in pagesSeen already, to dupURL(arg, url) (see pagescan.c).
+ * Exits non-zero if out of memory.
+ */
+void pagescan_begin(pagescan_t* scan, webpage_t* page, const int maxDepth,
+                    linkmemo_t* memo, void* arg,
+                    bool (*addURL)(void* arg, char* url, const int depth),
+                    void (*dupURL)(void* arg, const char* url));
+
+/**************** pagescan_chunk ****************/
+/* Body sink for a fetch: arg is the pagescan_t*. Feed the next piece of
+ * the page to its link scanner, if it has one.
+ */
+void pagescan_chunk(void* arg, const char* data, size_t len);
+
+/**************** pagescan_end ****************/
+/* Free what pagescan_begin allocated. */
+void pagescan_end(pagescan_t* scan);
+
+/**************** pagescan_fetch ****************/
+/* Fetch page once its host's politeness budget allows, feeding it to
+ * scan as it arrives. After a transient failure, back off and try again,
+ * up to PAGESCAN_MAX_TRY fetches in all; each retry waits for the slot the
+ * scheduler gives it, so the backoff delays only this host, and starts
+ * the scan over. Return true iff the page was fetched.
+ */
+bool pagescan_fetch(politeness_t* polite, webpage_t* page, pagescan_t* scan);
+
+/**************** pagescan_isTransient ****************/
+/* Is the page's failed fetch worth retrying? Yes if no response came at
+ * all (connection refused or timed out), or if the server reported
+ * trouble of its own (5xx) or asked us to slow down (429); no if it
+ * answered for good, as with 404.
+ */
+bool pagescan_isTransient(const webpage_t* page);
+
+#endif // __PAGESCAN_H
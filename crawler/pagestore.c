@@ -0,0 +1,284 @@
+/*
+ * pagestore.c - where the crawler saves pages
+ *
+ * see pagestore.h for more information.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <limits.h>
+#include "../common/pagedir.h"
+#include "../common/index.h"
+#include "pagestore.h"
+#include "metrics.h"
+
+/**************** file-local global variables ****************/
+static const int INDEX_THREADS = 2;      // threads indexing pages for --index
+static const int INDEX_QUEUE = 64;       // pages waiting to be indexed, at most
+static const int WRITE_QUEUE = 64;       // pages waiting to be saved, at most
+
+/**************** local functions ****************/
+static indexpipe_t* indexNew(const crawlopts_t* opts, const char* pageDirectory,
+                             const int nextDocID);
+static void checkpointSeen(void* arg, const uint64_t fp);
+
+/**************** pagestore_openMeta() ****************/
+/* see pagestore.h for description */
+pagemeta_t*
+pagestore_openMeta(const crawlopts_t* opts, const char* pageDirectory, int* nextDocID)
+{
+    bool again = opts->recrawl && *nextDocID == 1;
+    pagemeta_t* meta = pagemeta_open(pageDirectory, again ? INT_MAX : *nextDocID);
+    if (meta == NULL) {
+        fprintf(stderr, "Error: could not open the page metadata in '%s'\n",
+                pageDirectory);
+        exit(2);
+    }
+    if (again) {
+        *nextDocID = pagemeta_maxDocID(meta) + 1;
+        printf("Recrawling: next docID %d\n", *nextDocID);
+    }
+    return meta;
+}
+
+/**************** pagestore_openPack() ****************/
+/* see pagestore.h for description */
+pagepack_t*
+pagestore_openPack(const crawlopts_t* opts, const char* pageDirectory,
+                   const int nextDocID)
+{
+    if (!opts->pack) {
+        if (nextDocID == 1) {
+            pagepack_remove(pageDirectory);
+        }
+        return NULL;
+    }
+    pagepack_t* pack = pagepack_create(pageDirectory, nextDocID);
+    if (pack == NULL) {
+        fprintf(stderr, "Error: could not open the pack in '%s'\n", pageDirectory);
+        exit(2);
+    }
+    return pack;
+}
+
+/**************** indexNew ****************/
+/* With --index, return a pipeline to index the pages of the crawl as they
+ * are saved; otherwise NULL. A crawl resumed at nextDocID first queues
+ * the pages saved before, so the index covers them too. Exits non-zero on
+ * error.
+ */
+static indexpipe_t*
+indexNew(const crawlopts_t* opts, const char* pageDirectory, const int nextDocID)
+{
+    if (opts->indexFile == NULL) {
+        return NULL;
+    }
+    indexpipe_t* index = indexpipe_new(INDEX_THREADS, INDEX_QUEUE);
+    if (index == NULL) {
+        fprintf(stderr, "Error: could not start the index pipeline\n");
+        exit(2);
+    }
+    if (nextDocID > 1) {
+        pagepack_t* pages = pagepack_open(pageDirectory);
+        for (int docID = 1; docID < nextDocID; docID++) {
+            webpage_t* page = pagepack_load(pages, docID);
+            if (page != NULL) {
+                indexpipe_add(index, page, docID);
+                webpage_delete(page);
+            }
+        }
+        pagepack_close(pages);
+    }
+    return index;
+}
+
+/**************** pagestore_open() ****************/
+/* see pagestore.h for description */
+void
+pagestore_open(pagestore_t* store, const crawlopts_t* opts, const char* pageDirectory,
+               int* nextDocID, const crawlpart_t* part)
+{
+    store->pageDirectory = pageDirectory;
+    if (part != NULL) {
+        // a --procs process: the parent opened the log for all of them
+        store->meta = part->meta;
+        store->pack = NULL;
+    } else {
+        store->meta = opts->keepPages
+            ? pagestore_openMeta(opts, pageDirectory, nextDocID) : NULL;
+        store->pack = opts->keepPages
+            ? pagestore_openPack(opts, pageDirectory, *nextDocID) : NULL;
+    }
+    store->writer = NULL;
+    if (opts->keepPages) {
+        store->writer = pagewriter_new(pageDirectory, store->pack, store->meta,
+                                       opts->codec, opts->fsync, opts->io, WRITE_QUEUE);
+        if (store->writer == NULL) {
+            fprintf(stderr, "Error: could not start the page writer\n");
+            exit(2);
+        }
+    }
+    store->index = indexNew(opts, pageDirectory, *nextDocID);
+    store->aliases = NULL;
+    if (opts->nearDup >= 0) {
+        // a fresh crawl will find its aliases again; the rest append
+        char* path = pagedir_path(pageDirectory, ".aliases");
+        if (path != NULL) {
+            store->aliases = fopen(path, (*nextDocID == 1) ? "w" : "a");
+        }
+        if (store->aliases == NULL) {
+            fprintf(stderr, "Error: could not open '%s/.aliases'\n", pageDirectory);
+            exit(2);
+        }
+        free(path);
+    }
+    store->checkpoint = NULL;
+    if (opts->checkpointEvery > 0) {
+        store->checkpoint = checkpoint_new(pageDirectory);
+        if (store->checkpoint == NULL) {
+            fprintf(stderr, "Error: could not open the checkpoint in '%s'\n",
+                    pageDirectory);
+            exit(2);
+        }
+    }
+}
+
+/**************** pagestore_close() ****************/
+/* see pagestore.h for description */
+void
+pagestore_close(pagestore_t* store, const crawlopts_t* opts)
+{
+    pagewriter_finish(store->writer);
+    checkpoint_delete(store->checkpoint);
+    if (store->aliases != NULL) {
+        fclose(store->aliases);
+    }
+    pagepack_close(store->pack);
+    pagemeta_close(store->meta);
+    if (store->index == NULL) {
+        return;
+    }
+    index_t* index = indexpipe_finish(store->index);
+    FILE* fp = fopen(opts->indexFile, "w");
+    if (index == NULL || fp == NULL) {
+        fprintf(stderr, "Error: could not write the index to '%s'\n", opts->indexFile);
+        exit(2);
+    }
+    index_save(index, fp);
+    fclose(fp);
+    index_delete(index);
+    printf("Indexed: %s\n", opts->indexFile);
+}
+
+/**************** pagestore_save() ****************/
+/* see pagestore.h for description */
+void
+pagestore_save(pagestore_t* store, webpage_t* page, const int docID)
+{
+    long start = metrics_clock();
+    if (store->index != NULL && !indexpipe_add(store->index, page, docID)) {
+        fprintf(stderr, "Warning: could not index %s\n", webpage_getURL(page));
+    }
+    if (store->writer != NULL && !pagewriter_add(store->writer, page, docID)) {
+        fprintf(stderr, "Warning: could not save %s\n", webpage_getURL(page));
+    }
+    metrics_saved(metrics_clock() - start);
+}
+
+/**************** pagestore_nearDups() ****************/
+/* see pagestore.h for description */
+simindex_t*
+pagestore_nearDups(const crawlopts_t* opts, const char* pageDirectory,
+                   const int nextDocID)
+{
+    if (opts->nearDup < 0) {
+        return NULL;
+    }
+    simindex_t* nearDups = simindex_new(opts->nearDup);
+    if (nearDups == NULL) {
+        fprintf(stderr, "Error: could not allocate near-duplicate index\n");
+        exit(2);
+    }
+
+    pagepack_t* pages = pagepack_open(pageDirectory);
+    for (int docID = 1; docID < nextDocID; docID++) {
+        webpage_t* page = pagepack_load(pages, docID);
+        if (page != NULL) {
+            simindex_add(nearDups, simhash_page(page), docID);
+            webpage_delete(page);
+        }
+    }
+    pagepack_close(pages);
+    return nearDups;
+}
+
+/**************** pagestore_findNearDup() ****************/
+/* see pagestore.h for description */
+int
+pagestore_findNearDup(simindex_t* nearDups, webpage_t* page, const uint64_t fp,
+                      pagestore_t* store)
+{
+    int original = simindex_find(nearDups, fp);
+    if (original == 0) {
+        return 0;
+    }
+    pagewriter_flush(store->writer);
+    webpage_t* saved = (store->pack != NULL)
+        ? pagepack_load(store->pack, original)
+        : pagedir_load(store->pageDirectory, original);
+    bool confirmed = simhash_confirm(page, saved);
+    if (saved != NULL) {
+        webpage_delete(saved);
+    }
+    if (!confirmed) {
+        return 0;
+    }
+    printf("NearDup: %s (docID %d)\n", webpage_getURL(page), original);
+    fprintf(store->aliases, "%d %s\n", original, webpage_getURL(page));
+    return original;
+}
+
+/**************** pagestore_checkpointBegin() ****************/
+/* see pagestore.h for description */
+checkpoint_t*
+pagestore_checkpointBegin(pagestore_t* store, const int nextDocID, seenset_t* pagesSeen)
+{
+    checkpoint_t* cp = store->checkpoint;
+    checkpoint_begin(cp, nextDocID);
+    seenset_takeNew(pagesSeen, cp, checkpointSeen);
+    return cp;
+}
+
+/**************** checkpointSeen ****************/
+/* seenset_takeNew callback: arg is the checkpoint_t*. */
+static void
+checkpointSeen(void* arg, const uint64_t fp)
+{
+    checkpoint_seen(arg, fp);
+}
+
+/**************** pagestore_checkpointPage() ****************/
+/* see pagestore.h for description */
+void
+pagestore_checkpointPage(void* arg, webpage_t* page)
+{
+    checkpoint_page(arg, webpage_getURL(page), webpage_getDepth(page));
+}
+
+/**************** pagestore_checkpointEnd() ****************/
+/* see pagestore.h for description */
+void
+pagestore_checkpointEnd(checkpoint_t* cp, pagestore_t* store)
+{
+    pagewriter_flush(store->writer);
+    if (store->aliases != NULL) {
+        fflush(store->aliases);     // the aliases of pages fetched before it
+    }
+    if (!checkpoint_commit(cp)) {
+        fprintf(stderr, "Warning: could not write a checkpoint in '%s'\n",
+                store->pageDirectory);
+    }
+}
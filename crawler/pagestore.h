@@ -0,0 +1,133 @@
+/*
+ * pagestore.h - header file for where the crawler saves pages
+ *
+ * A *pagestore* is where each page a crawl saves goes: its page writer
+ * (in a pack with --pack, a file each without), the log of the pages'
+ * validators, and the index pipeline with --index. It also holds the
+ * crawl's checkpoints, which vouch for the pages saved, and the .aliases
+ * of --near-dup, so the glue for both lives here too.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#ifndef __PAGESTORE_H
+#define __PAGESTORE_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "../libcs50/webpage.h"
+#include "../common/pagepack.h"
+#include "crawlopts.h"
+#include "pagewriter.h"
+#include "pagemeta.h"
+#include "indexpipe.h"
+#include "checkpoint.h"
+#include "seenset.h"
+#include "simhash.h"
+
+/**************** global types ****************/
+/* where each page saved goes: the page directory, and the index if any */
+typedef struct pagestore {
+    const char* pageDirectory;
+    pagewriter_t* writer;        // saves pages (NULL: --no-pages)
+    pagepack_t* pack;            // where pages go (NULL: a file each)
+    pagemeta_t* meta;            // validators of the pages saved (NULL: --no-pages)
+    indexpipe_t* index;          // indexes pages as they are saved (NULL: no --index)
+    checkpoint_t* checkpoint;    // the crawl's checkpoints (NULL: --checkpoint 0)
+    FILE* aliases;               // .aliases, for --near-dup (NULL: off)
+} pagestore_t;
+
+/**************** functions ****************/
+
+/**************** pagestore_openMeta ****************/
+/* Return the log of the validators of the pages saved (see pagemeta.h),
+ * opened to go on at *nextDocID, which drops the records of any pages a
+ * resumed crawl saved after its checkpoint. A fresh crawl starts the log
+ * anew; a fresh --recrawl keeps all of it, and moves *nextDocID past the
+ * pages it records, so only pages not seen before get new docIDs.
+ * Exits non-zero on error.
+ */
+pagemeta_t* pagestore_openMeta(const crawlopts_t* opts, const char* pageDirectory,
+                               int* nextDocID);
+
+/**************** pagestore_openPack ****************/
+/* Return the pack that --pack saves pages in, opened to go on at
+ * nextDocID (which drops any entries a resumed crawl saved after its
+ * checkpoint), or NULL without --pack; a fresh crawl without it removes
+ * any pack an earlier crawl left in pageDirectory, so readers look for
+ * page files instead. Exits non-zero on error.
+ */
+pagepack_t* pagestore_openPack(const crawlopts_t* opts, const char* pageDirectory,
+                               const int nextDocID);
+
+/**************** pagestore_open ****************/
+/* Set up store to save the pages of a crawl in pageDirectory, starting at
+ * *nextDocID (which pagestore_openMeta may move; see there), or those of
+ * a --procs process's part of one, and start its page writer. Exits
+ * non-zero on error.
+ * Caller is responsible for:
+ *   later calling pagestore_close.
+ */
+void pagestore_open(pagestore_t* store, const crawlopts_t* opts,
+                    const char* pageDirectory, int* nextDocID, const crawlpart_t* part);
+
+/**************** pagestore_close ****************/
+/* Wait for the last pages to be saved; with --index, wait for them to be
+ * indexed too, and write the index to opts->indexFile.
+ */
+void pagestore_close(pagestore_t* store, const crawlopts_t* opts);
+
+/**************** pagestore_save ****************/
+/* Queue page to be saved as docID by the store's writer: in its pack, or
+ * in its own file if it has none, with its validators then recorded in
+ * the store's meta. The writer takes the page's HTML, so that is the
+ * last use of it. With --no-pages, do neither. With --index, first queue
+ * a copy of the page to be indexed. The time that takes, including any
+ * wait for room in either queue, goes into the metrics.
+ */
+void pagestore_save(pagestore_t* store, webpage_t* page, const int docID);
+
+/**************** pagestore_nearDups ****************/
+/* Return a new simindex for --near-dup, or NULL if it is off. A crawl
+ * resumed (or recrawling) at nextDocID first indexes the pages saved
+ * before. Exits non-zero on error.
+ */
+simindex_t* pagestore_nearDups(const crawlopts_t* opts, const char* pageDirectory,
+                               const int nextDocID);
+
+/**************** pagestore_findNearDup ****************/
+/* If page, whose SimHash is fp, nearly duplicates a page already saved,
+ * record it as an alias of that page (a "docID URL" line in the store's
+ * .aliases) and return that page's docID; otherwise, or if nearDups is
+ * NULL, return 0. A SimHash match is only a candidate: the page must
+ * also pass simhash_confirm against the candidate's saved copy, read
+ * back once the store's writer has saved every page queued. A candidate
+ * whose copy cannot be read is taken as no match, since keeping a page
+ * is the safe mistake.
+ */
+int pagestore_findNearDup(simindex_t* nearDups, webpage_t* page, const uint64_t fp,
+                          pagestore_t* store);
+
+/**************** pagestore_checkpointBegin ****************/
+/* Start one of the store's checkpoints with the given next docID, logging
+ * the URLs added to pagesSeen since the last one; the caller adds the
+ * waiting pages and calls pagestore_checkpointEnd.
+ */
+checkpoint_t* pagestore_checkpointBegin(pagestore_t* store, const int nextDocID,
+                                        seenset_t* pagesSeen);
+
+/**************** pagestore_checkpointPage ****************/
+/* frontier_iterate callback: arg is the checkpoint_t*; add page to it as
+ * a page still to be fetched.
+ */
+void pagestore_checkpointPage(void* arg, webpage_t* page);
+
+/**************** pagestore_checkpointEnd ****************/
+/* Commit the checkpoint, once the store's writer has saved every page
+ * queued, since the checkpoint vouches for them; a failure costs only a
+ * warning, since the crawl itself can go on.
+ */
+void pagestore_checkpointEnd(checkpoint_t* cp, pagestore_t* store);
+
+#endif // __PAGESTORE_H
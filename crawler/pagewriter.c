@@ -0,0 +1,403 @@
+/*
+ * pagewriter.c - the crawler's page writer
+ *
+ * see pagewriter.h for more information.
+ *
+ * The queue is a circular array guarded by one mutex, as in indexpipe.c:
+ * "not empty" wakes the writer thread, "not full" the crawler threads
+ * waiting for room. The writer takes every page waiting in one go, which
+ * frees the whole queue at once, and saves them outside the lock; "saved"
+ * is signaled when it has done, for pagewriter_flush. Pages are encoded
+ * (compressed) on the writer thread as well.
+ *
+ * With pages a file each, a batch is saved through a pagedir batch, which
+ * with --io uring opens all of its files with one system call, and writes
+ * and closes them with another (see pagedir_batchNew); and the batch
+ * policy syncs with one syncfs on the page directory, rather than an
+ * fsync per file.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#define _GNU_SOURCE       // strdup, syncfs
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "pagewriter.h"
+
+/**************** file-local global variables ****************/
+static atomic_long totalPages;            // of writers finished so far
+static atomic_long totalBatches;
+static atomic_long totalWaits;
+
+/**************** global types ****************/
+/* a page waiting to be saved */
+typedef struct writeitem {
+    webpage_t* page;          // the writer's own, holding the crawl's HTML
+    int docID;
+} writeitem_t;
+
+typedef struct pagewriter {
+    const char* pageDirectory;
+    int dirFd;                // pageDirectory, for syncfs
+    pagepack_t* pack;         // NULL: a file each
+    pagedir_batch_t* io;      // saves a file each (NULL with a pack)
+    pagemeta_t* meta;
+    pagedir_codec_t codec;
+    pagewriter_sync_t sync;
+    writeitem_t* items;       // circular array of items[capacity]
+    int capacity;
+    int head;                 // index of the oldest item
+    int count;                // number of items waiting
+    int saving;               // number of items taken and not yet saved
+    bool closing;             // no more will come; set by pagewriter_finish
+    long pages, batches, waits;
+    pthread_mutex_t lock;     // protects items through waits
+    pthread_cond_t notEmpty;  // signaled when an item arrives or closing is set
+    pthread_cond_t notFull;   // signaled when items are taken
+    pthread_cond_t saved;     // signaled when a batch is saved
+    pthread_t thread;
+    // the writer thread's own: the batch being saved
+    writeitem_t* batch;       // batch[capacity]
+    char** files;             // their page files, for the pack
+    size_t* fileLens;
+    int* docIDs;
+    webpage_t** batchPages;   // their pages, for the page files
+    bool* ok;                 // whether each page of the batch was saved
+} pagewriter_t;
+
+/**************** local functions ****************/
+static void* writerRun(void* arg);
+static void saveBatch(pagewriter_t* writer, const int n);
+static bool packBatch(pagewriter_t* writer, const int first, const int n);
+static webpage_t* takePage(webpage_t* page);
+static void freeWriter(pagewriter_t* writer);
+
+/**************** pagewriter_new() ****************/
+/* see pagewriter.h for description */
+pagewriter_t*
+pagewriter_new(const char* pageDirectory, pagepack_t* pack, pagemeta_t* meta,
+               const pagedir_codec_t codec, const pagewriter_sync_t sync,
+               const pagedir_io_t io, const int capacity)
+{
+    if (pageDirectory == NULL || capacity < 1) {
+        return NULL;
+    }
+    pagewriter_t* writer = calloc(1, sizeof(pagewriter_t));
+    if (writer == NULL) {
+        return NULL;
+    }
+    writer->items = calloc(capacity, sizeof(writeitem_t));
+    writer->batch = calloc(capacity, sizeof(writeitem_t));
+    writer->files = calloc(capacity, sizeof(char*));
+    writer->fileLens = calloc(capacity, sizeof(size_t));
+    writer->docIDs = calloc(capacity, sizeof(int));
+    writer->batchPages = calloc(capacity, sizeof(webpage_t*));
+    writer->ok = calloc(capacity, sizeof(bool));
+    writer->dirFd = open(pageDirectory, O_RDONLY);
+    if (pack == NULL) {
+        writer->io = pagedir_batchNew(capacity, io);
+    }
+    if (writer->items == NULL || writer->batch == NULL || writer->files == NULL
+        || writer->fileLens == NULL || writer->docIDs == NULL || writer->batchPages == NULL
+        || writer->ok == NULL || writer->dirFd < 0 || (pack == NULL && writer->io == NULL)) {
+        freeWriter(writer);
+        return NULL;
+    }
+    writer->pageDirectory = pageDirectory;
+    writer->pack = pack;
+    writer->meta = meta;
+    writer->codec = codec;
+    writer->sync = sync;
+    writer->capacity = capacity;
+    pthread_mutex_init(&writer->lock, NULL);
+    pthread_cond_init(&writer->notEmpty, NULL);
+    pthread_cond_init(&writer->notFull, NULL);
+    pthread_cond_init(&writer->saved, NULL);
+
+    if (pthread_create(&writer->thread, NULL, writerRun, writer) != 0) {
+        pthread_cond_destroy(&writer->saved);
+        pthread_cond_destroy(&writer->notFull);
+        pthread_cond_destroy(&writer->notEmpty);
+        pthread_mutex_destroy(&writer->lock);
+        freeWriter(writer);
+        return NULL;
+    }
+    return writer;
+}
+
+/**************** pagewriter_policy() ****************/
+/* see pagewriter.h for description */
+bool
+pagewriter_policy(const char* name, pagewriter_sync_t* sync)
+{
+    if (name == NULL || sync == NULL) {
+        return false;
+    } else if (strcmp(name, "none") == 0) {
+        *sync = PAGEWRITER_NONE;
+    } else if (strcmp(name, "batch") == 0) {
+        *sync = PAGEWRITER_BATCH;
+    } else if (strcmp(name, "page") == 0) {
+        *sync = PAGEWRITER_PAGE;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**************** pagewriter_add() ****************/
+/* see pagewriter.h for description */
+bool
+pagewriter_add(pagewriter_t* writer, webpage_t* page, const int docID)
+{
+    if (writer == NULL || page == NULL) {
+        return false;
+    }
+    // take the HTML outside the lock, so other threads may queue meanwhile
+    webpage_t* copy = takePage(page);
+    if (copy == NULL) {
+        return false;
+    }
+
+    pthread_mutex_lock(&writer->lock);
+    if (writer->count == writer->capacity) {
+        writer->waits++;
+        while (writer->count == writer->capacity) {
+            pthread_cond_wait(&writer->notFull, &writer->lock);
+        }
+    }
+    writeitem_t* item = &writer->items[(writer->head + writer->count) % writer->capacity];
+    item->page = copy;
+    item->docID = docID;
+    writer->count++;
+    pthread_cond_signal(&writer->notEmpty);
+    pthread_mutex_unlock(&writer->lock);
+    return true;
+}
+
+/**************** pagewriter_flush() ****************/
+/* see pagewriter.h for description */
+void
+pagewriter_flush(pagewriter_t* writer)
+{
+    if (writer == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&writer->lock);
+    while (writer->count > 0 || writer->saving > 0) {
+        pthread_cond_wait(&writer->saved, &writer->lock);
+    }
+    pthread_mutex_unlock(&writer->lock);
+}
+
+/**************** pagewriter_stats() ****************/
+/* see pagewriter.h for description */
+void
+pagewriter_stats(long* pages, long* batches, long* waits)
+{
+    if (pages != NULL) {
+        *pages = atomic_load(&totalPages);
+    }
+    if (batches != NULL) {
+        *batches = atomic_load(&totalBatches);
+    }
+    if (waits != NULL) {
+        *waits = atomic_load(&totalWaits);
+    }
+}
+
+/**************** pagewriter_finish() ****************/
+/* see pagewriter.h for description */
+void
+pagewriter_finish(pagewriter_t* writer)
+{
+    if (writer == NULL) {
+        return;
+    }
+    // the writer thread drains the queue before it sees closing
+    pthread_mutex_lock(&writer->lock);
+    writer->closing = true;
+    pthread_cond_signal(&writer->notEmpty);
+    pthread_mutex_unlock(&writer->lock);
+    pthread_join(writer->thread, NULL);
+
+    atomic_fetch_add(&totalPages, writer->pages);
+    atomic_fetch_add(&totalBatches, writer->batches);
+    atomic_fetch_add(&totalWaits, writer->waits);
+    pthread_cond_destroy(&writer->saved);
+    pthread_cond_destroy(&writer->notFull);
+    pthread_cond_destroy(&writer->notEmpty);
+    pthread_mutex_destroy(&writer->lock);
+    freeWriter(writer);
+}
+
+/**************** writerRun ****************/
+/* Thread body of the writer thread (arg is the pagewriter_t): save the
+ * pages in the queue, all that are waiting at a time, until the queue is
+ * empty and closing.
+ */
+static void*
+writerRun(void* arg)
+{
+    pagewriter_t* writer = arg;
+
+    while (true) {
+        pthread_mutex_lock(&writer->lock);
+        while (writer->count == 0 && !writer->closing) {
+            pthread_cond_wait(&writer->notEmpty, &writer->lock);
+        }
+        int n = writer->count;
+        if (n == 0) {
+            pthread_mutex_unlock(&writer->lock);
+            return NULL;            // closing, and nothing left
+        }
+        for (int i = 0; i < n; i++) {
+            writer->batch[i] = writer->items[(writer->head + i) % writer->capacity];
+        }
+        writer->head = (writer->head + n) % writer->capacity;
+        writer->count = 0;
+        writer->saving = n;
+        pthread_cond_broadcast(&writer->notFull);
+        pthread_mutex_unlock(&writer->lock);
+
+        saveBatch(writer, n);
+
+        pthread_mutex_lock(&writer->lock);
+        writer->saving = 0;
+        writer->pages += n;
+        writer->batches++;
+        pthread_cond_broadcast(&writer->saved);
+        pthread_mutex_unlock(&writer->lock);
+    }
+}
+
+/**************** saveBatch ****************/
+/* Save the first n pages of writer->batch, sync them as writer->sync
+ * says, record the validators of those saved, and delete them all.
+ */
+static void
+saveBatch(pagewriter_t* writer, const int n)
+{
+    bool each = (writer->sync == PAGEWRITER_PAGE);
+    bool* ok = writer->ok;
+    if (writer->pack != NULL && !each) {
+        bool packed = packBatch(writer, 0, n);
+        for (int i = 0; i < n; i++) {
+            ok[i] = packed;
+        }
+    } else if (writer->pack != NULL) {
+        for (int i = 0; i < n; i++) {
+            ok[i] = packBatch(writer, i, 1);
+        }
+    } else {
+        for (int i = 0; i < n; i++) {
+            writer->batchPages[i] = writer->batch[i].page;
+            writer->docIDs[i] = writer->batch[i].docID;
+        }
+        pagedir_saveBatch(writer->io, writer->pageDirectory, writer->batchPages,
+                          writer->docIDs, n, writer->codec, each, ok);
+    }
+    if (writer->sync == PAGEWRITER_BATCH) {
+        bool synced = (writer->pack != NULL) ? pagepack_sync(writer->pack)
+          : syncfs(writer->dirFd) == 0;
+        if (!synced) {
+            fprintf(stderr, "Warning: could not sync the pages in '%s'\n",
+                    writer->pageDirectory);
+        }
+    }
+
+    for (int i = 0; i < n; i++) {
+        webpage_t* page = writer->batch[i].page;
+        if (ok[i] && writer->meta != NULL
+            && !pagemeta_record(writer->meta, writer->batch[i].docID, page)) {
+            fprintf(stderr, "Warning: could not record the validators of %s\n",
+                    webpage_getURL(page));
+        }
+        webpage_delete(page);
+    }
+}
+
+/**************** packBatch ****************/
+/* Encode the n pages of writer->batch from first on, and save them in the
+ * pack together; with the page policy, sync them too. Returns true if
+ * they are all saved.
+ */
+static bool
+packBatch(pagewriter_t* writer, const int first, const int n)
+{
+    int numFiles = 0;
+    bool ok = true;
+    for (int i = first; i < first + n; i++) {
+        writeitem_t* item = &writer->batch[i];
+        char* file = pagedir_encode(item->page, writer->codec, &writer->fileLens[numFiles]);
+        if (file == NULL) {
+            fprintf(stderr, "Error: could not encode docID %d\n", item->docID);
+            ok = false;
+            continue;
+        }
+        writer->files[numFiles] = file;
+        writer->docIDs[numFiles] = item->docID;
+        numFiles++;
+    }
+
+    ok = pagepack_saveFiles(writer->pack, numFiles, writer->files, writer->fileLens,
+                            writer->docIDs) && ok;
+    if (ok && writer->sync == PAGEWRITER_PAGE && !pagepack_sync(writer->pack)) {
+        fprintf(stderr, "Warning: could not sync the pages in '%s'\n",
+                writer->pageDirectory);
+    }
+    for (int i = 0; i < numFiles; i++) {
+        free(writer->files[i]);
+    }
+    return ok;
+}
+
+/**************** takePage ****************/
+/* Return a new webpage with copies of page's URL, depth, and validators,
+ * and page's own HTML, taken from it; NULL if out of memory, in which
+ * case page keeps its HTML.
+ */
+static webpage_t*
+takePage(webpage_t* page)
+{
+    char* url = strdup(webpage_getURL(page));
+    webpage_t* copy = (url != NULL) ? webpage_new(url, webpage_getDepth(page), NULL) : NULL;
+    if (copy == NULL) {
+        free(url);
+        return NULL;
+    }
+    if (!webpage_setValidators(copy, webpage_getETag(page), webpage_getLastModified(page))) {
+        webpage_delete(copy);
+        return NULL;
+    }
+    char* html = webpage_takeHTML(page);
+    if (html != NULL) {
+        webpage_setHTML(copy, html);
+    }
+    return copy;
+}
+
+/**************** freeWriter ****************/
+/* Close and free what writer holds, and writer itself. */
+static void
+freeWriter(pagewriter_t* writer)
+{
+    if (writer->dirFd >= 0) {
+        close(writer->dirFd);
+    }
+    free(writer->items);
+    free(writer->batch);
+    free(writer->files);
+    free(writer->fileLens);
+    free(writer->docIDs);
+    free(writer->batchPages);
+    free(writer->ok);
+    pagedir_batchDelete(writer->io);
+    free(writer);
+}
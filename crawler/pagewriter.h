@@ -0,0 +1,101 @@
+/*
+ * pagewriter.h - header file for the crawler's page writer
+ *
+ * A *page writer* saves the pages of a crawl on a thread of its own, so
+ * the crawl never waits for the disk. The crawler hands each page to the
+ * writer as it would have saved it; a bounded queue carries the page's
+ * HTML, taken from it rather than copied, to the writer thread, which takes all the pages waiting at once
+ * and saves them as one batch: into the pack with a single write, or a
+ * file each, each file with a single write (and, with io_uring, all the
+ * files with two system calls). Then it records each page's
+ * validators in the metadata log, so the log never names a page that is
+ * not saved. When the queue is full, handing over a page waits for room,
+ * so a crawl that outruns the disk slows down rather than filling memory.
+ *
+ * How soon a saved page must be on disk is the writer's *sync policy*:
+ * never (the kernel writes it back in its own time), once for each batch,
+ * or before the next page. Whatever the policy, a checkpoint first waits
+ * for the writer to save every page queued (pagewriter_flush), but only
+ * the policy puts them on disk: under "none", a checkpoint outlives a
+ * crash of the crawler, but after a power loss it may count pages the
+ * kernel had not yet written.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#ifndef __PAGEWRITER_H
+#define __PAGEWRITER_H
+
+#include <stdbool.h>
+#include "../libcs50/webpage.h"
+#include "../common/pagedir.h"
+#include "../common/pagepack.h"
+#include "pagemeta.h"
+
+/**************** global types ****************/
+typedef struct pagewriter pagewriter_t;  // opaque to users of the module
+
+/* when saved pages are put on disk */
+typedef enum {
+    PAGEWRITER_NONE,          // when the kernel writes them back
+    PAGEWRITER_BATCH,         // once a batch is saved
+    PAGEWRITER_PAGE           // as each page is saved
+} pagewriter_sync_t;
+
+/**************** functions ****************/
+
+/**************** pagewriter_new ****************/
+/* Start a writer that saves pages in pack, or, if pack is NULL, a file
+ * each in pageDirectory, stored with codec (see pagedir_saveCompressed)
+ * and written with io (see pagedir_batchNew); records their validators in
+ * meta (unless NULL); syncs them as the sync policy says; and has room
+ * for capacity pages waiting to be saved. The
+ * caller keeps pack and meta, and must not close them before
+ * pagewriter_finish.
+ *
+ * We return:
+ *   the writer, or NULL on error.
+ * Caller is responsible for:
+ *   later calling pagewriter_finish.
+ */
+pagewriter_t* pagewriter_new(const char* pageDirectory, pagepack_t* pack,
+                             pagemeta_t* meta, const pagedir_codec_t codec,
+                             const pagewriter_sync_t sync, const pagedir_io_t io,
+                             const int capacity);
+
+/**************** pagewriter_policy ****************/
+/* Return the sync policy named by name ("none", "batch", or "page") in
+ * *sync, and true; or false if there is no such policy.
+ */
+bool pagewriter_policy(const char* name, pagewriter_sync_t* sync);
+
+/**************** pagewriter_add ****************/
+/* Queue page to be saved as docID, waiting while the queue is full.
+ * The writer takes page's HTML (see webpage_takeHTML), so page has none
+ * afterwards; the caller keeps the rest of page. Safe to call from
+ * several threads at once.
+ * We return true on success; false if out of memory (page then keeps its
+ * HTML).
+ */
+bool pagewriter_add(pagewriter_t* writer, webpage_t* page, const int docID);
+
+/**************** pagewriter_flush ****************/
+/* Wait until every page queued so far is saved (or has failed to save,
+ * with a message). NULL is ignored.
+ */
+void pagewriter_flush(pagewriter_t* writer);
+
+/**************** pagewriter_stats ****************/
+/* Report the pages saved, the batches they were saved in, and the times
+ * pagewriter_add waited for room, by all the writers this process has
+ * finished so far.
+ */
+void pagewriter_stats(long* pages, long* batches, long* waits);
+
+/**************** pagewriter_finish ****************/
+/* Wait until every page queued is saved, stop the writer thread, and free
+ * the writer. NULL is ignored.
+ */
+void pagewriter_finish(pagewriter_t* writer);
+
+#endif // __PAGEWRITER_H
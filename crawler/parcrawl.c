@@ -0,0 +1,505 @@
+/*
+ * parcrawl.c - the crawler's parallel (-j) crawl
+ *
+ * see parcrawl.h for more information.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#define _GNU_SOURCE       // pthread_rwlockattr_setkind_np
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "../libcs50/webpage.h"
+#include "parcrawl.h"
+#include "wsdeque.h"
+#include "seenset.h"
+#include "linkmemo.h"
+#include "pagescan.h"
+#include "recrawl.h"
+#include "pagestore.h"
+#include "crawlstart.h"
+#include "simhash.h"
+#include "metrics.h"
+
+/**************** local types ****************/
+/* state shared by every worker thread of a parallel (-j) crawl */
+typedef struct crawlshare {
+    const char* pageDirectory;
+    pagestore_t store;           // where pages are saved
+    pagepack_t* oldPages;        // pages saved before (NULL: no --recrawl)
+    int maxDepth;
+    int maxPages;                // page budget (0: no limit)
+    int checkpointEvery;         // pages between checkpoints (0: none)
+    politeness_t* polite;        // when each host may be fetched again
+    int numWorkers;
+    struct worker* workers;      // workers[numWorkers]
+
+    seenset_t* pagesSeen;      // every URL ever queued; guarded by seenLock
+    pthread_mutex_t seenLock;
+
+    int nextDocID;               // next docID to hand out; guarded by docLock
+    bool budgetSpent;            // someone saw nextDocID pass maxPages; ditto
+    pthread_mutex_t docLock;
+
+    simindex_t* nearDups;        // fingerprints of pages saved (NULL: --near-dup off)
+    pthread_mutex_t simLock;     // guards nearDups and .aliases
+
+    // held for reading while a worker moves a page between a deque, its
+    // hands, and the page directory; for writing while taking a checkpoint
+    pthread_rwlock_t snapLock;
+
+    long pending;                // pages queued or in progress; guarded by workLock
+    unsigned long version;       // bumped whenever a page is queued
+    int idle;                    // workers waiting for work
+    pthread_mutex_t workLock;
+    pthread_cond_t workCond;     // signaled when work arrives or the crawl ends
+} crawlshare_t;
+
+/* one worker thread and the deque of pages it owns */
+typedef struct worker {
+    int id;                      // index into share->workers
+    pthread_t thread;
+    wsdeque_t* pagesToCrawl;     // this worker's own pages
+    webpage_t* current;          // the page in hand; guarded by snapLock
+    linkmemo_t* linkMemo;        // links this worker handled before
+    crawlshare_t* share;
+} worker_t;
+
+/**************** local functions ****************/
+static void* workerRun(void* arg);
+static webpage_t* workerNext(worker_t* self);
+static int workerSave(worker_t* self, webpage_t* page, const int known);
+static void workerDrop(worker_t* self);
+static int takeDocID(crawlshare_t* share, const bool take);
+static bool takeBudgetSpent(crawlshare_t* share);
+static void workerDone(crawlshare_t* share);
+static bool addToWorker(void* arg, char* url, const int depth);
+static void dupToWorker(void* arg, const char* url);
+static bool queueWorker(void* arg, webpage_t* page);
+static void checkpointItem(void* arg, void* item);
+static void parallelCheckpoint(crawlshare_t* share);
+
+/**************** parcrawl_run() ****************/
+/* see parcrawl.h for description */
+void
+parcrawl_run(char* seedURL, char* pageDirectory, const int maxDepth,
+             const crawlopts_t* opts, politeness_t* polite)
+{
+    const int numThreads = opts->numThreads;
+    crawlshare_t share;
+    share.pageDirectory = pageDirectory;
+    share.maxDepth = maxDepth;
+    share.maxPages = opts->maxPages;
+    share.checkpointEvery = opts->checkpointEvery;
+    share.polite = polite;
+    share.numWorkers = numThreads;
+    share.budgetSpent = false;
+    share.pending = 0;
+    share.version = 0;
+    share.idle = 0;
+    pthread_mutex_init(&share.seenLock, NULL);
+    pthread_mutex_init(&share.docLock, NULL);
+    pthread_mutex_init(&share.simLock, NULL);
+    pthread_mutex_init(&share.workLock, NULL);
+    pthread_cond_init(&share.workCond, NULL);
+
+    // prefer the writer, or a busy crawl could put checkpoints off forever
+    pthread_rwlockattr_t attr;
+    pthread_rwlockattr_init(&attr);
+    pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+    pthread_rwlock_init(&share.snapLock, &attr);
+    pthread_rwlockattr_destroy(&attr);
+
+    // set of seen URLs
+    share.pagesSeen = seenset_new(opts->expectedURLs);
+    if (share.pagesSeen == NULL) {
+        fprintf(stderr, "Error: could not allocate pagesSeen set\n");
+        exit(2);
+    }
+
+    // one deque per worker
+    share.workers = calloc(numThreads, sizeof(worker_t));
+    if (share.workers == NULL) {
+        fprintf(stderr, "Error: could not allocate workers\n");
+        seenset_delete(share.pagesSeen);
+        exit(2);
+    }
+    for (int i = 0; i < numThreads; i++) {
+        share.workers[i].id = i;
+        share.workers[i].share = &share;
+        share.workers[i].pagesToCrawl = wsdeque_new();
+        share.workers[i].linkMemo = linkmemo_new(CRAWL_LINK_MEMO);
+        if (share.workers[i].pagesToCrawl == NULL || share.workers[i].linkMemo == NULL) {
+            fprintf(stderr, "Error: could not allocate pagesToCrawl deque\n");
+            exit(2);
+        }
+    }
+
+    // the seed (or a checkpoint's frontier) starts on worker 0; the others
+    // will steal from it
+    share.nextDocID = crawlstart_seed(seedURL, pageDirectory, opts, share.pagesSeen,
+                                      &share.workers[0], queueWorker);
+    pagestore_open(&share.store, opts, pageDirectory, &share.nextDocID, NULL);
+    share.oldPages = recrawl_open(opts, pageDirectory);
+    share.nearDups = pagestore_nearDups(opts, pageDirectory, share.nextDocID);
+
+    for (int i = 0; i < numThreads; i++) {
+        if (pthread_create(&share.workers[i].thread, NULL, workerRun,
+                           &share.workers[i]) != 0) {
+            fprintf(stderr, "Error: could not start worker thread %d\n", i);
+            exit(2);
+        }
+    }
+    for (int i = 0; i < numThreads; i++) {
+        pthread_join(share.workers[i].thread, NULL);
+    }
+
+    // if the budget ran out, the checkpoint taken then kept the pages
+    // drained since; otherwise the crawl is complete
+    if (share.checkpointEvery > 0 && !share.budgetSpent) {
+        parallelCheckpoint(&share);
+    }
+
+    // clean up
+    for (int i = 0; i < numThreads; i++) {
+        wsdeque_delete(share.workers[i].pagesToCrawl, webpage_delete);
+        linkmemo_delete(share.workers[i].linkMemo);
+    }
+    free(share.workers);
+    seenset_delete(share.pagesSeen);
+    simindex_delete(share.nearDups);
+    pagepack_close(share.oldPages);
+    pagestore_close(&share.store, opts);
+    pthread_rwlock_destroy(&share.snapLock);
+    pthread_cond_destroy(&share.workCond);
+    pthread_mutex_destroy(&share.workLock);
+    pthread_mutex_destroy(&share.simLock);
+    pthread_mutex_destroy(&share.docLock);
+    pthread_mutex_destroy(&share.seenLock);
+}
+
+/**************** workerRun ****************/
+/* Thread body for one worker: fetch (and scan) and save pages until the
+ * whole crawl has run out of work.
+ */
+static void*
+workerRun(void* arg)
+{
+    worker_t* self = arg;
+    crawlshare_t* share = self->share;
+    webpage_t* page;
+
+    while ((page = workerNext(self)) != NULL) {
+        int docID = 0;
+        pagescan_t scan;
+        pagescan_begin(&scan, page, share->maxDepth, self->linkMemo, self, addToWorker,
+                       dupToWorker);
+        int known = recrawl_recall(share->store.meta, share->oldPages, page);
+
+        if (takeDocID(share, false) == 0) {
+            // page budget spent: drain the deques without fetching
+        } else if (recrawl_fetch(share->polite, share->oldPages, known, page, &scan)) {
+            docID = workerSave(self, page, known);  // 0 if the budget ran out meanwhile
+        } else if (webpage_getStatus(page) != 304) {
+            fprintf(stderr, "Warning: failed to fetch %s\n", webpage_getURL(page));
+        }
+        pagescan_end(&scan);
+
+        if (share->checkpointEvery > 0) {
+            if (docID == 0 && takeBudgetSpent(share)) {
+                // the crawl's last checkpoint; it keeps the pages still
+                // queued (and this one) for a later --resume
+                parallelCheckpoint(share);
+            } else if (docID != 0 && docID != known      // a new docID
+                       && docID % share->checkpointEvery == 0) {
+                parallelCheckpoint(share);
+            }
+        }
+
+        workerDrop(self);
+        webpage_delete(page);
+        workerDone(share);
+    }
+    return NULL;
+}
+
+/**************** workerSave ****************/
+/* Give the page in hand, just fetched (and scanned), the next docID and
+ * save it. Return its docID; or 0 if the page budget is spent, or if the
+ * page is a near-duplicate (and do nothing). A page saved before as
+ * known (nonzero) keeps that docID, and is saved over its old copy.
+ */
+static int
+workerSave(worker_t* self, webpage_t* page, const int known)
+{
+    crawlshare_t* share = self->share;
+    if (known != 0) {
+        pthread_rwlock_rdlock(&share->snapLock);
+        printf("Fetched: %s\n", webpage_getURL(page));
+        pagestore_save(&share->store, page, known);
+        self->current = NULL;
+        pthread_rwlock_unlock(&share->snapLock);
+        return known;
+    }
+    uint64_t fp = (share->nearDups != NULL) ? simhash_page(page) : 0;
+
+    pthread_rwlock_rdlock(&share->snapLock);
+    bool budgetLeft;
+    int docID = 0;
+    if (share->nearDups == NULL) {
+        docID = takeDocID(share, true);
+        budgetLeft = docID != 0;
+        if (budgetLeft) {
+            printf("Fetched: %s\n", webpage_getURL(page));
+        }
+    } else {
+        // take the next docID only once we know the page is not a
+        // near-duplicate; simLock makes the check and the taking one step,
+        // so two near-identical pages fetched at once cannot both be saved.
+        // A match not yet queued for saving cannot be confirmed, and the
+        // page is kept.
+        pthread_mutex_lock(&share->simLock);
+        budgetLeft = takeDocID(share, false) != 0;
+        if (budgetLeft) {
+            printf("Fetched: %s\n", webpage_getURL(page));
+            if (pagestore_findNearDup(share->nearDups, page, fp, &share->store) == 0) {
+                docID = takeDocID(share, true);
+                simindex_add(share->nearDups, fp, docID);
+            }
+        }
+        pthread_mutex_unlock(&share->simLock);
+    }
+    if (docID != 0) {
+        // outside simLock, which a full writer queue could otherwise hold;
+        // the docID already fixes where the page goes
+        pagestore_save(&share->store, page, docID);
+    }
+
+    if (budgetLeft) {
+        self->current = NULL;    // saved or aliased: no longer the frontier's
+    }
+    pthread_rwlock_unlock(&share->snapLock);
+    return docID;
+}
+
+/**************** workerDrop ****************/
+/* Let go of the page in hand, which is done with for good. */
+static void
+workerDrop(worker_t* self)
+{
+    pthread_rwlock_rdlock(&self->share->snapLock);
+    self->current = NULL;
+    pthread_rwlock_unlock(&self->share->snapLock);
+}
+
+/**************** takeDocID ****************/
+/* Return the next docID, or 0 if the page budget is spent; advance the
+ * counter only if take is true (otherwise just peek at the budget).
+ */
+static int
+takeDocID(crawlshare_t* share, const bool take)
+{
+    pthread_mutex_lock(&share->docLock);
+    int docID = share->nextDocID;
+    if (share->maxPages > 0 && docID > share->maxPages) {
+        docID = 0;
+    } else if (take) {
+        share->nextDocID++;
+    }
+    pthread_mutex_unlock(&share->docLock);
+    return docID;
+}
+
+/**************** takeBudgetSpent ****************/
+/* Return true the first time anyone calls this with the page budget spent;
+ * false if it is not spent, or someone already got the true.
+ */
+static bool
+takeBudgetSpent(crawlshare_t* share)
+{
+    pthread_mutex_lock(&share->docLock);
+    bool first = share->maxPages > 0 && share->nextDocID > share->maxPages
+                 && !share->budgetSpent;
+    if (first) {
+        share->budgetSpent = true;
+    }
+    pthread_mutex_unlock(&share->docLock);
+    return first;
+}
+
+/**************** workerNext ****************/
+/* Return the next page for this worker: its own newest page if any,
+ * otherwise the oldest page of some peer. If every deque is empty, wait
+ * until a page is queued somewhere, or return NULL once no page is queued
+ * or in progress anywhere (the crawl is over).
+ */
+static webpage_t*
+workerNext(worker_t* self)
+{
+    crawlshare_t* share = self->share;
+
+    while (true) {
+        // remember how much work had been queued before we looked
+        pthread_mutex_lock(&share->workLock);
+        unsigned long version = share->version;
+        pthread_mutex_unlock(&share->workLock);
+
+        pthread_rwlock_rdlock(&share->snapLock);
+        webpage_t* page = wsdeque_pop(self->pagesToCrawl);
+        for (int i = 1; page == NULL && i < share->numWorkers; i++) {
+            worker_t* victim = &share->workers[(self->id + i) % share->numWorkers];
+            page = wsdeque_steal(victim->pagesToCrawl);
+        }
+        self->current = page;
+        pthread_rwlock_unlock(&share->snapLock);
+        if (page != NULL) {
+            metrics_dequeued(webpage_getDepth(page));
+            return page;
+        }
+
+        pthread_mutex_lock(&share->workLock);
+        if (share->pending == 0) {
+            pthread_mutex_unlock(&share->workLock);
+            return NULL;
+        }
+        // sleep only if nothing was queued while we were scanning
+        if (version == share->version) {
+            share->idle++;
+            pthread_cond_wait(&share->workCond, &share->workLock);
+            share->idle--;
+        }
+        pthread_mutex_unlock(&share->workLock);
+    }
+}
+
+/**************** workerDone ****************/
+/* Record that one page has been fully processed; wake everyone if that
+ * was the last page anywhere, so idle workers can exit.
+ */
+static void
+workerDone(crawlshare_t* share)
+{
+    pthread_mutex_lock(&share->workLock);
+    if (--share->pending == 0) {
+        pthread_cond_broadcast(&share->workCond);
+    }
+    pthread_mutex_unlock(&share->workLock);
+}
+
+/**************** addToWorker ****************/
+/* addURL for a parallel crawl: arg is the worker_t* that found the link.
+ * Like seqcrawl_add, but pagesSeen is shared and the new page goes on the
+ * finder's own deque, waking an idle worker to come and steal it. Links
+ * arrive while the finder is fetching, outside snapLock, so take it here:
+ * a checkpoint must see the URL both seen and queued, or neither.
+ */
+static bool
+addToWorker(void* arg, char* url, const int depth)
+{
+    worker_t* self = arg;
+    crawlshare_t* share = self->share;
+
+    pthread_rwlock_rdlock(&share->snapLock);
+    pthread_mutex_lock(&share->seenLock);
+    bool isNew = seenset_insert(share->pagesSeen, url);
+    pthread_mutex_unlock(&share->seenLock);
+    if (!isNew) {
+        pthread_rwlock_unlock(&share->snapLock);
+        dupToWorker(self, url);
+        free(url);
+        return false;
+    }
+    metrics_seen();
+
+    webpage_t* newPage = webpage_new(url, depth, NULL);
+    if (newPage == NULL) {
+        pthread_rwlock_unlock(&share->snapLock);
+        free(url);
+        return false;
+    }
+    // print now: once pushed, another worker may fetch and free the page
+    printf("Added: %s\n", url);
+
+    bool queued = queueWorker(self, newPage);
+    pthread_rwlock_unlock(&share->snapLock);
+    if (!queued) {
+        webpage_delete(newPage);
+        return false;
+    }
+    return true;
+}
+
+/**************** dupToWorker ****************/
+/* dupURL for a parallel crawl: arg is the worker_t* that found the link.
+ * Count a link to url, which is in pagesSeen already.
+ */
+static void
+dupToWorker(void* arg, const char* url)
+{
+    printf("IgnDupl: %s\n", url);
+    metrics_duplicate();
+}
+
+/**************** queueWorker ****************/
+/* Push page onto the deque of the worker_t* arg, count it as pending, and
+ * wake an idle worker to come and steal it. Return false if out of memory.
+ */
+static bool
+queueWorker(void* arg, webpage_t* page)
+{
+    worker_t* self = arg;
+    crawlshare_t* share = self->share;
+
+    // count the page as pending before anyone can steal and finish it
+    pthread_mutex_lock(&share->workLock);
+    if (!wsdeque_push(self->pagesToCrawl, page)) {
+        pthread_mutex_unlock(&share->workLock);
+        return false;
+    }
+    metrics_queued(webpage_getDepth(page));
+    share->pending++;
+    share->version++;
+    if (share->idle > 0) {
+        pthread_cond_signal(&share->workCond);
+    }
+    pthread_mutex_unlock(&share->workLock);
+    return true;
+}
+
+/**************** checkpointItem ****************/
+/* wsdeque_iterate callback: arg is the checkpoint_t*, item a webpage_t*. */
+static void
+checkpointItem(void* arg, void* item)
+{
+    pagestore_checkpointPage(arg, item);
+}
+
+/**************** parallelCheckpoint ****************/
+/* Take a checkpoint of a parallel crawl: every deque, and every page in a
+ * worker's hands. Holding snapLock for writing keeps all workers out of
+ * the places a page could be caught between, and pagesSeen still.
+ */
+static void
+parallelCheckpoint(crawlshare_t* share)
+{
+    pthread_rwlock_wrlock(&share->snapLock);
+    pthread_mutex_lock(&share->docLock);
+    int nextDocID = share->nextDocID;
+    pthread_mutex_unlock(&share->docLock);
+
+    checkpoint_t* cp = pagestore_checkpointBegin(&share->store, nextDocID,
+                                                 share->pagesSeen);
+    for (int i = 0; i < share->numWorkers; i++) {
+        worker_t* worker = &share->workers[i];
+        wsdeque_iterate(worker->pagesToCrawl, cp, checkpointItem);
+        if (worker->current != NULL) {
+            pagestore_checkpointPage(cp, worker->current);
+        }
+    }
+    pagestore_checkpointEnd(cp, &share->store);
+    pthread_rwlock_unlock(&share->snapLock);
+}
@@ -0,0 +1,37 @@
+/*
+ * parcrawl.h - header file for the crawler's parallel (-j) crawl
+ *
+ * With -j, worker threads crawl at once, each from a deque of its own,
+ * stealing from their peers when it runs dry (see wsdeque.h).
+ *
+ * CS50 FA25 Final Project
+ */
+
+#ifndef __PARCRAWL_H
+#define __PARCRAWL_H
+
+#include "crawlopts.h"
+#include "politeness.h"
+
+/**************** functions ****************/
+
+/**************** parcrawl_run ****************/
+/* Crawl with opts->numThreads worker threads. Each worker owns a deque
+ * of pages; pages it discovers go on its own deque, and a worker whose
+ * deque is empty steals from its peers. pagesSeen and the docID counter are shared, so
+ * every URL is fetched once and docIDs stay unique and dense (a docID is
+ * handed out only after a successful fetch). The crawl ends when no page
+ * is queued or in progress anywhere. The deques keep their own order:
+ * --priority applies only to the frontier of the other modes, while
+ * --max-pages applies here too.
+ *
+ * A checkpoint must not catch a page between places: taken from a deque
+ * but not yet in a worker's hands, given a docID but not yet saved, or
+ * (for a link found while a page arrives) seen but not yet queued.
+ * Workers make those moves holding snapLock for reading, and the
+ * checkpoint holds it for writing; fetches happen outside it.
+ */
+void parcrawl_run(char* seedURL, char* pageDirectory, const int maxDepth,
+                  const crawlopts_t* opts, politeness_t* polite);
+
+#endif // __PARCRAWL_H
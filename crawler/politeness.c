@@ -0,0 +1,197 @@
+/*
+ * politeness.c - per-host politeness scheduler for the crawler
+ *
+ * see politeness.h for more information.
+ *
+ * Each host's budget is a token bucket, kept in the compact form of the
+ * generic cell rate algorithm: the only state per host is `tat`, the
+ * "theoretical arrival time" at which the host's bucket will be full
+ * again. A request may go at time t if t >= tat - tolerance, where
+ * tolerance = (burst - 1) * interval; each request pushes tat forward by
+ * one interval. Backing off just moves tat further into the future.
+ *
+ * Hosts are keyed by "hostname:port" in a hashtable. One mutex guards it;
+ * it is held only for the arithmetic, never while anyone sleeps.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#define _GNU_SOURCE       // clock_gettime, nanosleep
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <time.h>
+#include <pthread.h>
+#include "../libcs50/hashtable.h"
+#include "../libcs50/http.h"
+#include "politeness.h"
+
+/**************** file-local global variables ****************/
+static const int HOST_SLOTS = 50;           // hashtable slots for hosts
+static const long BACKOFF_BASE = 1000;      // ms before the first retry
+static const long BACKOFF_MAX = 60000;      // longest backoff, ms
+
+/**************** global types ****************/
+typedef struct politeness {
+    double interval;          // ms between requests to one host (0: no limit)
+    double tolerance;         // how far ahead of schedule a burst may run, ms
+    hashtable_t* hosts;       // "hostname:port" -> host_t
+    pthread_mutex_t lock;     // protects hosts and every host_t
+} politeness_t;
+
+/**************** local types ****************/
+typedef struct host {
+    double tat;               // theoretical arrival time, ms
+} host_t;
+
+/**************** local functions ****************/
+static host_t* findHost(politeness_t* pol, const char* url);
+
+/**************** politeness_new() ****************/
+/* see politeness.h for description */
+politeness_t*
+politeness_new(const double rate, const int burst)
+{
+    if (rate < 0 || burst < 1) {
+        return NULL;
+    }
+
+    politeness_t* pol = malloc(sizeof(politeness_t));
+    if (pol == NULL) {
+        return NULL;
+    }
+    pol->hosts = hashtable_new(HOST_SLOTS);
+    if (pol->hosts == NULL) {
+        free(pol);
+        return NULL;
+    }
+    pol->interval = (rate > 0) ? 1000.0 / rate : 0;
+    pol->tolerance = (burst - 1) * pol->interval;
+    pthread_mutex_init(&pol->lock, NULL);
+    return pol;
+}
+
+/**************** politeness_reserve() ****************/
+/* see politeness.h for description */
+long
+politeness_reserve(politeness_t* pol, const char* url)
+{
+    if (pol == NULL || url == NULL) {
+        return 0;
+    }
+
+    long now = politeness_now();
+    long delay = 0;
+    pthread_mutex_lock(&pol->lock);
+    host_t* host = findHost(pol, url);
+    if (host != NULL) {
+        // the earliest time this request conforms to the host's budget
+        double at = host->tat - pol->tolerance;
+        if (at < now) {
+            at = now;
+        }
+        host->tat = (host->tat > at ? host->tat : at) + pol->interval;
+        delay = (long)(at - now + 0.5);
+    }
+    pthread_mutex_unlock(&pol->lock);
+    return delay;
+}
+
+/**************** politeness_wait() ****************/
+/* see politeness.h for description */
+void
+politeness_wait(politeness_t* pol, const char* url)
+{
+    long delay = politeness_reserve(pol, url);
+    if (delay > 0) {
+        struct timespec ts = { delay / 1000, (delay % 1000) * 1000000L };
+        while (nanosleep(&ts, &ts) != 0) {
+            // interrupted by a signal: sleep for the remainder
+        }
+    }
+}
+
+/**************** politeness_backoff() ****************/
+/* see politeness.h for description */
+void
+politeness_backoff(politeness_t* pol, const char* url, const int attempt)
+{
+    if (pol == NULL || url == NULL) {
+        return;
+    }
+
+    long backoff = BACKOFF_MAX;
+    if (attempt >= 0 && attempt < 16 && (BACKOFF_BASE << attempt) < BACKOFF_MAX) {
+        backoff = BACKOFF_BASE << attempt;
+    }
+
+    long now = politeness_now();
+    pthread_mutex_lock(&pol->lock);
+    host_t* host = findHost(pol, url);
+    if (host != NULL) {
+        // no request conforms before now + backoff
+        double tat = now + backoff + pol->tolerance;
+        if (host->tat < tat) {
+            host->tat = tat;
+        }
+    }
+    pthread_mutex_unlock(&pol->lock);
+}
+
+/**************** politeness_now() ****************/
+/* see politeness.h for description */
+long
+politeness_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+/**************** politeness_delete() ****************/
+/* see politeness.h for description */
+void
+politeness_delete(politeness_t* pol)
+{
+    if (pol != NULL) {
+        hashtable_delete(pol->hosts, free);
+        pthread_mutex_destroy(&pol->lock);
+        free(pol);
+    }
+}
+
+/**************** findHost ****************/
+/* Return the state for url's host, creating it (with a full bucket) on
+ * first sight; NULL if the URL has no host or memory is exhausted.
+ * Caller holds pol->lock.
+ */
+static host_t*
+findHost(politeness_t* pol, const char* url)
+{
+    char* hostname;
+    int port;
+    char* pathname;
+    if (!http_burstURL(url, &hostname, &port, &pathname)) {
+        return NULL;
+    }
+
+    char key[300];
+    snprintf(key, sizeof(key), "%s:%d", hostname, port);
+    free(hostname);
+    free(pathname);
+
+    host_t* host = hashtable_find(pol->hosts, key);
+    if (host == NULL) {
+        host = malloc(sizeof(host_t));
+        if (host == NULL) {
+            return NULL;
+        }
+        host->tat = 0;          // long ago: the bucket is full
+        if (!hashtable_insert(pol->hosts, key, host)) {
+            free(host);
+            return NULL;
+        }
+    }
+    return host;
+}
@@ -0,0 +1,79 @@
+/*
+ * politeness.h - header file for the crawler's per-host politeness scheduler
+ *
+ * A *politeness* scheduler decides when the crawler may next fetch from
+ * each web server. Every host gets its own budget: at most `rate`
+ * requests per second on average, with up to `burst` requests allowed
+ * back to back after the host has been idle. Hosts are independent, so
+ * pages from different servers never wait on each other.
+ *
+ * Callers reserve a fetch slot before each request. A reservation never
+ * blocks: it returns how long the caller must wait, and the slot is
+ * theirs at that time. The blocking crawl modes simply wait out the delay
+ * (politeness_wait); the event-driven mode schedules the request for later.
+ *
+ * When a fetch fails, politeness_backoff pushes the host's next slot out
+ * exponentially (1s, 2s, 4s, ...), so the retry, reserved afterwards,
+ * lands on the same timer instead of sleeping inline.
+ *
+ * All functions are safe to call from any thread.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#ifndef __POLITENESS_H
+#define __POLITENESS_H
+
+#include <stdbool.h>
+
+/**************** global types ****************/
+typedef struct politeness politeness_t;  // opaque to users of the module
+
+/**************** functions ****************/
+
+/**************** politeness_new ****************/
+/* Create a new scheduler.
+ *
+ * Caller provides:
+ *   rate: requests per second allowed to each host (> 0), or 0 for no limit;
+ *   burst: requests a rested host may receive back to back (>= 1).
+ * We return:
+ *   pointer to a new scheduler, or NULL if error.
+ * Caller is responsible for:
+ *   later calling politeness_delete.
+ */
+politeness_t* politeness_new(const double rate, const int burst);
+
+/**************** politeness_reserve ****************/
+/* Reserve the next fetch slot for url's host.
+ *
+ * We return:
+ *   milliseconds until the caller may fetch url (0: right now).
+ *   The slot is held for the caller; they should fetch at that time.
+ */
+long politeness_reserve(politeness_t* pol, const char* url);
+
+/**************** politeness_wait ****************/
+/* Reserve the next fetch slot for url's host and sleep until it arrives.
+ * Only this thread waits; other threads may fetch from other hosts.
+ */
+void politeness_wait(politeness_t* pol, const char* url);
+
+/**************** politeness_backoff ****************/
+/* Record that fetch number `attempt` (0 for the first) of url failed:
+ * the host gets no slot for the next 2^attempt seconds (capped at a
+ * minute), counted from now.
+ */
+void politeness_backoff(politeness_t* pol, const char* url, const int attempt);
+
+/**************** politeness_now ****************/
+/* Return the scheduler's clock, in milliseconds; reservation delays are
+ * relative to it.
+ */
+long politeness_now(void);
+
+/**************** politeness_delete ****************/
+/* Delete the scheduler and all its per-host state. */
+void politeness_delete(politeness_t* pol);
+
+#endif // __POLITENESS_H
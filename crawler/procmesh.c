@@ -0,0 +1,368 @@
+/*
+ * procmesh.c - the crawler's multi-process mesh
+ *
+ * see procmesh.h for more information.
+ *
+ * Process i receives on recvFds[i], one end of a datagram socketpair;
+ * every other process sends to it on sendFds[i], the other end, which
+ * they all inherit. Each message is one datagram, "depth url", so
+ * messages from several senders never mix. Sends never block: when the
+ * owner's queue is full, the sender receives its own messages while it
+ * waits for room.
+ *
+ * The count of pages held, the next docID, and whether the budget is
+ * spent live in an anonymous shared mapping made before the fork, and
+ * are only touched with atomic operations.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#define _GNU_SOURCE       // MAP_ANONYMOUS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include "procmesh.h"
+#include "../libcs50/hash.h"
+
+/**************** file-local global variables ****************/
+static const int MAX_MESSAGE = 65536;     // bytes in one datagram, at most
+static const int FULL_WAIT = 10;          // ms to wait for room to send
+
+/**************** global types ****************/
+/* what the processes share, in memory mapped before the fork */
+typedef struct meshshared {
+    atomic_long held;           // pages queued, in progress, or on their way
+    atomic_int nextDocID;       // next docID to hand out
+    atomic_bool budgetSpent;    // the last docID of the budget is taken
+} meshshared_t;
+
+typedef struct procmesh {
+    int numProcs;
+    int maxPages;               // page budget (0: no limit)
+    int self;                   // this process's number (-1: the parent)
+    meshshared_t* shared;
+    int* recvFds;               // recvFds[numProcs]; -1 once closed
+    int* sendFds;               // sendFds[numProcs]; -1 once closed
+    pid_t* pids;                // pids[numProcs] of the children (parent only)
+    char* sendBuf;              // a message being sent, MAX_MESSAGE bytes
+    char* recvBuf;              // a message being received, MAX_MESSAGE bytes
+} procmesh_t;
+
+/**************** local functions ****************/
+static void closeFd(int* fd);
+static void killAll(procmesh_t* mesh);
+
+/**************** procmesh_new() ****************/
+/* see procmesh.h for description */
+procmesh_t*
+procmesh_new(const int numProcs, const int maxPages)
+{
+    if (numProcs < 2 || maxPages < 0) {
+        return NULL;
+    }
+    procmesh_t* mesh = calloc(1, sizeof(procmesh_t));
+    if (mesh == NULL) {
+        return NULL;
+    }
+    mesh->numProcs = numProcs;
+    mesh->maxPages = maxPages;
+    mesh->self = -1;
+    mesh->recvFds = malloc(numProcs * sizeof(int));
+    mesh->sendFds = malloc(numProcs * sizeof(int));
+    mesh->pids = calloc(numProcs, sizeof(pid_t));
+    mesh->sendBuf = malloc(MAX_MESSAGE);
+    mesh->recvBuf = malloc(MAX_MESSAGE);
+    void* shared = mmap(NULL, sizeof(meshshared_t), PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    mesh->shared = (shared != MAP_FAILED) ? shared : NULL;
+    if (mesh->recvFds == NULL || mesh->sendFds == NULL || mesh->pids == NULL
+        || mesh->sendBuf == NULL || mesh->recvBuf == NULL || mesh->shared == NULL) {
+        mesh->numProcs = 0;       // no sockets to close yet
+        procmesh_delete(mesh);
+        return NULL;
+    }
+    atomic_init(&mesh->shared->held, 1);          // the seed
+    atomic_init(&mesh->shared->nextDocID, 1);
+    atomic_init(&mesh->shared->budgetSpent, false);
+
+    for (int i = 0; i < numProcs; i++) {
+        mesh->recvFds[i] = mesh->sendFds[i] = -1;
+    }
+    for (int i = 0; i < numProcs; i++) {
+        int pair[2];
+        if (socketpair(AF_UNIX, SOCK_DGRAM, 0, pair) != 0) {
+            procmesh_delete(mesh);
+            return NULL;
+        }
+        mesh->recvFds[i] = pair[0];
+        mesh->sendFds[i] = pair[1];
+    }
+    return mesh;
+}
+
+/**************** procmesh_spawn() ****************/
+/* see procmesh.h for description */
+bool
+procmesh_spawn(procmesh_t* mesh, int* self)
+{
+    if (mesh == NULL || self == NULL) {
+        return false;
+    }
+    fflush(NULL);
+    for (int i = 0; i < mesh->numProcs; i++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            // keep only our own inbox, and the ways to the others'
+            mesh->self = i;
+            for (int j = 0; j < mesh->numProcs; j++) {
+                if (j != i) {
+                    closeFd(&mesh->recvFds[j]);
+                }
+            }
+            closeFd(&mesh->sendFds[i]);
+            free(mesh->pids);
+            mesh->pids = NULL;
+            *self = i;
+            return true;
+        }
+        if (pid < 0) {
+            killAll(mesh);
+            procmesh_wait(mesh);
+            return false;
+        }
+        mesh->pids[i] = pid;
+    }
+
+    // the parent neither sends nor receives
+    for (int i = 0; i < mesh->numProcs; i++) {
+        closeFd(&mesh->recvFds[i]);
+        closeFd(&mesh->sendFds[i]);
+    }
+    *self = -1;
+    return true;
+}
+
+/**************** procmesh_wait() ****************/
+/* see procmesh.h for description */
+bool
+procmesh_wait(procmesh_t* mesh)
+{
+    if (mesh == NULL || mesh->pids == NULL) {
+        return false;
+    }
+    bool ok = true;
+    while (true) {
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0 && errno == EINTR) {
+            continue;
+        }
+        if (pid < 0) {
+            break;                  // no children left
+        }
+        for (int i = 0; i < mesh->numProcs; i++) {
+            if (mesh->pids[i] == pid) {
+                mesh->pids[i] = 0;
+            }
+        }
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            if (ok) {
+                killAll(mesh);
+            }
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+/**************** procmesh_owns() ****************/
+/* see procmesh.h for description */
+bool
+procmesh_owns(procmesh_t* mesh, const char* url)
+{
+    return (int)hash_jenkins(url, mesh->numProcs) == mesh->self;
+}
+
+/**************** procmesh_send() ****************/
+/* see procmesh.h for description */
+bool
+procmesh_send(procmesh_t* mesh, const char* url, const int depth,
+              bool (*deliver)(void* arg, char* url, const int depth), void* arg)
+{
+    if (mesh == NULL || url == NULL) {
+        return false;
+    }
+    int len = snprintf(mesh->sendBuf, MAX_MESSAGE, "%d %s", depth, url);
+    if (len < 0 || len >= MAX_MESSAGE) {
+        return false;
+    }
+    int fd = mesh->sendFds[hash_jenkins(url, mesh->numProcs)];
+
+    // held before it leaves, so the count never drops to zero meanwhile
+    procmesh_hold(mesh);
+    while (send(fd, mesh->sendBuf, len, MSG_DONTWAIT) != len) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS) {
+            // the owner may be waiting on us; take our mail while we wait
+            procmesh_receive(mesh, 0, deliver, arg);
+            struct pollfd fds[2] = {
+                { .fd = fd, .events = POLLOUT },
+                { .fd = mesh->recvFds[mesh->self], .events = POLLIN },
+            };
+            poll(fds, 2, FULL_WAIT);
+        } else if (errno != EINTR) {
+            procmesh_release(mesh);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**************** procmesh_receive() ****************/
+/* see procmesh.h for description */
+int
+procmesh_receive(procmesh_t* mesh, const int timeout,
+                 bool (*deliver)(void* arg, char* url, const int depth), void* arg)
+{
+    if (mesh == NULL || mesh->self < 0) {
+        return 0;
+    }
+    int fd = mesh->recvFds[mesh->self];
+    int count = 0;
+    bool waited = (timeout <= 0);
+    while (true) {
+        ssize_t n = recv(fd, mesh->recvBuf, MAX_MESSAGE - 1, MSG_DONTWAIT);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if ((errno == EAGAIN || errno == EWOULDBLOCK) && count == 0 && !waited) {
+                struct pollfd pfd = { .fd = fd, .events = POLLIN };
+                poll(&pfd, 1, timeout);
+                waited = true;
+                continue;
+            }
+            return count;
+        }
+        mesh->recvBuf[n] = '\0';
+        char* space = strchr(mesh->recvBuf, ' ');
+        char* url = (space != NULL) ? strdup(space + 1) : NULL;
+        if (url != NULL) {
+            (*deliver)(arg, url, atoi(mesh->recvBuf));
+        }
+        procmesh_release(mesh);   // the sender's hold; deliver took its own
+        count++;
+    }
+}
+
+/**************** procmesh_hold() ****************/
+/* see procmesh.h for description */
+void
+procmesh_hold(procmesh_t* mesh)
+{
+    if (mesh != NULL) {
+        atomic_fetch_add(&mesh->shared->held, 1);
+    }
+}
+
+/**************** procmesh_release() ****************/
+/* see procmesh.h for description */
+void
+procmesh_release(procmesh_t* mesh)
+{
+    if (mesh != NULL) {
+        atomic_fetch_sub(&mesh->shared->held, 1);
+    }
+}
+
+/**************** procmesh_done() ****************/
+/* see procmesh.h for description */
+bool
+procmesh_done(procmesh_t* mesh)
+{
+    return atomic_load(&mesh->shared->budgetSpent)
+           || atomic_load(&mesh->shared->held) <= 0;
+}
+
+/**************** procmesh_takeDocID() ****************/
+/* see procmesh.h for description */
+int
+procmesh_takeDocID(procmesh_t* mesh)
+{
+    if (mesh->maxPages == 0) {
+        return atomic_fetch_add(&mesh->shared->nextDocID, 1);
+    }
+    int docID = atomic_load(&mesh->shared->nextDocID);
+    do {
+        if (docID > mesh->maxPages) {
+            return 0;
+        }
+    } while (!atomic_compare_exchange_weak(&mesh->shared->nextDocID, &docID, docID + 1));
+    if (docID == mesh->maxPages) {
+        atomic_store(&mesh->shared->budgetSpent, true);
+    }
+    return docID;
+}
+
+/**************** procmesh_pages() ****************/
+/* see procmesh.h for description */
+int
+procmesh_pages(procmesh_t* mesh)
+{
+    return atomic_load(&mesh->shared->nextDocID) - 1;
+}
+
+/**************** procmesh_delete() ****************/
+/* see procmesh.h for description */
+void
+procmesh_delete(procmesh_t* mesh)
+{
+    if (mesh == NULL) {
+        return;
+    }
+    for (int i = 0; i < mesh->numProcs; i++) {
+        closeFd(&mesh->recvFds[i]);
+        closeFd(&mesh->sendFds[i]);
+    }
+    if (mesh->shared != NULL) {
+        munmap(mesh->shared, sizeof(meshshared_t));
+    }
+    free(mesh->recvFds);
+    free(mesh->sendFds);
+    free(mesh->pids);
+    free(mesh->sendBuf);
+    free(mesh->recvBuf);
+    free(mesh);
+}
+
+/**************** closeFd ****************/
+/* Close *fd unless it is closed already (-1), and mark it closed. */
+static void
+closeFd(int* fd)
+{
+    if (*fd >= 0) {
+        close(*fd);
+        *fd = -1;
+    }
+}
+
+/**************** killAll ****************/
+/* Send SIGTERM to every child not yet reaped. */
+static void
+killAll(procmesh_t* mesh)
+{
+    for (int i = 0; i < mesh->numProcs; i++) {
+        if (mesh->pids[i] > 0) {
+            kill(mesh->pids[i], SIGTERM);
+        }
+    }
+}
@@ -0,0 +1,109 @@
+/*
+ * procmesh.h - header file for the crawler's multi-process mesh
+ *
+ * A *mesh* splits one crawl among several crawler processes (--procs).
+ * Each process owns the URLs whose hash falls in its share, and only it
+ * crawls them: a link found by another process is sent to its owner
+ * over a Unix-domain datagram socket. Every process saves pages into
+ * the same pageDirectory, taking each docID from a counter they share
+ * in memory, so the docIDs stay unique and dense.
+ *
+ * The crawl is over when no page is queued, in progress, or on its way
+ * anywhere. The processes keep that count together: each page queued or
+ * sent is held, and released once it is done with (or found to be a
+ * duplicate), so the count can only reach zero when every page is done.
+ *
+ * Usage: the parent calls procmesh_new and procmesh_spawn; each child
+ * crawls its part and exits; the parent calls procmesh_wait and
+ * procmesh_delete.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#ifndef __PROCMESH_H
+#define __PROCMESH_H
+
+#include <stdbool.h>
+
+/**************** global types ****************/
+typedef struct procmesh procmesh_t;  // opaque to users of the module
+
+/**************** functions ****************/
+
+/**************** procmesh_new ****************/
+/* Create a mesh for numProcs processes (at least 2) sharing a budget of
+ * maxPages pages (0: no limit). The seed page is held already.
+ *
+ * We return:
+ *   the mesh, or NULL on error.
+ * Caller is responsible for:
+ *   later calling procmesh_delete, in the parent and in each child.
+ */
+procmesh_t* procmesh_new(const int numProcs, const int maxPages);
+
+/**************** procmesh_spawn ****************/
+/* Fork the processes of the mesh. In each child, set *self to its number,
+ * from 0 to numProcs-1; in the parent, set *self to -1. Flushes stdio
+ * first, so nothing buffered is written twice.
+ * We return true on success; false in the parent if a fork failed (any
+ * children started are killed and reaped).
+ */
+bool procmesh_spawn(procmesh_t* mesh, int* self);
+
+/**************** procmesh_wait ****************/
+/* In the parent: wait for every child to exit. If one fails, kill the
+ * others, which would wait forever for its pages.
+ * We return true if every child exited with status 0.
+ */
+bool procmesh_wait(procmesh_t* mesh);
+
+/**************** procmesh_owns ****************/
+/* Return true if url is this process's to crawl. */
+bool procmesh_owns(procmesh_t* mesh, const char* url);
+
+/**************** procmesh_send ****************/
+/* Hold a page for url at depth and send it to its owner. While the
+ * owner's socket is full, receive (see procmesh_receive) with deliver,
+ * so two processes sending to each other cannot both wait forever.
+ * We return true on success; false (and release the page) on error.
+ */
+bool procmesh_send(procmesh_t* mesh, const char* url, const int depth,
+                   bool (*deliver)(void* arg, char* url, const int depth), void* arg);
+
+/**************** procmesh_receive ****************/
+/* Receive every URL sent to this process, waiting up to timeout ms
+ * (0: not at all) for the first. For each, call deliver(arg, url, depth),
+ * which takes the malloc'd url; then release the page its sender held.
+ * To keep the page, deliver must hold it again (procmesh_hold).
+ * We return the number of URLs received.
+ */
+int procmesh_receive(procmesh_t* mesh, const int timeout,
+                     bool (*deliver)(void* arg, char* url, const int depth), void* arg);
+
+/**************** procmesh_hold ****************/
+/* Count one more page queued in this process. NULL is ignored. */
+void procmesh_hold(procmesh_t* mesh);
+
+/**************** procmesh_release ****************/
+/* Count one page held as done with. NULL is ignored. */
+void procmesh_release(procmesh_t* mesh);
+
+/**************** procmesh_done ****************/
+/* Return true if the crawl is over: no page is held anywhere, or the
+ * page budget is spent.
+ */
+bool procmesh_done(procmesh_t* mesh);
+
+/**************** procmesh_takeDocID ****************/
+/* Return the next docID of the crawl, or 0 if the page budget is spent. */
+int procmesh_takeDocID(procmesh_t* mesh);
+
+/**************** procmesh_pages ****************/
+/* Return the number of docIDs taken so far, by every process. */
+int procmesh_pages(procmesh_t* mesh);
+
+/**************** procmesh_delete ****************/
+/* Close this process's view of the mesh and free it. NULL is ignored. */
+void procmesh_delete(procmesh_t* mesh);
+
+#endif // __PROCMESH_H
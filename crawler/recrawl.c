@@ -0,0 +1,78 @@
+/*
+ * recrawl.c - the crawler's --recrawl glue
+ *
+ * see recrawl.h for more information.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include "recrawl.h"
+
+/**************** recrawl_open() ****************/
+/* see recrawl.h for description */
+pagepack_t*
+recrawl_open(const crawlopts_t* opts, const char* pageDirectory)
+{
+    if (!opts->recrawl) {
+        return NULL;
+    }
+    pagepack_t* oldPages = pagepack_open(pageDirectory);
+    if (oldPages == NULL) {
+        fprintf(stderr, "Error: could not read the pages in '%s'\n", pageDirectory);
+        exit(2);
+    }
+    return oldPages;
+}
+
+/**************** recrawl_recall() ****************/
+/* see recrawl.h for description */
+int
+recrawl_recall(pagemeta_t* meta, pagepack_t* oldPages, webpage_t* page)
+{
+    if (oldPages == NULL) {
+        return 0;
+    }
+    const char* etag;
+    const char* lastModified;
+    int docID = pagemeta_find(meta, webpage_getURL(page), &etag, &lastModified);
+    if (docID != 0) {
+        webpage_setValidators(page, etag, lastModified);
+    }
+    return docID;
+}
+
+/**************** recrawl_keep() ****************/
+/* see recrawl.h for description */
+bool
+recrawl_keep(pagepack_t* oldPages, const int docID, webpage_t* page, pagescan_t* scan)
+{
+    webpage_t* copy = pagepack_load(oldPages, docID);
+    bool kept = (copy != NULL && strcmp(webpage_getURL(copy), webpage_getURL(page)) == 0);
+    if (kept) {
+        printf("Unchanged: %s\n", webpage_getURL(page));
+        const char* html = webpage_getHTML(copy);
+        pagescan_chunk(scan, html, strlen(html));
+    }
+    webpage_delete(copy);
+    return kept;
+}
+
+/**************** recrawl_fetch() ****************/
+/* see recrawl.h for description */
+bool
+recrawl_fetch(politeness_t* polite, pagepack_t* oldPages, const int known,
+              webpage_t* page, pagescan_t* scan)
+{
+    if (pagescan_fetch(polite, page, scan)) {
+        return true;
+    }
+    if (webpage_getStatus(page) != 304 || recrawl_keep(oldPages, known, page, scan)) {
+        return false;
+    }
+    webpage_setValidators(page, NULL, NULL);
+    return pagescan_fetch(polite, page, scan);
+}
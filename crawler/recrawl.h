@@ -0,0 +1,57 @@
+/*
+ * recrawl.h - header file for the crawler's --recrawl glue
+ *
+ * With --recrawl, a crawl of a page directory crawled before fetches each
+ * page saved then only if it has changed: it sends the validators the
+ * page was saved with (see pagemeta.h), and if the server answers 304,
+ * it keeps the saved copy, and scans that for links instead.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#ifndef __RECRAWL_H
+#define __RECRAWL_H
+
+#include <stdbool.h>
+#include "../libcs50/webpage.h"
+#include "../common/pagepack.h"
+#include "crawlopts.h"
+#include "pagemeta.h"
+#include "politeness.h"
+#include "pagescan.h"
+
+/**************** functions ****************/
+
+/**************** recrawl_open ****************/
+/* With --recrawl, return a reader for the pages saved before, whose
+ * copies stand in for the pages that have not changed; otherwise NULL.
+ * Exits non-zero on error.
+ */
+pagepack_t* recrawl_open(const crawlopts_t* opts, const char* pageDirectory);
+
+/**************** recrawl_recall ****************/
+/* With --recrawl (oldPages not NULL), if page was saved before, give it
+ * the validators it was saved with, so it is fetched only if it has
+ * changed, and return the docID it was saved as; otherwise return 0.
+ */
+int recrawl_recall(pagemeta_t* meta, pagepack_t* oldPages, webpage_t* page);
+
+/**************** recrawl_keep ****************/
+/* The page has not changed since it was saved as docID: keep that copy,
+ * and scan it for links just as if it had been fetched. Return false if
+ * the copy cannot be read (or is of some other page).
+ */
+bool recrawl_keep(pagepack_t* oldPages, const int docID, webpage_t* page,
+                  pagescan_t* scan);
+
+/**************** recrawl_fetch ****************/
+/* pagescan_fetch, for a page that may have been saved before as docID
+ * known (0 if not). If recrawl_recall gave it validators and the server says
+ * it has not changed, keep the old copy (see recrawl_keep) and return false
+ * with status 304; if that copy cannot be read, fetch the page in full
+ * after all. Return true iff the page was fetched.
+ */
+bool recrawl_fetch(politeness_t* polite, pagepack_t* oldPages, const int known,
+                   webpage_t* page, pagescan_t* scan);
+
+#endif // __RECRAWL_H
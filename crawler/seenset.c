@@ -0,0 +1,298 @@
+/*
+ * seenset.c - compact set of seen URLs for the crawler
+ *
+ * see seenset.h for more information.
+ *
+ * The table holds fingerprints by value in one array, with 0 marking an
+ * empty slot, and resolves collisions by linear probing; it grows to
+ * twice the size once it is 3/4 full. A URL's home slot comes from the
+ * high half of its fingerprint, scaled to the table size by a multiply
+ * rather than a modulo, so the table need not be a power of two and can
+ * be sized to the hint exactly.
+ *
+ * The Bloom filter in front is *blocked*: each fingerprint sets BLOOM_K
+ * bits, all within one 64-byte block (one cache line) chosen by the low
+ * half of the fingerprint, so a lookup touches one line of the filter.
+ * It has 8 bits per table slot, at most about 11 bits per URL, for a
+ * false-positive rate near 1%. Almost every URL the crawler has not seen
+ * is thus recognized without probing the table. Since the filter is
+ * built from fingerprints alone, it is rebuilt from the table when the
+ * table grows.
+ *
+ * Once tracking starts, each fingerprint added is also appended to an
+ * array of its own, which doubles when full; seenset_takeNew empties it
+ * but keeps the memory for the next ones.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "seenset.h"
+
+/**************** file-local global variables ****************/
+static const long MIN_CAPACITY = 16;      // slots in the smallest table
+static const int BLOCK_WORDS = 8;         // 64-bit words per Bloom block
+static const int BLOOM_K = 7;             // bits set per fingerprint
+
+/**************** global types ****************/
+typedef struct seenset {
+    uint64_t* slots;          // fingerprints; 0 is an empty slot
+    long capacity;            // number of slots
+    long count;               // fingerprints stored
+    uint64_t* bloom;          // numBlocks * BLOCK_WORDS words
+    long numBlocks;
+    bool tracking;            // remember new fingerprints in fresh
+    uint64_t* fresh;          // fingerprints added since the last take
+    long numFresh;
+    long freshCapacity;
+} seenset_t;
+
+/**************** local functions ****************/
+static bool build(seenset_t* ss, const long capacity);
+static long homeSlot(const seenset_t* ss, const uint64_t fp);
+static bool bloomTest(const seenset_t* ss, const uint64_t fp, const bool set);
+static bool find(const seenset_t* ss, const uint64_t fp, long* slot);
+
+/**************** seenset_new() ****************/
+/* see seenset.h for description */
+seenset_t*
+seenset_new(const long expected)
+{
+    if (expected < 1) {
+        return NULL;
+    }
+
+    seenset_t* ss = calloc(1, sizeof(seenset_t));
+    if (ss == NULL) {
+        return NULL;
+    }
+    long capacity = expected + expected / 3 + 1;    // 3/4 full when expected
+    if (!build(ss, capacity < MIN_CAPACITY ? MIN_CAPACITY : capacity)) {
+        free(ss);
+        return NULL;
+    }
+    return ss;
+}
+
+/**************** seenset_fingerprint() ****************/
+/* see seenset.h for description */
+uint64_t
+seenset_fingerprint(const char* url)
+{
+    // FNV-1a over the bytes, then the MurmurHash3 finalizer to spread them
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (const unsigned char* p = (const unsigned char*)url; *p != '\0'; p++) {
+        h = (h ^ *p) * 0x100000001b3ULL;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return (h != 0) ? h : 1;
+}
+
+/**************** seenset_insert() ****************/
+/* see seenset.h for description */
+bool
+seenset_insert(seenset_t* ss, const char* url)
+{
+    if (ss == NULL || url == NULL) {
+        return false;
+    }
+    return seenset_insertFingerprint(ss, seenset_fingerprint(url));
+}
+
+/**************** seenset_insertFingerprint() ****************/
+/* see seenset.h for description */
+bool
+seenset_insertFingerprint(seenset_t* ss, const uint64_t fp)
+{
+    if (ss == NULL || fp == 0) {
+        return false;
+    }
+
+    long slot;
+    if (bloomTest(ss, fp, false) && find(ss, fp, &slot)) {
+        return false;                 // already seen
+    }
+    if (ss->tracking && ss->numFresh == ss->freshCapacity) {
+        long capacity = (ss->freshCapacity > 0) ? 2 * ss->freshCapacity : MIN_CAPACITY;
+        uint64_t* fresh = realloc(ss->fresh, capacity * sizeof(uint64_t));
+        if (fresh == NULL) {
+            return false;
+        }
+        ss->fresh = fresh;
+        ss->freshCapacity = capacity;
+    }
+    if (4 * (ss->count + 1) > 3 * ss->capacity) {
+        if (!build(ss, 2 * ss->capacity)) {
+            return false;
+        }
+    }
+    find(ss, fp, &slot);            // the empty slot where it goes
+    ss->slots[slot] = fp;
+    ss->count++;
+    bloomTest(ss, fp, true);
+    if (ss->tracking) {
+        ss->fresh[ss->numFresh++] = fp;
+    }
+    return true;
+}
+
+/**************** seenset_contains() ****************/
+/* see seenset.h for description */
+bool
+seenset_contains(seenset_t* ss, const char* url)
+{
+    if (ss == NULL || url == NULL) {
+        return false;
+    }
+    uint64_t fp = seenset_fingerprint(url);
+    long slot;
+    return bloomTest(ss, fp, false) && find(ss, fp, &slot);
+}
+
+/**************** seenset_size() ****************/
+/* see seenset.h for description */
+long
+seenset_size(seenset_t* ss)
+{
+    return ss ? ss->count : 0;
+}
+
+/**************** seenset_trackNew() ****************/
+/* see seenset.h for description */
+void
+seenset_trackNew(seenset_t* ss)
+{
+    if (ss != NULL) {
+        ss->tracking = true;
+    }
+}
+
+/**************** seenset_takeNew() ****************/
+/* see seenset.h for description */
+void
+seenset_takeNew(seenset_t* ss, void* arg,
+                void (*itemfunc)(void* arg, const uint64_t fp))
+{
+    if (ss == NULL || itemfunc == NULL) {
+        return;
+    }
+    for (long i = 0; i < ss->numFresh; i++) {
+        (*itemfunc)(arg, ss->fresh[i]);
+    }
+    ss->numFresh = 0;
+}
+
+/**************** seenset_delete() ****************/
+/* see seenset.h for description */
+void
+seenset_delete(seenset_t* ss)
+{
+    if (ss != NULL) {
+        free(ss->slots);
+        free(ss->bloom);
+        free(ss->fresh);
+        free(ss);
+    }
+}
+
+/**************** build ****************/
+/* Give the set a table of `capacity` slots and a matching Bloom filter,
+ * moving any fingerprints already stored into them. Returns false if
+ * memory is exhausted; the set is then unchanged.
+ */
+static bool
+build(seenset_t* ss, const long capacity)
+{
+    long numBlocks = (capacity * 8 + 511) / 512;    // 8 bits per slot
+    uint64_t* slots = calloc(capacity, sizeof(uint64_t));
+    uint64_t* bloom = calloc(numBlocks * BLOCK_WORDS, sizeof(uint64_t));
+    if (slots == NULL || bloom == NULL) {
+        free(slots);
+        free(bloom);
+        return false;
+    }
+
+    seenset_t old = *ss;
+    ss->slots = slots;
+    ss->capacity = capacity;
+    ss->bloom = bloom;
+    ss->numBlocks = numBlocks;
+    for (long i = 0; i < old.capacity; i++) {
+        uint64_t fp = old.slots[i];
+        if (fp != 0) {
+            long slot;
+            find(ss, fp, &slot);
+            ss->slots[slot] = fp;
+            bloomTest(ss, fp, true);
+        }
+    }
+    free(old.slots);
+    free(old.bloom);
+    return true;
+}
+
+/**************** homeSlot ****************/
+/* Return the slot where the probe for fp starts: the high 32 bits of fp,
+ * taken as a fraction of 2^32, times the capacity.
+ */
+static long
+homeSlot(const seenset_t* ss, const uint64_t fp)
+{
+    return (long)(((fp >> 32) * (uint64_t)ss->capacity) >> 32);
+}
+
+/**************** bloomTest ****************/
+/* Return true if every Bloom bit for fp is set (fp may be in the set);
+ * false if not (it is certainly not). If set is true, set the bits too.
+ */
+static bool
+bloomTest(const seenset_t* ss, const uint64_t fp, const bool set)
+{
+    uint64_t block = ((fp & 0xffffffffULL) * (uint64_t)ss->numBlocks) >> 32;
+    uint64_t* words = &ss->bloom[block * BLOCK_WORDS];
+
+    // BLOOM_K 9-bit positions within the 512-bit block, from a remix of fp
+    uint64_t bits = fp * 0x9e3779b97f4a7c15ULL;
+    bool present = true;
+    for (int i = 0; i < BLOOM_K; i++, bits >>= 9) {
+        int bit = bits & 511;
+        uint64_t mask = 1ULL << (bit & 63);
+        if ((words[bit >> 6] & mask) == 0) {
+            present = false;
+            if (!set) {
+                break;
+            }
+            words[bit >> 6] |= mask;
+        }
+    }
+    return present;
+}
+
+/**************** find ****************/
+/* Probe for fp. Return true with its slot in *slot if it is stored;
+ * otherwise false, with the empty slot where it would go in *slot.
+ * The table always has an empty slot, so the probe ends.
+ */
+static bool
+find(const seenset_t* ss, const uint64_t fp, long* slot)
+{
+    long i = homeSlot(ss, fp);
+    while (ss->slots[i] != 0) {
+        if (ss->slots[i] == fp) {
+            *slot = i;
+            return true;
+        }
+        if (++i == ss->capacity) {
+            i = 0;
+        }
+    }
+    *slot = i;
+    return false;
+}
@@ -0,0 +1,88 @@
+/*
+ * seenset.h - header file for the crawler's compact set of seen URLs
+ *
+ * A *seenset* remembers which URLs the crawler has queued, without keeping
+ * the URLs themselves. Each URL is reduced to a 64-bit *fingerprint*; the
+ * set is an open-addressing table of fingerprints, with a blocked Bloom
+ * filter in front of it. At the size it was created for, it takes about
+ * 12 bytes per URL, and both lookups and insertions are O(1).
+ *
+ * Two different URLs with the same fingerprint look like one URL, so the
+ * second would be skipped; at a million URLs the chance that this happens
+ * at all is about 1 in 30 million.
+ *
+ * The set is not thread-safe; the parallel crawl guards it with a mutex.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#ifndef __SEENSET_H
+#define __SEENSET_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**************** global types ****************/
+typedef struct seenset seenset_t;  // opaque to users of the module
+
+/**************** functions ****************/
+
+/**************** seenset_new ****************/
+/* Create a new (empty) set sized for about `expected` URLs. It grows past
+ * that as needed, at the cost of a rebuild and some memory per URL.
+ *
+ * We return:
+ *   pointer to a new set, or NULL if expected < 1 or memory is exhausted.
+ * Caller is responsible for:
+ *   later calling seenset_delete.
+ */
+seenset_t* seenset_new(const long expected);
+
+/**************** seenset_fingerprint ****************/
+/* Return the 64-bit fingerprint of url (never 0). */
+uint64_t seenset_fingerprint(const char* url);
+
+/**************** seenset_insert ****************/
+/* Add url to the set.
+ *
+ * We return:
+ *   true if url was new and is now in the set;
+ *   false if it was already there, a parameter is NULL, or memory is
+ *   exhausted.
+ */
+bool seenset_insert(seenset_t* ss, const char* url);
+
+/**************** seenset_insertFingerprint ****************/
+/* Like seenset_insert, given the URL's fingerprint instead of the URL;
+ * used to restore a set saved with seenset_takeNew.
+ */
+bool seenset_insertFingerprint(seenset_t* ss, const uint64_t fp);
+
+/**************** seenset_contains ****************/
+/* Return true iff url is in the set (false if either is NULL). */
+bool seenset_contains(seenset_t* ss, const char* url);
+
+/**************** seenset_size ****************/
+/* Return the number of URLs in the set (0 if NULL). */
+long seenset_size(seenset_t* ss);
+
+/**************** seenset_trackNew ****************/
+/* From now on, remember the fingerprint of each URL added to the set,
+ * until seenset_takeNew hands it over. Until then it takes 8 more bytes
+ * per URL.
+ */
+void seenset_trackNew(seenset_t* ss);
+
+/**************** seenset_takeNew ****************/
+/* Call itemfunc(arg, fp) with the fingerprint of each URL added since
+ * the last call (or since seenset_trackNew), in the order added, and
+ * forget them; so a set can be saved a part at a time.
+ */
+void seenset_takeNew(seenset_t* ss, void* arg,
+                     void (*itemfunc)(void* arg, const uint64_t fp));
+
+/**************** seenset_delete ****************/
+/* Delete the set. */
+void seenset_delete(seenset_t* ss);
+
+#endif // __SEENSET_H
@@ -0,0 +1,158 @@
+/*
+ * seensettest.c - unit test for the seenset module
+ *
+ * Checks that a set holds every URL added to it and none other, well past
+ * the size it was created for; that adding a URL twice reports it the
+ * second time; and that the fingerprints handed over by seenset_takeNew
+ * come in the order added and restore the same set, as a resumed crawl
+ * restores it from its checkpoint.
+ *
+ * usage: seensettest
+ * Prints a line for each failed check, then a count; exits non-zero if
+ * any check failed.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "seenset.h"
+
+/**************** file-local global variables ****************/
+static int checks = 0;
+static int failures = 0;
+static const int NUM_URLS = 100000;      // 1000 times what the set is sized for
+
+/**************** local types ****************/
+typedef struct taken {
+    uint64_t* fps;
+    int count;
+    int capacity;
+} taken_t;
+
+/**************** local functions ****************/
+static void check(const bool ok, const char* what);
+static void makeURL(char* url, const size_t size, const int i);
+static void takeOne(void* arg, const uint64_t fp);
+
+/**************** main ****************/
+int main(void)
+{
+    char url[100];
+
+    check(seenset_new(0) == NULL, "new with expected 0");
+    check(seenset_size(NULL) == 0 && !seenset_insert(NULL, "x")
+          && !seenset_contains(NULL, "x"), "NULL set");
+
+    seenset_t* ss = seenset_new(100);
+    check(ss != NULL, "new");
+    if (ss == NULL) {
+        return 1;
+    }
+    check(!seenset_insert(ss, NULL) && !seenset_contains(ss, NULL), "NULL url");
+    check(seenset_fingerprint("http://a/") == seenset_fingerprint("http://a/")
+          && seenset_fingerprint("http://a/") != seenset_fingerprint("http://b/")
+          && seenset_fingerprint("") != 0, "fingerprint");
+
+    // the first 1000 URLs, tracked from the start
+    seenset_trackNew(ss);
+    bool allNew = true;
+    for (int i = 0; i < 1000; i++) {
+        makeURL(url, sizeof(url), i);
+        allNew = seenset_insert(ss, url) && allNew;
+    }
+    check(allNew, "insert new URLs");
+    taken_t taken = { malloc(1000 * sizeof(uint64_t)), 0, 1000 };
+    seenset_takeNew(ss, &taken, takeOne);
+    bool inOrder = (taken.count == 1000);
+    for (int i = 0; inOrder && i < 1000; i++) {
+        makeURL(url, sizeof(url), i);
+        inOrder = (taken.fps[i] == seenset_fingerprint(url));
+    }
+    check(inOrder, "takeNew hands over each URL in order");
+    int before = taken.count;
+    seenset_takeNew(ss, &taken, takeOne);
+    check(taken.count == before, "takeNew forgets what it handed over");
+
+    // the rest, growing the set many times
+    for (int i = 1000; i < NUM_URLS; i++) {
+        makeURL(url, sizeof(url), i);
+        allNew = seenset_insert(ss, url) && allNew;
+    }
+    check(allNew, "insert past the expected size");
+    check(seenset_size(ss) == NUM_URLS, "size");
+
+    bool allThere = true;
+    bool noneTwice = true;
+    for (int i = 0; i < NUM_URLS; i++) {
+        makeURL(url, sizeof(url), i);
+        allThere = seenset_contains(ss, url) && allThere;
+        noneTwice = !seenset_insert(ss, url) && noneTwice;
+    }
+    check(allThere, "contains every URL added");
+    check(noneTwice, "insert of a URL already there");
+    check(seenset_size(ss) == NUM_URLS, "size after inserting again");
+
+    bool noneElse = true;
+    for (int i = NUM_URLS; i < 2 * NUM_URLS; i++) {
+        makeURL(url, sizeof(url), i);
+        noneElse = !seenset_contains(ss, url) && noneElse;
+    }
+    check(noneElse, "contains no URL not added");
+
+    // the first 1000 restored from their fingerprints
+    seenset_t* restored = seenset_new(10);
+    check(restored != NULL, "new for restoring");
+    bool restoredNew = true;
+    for (int i = 0; restored != NULL && i < taken.count; i++) {
+        restoredNew = seenset_insertFingerprint(restored, taken.fps[i]) && restoredNew;
+    }
+    check(restoredNew, "insertFingerprint");
+    bool sameSet = (restored != NULL && seenset_size(restored) == 1000);
+    for (int i = 0; sameSet && i < 1000; i++) {
+        makeURL(url, sizeof(url), i);
+        sameSet = !seenset_insert(restored, url);
+    }
+    makeURL(url, sizeof(url), 1000);
+    check(sameSet && seenset_insert(restored, url), "restored set");
+
+    free(taken.fps);
+    seenset_delete(restored);
+    seenset_delete(ss);
+    printf("seensettest: %d checks, %d failed\n", checks, failures);
+    return failures == 0 ? 0 : 1;
+}
+
+/**************** check ****************/
+/* Count one check, and report it if it failed. */
+static void
+check(const bool ok, const char* what)
+{
+    checks++;
+    if (!ok) {
+        failures++;
+        printf("FAIL: %s\n", what);
+    }
+}
+
+/**************** makeURL ****************/
+/* Write the ith test URL into url. */
+static void
+makeURL(char* url, const size_t size, const int i)
+{
+    snprintf(url, size, "http://cs50tse.cs.dartmouth.edu/tse/site%d/page%d.html", i % 37, i);
+}
+
+/**************** takeOne ****************/
+/* seenset_takeNew's itemfunc: keep the fingerprint, if there is room. */
+static void
+takeOne(void* arg, const uint64_t fp)
+{
+    taken_t* taken = arg;
+    if (taken->fps != NULL && taken->count < taken->capacity) {
+        taken->fps[taken->count] = fp;
+    }
+    taken->count++;
+}
@@ -0,0 +1,217 @@
+/*
+ * seqcrawl.c - the crawler's single-threaded crawl
+ *
+ * see seqcrawl.h for more information.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "seqcrawl.h"
+#include "pagescan.h"
+#include "recrawl.h"
+#include "pagestore.h"
+#include "crawlstart.h"
+#include "simhash.h"
+#include "metrics.h"
+
+/**************** local functions ****************/
+static webpage_t* seqNext(seqcrawl_t* state);
+static void seqCheckpoint(seqcrawl_t* state, pagestore_t* store, const int nextDocID);
+
+/**************** seqcrawl_run() ****************/
+/* see seqcrawl.h for description */
+void
+seqcrawl_run(char* seedURL, char* pageDirectory, const int maxDepth,
+             const crawlopts_t* opts, politeness_t* polite, const crawlpart_t* part)
+{
+    seqcrawl_t state;
+    state.mesh = (part != NULL) ? part->mesh : NULL;
+
+    // set of seen URLs, and the links that led to them
+    state.pagesSeen = seenset_new(opts->expectedURLs);
+    state.linkMemo = linkmemo_new(CRAWL_LINK_MEMO);
+    if (state.pagesSeen == NULL || state.linkMemo == NULL) {
+        fprintf(stderr, "Error: could not allocate pagesSeen set\n");
+        exit(2); // non-zero exit
+    }
+
+    // frontier of pages to crawl
+    state.pagesToCrawl = frontier_new(opts->priority);
+    if (state.pagesToCrawl == NULL) {
+        fprintf(stderr, "Error: could not allocate pagesToCrawl frontier\n");
+        seenset_delete(state.pagesSeen);
+        exit(2); // non-zero exit
+    }
+
+    // the seed page, or wherever the last checkpoint left off
+    int docID = (part != NULL)
+        ? crawlstart_part(seedURL, state.mesh, state.pagesSeen, &state, seqcrawl_queue)
+        : crawlstart_seed(seedURL, pageDirectory, opts, state.pagesSeen, &state,
+                          seqcrawl_queue);
+    pagestore_t store;
+    pagestore_open(&store, opts, pageDirectory, &docID, part);
+    pagepack_t* oldPages = recrawl_open(opts, pageDirectory);
+    simindex_t* nearDups = pagestore_nearDups(opts, pageDirectory, docID);
+    webpage_t* page;
+
+    // main crawl loop
+    while ((opts->maxPages == 0 || docID <= opts->maxPages)
+           && (page = seqNext(&state)) != NULL ) {
+
+        // if not at maxDepth, scan for links while the page arrives
+        pagescan_t scan;
+        pagescan_begin(&scan, page, maxDepth, state.linkMemo, &state, seqcrawl_add,
+                       seqcrawl_dup);
+        int known = recrawl_recall(store.meta, oldPages, page);
+        if (recrawl_fetch(polite, oldPages, known, page, &scan)) {
+            // fetched successfully
+            printf("Fetched: %s\n", webpage_getURL(page));
+
+            if (known != 0) {
+                // changed since it was saved: replace that copy
+                pagestore_save(&store, page, known);
+            } else {
+                // save the page to pageDirectory/docID, unless it nearly
+                // duplicates a page saved already
+                uint64_t fp = (nearDups != NULL) ? simhash_page(page) : 0;
+                bool saved = pagestore_findNearDup(nearDups, page, fp, &store) == 0;
+                int newID = saved ? seqcrawl_newDocID(state.mesh, &docID) : 0;
+                if (newID != 0) {
+                    pagestore_save(&store, page, newID);
+                    simindex_add(nearDups, fp, newID);
+                }
+
+                if (saved && opts->checkpointEvery > 0
+                    && (docID - 1) % opts->checkpointEvery == 0) {
+                    seqCheckpoint(&state, &store, docID);
+                }
+            }
+        } else if (webpage_getStatus(page) != 304) {
+            fprintf(stderr, "Warning: failed to fetch %s\n", webpage_getURL(page));
+        }
+
+        pagescan_end(&scan);
+        webpage_delete(page); // frees URL and HTML
+        procmesh_release(state.mesh);
+    }
+
+    // what is left is the frontier a later --resume starts from
+    if (opts->checkpointEvery > 0) {
+        seqCheckpoint(&state, &store, docID);
+    }
+
+    // clean up
+    seenset_delete(state.pagesSeen);
+    linkmemo_delete(state.linkMemo);
+    frontier_delete(state.pagesToCrawl, webpage_delete);  // left by the budget
+    simindex_delete(nearDups);
+    pagepack_close(oldPages);
+    pagestore_close(&store, opts);
+}
+
+/**************** seqNext ****************/
+/* Return the next page to fetch from state's frontier, or NULL if there
+ * is none. With --procs, first take in the pages the other processes sent;
+ * if the frontier is empty, wait for more until the whole crawl is over.
+ */
+static webpage_t*
+seqNext(seqcrawl_t* state)
+{
+    webpage_t* page = NULL;
+    if (state->mesh == NULL) {
+        page = frontier_pop(state->pagesToCrawl);
+    } else {
+        procmesh_receive(state->mesh, 0, seqcrawl_add, state);
+        while (!procmesh_done(state->mesh)
+               && (page = frontier_pop(state->pagesToCrawl)) == NULL) {
+            procmesh_receive(state->mesh, CRAWL_MESH_WAIT, seqcrawl_add, state);
+        }
+    }
+    if (page != NULL) {
+        metrics_dequeued(webpage_getDepth(page));
+    }
+    return page;
+}
+
+/**************** seqcrawl_newDocID() ****************/
+/* see seqcrawl.h for description */
+int
+seqcrawl_newDocID(procmesh_t* mesh, int* docID)
+{
+    return (mesh != NULL) ? procmesh_takeDocID(mesh) : (*docID)++;
+}
+
+/**************** seqcrawl_add() ****************/
+/* see seqcrawl.h for description */
+bool
+seqcrawl_add(void* arg, char* url, const int depth)
+{
+    seqcrawl_t* state = arg;
+
+    if (!seenset_insert(state->pagesSeen, url)) {
+        seqcrawl_dup(state, url);
+        free(url);
+        return false;
+    }
+    metrics_seen();
+    if (state->mesh != NULL && !procmesh_owns(state->mesh, url)
+        && procmesh_send(state->mesh, url, depth, seqcrawl_add, state)) {
+        // another process crawls it; our pagesSeen keeps us from sending it twice
+        printf("Sent: %s\n", url);
+        free(url);
+        return true;
+    }
+
+    // url is new -> create a webpage_t that takes ownership of `url`
+    webpage_t* newPage = webpage_new(url, depth, NULL);
+    if (newPage == NULL) {
+        free(url);       // allocation failed -> avoid leak
+        return false;
+    }
+    if (!seqcrawl_queue(state, newPage)) {
+        webpage_delete(newPage);
+        return false;
+    }
+    procmesh_hold(state->mesh);
+    printf("Added: %s\n", url);
+    // DO NOT free(url); webpage_delete(newPage) will free it later
+    return true;
+}
+
+/**************** seqcrawl_dup() ****************/
+/* see seqcrawl.h for description */
+void
+seqcrawl_dup(void* arg, const char* url)
+{
+    seqcrawl_t* state = arg;
+    printf("IgnDupl: %s\n", url);
+    metrics_duplicate();
+    frontier_link(state->pagesToCrawl, url);
+}
+
+/**************** seqcrawl_queue() ****************/
+/* see seqcrawl.h for description */
+bool
+seqcrawl_queue(void* arg, webpage_t* page)
+{
+    seqcrawl_t* state = arg;
+    if (!frontier_push(state->pagesToCrawl, page)) {
+        return false;
+    }
+    metrics_queued(webpage_getDepth(page));
+    return true;
+}
+
+/**************** seqCheckpoint ****************/
+/* Take a checkpoint of a single-threaded crawl. */
+static void
+seqCheckpoint(seqcrawl_t* state, pagestore_t* store, const int nextDocID)
+{
+    checkpoint_t* cp = pagestore_checkpointBegin(store, nextDocID, state->pagesSeen);
+    frontier_iterate(state->pagesToCrawl, cp, pagestore_checkpointPage);
+    pagestore_checkpointEnd(cp, store);
+}
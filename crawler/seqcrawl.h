@@ -0,0 +1,72 @@
+/*
+ * seqcrawl.h - header file for the crawler's single-threaded crawl
+ *
+ * The default crawl: one thread takes the best page from the frontier,
+ * fetches it (finding its links as it arrives), and saves it, until the
+ * frontier is empty or the page budget is spent. The event-driven crawl
+ * (see asynccrawl.h) keeps its frontier and seen-set the same way, so
+ * the functions that add to them are exported too.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#ifndef __SEQCRAWL_H
+#define __SEQCRAWL_H
+
+#include <stdbool.h>
+#include "../libcs50/webpage.h"
+#include "crawlopts.h"
+#include "frontier.h"
+#include "seenset.h"
+#include "procmesh.h"
+#include "linkmemo.h"
+#include "politeness.h"
+
+/**************** global types ****************/
+/* the frontier and seen-set of a single-threaded crawl */
+typedef struct seqcrawl {
+    frontier_t* pagesToCrawl;    // pages waiting to be fetched, best first
+    seenset_t* pagesSeen;      // every URL ever added to pagesToCrawl
+    procmesh_t* mesh;            // the other processes (NULL: no --procs)
+    linkmemo_t* linkMemo;        // links handled before
+} seqcrawl_t;
+
+/**************** functions ****************/
+
+/**************** seqcrawl_run ****************/
+/* Initialize set of seen URLs and frontier of pages to crawl;
+ * add seedURL as depth 0 (or restore both from the last checkpoint);
+ * repeatedly fetch (scanning it for links as it arrives) and save the
+ * best page until the frontier is empty or the page budget is spent,
+ * taking a checkpoint every opts->checkpointEvery pages and at the end
+ */
+void seqcrawl_run(char* seedURL, char* pageDirectory, const int maxDepth,
+                  const crawlopts_t* opts, politeness_t* polite, const crawlpart_t* part);
+
+/**************** seqcrawl_add ****************/
+/* addURL for the single-threaded crawls: arg is a seqcrawl_t*.
+ * If url is new, record it in pagesSeen and queue a page for it, which
+ * takes ownership of url; otherwise count the link and free url.
+ * With --procs, a new url another process owns is sent to it instead
+ * (or, if that fails, queued here after all). Return true iff queued.
+ */
+bool seqcrawl_add(void* arg, char* url, const int depth);
+
+/**************** seqcrawl_dup ****************/
+/* dupURL for the single-threaded crawls: arg is a seqcrawl_t*.
+ * Count a link to url, which is in pagesSeen already.
+ */
+void seqcrawl_dup(void* arg, const char* url);
+
+/**************** seqcrawl_queue ****************/
+/* Push page onto the frontier of the seqcrawl_t* arg. */
+bool seqcrawl_queue(void* arg, webpage_t* page);
+
+/**************** seqcrawl_newDocID ****************/
+/* Return the docID for a new page about to be saved: the next of *docID,
+ * which moves on; or with --procs (mesh not NULL) the next of the whole
+ * crawl, or 0 if its page budget is spent.
+ */
+int seqcrawl_newDocID(procmesh_t* mesh, int* docID);
+
+#endif // __SEQCRAWL_H
@@ -0,0 +1,391 @@
+/*
+ * simhash.c - SimHash fingerprints and a multi-index Hamming lookup table
+ *
+ * see simhash.h for more information.
+ *
+ * simhash_page hashes each word to 64 bits and keeps one counter per bit
+ * position, adding 1 where the word's hash has a 1 bit and subtracting 1
+ * where it has a 0; bit i of the fingerprint is set iff counter i ends up
+ * positive. Words that appear often pull hardest, and a few changed words
+ * flip only the bits whose counters were close to zero.
+ *
+ * simhash_confirm hashes each run of 3 words of each page to 64 bits,
+ * sorts each page's hashes and drops repeats, and counts the hashes the
+ * two sorted sets share with one merge. Two different shingles with the
+ * same hash would count as one, at odds of about 1 in 2^64 per pair.
+ *
+ * The simindex keeps its entries in one array. For each of its d+1 blocks
+ * it has a chained hash table: heads[t][bucket] is the first entry whose
+ * block t hashes to that bucket, and next[t][entry] the entry after it.
+ * All tables have as many buckets as the array has room for entries, and
+ * everything is rebuilt at twice the size when the array fills.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "simhash.h"
+
+/**************** file-local global variables ****************/
+static const int MIN_WORDS = 8;           // fewer words: no fingerprint
+static const int INITIAL_BITS = 6;        // log2 of the entries in a new index
+#define MAX_TABLES (SIMHASH_MAX_DISTANCE + 1)
+
+/**************** local types ****************/
+typedef struct simentry {
+    uint64_t fp;
+    int docID;
+} simentry_t;
+
+/**************** global types ****************/
+typedef struct simindex {
+    int maxDistance;
+    int numTables;                 // maxDistance + 1
+    int start[MAX_TABLES];         // block t is bits start[t]..start[t]+width[t]-1
+    int width[MAX_TABLES];
+    simentry_t* entries;
+    int count;                     // entries in use
+    int bits;                      // entries and buckets: 1 << bits of each
+    int* heads[MAX_TABLES];        // heads[t][bucket]: first entry, or -1
+    int* next[MAX_TABLES];         // next[t][entry]: next entry, or -1
+} simindex_t;
+
+/**************** local functions ****************/
+static uint64_t hashWord(const char* word);
+static uint64_t* shingles(webpage_t* page, long* count);
+static int compareHashes(const void* a, const void* b);
+static uint64_t block(const simindex_t* si, const uint64_t fp, const int t);
+static int bucket(const simindex_t* si, const uint64_t key, const int t);
+static bool grow(simindex_t* si);
+static void chain(simindex_t* si, const int entry);
+
+/**************** simhash_page() ****************/
+/* see simhash.h for description */
+uint64_t
+simhash_page(webpage_t* page)
+{
+    if (page == NULL || webpage_getHTML(page) == NULL) {
+        return 0;
+    }
+
+    int counts[64] = { 0 };
+    int numWords = 0;
+    int pos = 0;
+    char* word;
+    while ((word = webpage_getNextWord(page, &pos)) != NULL) {
+        if (word[0] != '\0' && word[1] != '\0' && word[2] != '\0') {   // 3 or more
+            uint64_t h = hashWord(word);
+            for (int i = 0; i < 64; i++) {
+                counts[i] += ((h >> i) & 1) ? 1 : -1;
+            }
+            numWords++;
+        }
+        free(word);
+    }
+    if (numWords < MIN_WORDS) {
+        return 0;
+    }
+
+    uint64_t fp = 0;
+    for (int i = 0; i < 64; i++) {
+        if (counts[i] > 0) {
+            fp |= 1ULL << i;
+        }
+    }
+    return (fp != 0) ? fp : 1;        // 0 means "no fingerprint"
+}
+
+/**************** simhash_confirm() ****************/
+/* see simhash.h for description */
+bool
+simhash_confirm(webpage_t* page, webpage_t* other)
+{
+    long n1, n2;
+    uint64_t* s1 = shingles(page, &n1);
+    uint64_t* s2 = shingles(other, &n2);
+    if (s1 == NULL || s2 == NULL) {
+        free(s1);
+        free(s2);
+        return false;
+    }
+
+    long shared = 0;
+    for (long i = 0, j = 0; i < n1 && j < n2; ) {
+        if (s1[i] < s2[j]) {
+            i++;
+        } else if (s1[i] > s2[j]) {
+            j++;
+        } else {
+            shared++;
+            i++;
+            j++;
+        }
+    }
+    free(s1);
+    free(s2);
+    long either = n1 + n2 - shared;
+    return either > 0 && shared >= SIMHASH_MIN_RESEMBLANCE * either;
+}
+
+/**************** simindex_new() ****************/
+/* see simhash.h for description */
+simindex_t*
+simindex_new(const int maxDistance)
+{
+    if (maxDistance < 0 || maxDistance > SIMHASH_MAX_DISTANCE) {
+        return NULL;
+    }
+
+    simindex_t* si = calloc(1, sizeof(simindex_t));
+    if (si == NULL) {
+        return NULL;
+    }
+    si->maxDistance = maxDistance;
+    si->numTables = maxDistance + 1;
+    // split the 64 bits as evenly as possible
+    for (int t = 0, start = 0; t < si->numTables; t++) {
+        si->start[t] = start;
+        si->width[t] = (64 - start) / (si->numTables - t);
+        start += si->width[t];
+    }
+    si->bits = INITIAL_BITS - 1;      // grow() doubles it
+    if (!grow(si)) {
+        simindex_delete(si);
+        return NULL;
+    }
+    return si;
+}
+
+/**************** simindex_find() ****************/
+/* see simhash.h for description */
+int
+simindex_find(simindex_t* si, const uint64_t fp)
+{
+    if (si == NULL || fp == 0) {
+        return 0;
+    }
+
+    int bestDocID = 0;
+    int bestDistance = si->maxDistance + 1;
+    for (int t = 0; t < si->numTables; t++) {
+        uint64_t key = block(si, fp, t);
+        for (int e = si->heads[t][bucket(si, key, t)]; e >= 0; e = si->next[t][e]) {
+            const simentry_t* entry = &si->entries[e];
+            if (block(si, entry->fp, t) == key) {
+                int distance = __builtin_popcountll(entry->fp ^ fp);
+                if (distance < bestDistance
+                    || (distance == bestDistance && entry->docID < bestDocID)) {
+                    bestDistance = distance;
+                    bestDocID = entry->docID;
+                }
+            }
+        }
+    }
+    return bestDocID;
+}
+
+/**************** simindex_add() ****************/
+/* see simhash.h for description */
+bool
+simindex_add(simindex_t* si, const uint64_t fp, const int docID)
+{
+    if (si == NULL || fp == 0 || docID <= 0) {
+        return false;
+    }
+
+    if (si->count == (1 << si->bits) && !grow(si)) {
+        return false;
+    }
+    si->entries[si->count].fp = fp;
+    si->entries[si->count].docID = docID;
+    chain(si, si->count);
+    si->count++;
+    return true;
+}
+
+/**************** simindex_delete() ****************/
+/* see simhash.h for description */
+void
+simindex_delete(simindex_t* si)
+{
+    if (si != NULL) {
+        for (int t = 0; t < si->numTables; t++) {
+            free(si->heads[t]);
+            free(si->next[t]);
+        }
+        free(si->entries);
+        free(si);
+    }
+}
+
+/**************** hashWord ****************/
+/* Hash a word, ignoring case, to 64 well-mixed bits: FNV-1a, then the
+ * MurmurHash3 finalizer.
+ */
+static uint64_t
+hashWord(const char* word)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (const unsigned char* p = (const unsigned char*)word; *p != '\0'; p++) {
+        h = (h ^ tolower(*p)) * 0x100000001b3ULL;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+/**************** shingles ****************/
+/* Return the distinct hashes of the page's runs of 3 words (words of 3
+ * or more letters, ignoring case), sorted, with their number in *count;
+ * NULL if the page has no HTML or memory is exhausted. The caller frees it.
+ */
+static uint64_t*
+shingles(webpage_t* page, long* count)
+{
+    if (page == NULL || webpage_getHTML(page) == NULL) {
+        return NULL;
+    }
+
+    long n = 0;
+    long capacity = 64;
+    uint64_t* hashes = malloc(capacity * sizeof(uint64_t));
+    uint64_t prev2 = 0, prev1 = 0;      // hashes of the two words before
+    int numWords = 0;
+    int pos = 0;
+    char* word;
+    while (hashes != NULL && (word = webpage_getNextWord(page, &pos)) != NULL) {
+        if (word[0] != '\0' && word[1] != '\0' && word[2] != '\0') {   // 3 or more
+            uint64_t h = hashWord(word);
+            if (++numWords >= 3) {
+                if (n == capacity) {
+                    capacity *= 2;
+                    uint64_t* bigger = realloc(hashes, capacity * sizeof(uint64_t));
+                    if (bigger == NULL) {
+                        free(hashes);
+                        hashes = NULL;
+                        free(word);
+                        break;
+                    }
+                    hashes = bigger;
+                }
+                // order matters: "a b c" and "c b a" are different shingles
+                hashes[n++] = (prev2 * 0x9e3779b97f4a7c15ULL + prev1) * 0xbf58476d1ce4e5b9ULL
+                              + h;
+            }
+            prev2 = prev1;
+            prev1 = h;
+        }
+        free(word);
+    }
+    if (hashes == NULL) {
+        return NULL;
+    }
+
+    qsort(hashes, n, sizeof(uint64_t), compareHashes);
+    long distinct = 0;
+    for (long i = 0; i < n; i++) {
+        if (distinct == 0 || hashes[i] != hashes[distinct - 1]) {
+            hashes[distinct++] = hashes[i];
+        }
+    }
+    *count = distinct;
+    return hashes;
+}
+
+/**************** compareHashes ****************/
+/* qsort comparator for uint64_t, ascending. */
+static int
+compareHashes(const void* a, const void* b)
+{
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+/**************** block ****************/
+/* Return block t of fp, shifted down to the low bits. */
+static uint64_t
+block(const simindex_t* si, const uint64_t fp, const int t)
+{
+    uint64_t mask = (si->width[t] < 64) ? (1ULL << si->width[t]) - 1 : ~0ULL;
+    return (fp >> si->start[t]) & mask;
+}
+
+/**************** bucket ****************/
+/* Return the bucket for block value key in table t: the top bits of a
+ * multiplicative hash, so keys that differ only in high bits spread too.
+ */
+static int
+bucket(const simindex_t* si, const uint64_t key, const int t)
+{
+    return (int)(((key + 1) * 0x9e3779b97f4a7c15ULL + (uint64_t)t) * 0xbf58476d1ce4e5b9ULL
+                 >> (64 - si->bits));
+}
+
+/**************** grow ****************/
+/* Double the room for entries and the buckets of every table, and relink
+ * the entries already stored. Returns false if memory is exhausted; the
+ * index is then unchanged.
+ */
+static bool
+grow(simindex_t* si)
+{
+    int bits = si->bits + 1;
+    int size = 1 << bits;
+    simentry_t* entries = realloc(si->entries, size * sizeof(simentry_t));
+    if (entries == NULL) {
+        return false;
+    }
+    si->entries = entries;
+
+    int* heads[MAX_TABLES];
+    int* next[MAX_TABLES];
+    bool ok = true;
+    for (int t = 0; t < si->numTables; t++) {
+        heads[t] = malloc(size * sizeof(int));
+        next[t] = malloc(size * sizeof(int));
+        ok = ok && heads[t] != NULL && next[t] != NULL;
+    }
+    if (!ok) {
+        for (int t = 0; t < si->numTables; t++) {
+            free(heads[t]);
+            free(next[t]);
+        }
+        return false;
+    }
+
+    for (int t = 0; t < si->numTables; t++) {
+        free(si->heads[t]);
+        free(si->next[t]);
+        si->heads[t] = heads[t];
+        si->next[t] = next[t];
+        for (int b = 0; b < size; b++) {
+            heads[t][b] = -1;
+        }
+    }
+    si->bits = bits;
+    for (int e = 0; e < si->count; e++) {
+        chain(si, e);
+    }
+    return true;
+}
+
+/**************** chain ****************/
+/* Put entries[entry] at the head of its bucket's chain in every table. */
+static void
+chain(simindex_t* si, const int entry)
+{
+    uint64_t fp = si->entries[entry].fp;
+    for (int t = 0; t < si->numTables; t++) {
+        int b = bucket(si, block(si, fp, t), t);
+        si->next[t][entry] = si->heads[t][b];
+        si->heads[t][b] = entry;
+    }
+}
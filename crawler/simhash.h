@@ -0,0 +1,87 @@
+/*
+ * simhash.h - header file for the crawler's near-duplicate detector
+ *
+ * A page's *SimHash* is a 64-bit fingerprint of its words in which similar
+ * pages get similar fingerprints: the more words two pages share, the
+ * fewer bits (the smaller the Hamming distance) in which their
+ * fingerprints differ. Mirrors, and templated pages that differ only in
+ * their URL or a line or two, land within a few bits of each other.
+ *
+ * A SimHash match only says two pages may be alike: pages that share a
+ * large template can land within a few bits of each other even when
+ * their own text differs. simhash_confirm settles it by comparing the
+ * pages' word shingles exactly.
+ *
+ * A *simindex* holds the fingerprints of the pages saved so far and finds
+ * one within a fixed distance d of a new fingerprint without comparing
+ * against them all. It splits the 64 bits into d+1 blocks; two
+ * fingerprints that differ in at most d bits must agree exactly in at
+ * least one block, so it keeps one hash table per block and compares only
+ * against fingerprints that share a block with the new one.
+ *
+ * Neither is thread-safe; the parallel crawl guards its simindex with a
+ * mutex.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#ifndef __SIMHASH_H
+#define __SIMHASH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "../libcs50/webpage.h"
+
+/**************** global types ****************/
+typedef struct simindex simindex_t;  // opaque to users of the module
+
+/**************** global constants ****************/
+#define SIMHASH_MAX_DISTANCE 8       // largest distance a simindex supports
+#define SIMHASH_MIN_RESEMBLANCE 0.8  // share of shingles near-duplicates share
+
+/**************** functions ****************/
+
+/**************** simhash_page ****************/
+/* Return the SimHash of the page's words, as the indexer sees them
+ * (runs of 3 or more letters, ignoring case), or 0 if the page has too
+ * few words for its fingerprint to mean much.
+ */
+uint64_t simhash_page(webpage_t* page);
+
+/**************** simhash_confirm ****************/
+/* Return true iff page and other are near-duplicates: of the shingles
+ * (runs of 3 words, as simhash_page sees words) found in either, at
+ * least SIMHASH_MIN_RESEMBLANCE are found in both. False if either is
+ * NULL, has no HTML, or memory is exhausted.
+ */
+bool simhash_confirm(webpage_t* page, webpage_t* other);
+
+/**************** simindex_new ****************/
+/* Create a new (empty) index that matches fingerprints within
+ * maxDistance bits of each other.
+ *
+ * We return:
+ *   pointer to a new index, or NULL if maxDistance is not in
+ *   [0, SIMHASH_MAX_DISTANCE] or memory is exhausted.
+ * Caller is responsible for:
+ *   later calling simindex_delete.
+ */
+simindex_t* simindex_new(const int maxDistance);
+
+/**************** simindex_find ****************/
+/* Return the docID of the stored fingerprint closest to fp, if one is
+ * within the index's distance of it; otherwise (or if fp is 0) return 0.
+ */
+int simindex_find(simindex_t* si, const uint64_t fp);
+
+/**************** simindex_add ****************/
+/* Store fp as the fingerprint of docID (docID > 0).
+ * We return false if fp is 0, a parameter is bad, or memory is exhausted.
+ */
+bool simindex_add(simindex_t* si, const uint64_t fp, const int docID);
+
+/**************** simindex_delete ****************/
+/* Delete the index. */
+void simindex_delete(simindex_t* si);
+
+#endif // __SIMHASH_H
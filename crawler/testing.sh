@@ -22,6 +22,25 @@ mkdir -p ../data/toscrape-1
 mkdir -p ../data/wiki-0
 mkdir -p ../data/wiki-1
 
+# The crawler's own options are tested on a stand-in server (see ../bench),
+# so they need no network: a site of 16 pages, 3 links each, a fifth of
+# them near-copies of the page before
+SERVERPORT=18080
+BENCH="http://localhost:$SERVERPORT/tse/bench/p0.html"
+INTERNAL="--internal http://localhost:$SERVERPORT/tse/"
+make -C ../bench tseserver > /dev/null
+../bench/tseserver --port $SERVERPORT --pages 16 --links 3 --size 1500 --spread 0.3 --copies 0.2 > ../data/tseserver.out &
+SERVER=$!
+trap 'kill $SERVER' EXIT
+for i in $(seq 50); do [ -s ../data/tseserver.out ] && break; sleep 0.1; done
+cat ../data/tseserver.out
+
+# An index as one "word docID count" line per pair, sorted, so indexes
+# with the same contents compare equal whatever order they were saved in
+sortindex() {
+    awk '{ for (i = 2; i < NF; i += 2) print $1, $i, $(i + 1) }' "$1" | sort
+}
+
 echo
 echo "### Part 1: bad argument tests"
 
@@ -49,6 +68,10 @@ echo "6) Non-existent pageDirectory"
 $CRAWLER "$LETTERS" ../data/noSuchDir 1
 echo
 
+echo "6a) Bad thread count"
+$CRAWLER -j 0 "$LETTERS" ../data/letters-0 1
+echo
+
 echo
 echo "### Part 2: small valid crawls"
 
@@ -76,6 +99,201 @@ echo "12) wikipedia at depth 1"
 $CRAWLER "$WIKI" ../data/wiki-1 1
 echo
 
+echo "13) the stand-in site at depth 2 with 4 worker threads"
+mkdir -p ../data/bench-2-j4
+$CRAWLER -j 4 $INTERNAL "$BENCH" ../data/bench-2-j4 2
+echo
+
+echo "14) the stand-in site at depth 2 with the event-driven fetcher"
+mkdir -p ../data/bench-2-a20
+$CRAWLER -a 20 --connect-timeout 2000 --read-timeout 10000 $INTERNAL "$BENCH" ../data/bench-2-a20 2
+echo
+
+echo "15) the stand-in site at depth 2, two requests per second with bursts of 3"
+mkdir -p ../data/bench-2-rate
+$CRAWLER --rate 2 --burst 3 $INTERNAL "$BENCH" ../data/bench-2-rate 2
+echo
+
+echo "15a) Bad rate"
+$CRAWLER --rate -1 "$LETTERS" ../data/letters-0 1
+echo
+
+echo "16) the stand-in site at depth 10, most-linked pages first, stopping after 8 pages"
+mkdir -p ../data/bench-10-top8
+$CRAWLER --priority inlinks --max-pages 8 $INTERNAL "$BENCH" ../data/bench-10-top8 10
+echo
+
+echo "16a) Bad priority"
+$CRAWLER --priority random "$LETTERS" ../data/letters-0 1
+echo
+
+echo "16b) -j with a priority its threads cannot keep"
+$CRAWLER -j 4 --priority inlinks "$LETTERS" ../data/letters-0 1
+echo
+
+echo "17) the stand-in site at depth 10, stopping after 5 pages, then resuming to the end"
+mkdir -p ../data/bench-10-resume
+$CRAWLER --max-pages 5 --checkpoint 2 $INTERNAL "$BENCH" ../data/bench-10-resume 10
+$CRAWLER --resume $INTERNAL "$BENCH" ../data/bench-10-resume 10
+ls ../data/bench-10-resume | sort -n | tr '\n' ' '
+echo
+
+echo "18) the stand-in site at depth 10 with the seen-URL set sized for 1 URL, so it must grow"
+mkdir -p ../data/bench-10-grow
+$CRAWLER --rate 0 --expected-urls 1 $INTERNAL "$BENCH" ../data/bench-10-grow 10
+echo
+
+echo "19) the stand-in site at depth 10, skipping pages within 3 bits of one already saved"
+mkdir -p ../data/bench-10-neardup
+$CRAWLER --rate 0 --near-dup 3 $INTERNAL "$BENCH" ../data/bench-10-neardup 10 | grep "^NearDup:"
+cat ../data/bench-10-neardup/.aliases
+echo
+
+echo "19a) Bad near-duplicate distance"
+$CRAWLER --near-dup 9 "$LETTERS" ../data/letters-0 1
+echo
+
+echo "20) the stand-in site at depth 1 with -a: links are queued while each page is still arriving,"
+echo "    so every Scanning line comes before its page's Fetched line"
+mkdir -p ../data/bench-1-stream
+$CRAWLER -a 1 $INTERNAL "$BENCH" ../data/bench-1-stream 1 | grep -E "^(Scanning|Fetched|Added):"
+echo
+
+echo "21) the stand-in site at depth 10 with compressed page files, then indexed as usual"
+mkdir -p ../data/bench-10-lz
+$CRAWLER --rate 0 --compress lz $INTERNAL "$BENCH" ../data/bench-10-lz 10 > /dev/null
+head -c 4 ../data/bench-10-lz/1 | od -c | head -1
+../indexer/indexer ../data/bench-10-lz ../data/bench-10-lz.index
+echo
+
+echo "21a) Bad codec"
+$CRAWLER --compress gzip "$LETTERS" ../data/letters-0 1
+echo
+
+echo "22) the stand-in site at depth 10 with -j 4, pages packed into one segment file, then indexed as usual"
+mkdir -p ../data/bench-10-pack
+$CRAWLER --rate 0 -j 4 --pack --compress lz $INTERNAL "$BENCH" ../data/bench-10-pack 10 > /dev/null
+ls -A ../data/bench-10-pack
+../indexer/indexer ../data/bench-10-pack ../data/bench-10-pack.index
+echo
+
+echo "23) the stand-in site at depth 10, then recrawled: every page answers 304 and keeps its docID"
+mkdir -p ../data/bench-10-recrawl
+$CRAWLER --rate 0 $INTERNAL "$BENCH" ../data/bench-10-recrawl 10 > /dev/null
+$CRAWLER --rate 0 --recrawl $INTERNAL "$BENCH" ../data/bench-10-recrawl 10 | grep -E "^(Recrawling|Unchanged|Fetched):"
+head -3 ../data/bench-10-recrawl/.meta
+echo
+
+echo "23a) --recrawl with a page budget"
+$CRAWLER --recrawl --max-pages 5 "$LETTERS" ../data/letters-0 1
+echo
+
+echo "24) Bad internal prefix"
+$CRAWLER --internal ftp://localhost/tse/ "$LETTERS" ../data/letters-0 1
+echo
+
+echo "24a) seedURL outside a custom internal prefix"
+$CRAWLER --internal http://localhost:8080/tse/ "$LETTERS" ../data/letters-0 1
+echo
+
+echo "25) the stand-in site at depth 10 with -j 4 and --index: the same index the indexer builds"
+mkdir -p ../data/bench-10-index
+$CRAWLER --rate 0 -j 4 --index ../data/bench-10-index.crawled $INTERNAL "$BENCH" ../data/bench-10-index 10 | grep "^Indexed:"
+../indexer/indexer ../data/bench-10-index ../data/bench-10-index.index
+diff <(sortindex ../data/bench-10-index.crawled) <(sortindex ../data/bench-10-index.index) && echo "same index"
+echo
+
+echo "25a) --no-pages without --index"
+$CRAWLER --no-pages "$LETTERS" ../data/letters-0 1
+echo
+
+echo "26) the stand-in site at depth 10 split among 3 processes, with --index: same pages, same index"
+mkdir -p ../data/bench-10-procs
+$CRAWLER --rate 0 --procs 3 --index ../data/bench-10-procs.crawled $INTERNAL "$BENCH" ../data/bench-10-procs 10 | grep "^Procs:"
+../indexer/indexer ../data/bench-10-procs ../data/bench-10-procs.index
+diff <(sortindex ../data/bench-10-procs.crawled) <(sortindex ../data/bench-10-procs.index) && echo "same index"
+echo
+
+echo "26a) --procs with -j"
+$CRAWLER --procs 2 -j 2 "$LETTERS" ../data/letters-0 1
+echo
+
+echo "27) the stand-in site at depth 10 with --metrics: every page counted, and a final snapshot"
+mkdir -p ../data/bench-10-metrics
+$CRAWLER --rate 0 -a 4 --metrics ../data/bench-10-metrics.jsonl $INTERNAL "$BENCH" ../data/bench-10-metrics 10 | grep "^Metrics: [0-9]" | sed 's/ in .*//'
+grep -c '"type":"final"' ../data/bench-10-metrics.jsonl
+echo
+
+echo "27a) --metrics-every out of range"
+$CRAWLER --metrics /dev/null --metrics-every 0 "$LETTERS" ../data/letters-0 1
+echo
+
+echo "28) the stand-in site at depth 10, twice: the link memo changes nothing but the work done"
+mkdir -p ../data/bench-10-memo
+$CRAWLER --rate 0 $INTERNAL "$BENCH" ../data/bench-10-memo 10 > ../data/bench-10-memo.out
+grep -c "^IgnDupl" ../data/bench-10-memo.out
+grep "^Link memo:" ../data/bench-10-memo.out
+$CRAWLER --rate 0 -a 4 $INTERNAL "$BENCH" ../data/bench-10-memo 10 | grep -v "^Link memo:\|^Resolver:\|^Page writer:" | sort | diff - <(grep -v "^Link memo:\|^Resolver:\|^Page writer:" ../data/bench-10-memo.out | sort) && echo "same output"
+echo
+
+echo "29) the stand-in site at depth 10 under each --fsync policy, in files and in a pack: same pages"
+for policy in none batch page; do
+    mkdir -p ../data/bench-10-fsync-$policy ../data/bench-10-fsync-pack-$policy
+    $CRAWLER --rate 0 --fsync $policy $INTERNAL "$BENCH" ../data/bench-10-fsync-$policy 10 | grep "^Page writer:" | sed 's/ in .*//'
+    $CRAWLER --rate 0 --pack --fsync $policy $INTERNAL "$BENCH" ../data/bench-10-fsync-pack-$policy 10 > /dev/null
+done
+for policy in batch page; do
+    diff -r ../data/bench-10-fsync-none ../data/bench-10-fsync-$policy && echo "$policy: same files"
+    diff -r ../data/bench-10-fsync-pack-none ../data/bench-10-fsync-pack-$policy && echo "$policy: same pack"
+done
+echo
+
+echo "29a) an unknown --fsync policy"
+$CRAWLER --fsync always "$LETTERS" ../data/letters-0 1
+echo
+
+echo "30) the stand-in site at depth 10 with --io uring, synced per page and not: same files as --io sync"
+for policy in none page; do
+    mkdir -p ../data/bench-10-io-uring-$policy
+    $CRAWLER --rate 0 --io uring --fsync $policy $INTERNAL "$BENCH" ../data/bench-10-io-uring-$policy 10 > /dev/null
+    diff -r ../data/bench-10-fsync-$policy ../data/bench-10-io-uring-$policy && echo "$policy: same files"
+done
+echo
+
+echo "30a) an unknown --io backend"
+$CRAWLER --io aio "$LETTERS" ../data/letters-0 1
+echo
+
+echo "31) the streaming link scanner (-a) and webpage_getNextURL find the same links,"
+echo "    an empty href (the page's own directory) included: no MISMATCH"
+make -C ../bench linkbench > /dev/null
+../bench/linkbench --megabytes 1 --runs 1 | grep -c MISMATCH
+echo
+
+echo "32) the stand-in site at depth 1 while the first DNS lookup fails with EAI_AGAIN: the retry resolves it"
+cat > ../data/eaiagain.c <<'EOF'
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <netdb.h>
+int getaddrinfo(const char* node, const char* service, const struct addrinfo* hints,
+                struct addrinfo** res)
+{
+    static int calls = 0;
+    int (*real)(const char*, const char*, const struct addrinfo*, struct addrinfo**);
+    if (calls++ == 0) {
+        return EAI_AGAIN;
+    }
+    *(void**)&real = dlsym(RTLD_NEXT, "getaddrinfo");
+    return real(node, service, hints, res);
+}
+EOF
+gcc -shared -fPIC -o ../data/eaiagain.so ../data/eaiagain.c -ldl
+mkdir -p ../data/bench-1-eaiagain
+LD_PRELOAD=../data/eaiagain.so $CRAWLER $INTERNAL "$BENCH" ../data/bench-1-eaiagain 1 | grep "^Resolver:"
+ls ../data/bench-1-eaiagain | sort -n | tr '\n' ' '
+echo
+echo
+
 echo "### Valgrind - see Makefile, run separately 'make valgrind'"
 
 echo "### Done testing."
\ No newline at end of file
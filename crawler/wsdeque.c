@@ -0,0 +1,188 @@
+/*
+ * wsdeque.c - work-stealing deque for the crawler's worker threads
+ *
+ * see wsdeque.h for more information.
+ *
+ * Each deque is protected by its own mutex. Contention is low: the owner
+ * is usually the only one touching it, and thieves only show up when
+ * their own deque is empty. Fetch latency dwarfs the cost of the lock.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "wsdeque.h"
+
+/**************** file-local global variables ****************/
+static const int INITIAL_CAPACITY = 64;   // slots in a new deque
+
+/**************** global types ****************/
+typedef struct wsdeque {
+    void** items;             // circular array of items[capacity]
+    int capacity;             // number of slots in items
+    int top;                  // index of the oldest item
+    int count;                // number of items in the deque
+    pthread_mutex_t lock;     // protects all of the above
+} wsdeque_t;
+
+/**************** local functions ****************/
+static bool grow(wsdeque_t* dq);
+
+/**************** wsdeque_new() ****************/
+/* see wsdeque.h for description */
+wsdeque_t*
+wsdeque_new(void)
+{
+    wsdeque_t* dq = malloc(sizeof(wsdeque_t));
+    if (dq == NULL) {
+        return NULL;
+    }
+
+    dq->items = malloc(INITIAL_CAPACITY * sizeof(void*));
+    if (dq->items == NULL) {
+        free(dq);
+        return NULL;
+    }
+    dq->capacity = INITIAL_CAPACITY;
+    dq->top = 0;
+    dq->count = 0;
+    pthread_mutex_init(&dq->lock, NULL);
+    return dq;
+}
+
+/**************** wsdeque_push() ****************/
+/* see wsdeque.h for description */
+bool
+wsdeque_push(wsdeque_t* dq, void* item)
+{
+    if (dq == NULL || item == NULL) {
+        return false;
+    }
+
+    pthread_mutex_lock(&dq->lock);
+    if (dq->count == dq->capacity && !grow(dq)) {
+        pthread_mutex_unlock(&dq->lock);
+        return false;
+    }
+    dq->items[(dq->top + dq->count) % dq->capacity] = item;
+    dq->count++;
+    pthread_mutex_unlock(&dq->lock);
+    return true;
+}
+
+/**************** wsdeque_pop() ****************/
+/* see wsdeque.h for description */
+void*
+wsdeque_pop(wsdeque_t* dq)
+{
+    if (dq == NULL) {
+        return NULL;
+    }
+
+    void* item = NULL;
+    pthread_mutex_lock(&dq->lock);
+    if (dq->count > 0) {
+        dq->count--;
+        item = dq->items[(dq->top + dq->count) % dq->capacity];
+    }
+    pthread_mutex_unlock(&dq->lock);
+    return item;
+}
+
+/**************** wsdeque_steal() ****************/
+/* see wsdeque.h for description */
+void*
+wsdeque_steal(wsdeque_t* dq)
+{
+    if (dq == NULL) {
+        return NULL;
+    }
+
+    void* item = NULL;
+    pthread_mutex_lock(&dq->lock);
+    if (dq->count > 0) {
+        item = dq->items[dq->top];
+        dq->top = (dq->top + 1) % dq->capacity;
+        dq->count--;
+    }
+    pthread_mutex_unlock(&dq->lock);
+    return item;
+}
+
+/**************** wsdeque_size() ****************/
+/* see wsdeque.h for description */
+int
+wsdeque_size(wsdeque_t* dq)
+{
+    if (dq == NULL) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&dq->lock);
+    int count = dq->count;
+    pthread_mutex_unlock(&dq->lock);
+    return count;
+}
+
+/**************** wsdeque_iterate() ****************/
+/* see wsdeque.h for description */
+void
+wsdeque_iterate(wsdeque_t* dq, void* arg,
+                void (*itemfunc)(void* arg, void* item))
+{
+    if (dq == NULL || itemfunc == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&dq->lock);
+    for (int i = 0; i < dq->count; i++) {
+        (*itemfunc)(arg, dq->items[(dq->top + i) % dq->capacity]);
+    }
+    pthread_mutex_unlock(&dq->lock);
+}
+
+/**************** wsdeque_delete() ****************/
+/* see wsdeque.h for description */
+void
+wsdeque_delete(wsdeque_t* dq, void (*itemdelete)(void* item))
+{
+    if (dq == NULL) {
+        return;
+    }
+
+    if (itemdelete != NULL) {
+        for (int i = 0; i < dq->count; i++) {
+            (*itemdelete)(dq->items[(dq->top + i) % dq->capacity]);
+        }
+    }
+    pthread_mutex_destroy(&dq->lock);
+    free(dq->items);
+    free(dq);
+}
+
+/**************** grow ****************/
+/* Double the capacity of the deque, unwrapping the circular array so
+ * the oldest item lands in slot 0. Caller holds dq->lock.
+ * Returns false if memory is exhausted; the deque is then unchanged.
+ */
+static bool
+grow(wsdeque_t* dq)
+{
+    int newCapacity = dq->capacity * 2;
+    void** items = malloc(newCapacity * sizeof(void*));
+    if (items == NULL) {
+        return false;
+    }
+
+    for (int i = 0; i < dq->count; i++) {
+        items[i] = dq->items[(dq->top + i) % dq->capacity];
+    }
+    free(dq->items);
+    dq->items = items;
+    dq->capacity = newCapacity;
+    dq->top = 0;
+    return true;
+}
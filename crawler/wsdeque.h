@@ -0,0 +1,83 @@
+/*
+ * wsdeque.h - header file for the crawler's work-stealing deque module
+ *
+ * A *wsdeque* is a double-ended queue of items owned by one worker thread.
+ * The owner pushes and pops items at the bottom end (LIFO, which keeps a
+ * worker on the pages it just discovered); other workers that have run out
+ * of work steal items from the top end (the oldest, usually shallowest,
+ * pages). All operations are safe to call from any thread.
+ *
+ * Items are stored in a circular array that doubles when full, so pushes
+ * are amortized O(1) and do not allocate a node per item.
+ *
+ * CS50 FA25 Final Project
+ */
+
+#ifndef __WSDEQUE_H
+#define __WSDEQUE_H
+
+#include <stdbool.h>
+
+/**************** global types ****************/
+typedef struct wsdeque wsdeque_t;  // opaque to users of the module
+
+/**************** functions ****************/
+
+/**************** wsdeque_new ****************/
+/* Create a new (empty) deque.
+ *
+ * We return:
+ *   pointer to a new deque, or NULL if error.
+ * Caller is responsible for:
+ *   later calling wsdeque_delete.
+ */
+wsdeque_t* wsdeque_new(void);
+
+/**************** wsdeque_push ****************/
+/* Add an item at the owner's (bottom) end of the deque.
+ *
+ * Caller provides:
+ *   valid deque pointer and a valid item pointer.
+ * We return:
+ *   true if the item was added;
+ *   false if any parameter is NULL or memory is exhausted.
+ */
+bool wsdeque_push(wsdeque_t* dq, void* item);
+
+/**************** wsdeque_pop ****************/
+/* Remove and return the item most recently pushed (bottom end).
+ *
+ * We return:
+ *   pointer to an item, or NULL if the deque is NULL or empty.
+ */
+void* wsdeque_pop(wsdeque_t* dq);
+
+/**************** wsdeque_steal ****************/
+/* Remove and return the oldest item in the deque (top end).
+ * Intended for workers other than the owner.
+ *
+ * We return:
+ *   pointer to an item, or NULL if the deque is NULL or empty.
+ */
+void* wsdeque_steal(wsdeque_t* dq);
+
+/**************** wsdeque_size ****************/
+/* Return the number of items currently in the deque (0 if NULL).
+ * The answer may be stale by the time the caller looks at it.
+ */
+int wsdeque_size(wsdeque_t* dq);
+
+/**************** wsdeque_iterate ****************/
+/* Call itemfunc(arg, item) on each item in the deque, oldest first.
+ * The deque is locked meanwhile, so itemfunc must not use it.
+ */
+void wsdeque_iterate(wsdeque_t* dq, void* arg,
+                     void (*itemfunc)(void* arg, void* item));
+
+/**************** wsdeque_delete ****************/
+/* Delete the deque, calling itemdelete (if not NULL) on each item left.
+ * The caller must ensure no other thread is still using the deque.
+ */
+void wsdeque_delete(wsdeque_t* dq, void (*itemdelete)(void* item));
+
+#endif // __WSDEQUE_H
@@ -10,10 +10,9 @@
  #include "../libcs50/webpage.h"
  #include "../common/index.h"
  #include "../common/pagedir.h"
- #include "../common/word.h"
+ #include "../common/pagepack.h"
  
  static index_t* indexBuild(const char* pageDirectory);
- static void indexPage(webpage_t* page, index_t* index, int docID);
  static void parseArgs(int argc, char* argv[], char** pageDirectory, char** indexFilename);
  
  int main(int argc, char* argv[]) {
@@ -73,38 +72,23 @@
      fprintf(stderr, "Error: Could not create index.\n");
      return NULL;
    }
+   // Open the pages, whether packed or one file per docID
+   pagepack_t* pages = pagepack_open(pageDirectory);
+   if (pages == NULL) {
+     fprintf(stderr, "Error: Could not read the pages in '%s'.\n", pageDirectory);
+     index_delete(index);
+     return NULL;
+   }
    int docID_new = 1;    // Document ID starts from 1
-   // Continuously read documents from pageDirectory
-   while(true) {
-     webpage_t* webpageNew = pagedir_load(pageDirectory, docID_new);
-     if(webpageNew == NULL) {
-         break;  // Exit loop if no more pages are found
-     }
-     // Process the loaded webpage
-     indexPage(webpageNew, index, docID_new);
+   pagedir_view_t view;
+   // Continuously map documents from pageDirectory, and index them in place
+   while(pagepack_map(pages, docID_new, &view)) {
+     index_addText(index, view.html, view.htmlLen, docID_new);
      docID_new += 1;
-     // Free the allocated memory for the loaded webpage
-     webpage_delete(webpageNew);
+     // Release the mapping of the page
+     pagedir_unmap(&view);
    }
+   pagepack_close(pages);
  
    return index;
  }
- 
- // Scan a webpage document to add its words to the index
- static void indexPage(webpage_t* page, index_t* index, int docID) {
-   int pos = 0;
-   char* word;
- 
-   // Extract words from the webpage
-   while ((word = webpage_getNextWord(page, &pos)) != NULL) {
-     // Only consider words that have 3 or more characters
-     if (strlen(word) >= 3) {
-       // Normalize the word and add it to index
-       char* normalizedWord = NormalizeWord(word);
-       index_add(index, normalizedWord, docID);
-       free(normalizedWord);
-     }
-     free(word);
-   }
- }
- 
\ No newline at end of file
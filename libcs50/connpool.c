@@ -0,0 +1,174 @@
+/*
+ * connpool - pool of idle keep-alive connections, keyed by host and port
+ *
+ * See connpool.h for usage.
+ *
+ * The pool is a small fixed array searched linearly; a crawl talks to few
+ * hosts at once, and the array never holds more than MAX_IDLE entries.
+ * Among several idle connections to one host we hand out the most
+ * recently used, since it is the least likely to have been closed by
+ * the server's own idle timer.
+ */
+
+#define _GNU_SOURCE       // clock_gettime
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "connpool.h"
+
+/**************** file-local global variables ****************/
+#define MAX_IDLE 64              // idle connections kept in all
+#define MAX_HOSTNAME 256         // longest hostname we pool
+static const int MAX_PER_HOST = 8;      // idle connections kept per host
+static const long IDLE_TIMEOUT = 30;    // seconds before we discard one
+
+/**************** local types ****************/
+typedef struct idleconn {
+  bool used;                     // false if the entry is empty
+  int fd;                        // socket
+  int port;
+  char hostname[MAX_HOSTNAME];
+  long lastUsed;                 // when it went idle (monotonic seconds)
+} idleconn_t;
+
+static idleconn_t pool[MAX_IDLE];       // all empty to begin with
+static pthread_mutex_t poolLock = PTHREAD_MUTEX_INITIALIZER;
+
+/**************** local functions ****************/
+static long nowSec(void);
+static bool isAlive(const int fd);
+
+/**************** connpool_get() ****************/
+/* see connpool.h for description */
+int
+connpool_get(const char* hostname, const int port)
+{
+  if (hostname == NULL) {
+    return -1;
+  }
+
+  long now = nowSec();
+  int fd = -1;
+  pthread_mutex_lock(&poolLock);
+  while (fd < 0) {
+    // find the most recently used entry for this host
+    idleconn_t* best = NULL;
+    for (int i = 0; i < MAX_IDLE; i++) {
+      idleconn_t* c = &pool[i];
+      if (c->used && c->port == port && strcmp(c->hostname, hostname) == 0
+          && (best == NULL || c->lastUsed > best->lastUsed)) {
+        best = c;
+      }
+    }
+    if (best == NULL) {
+      break;
+    }
+
+    int candidate = best->fd;
+    best->used = false;
+    if (now - best->lastUsed < IDLE_TIMEOUT && isAlive(candidate)) {
+      fd = candidate;
+    } else {
+      close(candidate);         // stale; try the next one
+    }
+  }
+  pthread_mutex_unlock(&poolLock);
+  return fd;
+}
+
+/**************** connpool_put() ****************/
+/* see connpool.h for description */
+void
+connpool_put(const char* hostname, const int port, const int fd)
+{
+  if (fd < 0) {
+    return;
+  }
+  if (hostname == NULL || strlen(hostname) >= MAX_HOSTNAME) {
+    close(fd);
+    return;
+  }
+
+  long now = nowSec();
+  pthread_mutex_lock(&poolLock);
+  idleconn_t* slot = NULL;      // an empty entry
+  idleconn_t* oldest = NULL;    // least recently used entry overall
+  int perHost = 0;
+  for (int i = 0; i < MAX_IDLE; i++) {
+    idleconn_t* c = &pool[i];
+    if (!c->used) {
+      if (slot == NULL) {
+        slot = c;
+      }
+      continue;
+    }
+    if (c->port == port && strcmp(c->hostname, hostname) == 0) {
+      perHost++;
+    }
+    if (oldest == NULL || c->lastUsed < oldest->lastUsed) {
+      oldest = c;
+    }
+  }
+
+  if (perHost >= MAX_PER_HOST) {
+    slot = NULL;                // this host has enough spares
+  } else if (slot == NULL) {
+    close(oldest->fd);          // full: evict the least recently used
+    slot = oldest;
+  }
+
+  if (slot != NULL) {
+    slot->used = true;
+    slot->fd = fd;
+    slot->port = port;
+    strcpy(slot->hostname, hostname);
+    slot->lastUsed = now;
+  }
+  pthread_mutex_unlock(&poolLock);
+
+  if (slot == NULL) {
+    close(fd);
+  }
+}
+
+/**************** connpool_closeAll() ****************/
+/* see connpool.h for description */
+void
+connpool_closeAll(void)
+{
+  pthread_mutex_lock(&poolLock);
+  for (int i = 0; i < MAX_IDLE; i++) {
+    if (pool[i].used) {
+      close(pool[i].fd);
+      pool[i].used = false;
+    }
+  }
+  pthread_mutex_unlock(&poolLock);
+}
+
+/**************** nowSec ****************/
+/* Return a monotonic clock reading in seconds. */
+static long
+nowSec(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec;
+}
+
+/**************** isAlive ****************/
+/* An idle connection should have nothing to read. If it is readable,
+ * the server has closed it (or sent something we did not ask for);
+ * either way it is no good for another request.
+ */
+static bool
+isAlive(const int fd)
+{
+  struct pollfd pfd = { .fd = fd, .events = POLLIN };
+  return poll(&pfd, 1, 0) == 0;
+}
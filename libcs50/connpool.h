@@ -0,0 +1,56 @@
+/*
+ * connpool - pool of idle keep-alive connections, keyed by host and port
+ *
+ * Opening a TCP connection costs a round trip (more, with slow start)
+ * before the first byte of a request can go out. When a server keeps the
+ * connection open after a response, the fetch code hands the socket to
+ * this pool, and the next fetch from the same host takes it back instead
+ * of connecting again.
+ *
+ * The pool is a single process-wide table protected by a mutex, so the
+ * blocking fetch path may use it from several crawler threads at once.
+ * It holds at most a fixed number of idle sockets, a few per host;
+ * sockets idle too long, or that the server has since closed, are
+ * discarded rather than returned.
+ */
+
+#ifndef __CONNPOOL_H
+#define __CONNPOOL_H
+
+#include <stdbool.h>
+
+/**************** functions ****************/
+
+/**************** connpool_get ****************/
+/* Take an idle connection to hostname:port out of the pool.
+ *
+ * We return:
+ *   an open socket descriptor, now owned by the caller, or
+ *   -1 if the pool has no usable connection to that host.
+ * Notes:
+ *   The socket's blocking mode and timeouts are whatever the last user
+ *   left them; callers should set the ones they need.
+ *   A pooled connection may still be closed by the server at any moment,
+ *   so a request on it that fails before any response arrives should be
+ *   retried on a fresh connection.
+ */
+int connpool_get(const char* hostname, const int port);
+
+/**************** connpool_put ****************/
+/* Give an idle connection to hostname:port to the pool.
+ *
+ * Caller provides:
+ *   an open socket on which a response has been completely read.
+ * We do:
+ *   keep it for a later connpool_get, or close it if the host already
+ *   has its share of idle connections; if the pool is full, the least
+ *   recently used connection is closed to make room.
+ *   The caller no longer owns fd either way.
+ */
+void connpool_put(const char* hostname, const int port, const int fd);
+
+/**************** connpool_closeAll ****************/
+/* Close every idle connection in the pool. */
+void connpool_closeAll(void);
+
+#endif // __CONNPOOL_H
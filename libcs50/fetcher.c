@@ -0,0 +1,718 @@
+/*
+ * fetcher - event-driven, non-blocking engine for fetching many web pages
+ *
+ * See fetcher.h for usage.
+ *
+ * Every request lives in one slot of a fixed array, so a slot's address
+ * is stable for the life of the request and can be stored in its epoll
+ * registration. A request moves through these states:
+ *
+ *   RESOLVING   hostname lookup on the resolver thread; wait for its answer
+ *   CONNECTING  non-blocking connect() in progress; wait for writable
+ *   SENDING     request (partly) written; wait for writable
+ *   RECEIVING   response arriving; feed it to the http parser
+ *   FAILED      failed before reaching the network; reported next poll
+ *
+ * Deadlines are absolute: the connect deadline starts at submit time, so
+ * it covers the lookup as well as the connect, and the read deadline
+ * starts when the connection is established.
+ *
+ * The loop never waits on the DNS. A host in the resolver's cache is
+ * answered on the spot (resolver_cached); any other goes to the
+ * fetcher's resolver thread, which looks it up with the blocking
+ * resolver_lookup and posts the answer to an eventfd in the epoll set.
+ * Lookups run one at a time, in the order asked; a crawl has few hosts,
+ * and a lookup for a host already answered hits the cache. A request
+ * that expires or is aborted while its lookup runs simply leaves it
+ * behind: each lookup carries the ticket its request had when it asked,
+ * and an answer whose ticket no longer matches is dropped.
+ *
+ * A request whose host has an idle keep-alive connection in the pool
+ * skips CONNECTING and starts in SENDING. If the server turns out to have
+ * closed that connection before answering, the request quietly starts
+ * over on a fresh connection. A connection whose response allows reuse
+ * goes back to the pool when the request finishes.
+ */
+
+#define _GNU_SOURCE       // SOCK_NONBLOCK, clock_gettime
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include "fetcher.h"
+#include "connpool.h"
+#include "http.h"
+#include "resolver.h"
+#include "webpage.h"
+
+/**************** file-local global variables ****************/
+static const int MAX_EVENTS = 64;       // epoll events handled per wait
+
+/**************** local types ****************/
+enum { REQ_FREE, REQ_RESOLVING, REQ_CONNECTING, REQ_SENDING, REQ_RECEIVING, REQ_FAILED };
+
+typedef struct request {
+  int state;                  // one of the REQ_ values
+  int fd;                     // socket, or -1
+  bool reused;                // fd came from the connection pool
+  char* hostname;             // server, for returning fd to the pool
+  int port;
+  webpage_t* page;            // page being fetched
+  fetcher_done_t done;        // completion callback
+  void* arg;                  // and its argument
+  http_sink_t sink;           // sees the body as it arrives, or NULL
+  void* sinkArg;              // and its argument
+  char* out;                  // request text
+  size_t outLen, outSent;     // its length, and how much has been sent
+  http_response_t resp;       // response parser
+  long deadline;              // when this request times out (ms)
+  long mark;                  // when the phase being timed began (us)
+  webpage_timing_t timing;    // the phases timed so far
+  unsigned long ticket;       // of its latest lookup, while RESOLVING
+} request_t;
+
+/* a hostname lookup for the resolver thread */
+typedef struct lookup {
+  struct lookup* next;
+  request_t* req;             // the request that asked (it may have moved on)
+  unsigned long ticket;       // req->ticket when it asked
+  char* hostname;
+  int port;
+  bool found;                 // the answer, from the resolver thread
+  struct sockaddr_in addr;
+} lookup_t;
+
+/**************** global types ****************/
+typedef struct fetcher {
+  int epfd;                   // epoll instance
+  int maxInFlight;            // number of slots
+  int connectTimeout;         // ms
+  int readTimeout;            // ms
+  int active;                 // slots not REQ_FREE
+  request_t* reqs;            // reqs[maxInFlight]
+  int* freeSlots;             // stack of free slot indices
+  int numFree;
+  unsigned long nextTicket;   // for the next lookup
+  int dnsFd;                  // eventfd: the resolver thread has answers
+  pthread_t dnsThread;
+  pthread_mutex_t dnsLock;    // protects dnsQueue through dnsClosing
+  pthread_cond_t dnsWork;     // signaled when a lookup is queued or closing set
+  lookup_t* dnsQueue;         // lookups waiting for the thread, oldest first
+  lookup_t** dnsTail;         // where the next one goes
+  lookup_t* dnsAnswers;       // lookups answered, waiting for fetcher_poll
+  bool dnsClosing;            // set by fetcher_delete
+} fetcher_t;
+
+/**************** local functions ****************/
+static long nowMs(void);
+static long nowUs(void);
+static bool startRequest(fetcher_t* f, request_t* req);
+static bool startConnect(fetcher_t* f, request_t* req);
+static bool askResolver(fetcher_t* f, request_t* req);
+static void* resolverRun(void* arg);
+static void takeAnswers(fetcher_t* f);
+static bool connectTo(fetcher_t* f, request_t* req, const struct sockaddr_in* server);
+static void freeLookups(lookup_t* list);
+static void retryFresh(fetcher_t* f, request_t* req);
+static void handleEvent(fetcher_t* f, request_t* req, const unsigned int events);
+static bool sendMore(fetcher_t* f, request_t* req);
+static void receiveMore(fetcher_t* f, request_t* req);
+static void finish(fetcher_t* f, request_t* req, const bool fetched);
+
+/**************** fetcher_new() ****************/
+/* see fetcher.h for description */
+fetcher_t*
+fetcher_new(const int maxInFlight, const int connectTimeout, const int readTimeout)
+{
+  if (maxInFlight <= 0 || connectTimeout <= 0 || readTimeout <= 0) {
+    return NULL;
+  }
+
+  fetcher_t* f = malloc(sizeof(fetcher_t));
+  if (f == NULL) {
+    return NULL;
+  }
+  f->reqs = calloc(maxInFlight, sizeof(request_t));
+  f->freeSlots = malloc(maxInFlight * sizeof(int));
+  f->epfd = epoll_create1(EPOLL_CLOEXEC);
+  f->dnsFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  f->dnsQueue = f->dnsAnswers = NULL;
+  f->dnsTail = &f->dnsQueue;
+  f->dnsClosing = false;
+  pthread_mutex_init(&f->dnsLock, NULL);
+  pthread_cond_init(&f->dnsWork, NULL);
+  struct epoll_event ev;
+  ev.events = EPOLLIN;
+  ev.data.ptr = f;            // tells the eventfd's events from requests'
+  if (f->reqs == NULL || f->freeSlots == NULL || f->epfd < 0 || f->dnsFd < 0
+      || epoll_ctl(f->epfd, EPOLL_CTL_ADD, f->dnsFd, &ev) < 0
+      || pthread_create(&f->dnsThread, NULL, resolverRun, f) != 0) {
+    if (f->epfd >= 0) {
+      close(f->epfd);
+    }
+    if (f->dnsFd >= 0) {
+      close(f->dnsFd);
+    }
+    pthread_mutex_destroy(&f->dnsLock);
+    pthread_cond_destroy(&f->dnsWork);
+    free(f->reqs);
+    free(f->freeSlots);
+    free(f);
+    return NULL;
+  }
+
+  f->maxInFlight = maxInFlight;
+  f->connectTimeout = connectTimeout;
+  f->readTimeout = readTimeout;
+  f->active = 0;
+  f->numFree = 0;
+  f->nextTicket = 0;
+  for (int i = maxInFlight - 1; i >= 0; i--) {
+    f->reqs[i].state = REQ_FREE;
+    f->reqs[i].fd = -1;
+    f->freeSlots[f->numFree++] = i;
+  }
+  return f;
+}
+
+/**************** fetcher_submit() ****************/
+/* see fetcher.h for description */
+bool
+fetcher_submit(fetcher_t* f, webpage_t* page, fetcher_done_t done, void* arg)
+{
+  return fetcher_submitStream(f, page, NULL, NULL, done, arg);
+}
+
+/**************** fetcher_submitStream() ****************/
+/* see fetcher.h for description */
+bool
+fetcher_submitStream(fetcher_t* f, webpage_t* page,
+                     void (*sink)(void* arg, const char* data, size_t len),
+                     void* sinkArg, fetcher_done_t done, void* arg)
+{
+  if (f == NULL || page == NULL || done == NULL
+      || webpage_getURL(page) == NULL || webpage_getHTML(page) != NULL
+      || f->numFree == 0) {
+    return false;
+  }
+
+  request_t* req = &f->reqs[f->freeSlots[--f->numFree]];
+  req->fd = -1;
+  req->reused = false;
+  req->hostname = NULL;
+  req->page = page;
+  req->done = done;
+  req->arg = arg;
+  req->sink = sink;
+  req->sinkArg = sinkArg;
+  req->out = NULL;
+  req->outLen = req->outSent = 0;
+  http_response_init(&req->resp);
+  http_response_setSink(&req->resp, sink, sinkArg);
+  req->deadline = nowMs() + f->connectTimeout;
+  req->timing = (webpage_timing_t){ 0 };
+  f->active++;
+
+  if (!startRequest(f, req)) {
+    // report the failure from fetcher_poll, as promised
+    req->state = REQ_FAILED;
+  }
+  return true;
+}
+
+/**************** fetcher_poll() ****************/
+/* see fetcher.h for description */
+void
+fetcher_poll(fetcher_t* f, const int timeout)
+{
+  if (f == NULL) {
+    return;
+  }
+
+  // sleep no later than the earliest deadline, and not at all if some
+  // request has already failed and just needs reporting
+  long now = nowMs();
+  long wait = timeout;
+  for (int i = 0; i < f->maxInFlight; i++) {
+    request_t* req = &f->reqs[i];
+    if (req->state == REQ_FREE) {
+      continue;
+    }
+    long left = (req->state == REQ_FAILED) ? 0 : req->deadline - now;
+    if (left < 0) {
+      left = 0;
+    }
+    if (wait < 0 || left < wait) {
+      wait = left;
+    }
+  }
+
+  struct epoll_event events[MAX_EVENTS];
+  int n = epoll_wait(f->epfd, events, MAX_EVENTS, (int)wait);
+  for (int i = 0; i < n; i++) {
+    if (events[i].data.ptr == f) {
+      takeAnswers(f);
+    } else {
+      handleEvent(f, events[i].data.ptr, events[i].events);
+    }
+  }
+
+  // report failures and expire requests past their deadline
+  now = nowMs();
+  for (int i = 0; i < f->maxInFlight; i++) {
+    request_t* req = &f->reqs[i];
+    if (req->state == REQ_FAILED
+        || (req->state != REQ_FREE && req->deadline <= now)) {
+      finish(f, req, false);
+    }
+  }
+}
+
+/**************** fetcher_active() ****************/
+/* see fetcher.h for description */
+int
+fetcher_active(fetcher_t* f)
+{
+  return f ? f->active : 0;
+}
+
+/**************** fetcher_capacity() ****************/
+/* see fetcher.h for description */
+int
+fetcher_capacity(fetcher_t* f)
+{
+  return f ? f->numFree : 0;
+}
+
+/**************** fetcher_delete() ****************/
+/* see fetcher.h for description */
+void
+fetcher_delete(fetcher_t* f)
+{
+  if (f == NULL) {
+    return;
+  }
+  for (int i = 0; i < f->maxInFlight; i++) {
+    if (f->reqs[i].state != REQ_FREE) {
+      finish(f, &f->reqs[i], false);
+    }
+  }
+
+  // stop the resolver thread, once done with any lookup it is running
+  pthread_mutex_lock(&f->dnsLock);
+  f->dnsClosing = true;
+  pthread_cond_signal(&f->dnsWork);
+  pthread_mutex_unlock(&f->dnsLock);
+  pthread_join(f->dnsThread, NULL);
+  freeLookups(f->dnsQueue);
+  freeLookups(f->dnsAnswers);
+  pthread_mutex_destroy(&f->dnsLock);
+  pthread_cond_destroy(&f->dnsWork);
+
+  close(f->dnsFd);
+  close(f->epfd);
+  free(f->reqs);
+  free(f->freeSlots);
+  free(f);
+}
+
+/**************** nowMs ****************/
+/* Return a monotonic clock reading in milliseconds. */
+static long
+nowMs(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+/**************** nowUs ****************/
+/* Return a monotonic clock reading in microseconds. */
+static long
+nowUs(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000L + ts.tv_nsec / 1000L;
+}
+
+/**************** startRequest ****************/
+/* Prepare the request text and send it on a pooled connection to the
+ * page's host, if there is one, or else begin connecting.
+ * Returns false if any step fails immediately.
+ */
+static bool
+startRequest(fetcher_t* f, request_t* req)
+{
+  char* pathname;
+  if (!http_burstURL(webpage_getURL(req->page), &req->hostname, &req->port,
+                     &pathname)) {
+    return false;
+  }
+  req->out = http_formatConditionalRequest(req->hostname, pathname,
+                                          webpage_getETag(req->page),
+                                          webpage_getLastModified(req->page));
+  free(pathname);
+  if (req->out == NULL) {
+    return false;
+  }
+  req->outLen = strlen(req->out);
+
+  int fd = connpool_get(req->hostname, req->port);
+  if (fd < 0) {
+    return startConnect(f, req);
+  }
+
+  // already connected: go straight to sending, on the read deadline
+  req->fd = fd;
+  req->reused = true;
+  int flags = fcntl(fd, F_GETFL);
+  struct epoll_event ev;
+  ev.events = EPOLLOUT;
+  ev.data.ptr = req;
+  if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0
+      || epoll_ctl(f->epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+    return false;
+  }
+  req->state = REQ_SENDING;
+  req->deadline = nowMs() + f->readTimeout;
+  return true;
+}
+
+/**************** startConnect ****************/
+/* Begin a non-blocking connect to the request's host, if the resolver
+ * has its address cached; else hand the lookup to the resolver thread,
+ * and connect once it answers (see takeAnswers).
+ * Returns false if any step fails immediately.
+ */
+static bool
+startConnect(fetcher_t* f, request_t* req)
+{
+  struct sockaddr_in server;
+  bool resolved;
+  req->mark = nowUs();
+  if (!resolver_cached(req->hostname, req->port, &server, &resolved)) {
+    return askResolver(f, req);
+  }
+  return resolved && connectTo(f, req, &server);
+}
+
+/**************** askResolver ****************/
+/* Queue a lookup of the request's host for the resolver thread, and
+ * leave the request RESOLVING. Returns false if out of memory.
+ */
+static bool
+askResolver(fetcher_t* f, request_t* req)
+{
+  lookup_t* lookup = malloc(sizeof(lookup_t));
+  char* hostname = strdup(req->hostname);
+  if (lookup == NULL || hostname == NULL) {
+    free(lookup);
+    free(hostname);
+    return false;
+  }
+  lookup->next = NULL;
+  lookup->req = req;
+  lookup->ticket = req->ticket = ++f->nextTicket;
+  lookup->hostname = hostname;
+  lookup->port = req->port;
+  lookup->found = false;
+
+  pthread_mutex_lock(&f->dnsLock);
+  *f->dnsTail = lookup;
+  f->dnsTail = &lookup->next;
+  pthread_cond_signal(&f->dnsWork);
+  pthread_mutex_unlock(&f->dnsLock);
+  req->state = REQ_RESOLVING;
+  return true;
+}
+
+/**************** resolverRun ****************/
+/* Thread body for the resolver thread: look up each queued hostname in
+ * turn, and post the answers for fetcher_poll, until fetcher_delete.
+ */
+static void*
+resolverRun(void* arg)
+{
+  fetcher_t* f = arg;
+  pthread_mutex_lock(&f->dnsLock);
+  while (true) {
+    while (f->dnsQueue == NULL && !f->dnsClosing) {
+      pthread_cond_wait(&f->dnsWork, &f->dnsLock);
+    }
+    if (f->dnsClosing) {
+      break;
+    }
+    lookup_t* lookup = f->dnsQueue;
+    f->dnsQueue = lookup->next;
+    if (f->dnsQueue == NULL) {
+      f->dnsTail = &f->dnsQueue;
+    }
+    pthread_mutex_unlock(&f->dnsLock);
+
+    lookup->found = resolver_lookup(lookup->hostname, lookup->port, &lookup->addr);
+
+    pthread_mutex_lock(&f->dnsLock);
+    lookup->next = f->dnsAnswers;
+    f->dnsAnswers = lookup;
+    uint64_t one = 1;
+    if (write(f->dnsFd, &one, sizeof(one)) < 0) {
+      // the counter is already nonzero, so poll will look anyway
+    }
+  }
+  pthread_mutex_unlock(&f->dnsLock);
+  return NULL;
+}
+
+/**************** takeAnswers ****************/
+/* Collect the resolver thread's answers, and begin connecting each
+ * request still waiting for the one it got (failing it if its host
+ * did not resolve).
+ */
+static void
+takeAnswers(fetcher_t* f)
+{
+  uint64_t count;
+  if (read(f->dnsFd, &count, sizeof(count)) < 0) {
+    // nothing to read after all; look at the list anyway
+  }
+  pthread_mutex_lock(&f->dnsLock);
+  lookup_t* answers = f->dnsAnswers;
+  f->dnsAnswers = NULL;
+  pthread_mutex_unlock(&f->dnsLock);
+
+  for (lookup_t* lookup = answers; lookup != NULL; lookup = lookup->next) {
+    request_t* req = lookup->req;
+    if (req->state != REQ_RESOLVING || req->ticket != lookup->ticket) {
+      continue;               // the request has expired, or moved on
+    }
+    if (!lookup->found || !connectTo(f, req, &lookup->addr)) {
+      finish(f, req, false);
+    }
+  }
+  freeLookups(answers);
+}
+
+/**************** freeLookups ****************/
+/* Free a list of lookups. */
+static void
+freeLookups(lookup_t* list)
+{
+  while (list != NULL) {
+    lookup_t* next = list->next;
+    free(list->hostname);
+    free(list);
+    list = next;
+  }
+}
+
+/**************** connectTo ****************/
+/* The request's host is resolved to server: begin a non-blocking
+ * connect to it. Returns false if any step fails immediately.
+ */
+static bool
+connectTo(fetcher_t* f, request_t* req, const struct sockaddr_in* server)
+{
+  long now = nowUs();
+  req->timing.dns = now - req->mark;
+  req->mark = now;
+
+  req->fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (req->fd < 0) {
+    return false;
+  }
+  if (connect(req->fd, (const struct sockaddr*) server, sizeof(*server)) < 0
+      && errno != EINPROGRESS) {
+    return false;
+  }
+
+  // writable means the connection is up (or has failed)
+  struct epoll_event ev;
+  ev.events = EPOLLOUT;
+  ev.data.ptr = req;
+  if (epoll_ctl(f->epfd, EPOLL_CTL_ADD, req->fd, &ev) < 0) {
+    return false;
+  }
+  req->state = REQ_CONNECTING;
+  return true;
+}
+
+/**************** retryFresh ****************/
+/* A pooled connection failed before any of the response arrived, most
+ * likely because the server had already closed it; start the request
+ * over on a new connection, or fail it if that is impossible.
+ */
+static void
+retryFresh(fetcher_t* f, request_t* req)
+{
+  close(req->fd);             // also removes it from the epoll set
+  req->fd = -1;
+  req->reused = false;
+  req->outSent = 0;
+  req->timing = (webpage_timing_t){ 0 };
+  http_response_free(&req->resp);
+  http_response_init(&req->resp);
+  http_response_setSink(&req->resp, req->sink, req->sinkArg);
+  req->deadline = nowMs() + f->connectTimeout;
+  if (!startConnect(f, req)) {
+    finish(f, req, false);
+  }
+}
+
+/**************** handleEvent ****************/
+/* Advance one request in response to epoll reporting events on it. */
+static void
+handleEvent(fetcher_t* f, request_t* req, const unsigned int events)
+{
+  if (req->state == REQ_CONNECTING) {
+    int err = 0;
+    socklen_t len = sizeof(err);
+    if (getsockopt(req->fd, SOL_SOCKET, SO_ERROR, &err, &len) < 0 || err != 0) {
+      finish(f, req, false);
+      return;
+    }
+    // connected: the read deadline starts now
+    req->state = REQ_SENDING;
+    req->deadline = nowMs() + f->readTimeout;
+    req->timing.connect = nowUs() - req->mark;
+  }
+
+  if (req->state == REQ_SENDING) {
+    if (!sendMore(f, req)) {
+      if (req->reused) {
+        retryFresh(f, req);
+      } else {
+        finish(f, req, false);
+      }
+    }
+  } else if (req->state == REQ_RECEIVING) {
+    receiveMore(f, req);
+  }
+}
+
+/**************** sendMore ****************/
+/* Write as much of the request as the socket will take; once it is all
+ * sent, switch to waiting for the response. Returns false on error.
+ */
+static bool
+sendMore(fetcher_t* f, request_t* req)
+{
+  while (req->outSent < req->outLen) {
+    ssize_t n = send(req->fd, req->out + req->outSent,
+                     req->outLen - req->outSent, MSG_NOSIGNAL);
+    if (n < 0) {
+      return (errno == EAGAIN || errno == EWOULDBLOCK);  // wait for room
+    }
+    req->outSent += n;
+  }
+
+  struct epoll_event ev;
+  ev.events = EPOLLIN;
+  ev.data.ptr = req;
+  if (epoll_ctl(f->epfd, EPOLL_CTL_MOD, req->fd, &ev) < 0) {
+    return false;
+  }
+  req->state = REQ_RECEIVING;
+  req->mark = nowUs();        // waiting for the first byte
+  return true;
+}
+
+/**************** receiveMore ****************/
+/* Read everything available on the socket into the response parser,
+ * finishing the request when the response is complete or broken.
+ */
+static void
+receiveMore(fetcher_t* f, request_t* req)
+{
+  char buf[16384];
+  while (true) {
+    ssize_t n = recv(req->fd, buf, sizeof(buf), 0);
+    http_result_t result;
+    if (n > 0 && req->resp.bytesIn == 0) {
+      long now = nowUs();
+      req->timing.firstByte = now - req->mark;
+      req->mark = now;          // and now for the rest
+    }
+    if (n > 0) {
+      result = http_response_feed(&req->resp, buf, n);
+    } else if (n == 0) {
+      result = http_response_eof(&req->resp);
+    } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      return;                   // wait for more
+    } else {
+      result = HTTP_ERROR;
+    }
+
+    if (result == HTTP_ERROR && req->reused && req->resp.bytesIn == 0) {
+      retryFresh(f, req);
+      return;
+    }
+    if (result != HTTP_MORE) {
+      finish(f, req, result == HTTP_DONE && http_response_ok(&req->resp));
+      return;
+    }
+  }
+}
+
+/**************** finish ****************/
+/* Release the request's resources and slot (returning its connection to
+ * the pool if the server allows), then hand the page to the
+ * completion callback. The slot is free before the callback runs, so the
+ * callback may submit a new request.
+ */
+static void
+finish(fetcher_t* f, request_t* req, const bool fetched)
+{
+  webpage_t* page = req->page;
+  fetcher_done_t done = req->done;
+  void* arg = req->arg;
+
+  webpage_setStatus(page, req->resp.status);
+  if (req->state == REQ_RECEIVING && req->resp.bytesIn > 0) {
+    req->timing.body = nowUs() - req->mark;
+  }
+  req->timing.bytes = req->resp.bytesIn;
+  webpage_setTiming(page, &req->timing);
+  bool ok = fetched;
+  if (ok) {
+    char* html = http_response_takeBody(&req->resp);
+    ok = (html != NULL) && webpage_setHTML(page, html);
+    if (!ok) {
+      free(html);
+    } else {
+      webpage_setValidators(page, req->resp.etag, req->resp.lastModified);
+    }
+  }
+
+  if (req->fd >= 0) {
+    if (http_response_reusable(&req->resp)
+        && epoll_ctl(f->epfd, EPOLL_CTL_DEL, req->fd, NULL) == 0) {
+      connpool_put(req->hostname, req->port, req->fd);
+    } else {
+      close(req->fd);           // also removes it from the epoll set
+    }
+  }
+  http_response_free(&req->resp);
+  free(req->out);
+  free(req->hostname);
+  req->hostname = NULL;
+  req->fd = -1;
+  req->out = NULL;
+  req->page = NULL;
+  req->state = REQ_FREE;
+  f->freeSlots[f->numFree++] = req - f->reqs;
+  f->active--;
+
+  (*done)(arg, page, ok);
+}
@@ -0,0 +1,107 @@
+/*
+ * fetcher - event-driven, non-blocking engine for fetching many web pages
+ *
+ * A *fetcher* keeps many HTTP requests in flight from a single thread.
+ * Each submitted page gets a non-blocking socket; an epoll loop drives
+ * every connection through connect, request, and response, and calls the
+ * submitter's completion callback when the page is fetched, fails, or
+ * runs past its deadline. A slow server only delays its own pages.
+ * Requests and responses are as for webpage_fetch, compression included.
+ *
+ * Typical use:
+ *   fetcher_t* f = fetcher_new(100, 5000, 30000);
+ *   fetcher_submit(f, page, done, arg);      // callbacks may submit more
+ *   while (fetcher_active(f) > 0) {
+ *     fetcher_poll(f, -1);
+ *   }
+ *   fetcher_delete(f);
+ *
+ * This module requires Linux (epoll).
+ */
+
+#ifndef __FETCHER_H
+#define __FETCHER_H
+
+#include <stdbool.h>
+#include "webpage.h"
+
+/**************** global types ****************/
+typedef struct fetcher fetcher_t;  // opaque to users of the module
+
+/* Completion callback: called exactly once for each submitted page.
+ * fetched is true iff page->html now holds the page's content.
+ * webpage_getStatus(page) gives the HTTP status (0 if no response came).
+ * A page with validators is asked for conditionally, as by webpage_fetch:
+ * if it has not changed, fetched is false and the status is 304.
+ * The callback owns page from then on (typically webpage_delete's it).
+ */
+typedef void (*fetcher_done_t)(void* arg, webpage_t* page, const bool fetched);
+
+/**************** functions ****************/
+
+/**************** fetcher_new ****************/
+/* Create a new fetch engine.
+ *
+ * Caller provides:
+ *   maxInFlight: most requests that may be active at once (> 0);
+ *   connectTimeout: milliseconds allowed to establish each connection;
+ *   readTimeout: milliseconds allowed, once connected, to send the
+ *     request and receive the whole response.
+ * We return:
+ *   pointer to a new fetcher, or NULL on error.
+ * Caller is responsible for:
+ *   later calling fetcher_delete.
+ */
+fetcher_t* fetcher_new(const int maxInFlight, const int connectTimeout,
+                       const int readTimeout);
+
+/**************** fetcher_submit ****************/
+/* Start fetching page->url.
+ *
+ * Caller provides:
+ *   page: a webpage_t with a URL and no HTML yet;
+ *   done: the completion callback, and arg to pass it.
+ * We return:
+ *   true if the request was started; done will be called later, from
+ *   within fetcher_poll;
+ *   false if the fetcher is already at maxInFlight or the arguments are
+ *   invalid; the caller still owns page and done is never called.
+ * Notes:
+ *   Failures after the request starts (unresolvable host, refused
+ *   connection, timeout, non-200 status) are reported through done.
+ */
+bool fetcher_submit(fetcher_t* f, webpage_t* page, fetcher_done_t done, void* arg);
+
+/**************** fetcher_submitStream ****************/
+/* Like fetcher_submit, but also pass the page's HTML to
+ * sink(sinkArg, data, len) piece by piece as it arrives, from within
+ * fetcher_poll, as webpage_fetchStream does. If the fetch then fails,
+ * sink may have seen part of the page before done is called.
+ */
+bool fetcher_submitStream(fetcher_t* f, webpage_t* page,
+                          void (*sink)(void* arg, const char* data, size_t len),
+                          void* sinkArg, fetcher_done_t done, void* arg);
+
+/**************** fetcher_poll ****************/
+/* Wait up to timeout milliseconds (-1: until something happens) for
+ * network activity, advance every ready request, expire requests past
+ * their deadline, and call the completion callback of each request that
+ * finished. Callbacks may call fetcher_submit.
+ */
+void fetcher_poll(fetcher_t* f, const int timeout);
+
+/**************** fetcher_active ****************/
+/* Return the number of requests currently in flight. */
+int fetcher_active(fetcher_t* f);
+
+/**************** fetcher_capacity ****************/
+/* Return how many more requests may be submitted right now. */
+int fetcher_capacity(fetcher_t* f);
+
+/**************** fetcher_delete ****************/
+/* Abort any requests still in flight (calling their callbacks with
+ * fetched=false) and free the fetcher.
+ */
+void fetcher_delete(fetcher_t* f);
+
+#endif // __FETCHER_H
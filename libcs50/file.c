@@ -6,11 +6,26 @@
  * David Kotz - 2016, 2017, 2019, 2021
  */
 
+#define _POSIX_C_SOURCE 200809L   // getline
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
 #include <ctype.h>
 #include "file.h"
 
+/**************** file-local global variables ****************/
+static const size_t BLOCK = 65536;    // bytes per read of a large read
+
+/**************** global types ****************/
+typedef struct file_reader {
+  FILE* fp;
+  char* buf;              // buf[start..end) is read but not yet returned
+  size_t cap;             // a NUL always fits after buf[end-1]
+  size_t start, end;
+  bool eof;               // fp has no more to give
+} file_reader_t;
 
 /**************** file_numLines ****************/
 int
@@ -22,12 +37,12 @@ file_numLines(FILE* fp)
 
   rewind(fp);
 
+  // count a block at a time, not a character at a time
   int nlines = 0;
-  char c = '\0';
-  while ( (c = fgetc(fp)) != EOF) {
-    if (c == '\n') {
-      nlines++;
-    }
+  char block[16384];
+  size_t n;
+  while ( (n = fread(block, 1, sizeof(block), fp)) > 0) {
+    nlines += file_countLines(block, n);
   }
 
   rewind(fp);
@@ -35,18 +50,81 @@ file_numLines(FILE* fp)
   return nlines;
 }
 
+/**************** file_countLines ****************/
+/* See file.h for documentation. */
+size_t
+file_countLines(const char* buf, size_t len)
+{
+  // memchr looks at many bytes per step
+  size_t nlines = 0;
+  const char* end = buf + len;
+  const char* nl;
+  while (buf < end && (nl = memchr(buf, '\n', end - buf)) != NULL) {
+    nlines++;
+    buf = nl + 1;
+  }
+  return nlines;
+}
+
 /**************** utility stopfuncs ****************/
 // for use with readuntil()
 static int never(int c) { return (0); }
-static int isnewline(int c) { return (c == '\n'); }
 
 /**************** file_readFile ****************/
 /* See file.h for documentation. */
-char* file_readFile(FILE* fp) { return file_readUntil(fp, never); }
+char* 
+file_readFile(FILE* fp)
+{
+  // read large blocks into a buffer that doubles as it fills
+  size_t cap = BLOCK;
+  size_t len = 0;
+  char* buf = malloc(cap);
+  if (buf == NULL) {
+    return NULL;
+  }
+  size_t n;
+  while ( (n = fread(buf + len, 1, cap - len - 1, fp)) > 0) {
+    len += n;
+    if (len + 1 == cap) {
+      char* newbuf = realloc(buf, cap * 2);
+      if (newbuf == NULL) {
+        free(buf);
+        return NULL;
+      }
+      buf = newbuf;
+      cap *= 2;
+    }
+  }
+
+  if (len == 0 || ferror(fp)) {
+    // error, or EOF reached without reading anything
+    free(buf);
+    return NULL;
+  }
+  buf[len] = '\0';
+  return buf;
+}
 
 /**************** file_readLine ****************/
 /* See file.h for documentation. */
-char* file_readLine(FILE* fp) { return file_readUntil(fp, isnewline); }
+char* 
+file_readLine(FILE* fp)
+{
+  // getline finds the newline within stdio's buffer and grows the line
+  // geometrically, reading no further than the newline
+  char* line = NULL;
+  size_t cap = 0;
+  ssize_t len = getline(&line, &cap, fp);
+  if (len <= 0) {
+    // error, or EOF reached without reading a line
+    free(line);
+    return NULL;
+  }
+  if (line[len - 1] == '\n') {
+    line[len - 1] = '\0';
+  }
+  return line;
+}
 
 /**************** readword ****************/
 /* See file.h for documentation. */
@@ -69,20 +147,21 @@ file_readUntil(FILE* fp, int (*stopfunc)(int c))
   }
 
   // Read characters from file until stop-character or EOF, 
-  // expanding the buffer when needed to hold more.
+  // doubling the buffer when needed to hold more.
   int pos;
-  char c;
+  int c;
   for (pos = 0; (c = fgetc(fp)) != EOF && !(*stopfunc)(c); pos++) {
     // We need to save buf[pos+1] for the terminating null
     // and buf[len-1] is the last usable slot, 
     // so if pos+1 is past that slot, we need to grow the buffer.
     if (pos+1 > len-1) {
-      char* newbuf = realloc(buf, ++len * sizeof(char));
+      char* newbuf = realloc(buf, 2 * len * sizeof(char));
       if (newbuf == NULL) {
         free(buf);
         return NULL;
       } else {
         buf = newbuf;
+        len *= 2;
       }
     }
     buf[pos] = c;
@@ -99,6 +178,94 @@ file_readUntil(FILE* fp, int (*stopfunc)(int c))
   }
 }
 
+/**************** file_reader_new ****************/
+/* See file.h for documentation. */
+file_reader_t*
+file_reader_new(FILE* fp)
+{
+  if (fp == NULL) {
+    return NULL;
+  }
+  file_reader_t* reader = malloc(sizeof(file_reader_t));
+  char* buf = malloc(BLOCK + 1);
+  if (reader == NULL || buf == NULL) {
+    free(reader);
+    free(buf);
+    return NULL;
+  }
+  reader->fp = fp;
+  reader->buf = buf;
+  reader->cap = BLOCK + 1;
+  reader->start = reader->end = 0;
+  reader->eof = false;
+  return reader;
+}
+
+/**************** file_reader_line ****************/
+/* See file.h for documentation. */
+char*
+file_reader_line(file_reader_t* reader, size_t* len)
+{
+  if (reader == NULL) {
+    return NULL;
+  }
+
+  size_t scanned = reader->start;       // no newline in [start, scanned)
+  while (true) {
+    char* line = reader->buf + reader->start;
+    char* nl = memchr(reader->buf + scanned, '\n', reader->end - scanned);
+    if (nl != NULL || (reader->eof && reader->start < reader->end)) {
+      // a whole line, or the last one, unfinished
+      char* stop = (nl != NULL) ? nl : reader->buf + reader->end;
+      *stop = '\0';
+      reader->start = (nl != NULL) ? stop + 1 - reader->buf : reader->end;
+      if (len != NULL) {
+        *len = stop - line;
+      }
+      return line;
+    }
+    if (reader->eof) {
+      return NULL;
+    }
+
+    // move the partial line to the front, growing the buffer if it
+    // fills the buffer, then read another block after it
+    size_t partial = reader->end - reader->start;
+    memmove(reader->buf, line, partial);
+    reader->start = 0;
+    reader->end = partial;
+    scanned = partial;
+    if (reader->cap - reader->end - 1 < BLOCK / 2) {
+      char* newbuf = realloc(reader->buf, 2 * reader->cap);
+      if (newbuf == NULL) {
+        return NULL;
+      }
+      reader->buf = newbuf;
+      reader->cap *= 2;
+    }
+    size_t n = fread(reader->buf + reader->end, 1,
+                     reader->cap - reader->end - 1, reader->fp);
+    reader->end += n;
+    if (n == 0) {
+      reader->eof = true;
+      if (ferror(reader->fp)) {
+        return NULL;
+      }
+    }
+  }
+}
+
+/**************** file_reader_delete ****************/
+/* See file.h for documentation. */
+void
+file_reader_delete(file_reader_t* reader)
+{
+  if (reader != NULL) {
+    free(reader->buf);
+    free(reader);
+  }
+}
+
 /* ********************************************************** */
 /* a simple unit test of the code above */
 #ifdef QUICKTEST
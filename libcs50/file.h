@@ -1,6 +1,11 @@
 /* 
  * file utilities - reading a word, line, or entire file
  * 
+ * The functions that take a FILE* read no further than they return, so
+ * calls to them can be mixed with other reads of the same file. To read
+ * a whole file line by line, a file_reader_t is faster: it reads the file
+ * in large blocks and hands out each line in place, without copying it.
+ *
  * David Kotz, 2016, 2017, 2019, 2021
  */
 
@@ -8,6 +13,7 @@
 #define __FILE_H
 
 #include <stdio.h>
+#include <stddef.h>
 
 /**************** file_numLines ****************/
 /* Returns the number of lines in the given file,
@@ -60,4 +66,40 @@ char* file_readLine(FILE* fp);
  */
 char* file_readWord(FILE* fp);
 
+/**************** file_countLines ****************/
+/* Returns the number of newlines in the len bytes at buf. */
+size_t file_countLines(const char* buf, size_t len);
+
+/**************** file_reader_t ****************/
+/* A buffered reader for reading a file line by line. */
+typedef struct file_reader file_reader_t;  // opaque to users of the module
+
+/**************** file_reader_new ****************/
+/* Create a reader for the rest of the file fp.
+ *
+ * Caller provides:
+ *   fp, open for reading; it may be a pipe.
+ * We return:
+ *   the reader, or NULL if out of memory.
+ * Caller is responsible for:
+ *   later calling file_reader_delete, and then closing fp;
+ *   not reading fp any other way in between, since the reader reads ahead.
+ */
+file_reader_t* file_reader_new(FILE* fp);
+
+/**************** file_reader_line ****************/
+/* 
+ * Return the next line, with NO newline and a terminating null, and set
+ * *len to its length (if len is not NULL). The line lives in the reader's
+ * buffer: the caller may modify it, but must not free it, and it is only
+ * valid until the next call. A last line without a newline is returned
+ * too. Returns empty string if an empty line is read.
+ * Returns NULL if error, or EOF reached without reading a line.
+ */
+char* file_reader_line(file_reader_t* reader, size_t* len);
+
+/**************** file_reader_delete ****************/
+/* Free the reader (but do not close its file). NULL is ignored. */
+void file_reader_delete(file_reader_t* reader);
+
 #endif // __FILE_H
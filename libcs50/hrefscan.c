@@ -0,0 +1,254 @@
+/*
+ * hrefscan - one-pass finder for the hrefs of <a> tags in a page
+ *
+ * See hrefscan.h for usage.
+ *
+ * A vector kernel compares a block of the page, and the same block one
+ * byte on, against '<' and against 'a' (after OR-ing in 0x20, which
+ * folds 'A' into 'a' and nothing else into it), and ANDs the two: a bit
+ * is set in the mask exactly where "<a" or "<A" starts. The loads at
+ * i + 1 read one byte past the block, so the vector loop stops a block
+ * plus one byte short of the end, and the scalar kernel finishes up.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdbool.h>
+#include "hrefscan.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HAVE_X86_KERNELS
+#endif
+
+/**************** file-local global variables ****************/
+enum { K_AUTO, K_AVX2, K_SSE2, K_SCALAR };
+static int kernel = K_AUTO;               // see hrefscan_setKernel
+
+/**************** local functions ****************/
+static size_t findScalar(const char* html, const size_t len, size_t from);
+static size_t findHref(const char* html, size_t from, const size_t to);
+static int bestKernel(void);
+#ifdef HAVE_X86_KERNELS
+static size_t findSSE2(const char* html, const size_t len, size_t from);
+static size_t findAVX2(const char* html, const size_t len, size_t from);
+#endif
+
+/**************** hrefscan_next() ****************/
+/* see hrefscan.h for description */
+bool
+hrefscan_next(const char* html, const size_t len, const size_t from,
+              hrefscan_link_t* link)
+{
+  if (html == NULL || link == NULL) {
+    return false;
+  }
+
+  size_t tag;
+  for (size_t pos = from; (tag = hrefscan_findAnchor(html, len, pos)) < len;
+       pos = tag + 2) {
+    // the tag runs to its '>', or (with none) to the end of the page
+    const char* gt = memchr(html + tag, '>', len - tag);
+    size_t tagEnd = (gt != NULL) ? (size_t)(gt - html) : len;
+    size_t href = findHref(html, tag + 2, tagEnd);
+    if (href == tagEnd) {
+      if (gt == NULL) {
+        return false;           // no href anywhere from here on
+      }
+      continue;
+    }
+
+    // the value: quoted, to its closing quote; or else to the '>'
+    size_t start = href + 5;
+    size_t end;
+    if (start < len && (html[start] == '"' || html[start] == '\'')) {
+      const char* quote = memchr(html + start + 1, html[start], len - start - 1);
+      if (quote == NULL) {
+        continue;
+      }
+      start++;
+      end = quote - html;
+    } else if (gt != NULL) {
+      end = tagEnd;
+    } else {
+      continue;
+    }
+
+    // drop any #fragment; a link to a fragment of this page is no link
+    const char* hash = memchr(html + start, '#', end - start);
+    if (hash != NULL) {
+      end = hash - html;
+    }
+    if (end == start && hash != NULL) {
+      continue;
+    }
+
+    link->tag = tag;
+    link->start = start;
+    link->len = end - start;
+    link->end = end;
+    return true;
+  }
+  return false;
+}
+
+/**************** hrefscan_findAnchor() ****************/
+/* see hrefscan.h for description */
+size_t
+hrefscan_findAnchor(const char* html, const size_t len, const size_t from)
+{
+  if (html == NULL || from >= len) {
+    return len;
+  }
+  switch (kernel == K_AUTO ? bestKernel() : kernel) {
+#ifdef HAVE_X86_KERNELS
+  case K_AVX2:
+    return findAVX2(html, len, from);
+  case K_SSE2:
+    return findSSE2(html, len, from);
+#endif
+  default:
+    return findScalar(html, len, from);
+  }
+}
+
+/**************** hrefscan_setKernel() ****************/
+/* see hrefscan.h for description */
+bool
+hrefscan_setKernel(const char* name)
+{
+  int wanted;
+  if (name == NULL) {
+    return false;
+  } else if (strcmp(name, "auto") == 0) {
+    wanted = K_AUTO;
+  } else if (strcmp(name, "avx2") == 0) {
+    wanted = K_AVX2;
+  } else if (strcmp(name, "sse2") == 0) {
+    wanted = K_SSE2;
+  } else if (strcmp(name, "scalar") == 0) {
+    wanted = K_SCALAR;
+  } else {
+    return false;
+  }
+  // the kernels are in order, best first
+  if (wanted != K_AUTO && wanted < bestKernel()) {
+    return false;
+  }
+  kernel = wanted;
+  return true;
+}
+
+/**************** hrefscan_kernel() ****************/
+/* see hrefscan.h for description */
+const char*
+hrefscan_kernel(void)
+{
+  switch (kernel == K_AUTO ? bestKernel() : kernel) {
+  case K_AVX2:
+    return "avx2";
+  case K_SSE2:
+    return "sse2";
+  default:
+    return "scalar";
+  }
+}
+
+/**************** bestKernel ****************/
+/* Return the best kernel this CPU can run. */
+static int
+bestKernel(void)
+{
+#ifdef HAVE_X86_KERNELS
+  if (__builtin_cpu_supports("avx2")) {
+    return K_AVX2;
+  }
+  if (__builtin_cpu_supports("sse2")) {
+    return K_SSE2;
+  }
+#endif
+  return K_SCALAR;
+}
+
+/**************** findScalar ****************/
+/* hrefscan_findAnchor a byte at a time: to each '<' with memchr, then
+ * a look at the byte after it.
+ */
+static size_t
+findScalar(const char* html, const size_t len, size_t from)
+{
+  while (from + 1 < len) {
+    const char* lt = memchr(html + from, '<', len - 1 - from);
+    if (lt == NULL) {
+      break;
+    }
+    size_t i = lt - html;
+    if ((html[i + 1] | 0x20) == 'a') {
+      return i;
+    }
+    from = i + 1;
+  }
+  return len;
+}
+
+#ifdef HAVE_X86_KERNELS
+/**************** findSSE2 ****************/
+/* hrefscan_findAnchor 16 bytes at a time. */
+__attribute__((target("sse2")))
+static size_t
+findSSE2(const char* html, const size_t len, size_t from)
+{
+  const __m128i lt = _mm_set1_epi8('<');
+  const __m128i a = _mm_set1_epi8('a');
+  const __m128i fold = _mm_set1_epi8(0x20);
+  for (; from + 17 <= len; from += 16) {
+    __m128i here = _mm_loadu_si128((const __m128i*)(html + from));
+    __m128i next = _mm_loadu_si128((const __m128i*)(html + from + 1));
+    __m128i hit = _mm_and_si128(_mm_cmpeq_epi8(here, lt),
+                                _mm_cmpeq_epi8(_mm_or_si128(next, fold), a));
+    unsigned int mask = _mm_movemask_epi8(hit);
+    if (mask != 0) {
+      return from + __builtin_ctz(mask);
+    }
+  }
+  return findScalar(html, len, from);
+}
+
+/**************** findAVX2 ****************/
+/* hrefscan_findAnchor 32 bytes at a time. */
+__attribute__((target("avx2")))
+static size_t
+findAVX2(const char* html, const size_t len, size_t from)
+{
+  const __m256i lt = _mm256_set1_epi8('<');
+  const __m256i a = _mm256_set1_epi8('a');
+  const __m256i fold = _mm256_set1_epi8(0x20);
+  for (; from + 33 <= len; from += 32) {
+    __m256i here = _mm256_loadu_si256((const __m256i*)(html + from));
+    __m256i next = _mm256_loadu_si256((const __m256i*)(html + from + 1));
+    __m256i hit = _mm256_and_si256(_mm256_cmpeq_epi8(here, lt),
+                                   _mm256_cmpeq_epi8(_mm256_or_si256(next, fold), a));
+    unsigned int mask = _mm256_movemask_epi8(hit);
+    if (mask != 0) {
+      return from + __builtin_ctz(mask);
+    }
+  }
+  return findScalar(html, len, from);
+}
+#endif
+
+/**************** findHref ****************/
+/* Return the offset of the first "href=", in any case, that lies wholly
+ * within html[from, to); or to if there is none.
+ */
+static size_t
+findHref(const char* html, size_t from, const size_t to)
+{
+  for (; from + 5 <= to; from++) {
+    if ((html[from] | 0x20) == 'h' && strncasecmp(html + from, "href=", 5) == 0) {
+      return from;
+    }
+  }
+  return to;
+}
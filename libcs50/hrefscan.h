@@ -0,0 +1,69 @@
+/*
+ * hrefscan - one-pass finder for the hrefs of <a> tags in a page
+ *
+ * An *href* here is what webpage_getNextURL has always taken for a link:
+ * in a tag whose name begins with 'a' or 'A', the value after the first
+ * "href=" (in any case) that comes before the tag's '>'; quoted with '
+ * or ", or else running to the '>'; cut at any '#'. The page is expected
+ * to have had its whitespace removed, as webpage_getNextURL does, so
+ * "href=" is never split.
+ *
+ * The search for the next "<a" is the only part that touches every byte
+ * of the page, so it looks at 32 bytes at a time with AVX2 where the CPU
+ * has it, at 16 with SSE2 on other x86 CPUs, and otherwise a byte at a
+ * time behind memchr. Each candidate tag is then read once, up to its
+ * '>'; a tag that holds no usable href is passed over for good, so a
+ * page is scanned in one linear pass however many of its tags are not
+ * links.
+ *
+ * hrefscan_next only finds where each href lies; resolving it into a URL
+ * is up to the caller (see webpage_getNextURL and resolveURL).
+ */
+
+#ifndef __HREFSCAN_H
+#define __HREFSCAN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**************** global types ****************/
+/* where one href lies in a page; all offsets from the start of the page */
+typedef struct hrefscan_link {
+  size_t tag;           // the '<' of the tag holding it
+  size_t start;         // the first byte of its value
+  size_t len;           // bytes in its value, up to any '#'
+  size_t end;           // just past the value: its closing quote, '>', or '#'
+} hrefscan_link_t;
+
+/**************** functions ****************/
+
+/**************** hrefscan_next ****************/
+/* Find the first href in a tag that begins at or after html[from],
+ * where html holds len bytes. To go on to the next, call again with
+ * from set to link->end (or to link->tag + 2, to pass over this tag).
+ *
+ * We return:
+ *   true and fill in *link if there is one; false if not.
+ */
+bool hrefscan_next(const char* html, const size_t len, const size_t from,
+                   hrefscan_link_t* link);
+
+/**************** hrefscan_findAnchor ****************/
+/* Return the offset of the first "<a" or "<A" at or after html[from],
+ * where html holds len bytes; or len if there is none.
+ */
+size_t hrefscan_findAnchor(const char* html, const size_t len, const size_t from);
+
+/**************** hrefscan_setKernel ****************/
+/* Make hrefscan_findAnchor use the named kernel: "avx2", "sse2",
+ * "scalar", or "auto" (the default: the best this CPU runs). For
+ * benchmarks; call before any scanning starts, as it is not thread-safe.
+ * We return true if this CPU can run that kernel (and it is now in use).
+ */
+bool hrefscan_setKernel(const char* name);
+
+/**************** hrefscan_kernel ****************/
+/* Return the name of the kernel hrefscan_findAnchor is using. */
+const char* hrefscan_kernel(void);
+
+#endif // __HREFSCAN_H
@@ -0,0 +1,592 @@
+/*
+ * http - minimal HTTP/1.1 client helpers shared by the fetch paths
+ *
+ * See http.h for usage.
+ */
+
+#define _GNU_SOURCE       // strncasecmp, strcasestr, strndup
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include "http.h"
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+/**************** file-local global variables ****************/
+static const int HTTP_PORT = 80;            // default web server port
+static const size_t MAX_LINE = 64 * 1024;   // longest status/header line
+static const size_t INFLATE_ROOM = 16384;   // body space per inflate call
+#ifdef HAVE_ZLIB
+static const char* ACCEPT = "Accept-Encoding: gzip, deflate\r\n";
+#else
+static const char* ACCEPT = "";             // we could not decode it
+#endif
+
+/* parser states; the body is either raw (ST_BODY) or chunked */
+enum { ST_STATUS, ST_HEADERS, ST_BODY,
+       ST_CHUNK_SIZE, ST_CHUNK_DATA, ST_CHUNK_END, ST_TRAILERS, ST_DONE };
+
+/* Content-Encoding of the body: as sent, or compressed until the
+ * compressed stream has ended (after which any bytes are ignored) */
+enum { ENC_IDENTITY, ENC_GZIP, ENC_DEFLATE, ENC_ENDED };
+
+/**************** local functions ****************/
+static bool reserveBytes(char** buf, const size_t len, size_t* cap, size_t n);
+static bool appendBytes(char** buf, size_t* len, size_t* cap,
+                        const char* data, size_t n);
+static bool appendBody(http_response_t* resp, const char* data, size_t n);
+static bool keepBody(http_response_t* resp, const char* data, size_t n);
+#ifdef HAVE_ZLIB
+static bool inflateBody(http_response_t* resp, const char* data, size_t n);
+#endif
+static void endInflater(http_response_t* resp);
+static http_result_t endLine(http_response_t* resp);
+static http_result_t endHeaderLine(http_response_t* resp, const char* line);
+static bool headerValue(char** field, const char* value);
+
+/**************** http_burstURL ****************/
+/* see http.h for description.
+ *
+ * Each string is allocated enough space to hold the whole URL,
+ * which is more than necessary, allowing a little growth if needed.
+ * This is much simpler than a full URL parser and can't handle anything
+ * other than simple http://hostname[:port][/path] forms of URL anyway.
+ */
+bool
+http_burstURL(const char* url, char** hostname, int* port, char** pathname)
+{
+  // make plenty of space for the resulting strings
+  int length = strlen(url);
+
+  // initialize hostname to empty string
+  *hostname = calloc(sizeof(char), length); // initialized to all nulls
+  if (*hostname == NULL) {
+    return false;
+  }
+
+  // initialize pathname to slash
+  *pathname = calloc(sizeof(char), length); // initialized to all nulls
+  if (*pathname == NULL) {
+    free(*hostname);
+    return false;
+  } else {
+    **pathname = '/';
+  }
+
+  // initialize port to default port
+  *port = HTTP_PORT;
+
+  // parse various forms of the URL
+  if (sscanf(url, "http://%[^:]:%d/%s", *hostname, port, *pathname+1) == 3) {
+    return true;
+  } else if (sscanf(url, "http://%[^/]/%s", *hostname, *pathname+1) == 2) {
+    return true;
+  } else if (sscanf(url, "http://%[^:]:%d", *hostname, port) == 2) {
+    return true;
+  } else if (sscanf(url, "http://%[^/]/", *hostname) == 1) {
+    return true;
+  } else if (sscanf(url, "http://%s", *hostname) == 1) {
+    return true;
+  } else {
+    free(*hostname); *hostname = NULL;
+    free(*pathname); *pathname = NULL;
+    return false;
+  }
+}
+
+/**************** http_formatRequest ****************/
+/* see http.h for description */
+char*
+http_formatRequest(const char* hostname, const char* pathname)
+{
+  return http_formatConditionalRequest(hostname, pathname, NULL, NULL);
+}
+
+/**************** http_formatConditionalRequest ****************/
+/* see http.h for description */
+char*
+http_formatConditionalRequest(const char* hostname, const char* pathname,
+                              const char* etag, const char* lastModified)
+{
+  // each validator given adds a line: name, value, CRLF
+  const char* format =
+    "GET %s HTTP/1.1\r\nHost: %s\r\nConnection: keep-alive\r\n%s%s%s%s%s%s%s\r\n";
+  const char* tagLine = (etag != NULL) ? "If-None-Match: " : "";
+  const char* dateLine = (lastModified != NULL) ? "If-Modified-Since: " : "";
+  const char* tag = (etag != NULL) ? etag : "";
+  const char* date = (lastModified != NULL) ? lastModified : "";
+  const char* tagEnd = (etag != NULL) ? "\r\n" : "";
+  const char* dateEnd = (lastModified != NULL) ? "\r\n" : "";
+
+  int len = snprintf(NULL, 0, format, pathname, hostname, ACCEPT,
+                     tagLine, tag, tagEnd, dateLine, date, dateEnd);
+  char* request = malloc(len + 1);
+  if (request != NULL) {
+    snprintf(request, len + 1, format, pathname, hostname, ACCEPT,
+             tagLine, tag, tagEnd, dateLine, date, dateEnd);
+  }
+  return request;
+}
+
+/**************** http_response_init ****************/
+/* see http.h for description */
+void
+http_response_init(http_response_t* resp)
+{
+  resp->state = ST_STATUS;
+  resp->status = 0;
+  resp->contentLength = -1;
+  resp->chunked = false;
+  resp->keepAlive = false;
+  resp->overrun = false;
+  resp->bytesIn = 0;
+  resp->chunkLeft = 0;
+  resp->line = NULL;
+  resp->lineLen = resp->lineCap = 0;
+  resp->body = NULL;
+  resp->bodyLen = resp->bodyCap = 0;
+  resp->rawLen = 0;
+  resp->encoding = ENC_IDENTITY;
+  resp->inflater = NULL;
+  resp->sink = NULL;
+  resp->sinkArg = NULL;
+  resp->etag = NULL;
+  resp->lastModified = NULL;
+}
+
+/**************** http_response_setSink ****************/
+/* see http.h for description */
+void
+http_response_setSink(http_response_t* resp, http_sink_t sink, void* arg)
+{
+  resp->sink = sink;
+  resp->sinkArg = arg;
+}
+
+/**************** http_response_feed ****************/
+/* see http.h for description */
+http_result_t
+http_response_feed(http_response_t* resp, const char* data, size_t len)
+{
+  size_t i = 0;
+  resp->bytesIn += len;
+  while (i < len && resp->state != ST_DONE) {
+    if (resp->state == ST_CHUNK_DATA) {
+      // take up to the end of this chunk
+      size_t n = len - i;
+      if (n > (size_t)resp->chunkLeft) {
+        n = resp->chunkLeft;
+      }
+      if (!appendBody(resp, data + i, n)) {
+        return HTTP_ERROR;
+      }
+      i += n;
+      resp->chunkLeft -= n;
+      if (resp->chunkLeft == 0) {
+        resp->state = ST_CHUNK_END;
+      }
+    } else if (resp->state == ST_BODY) {
+      // take everything, or up to Content-Length (which counts the
+      // body as sent, not as decoded)
+      size_t n = len - i;
+      if (resp->contentLength >= 0
+          && n > (size_t)resp->contentLength - resp->rawLen) {
+        n = resp->contentLength - resp->rawLen;
+      }
+      if (!appendBody(resp, data + i, n)) {
+        return HTTP_ERROR;
+      }
+      i += n;
+      if (resp->contentLength >= 0 && resp->rawLen == (size_t)resp->contentLength) {
+        resp->state = ST_DONE;
+      }
+    } else {
+      // status, header, chunk-size, or trailer line:
+      // collect bytes up to the next newline
+      const char* nl = memchr(data + i, '\n', len - i);
+      size_t n = (nl == NULL) ? len - i : (size_t)(nl - (data + i));
+      if (resp->lineLen + n > MAX_LINE
+          || !appendBytes(&resp->line, &resp->lineLen, &resp->lineCap, data + i, n)) {
+        return HTTP_ERROR;
+      }
+      i += n;
+      if (nl != NULL) {
+        i++;        // consume the newline
+        if (endLine(resp) == HTTP_ERROR) {
+          return HTTP_ERROR;
+        }
+      }
+    }
+  }
+
+  if (i < len) {
+    resp->overrun = true;       // server sent more than one response
+  }
+  return (resp->state == ST_DONE) ? HTTP_DONE : HTTP_MORE;
+}
+
+/**************** http_response_eof ****************/
+/* see http.h for description */
+http_result_t
+http_response_eof(http_response_t* resp)
+{
+  resp->keepAlive = false;
+  if (resp->state == ST_BODY && resp->contentLength < 0) {
+    resp->state = ST_DONE;      // body delimited by connection close
+  }
+  return (resp->state == ST_DONE) ? HTTP_DONE : HTTP_ERROR;
+}
+
+/**************** http_response_ok ****************/
+/* see http.h for description */
+bool
+http_response_ok(const http_response_t* resp)
+{
+  return resp->state == ST_DONE && resp->status == 200
+    && (resp->encoding == ENC_IDENTITY || resp->encoding == ENC_ENDED);
+}
+
+/**************** http_response_notModified ****************/
+/* see http.h for description */
+bool
+http_response_notModified(const http_response_t* resp)
+{
+  return resp->state == ST_DONE && resp->status == 304;
+}
+
+/**************** http_response_reusable ****************/
+/* see http.h for description */
+bool
+http_response_reusable(const http_response_t* resp)
+{
+  if (http_response_notModified(resp)) {
+    return resp->keepAlive && !resp->overrun;
+  }
+  return http_response_ok(resp) && resp->keepAlive && !resp->overrun
+    && (resp->chunked || resp->contentLength >= 0);
+}
+
+/**************** http_response_takeBody ****************/
+/* see http.h for description */
+char*
+http_response_takeBody(http_response_t* resp)
+{
+  char* body = resp->body;
+  resp->body = NULL;
+  resp->bodyLen = resp->bodyCap = 0;
+  return body;
+}
+
+/**************** http_response_free ****************/
+/* see http.h for description */
+void
+http_response_free(http_response_t* resp)
+{
+  free(resp->line);
+  free(resp->body);
+  free(resp->etag);
+  free(resp->lastModified);
+  endInflater(resp);
+  resp->line = resp->body = NULL;
+  resp->etag = resp->lastModified = NULL;
+  resp->lineLen = resp->lineCap = 0;
+  resp->bodyLen = resp->bodyCap = 0;
+}
+
+/**************** endLine ****************/
+/* A complete status, header, chunk-size, or trailer line is in
+ * resp->line; act on it.
+ */
+static http_result_t
+endLine(http_response_t* resp)
+{
+  // strip the CR of a CRLF and terminate the line
+  if (resp->lineLen > 0 && resp->line[resp->lineLen - 1] == '\r') {
+    resp->lineLen--;
+  }
+  if (!appendBytes(&resp->line, &resp->lineLen, &resp->lineCap, "", 0)) {
+    return HTTP_ERROR;
+  }
+  char* line = resp->line;
+  resp->lineLen = 0;          // ready for the next line
+
+  switch (resp->state) {
+  case ST_STATUS: {
+    int minor;
+    if (sscanf(line, "HTTP/1.%d %d", &minor, &resp->status) != 2) {
+      return HTTP_ERROR;
+    }
+    resp->keepAlive = (minor >= 1);   // HTTP/1.1 is persistent by default
+    resp->state = ST_HEADERS;
+    return HTTP_MORE;
+  }
+
+  case ST_HEADERS:
+    return endHeaderLine(resp, line);
+
+  case ST_CHUNK_SIZE: {
+    // hex size, possibly followed by ";extension"
+    char* end;
+    long n = strtol(line, &end, 16);
+    if (end == line || n < 0 || (*end != '\0' && *end != ';' && *end != ' ')) {
+      return HTTP_ERROR;
+    }
+    resp->chunkLeft = n;
+    resp->state = (n == 0) ? ST_TRAILERS : ST_CHUNK_DATA;
+    return HTTP_MORE;
+  }
+
+  case ST_CHUNK_END:
+    // the CRLF after each chunk's data
+    if (*line != '\0') {
+      return HTTP_ERROR;
+    }
+    resp->state = ST_CHUNK_SIZE;
+    return HTTP_MORE;
+
+  case ST_TRAILERS:
+    // ignore trailer fields; a blank line ends the response
+    if (*line == '\0') {
+      resp->state = ST_DONE;
+    }
+    return HTTP_MORE;
+
+  default:
+    return HTTP_ERROR;
+  }
+}
+
+/**************** endHeaderLine ****************/
+/* Act on one header line, or on the blank line that ends the headers. */
+static http_result_t
+endHeaderLine(http_response_t* resp, const char* line)
+{
+  if (*line == '\0') {
+    // blank line ends the headers
+    if (resp->status != 200) {
+      resp->state = ST_DONE;
+    } else if (resp->chunked) {
+      resp->state = ST_CHUNK_SIZE;      // chunked overrides Content-Length
+    } else if (resp->contentLength == 0) {
+      resp->state = ST_DONE;
+    } else {
+      resp->state = ST_BODY;
+    }
+  } else if (strncasecmp(line, "Content-Length:", 15) == 0) {
+    char* end;
+    long n = strtol(line + 15, &end, 10);
+    if (end == line + 15 || n < 0) {
+      return HTTP_ERROR;
+    }
+    resp->contentLength = n;
+  } else if (strncasecmp(line, "Transfer-Encoding:", 18) == 0) {
+    if (strcasestr(line + 18, "chunked") != NULL) {
+      resp->chunked = true;
+    }
+  } else if (strncasecmp(line, "Connection:", 11) == 0) {
+    if (strcasestr(line + 11, "close") != NULL) {
+      resp->keepAlive = false;
+    } else if (strcasestr(line + 11, "keep-alive") != NULL) {
+      resp->keepAlive = true;
+    }
+#ifdef HAVE_ZLIB
+  } else if (strncasecmp(line, "Content-Encoding:", 17) == 0) {
+    // the only codings we offer; "x-gzip" is an old name for gzip
+    if (strcasestr(line + 17, "gzip") != NULL) {
+      resp->encoding = ENC_GZIP;
+    } else if (strcasestr(line + 17, "deflate") != NULL) {
+      resp->encoding = ENC_DEFLATE;
+    }
+#endif
+  } else if (strncasecmp(line, "ETag:", 5) == 0) {
+    if (!headerValue(&resp->etag, line + 5)) {
+      return HTTP_ERROR;
+    }
+  } else if (strncasecmp(line, "Last-Modified:", 14) == 0) {
+    if (!headerValue(&resp->lastModified, line + 14)) {
+      return HTTP_ERROR;
+    }
+  }
+  return HTTP_MORE;
+}
+
+/**************** headerValue ****************/
+/* Keep a copy of a header's value, without the whitespace around it, in
+ * *field (replacing any earlier one); an empty value leaves it NULL.
+ * Returns false if out of memory.
+ */
+static bool
+headerValue(char** field, const char* value)
+{
+  while (*value == ' ' || *value == '\t') {
+    value++;
+  }
+  size_t len = strlen(value);
+  while (len > 0 && (value[len - 1] == ' ' || value[len - 1] == '\t')) {
+    len--;
+  }
+  free(*field);
+  *field = NULL;
+  if (len == 0) {
+    return true;
+  }
+  *field = strndup(value, len);
+  return *field != NULL;
+}
+
+/**************** reserveBytes ****************/
+/* Make room in the growable buffer *buf (length len, capacity *cap) for
+ * n more bytes and a NUL, doubling it as needed.
+ * Returns false if out of memory; the buffer is then unchanged.
+ */
+static bool
+reserveBytes(char** buf, const size_t len, size_t* cap, size_t n)
+{
+  if (len + n + 1 > *cap) {
+    size_t newCap = (*cap == 0) ? 256 : *cap;
+    while (len + n + 1 > newCap) {
+      newCap *= 2;
+    }
+    char* newBuf = realloc(*buf, newCap);
+    if (newBuf == NULL) {
+      return false;
+    }
+    *buf = newBuf;
+    *cap = newCap;
+  }
+  return true;
+}
+
+/**************** appendBytes ****************/
+/* Append n bytes to the growable buffer *buf (length *len, capacity *cap),
+ * keeping it NUL-terminated and doubling it as needed.
+ * Returns false if out of memory; the buffer is then unchanged.
+ */
+static bool
+appendBytes(char** buf, size_t* len, size_t* cap, const char* data, size_t n)
+{
+  if (!reserveBytes(buf, *len, cap, n)) {
+    return false;
+  }
+  memcpy(*buf + *len, data, n);
+  *len += n;
+  (*buf)[*len] = '\0';
+  return true;
+}
+
+/**************** appendBody ****************/
+/* Take n more bytes of the body as sent: keep them, or what they decode
+ * to. Returns false if out of memory or the compressed stream is corrupt.
+ */
+static bool
+appendBody(http_response_t* resp, const char* data, size_t n)
+{
+  resp->rawLen += n;
+  switch (resp->encoding) {
+  case ENC_IDENTITY:
+    return keepBody(resp, data, n);
+  case ENC_ENDED:
+    return true;                // past the end of the compressed stream
+#ifdef HAVE_ZLIB
+  default:
+    return inflateBody(resp, data, n);
+#else
+  default:
+    return false;
+#endif
+  }
+}
+
+/**************** keepBody ****************/
+/* Keep n more bytes of the decoded body, and pass them to the sink, if
+ * any. Returns false if out of memory.
+ */
+static bool
+keepBody(http_response_t* resp, const char* data, size_t n)
+{
+  if (!appendBytes(&resp->body, &resp->bodyLen, &resp->bodyCap, data, n)) {
+    return false;
+  }
+  if (resp->sink != NULL && n > 0) {
+    (*resp->sink)(resp->sinkArg, data, n);
+  }
+  return true;
+}
+
+#ifdef HAVE_ZLIB
+/**************** inflateBody ****************/
+/* Inflate n more bytes of a compressed body straight into resp->body,
+ * passing each piece decoded to the sink, if any; once the compressed
+ * stream ends, later bytes are ignored. Returns false if out of memory
+ * or the stream is corrupt.
+ */
+static bool
+inflateBody(http_response_t* resp, const char* data, size_t n)
+{
+  z_stream* zs = resp->inflater;
+  if (zs == NULL) {
+    if (n == 0) {
+      return true;
+    }
+    // gzip, or deflate in its zlib wrapper, as detected by its header;
+    // some servers send "deflate" bare, which we tell by a first byte
+    // that does not name method 8 with a window of at most 32K
+    int windowBits = 15 + 32;
+    if (resp->encoding == ENC_DEFLATE && ((unsigned char)data[0] & 0x8f) != 0x08) {
+      windowBits = -15;
+    }
+    zs = calloc(1, sizeof(z_stream));
+    if (zs == NULL || inflateInit2(zs, windowBits) != Z_OK) {
+      free(zs);
+      return false;
+    }
+    resp->inflater = zs;
+  }
+
+  zs->next_in = (Bytef*)data;
+  zs->avail_in = n;
+  int ret;
+  do {
+    if (!reserveBytes(&resp->body, resp->bodyLen, &resp->bodyCap, INFLATE_ROOM)) {
+      return false;
+    }
+    char* out = resp->body + resp->bodyLen;
+    size_t room = resp->bodyCap - resp->bodyLen - 1;
+    zs->next_out = (Bytef*)out;
+    zs->avail_out = room;
+    ret = inflate(zs, Z_NO_FLUSH);
+    if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+      return false;             // corrupt data, or out of memory
+    }
+    size_t got = room - zs->avail_out;
+    resp->bodyLen += got;
+    resp->body[resp->bodyLen] = '\0';
+    if (resp->sink != NULL && got > 0) {
+      (*resp->sink)(resp->sinkArg, out, got);
+    }
+  } while (ret == Z_OK && (zs->avail_in > 0 || zs->avail_out == 0));
+
+  if (ret == Z_STREAM_END) {
+    endInflater(resp);
+    resp->encoding = ENC_ENDED;
+  }
+  return true;
+}
+#endif
+
+/**************** endInflater ****************/
+/* Free the body's zlib stream, if any. */
+static void
+endInflater(http_response_t* resp)
+{
+#ifdef HAVE_ZLIB
+  if (resp->inflater != NULL) {
+    inflateEnd(resp->inflater);
+    free(resp->inflater);
+  }
+#endif
+  resp->inflater = NULL;
+}
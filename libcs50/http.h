@@ -0,0 +1,159 @@
+/*
+ * http - minimal HTTP/1.1 client helpers shared by the fetch paths
+ *
+ * This module knows how to split an http:// URL into host, port, and
+ * path (the resolver module turns the host into an address), how to format a GET request, and how to parse a response
+ * incrementally: bytes can be fed in whatever pieces they arrive from the
+ * socket, and the parser reports when the response is complete. It
+ * understands Content-Length and chunked bodies, so it knows where a
+ * response ends on a persistent (keep-alive) connection. Built with zlib
+ * (HAVE_ZLIB), requests offer gzip and deflate Content-Encoding, and the
+ * parser inflates such a body as it arrives, so callers only ever see
+ * the decoded page. It also keeps
+ * the validators a server sends (ETag and Last-Modified), so a later
+ * conditional request can ask for the page only if it has changed. A caller that
+ * wants to look at the body while it is still arriving can give the
+ * parser a *sink*, which sees each piece of the (de-chunked, decoded)
+ * body as soon as it has been parsed.
+ *
+ * It is used by webpage_fetch() (blocking) and by the fetcher module
+ * (non-blocking, event-driven).
+ */
+
+#ifndef __HTTP_H
+#define __HTTP_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**************** global types ****************/
+
+/* result of feeding bytes to a response parser */
+typedef enum {
+  HTTP_MORE,     // need more bytes
+  HTTP_DONE,     // response complete (see status for success)
+  HTTP_ERROR     // malformed response or out of memory
+} http_result_t;
+
+/* receives each piece of a response body as it is parsed */
+typedef void (*http_sink_t)(void* arg, const char* data, size_t len);
+
+/* incremental response parser; fields are read-only to callers */
+typedef struct http_response {
+  int state;               // parser state, private
+  int status;              // status code, or 0 before the status line
+  long contentLength;      // Content-Length header, or -1 if absent
+  bool chunked;            // Transfer-Encoding: chunked
+  bool keepAlive;          // server will keep the connection open
+  bool overrun;            // bytes arrived past the end of the response
+  size_t bytesIn;          // total bytes fed to the parser
+  long chunkLeft;          // bytes left in the current chunk, private
+  char* line;              // partial status/header line, private
+  size_t lineLen, lineCap;
+  char* body;              // body bytes received so far, decoded (NUL-terminated)
+  size_t bodyLen, bodyCap;
+  size_t rawLen;           // body bytes received so far, as sent
+  int encoding;            // Content-Encoding being undone, private
+  void* inflater;          // its zlib stream, or NULL; private
+  http_sink_t sink;        // sees the body as it arrives, or NULL; private
+  void* sinkArg;
+  char* etag;              // ETag header, or NULL if absent
+  char* lastModified;      // Last-Modified header, or NULL if absent
+} http_response_t;
+
+/**************** http_burstURL ****************/
+/* Burst the URL into components (hostname, port, pathname).
+ *
+ * Caller provides:
+ *   url, assumed non-NULL and already normalized, of the form
+ *   http://hostname[:port][/pathname].
+ * We return:
+ *   true if successful, filling in *hostname and *pathname with new
+ *   strings (to be free'd by the caller) and *port with the port;
+ *   false otherwise, with nothing allocated.
+ */
+bool http_burstURL(const char* url, char** hostname, int* port, char** pathname);
+
+/**************** http_formatRequest ****************/
+/* Return a newly allocated HTTP/1.1 GET request for pathname on hostname,
+ * asking the server to keep the connection open afterwards (and, with
+ * zlib, offering to take the body compressed),
+ * or NULL if out of memory. Caller must free the result.
+ */
+char* http_formatRequest(const char* hostname, const char* pathname);
+
+/**************** http_formatConditionalRequest ****************/
+/* Like http_formatRequest, but ask for the page only if it has changed
+ * since the response that carried these validators: an If-None-Match
+ * line for etag and an If-Modified-Since line for lastModified, each
+ * only if not NULL. An unchanged page gets a 304 response, without body.
+ */
+char* http_formatConditionalRequest(const char* hostname, const char* pathname,
+                                    const char* etag, const char* lastModified);
+
+/**************** http_response_init ****************/
+/* Initialize a response parser; call http_response_free when done. */
+void http_response_init(http_response_t* resp);
+
+/**************** http_response_setSink ****************/
+/* Have the parser pass each piece of the body to sink(arg, data, len)
+ * as soon as it is parsed, in order, in addition to keeping it.
+ * Only the body of a 200 response is passed. Call after
+ * http_response_init (which clears the sink); sink may be NULL.
+ */
+void http_response_setSink(http_response_t* resp, http_sink_t sink, void* arg);
+
+/**************** http_response_feed ****************/
+/* Feed len bytes of the server's response to the parser.
+ *
+ * We return:
+ *   HTTP_MORE if the response is not yet complete,
+ *   HTTP_DONE once it is (any bytes past the end are ignored),
+ *   HTTP_ERROR if the response is malformed, its compressed body is
+ *   corrupt, or memory runs out.
+ * Notes:
+ *   Parsing stops at the end of the headers unless the status is 200;
+ *   we have no use for the body of an error page.
+ */
+http_result_t http_response_feed(http_response_t* resp, const char* data, size_t len);
+
+/**************** http_response_eof ****************/
+/* Tell the parser the server closed the connection.
+ * We return HTTP_DONE if that legitimately ends the response (a body
+ * delimited by connection close), or HTTP_ERROR if it came too early.
+ */
+http_result_t http_response_eof(http_response_t* resp);
+
+/**************** http_response_ok ****************/
+/* Return true iff a complete response was parsed with status 200 (and,
+ * if its body was compressed, the compressed stream was complete).
+ */
+bool http_response_ok(const http_response_t* resp);
+
+/**************** http_response_notModified ****************/
+/* Return true iff a complete response was parsed with status 304, the
+ * answer to a conditional request for a page that has not changed.
+ */
+bool http_response_notModified(const http_response_t* resp);
+
+/**************** http_response_reusable ****************/
+/* Return true iff the connection that carried this response may be used
+ * for another request: the response completed with status 200, its end
+ * was marked by Content-Length or chunked encoding (not by close), the
+ * server did not ask to close, and nothing arrived past its end.
+ * A 304 has no body, so it qualifies on the last two alone.
+ */
+bool http_response_reusable(const http_response_t* resp);
+
+/**************** http_response_takeBody ****************/
+/* Return the NUL-terminated body, decoded, and hand ownership to the
+ * caller, who must later free it; returns NULL if there is no body.
+ */
+char* http_response_takeBody(http_response_t* resp);
+
+/**************** http_response_free ****************/
+/* Free the memory held by the parser (but not the struct itself). */
+void http_response_free(http_response_t* resp);
+
+#endif // __HTTP_H
@@ -0,0 +1,361 @@
+/*
+ * linkscan - incremental scanner for the links in an HTML page
+ *
+ * See linkscan.h for usage.
+ *
+ * The scanner is a state machine over the bytes of the page, so it can
+ * stop at the end of any piece and go on with the next. Outside tags it
+ * only looks for the next '<' (with memchr). After a '<' it reads the tag
+ * name one byte at a time; the attributes of <a> and <area> tags are read
+ * the same way, while any other tag, end tag, or declaration is skipped
+ * to its '>' (with memchr again), and a comment to its "-->".
+ *
+ * The value of the first href in a tag is collected, without whitespace
+ * and up to any '#', and reported when its closing quote (or, unquoted,
+ * the whitespace or '>' after it) arrives. Values longer than MAX_HREF
+ * are dropped rather than kept in full.
+ */
+
+#define _GNU_SOURCE       // strdup
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdbool.h>
+#include "linkscan.h"
+#include "webpage.h"
+
+/**************** file-local global variables ****************/
+#define MAX_HREF 4096                   // longest href we report
+#define MAX_NAME 8                      // tag and attribute names we compare
+
+/* scanner states; see above */
+enum { LS_TEXT, LS_OPEN, LS_BANG, LS_COMMENT, LS_NAME, LS_SKIP,
+       LS_ATTRS, LS_ATTRNAME, LS_AFTERNAME, LS_BEFOREVALUE, LS_VALUE };
+
+/**************** global types ****************/
+typedef struct linkscan {
+  char* base;                 // the page's URL (NULL if raw)
+  void (*found)(void* arg, char* url);
+  void (*foundRaw)(void* arg, const char* href, size_t len);
+  void* arg;
+  int state;                  // one of the LS_ values
+  char name[MAX_NAME];        // tag or attribute name so far, lower case
+  int nameLen;                // its length, capped at MAX_NAME
+  int dashes;                 // '-' just seen, in "<!--" and "-->"
+  bool linked;                // this tag's href has been seen already
+  bool isHref;                // the value being read is that href
+  char quote;                 // the value's closing quote, or 0 if unquoted
+  char value[MAX_HREF];       // the href so far
+  size_t valueLen;
+  bool fragment;              // reached its '#': ignore the rest
+  bool overflow;              // longer than MAX_HREF: ignore it
+} linkscan_t;
+
+/**************** local functions ****************/
+static bool step(linkscan_t* ls, const char c);
+static void addName(linkscan_t* ls, const char c);
+static bool nameIs(const linkscan_t* ls, const char* name);
+static void addValue(linkscan_t* ls, const char c);
+static void endValue(linkscan_t* ls);
+
+/**************** linkscan_new() ****************/
+/* see linkscan.h for description */
+linkscan_t*
+linkscan_new(const char* baseURL, void (*found)(void* arg, char* url), void* arg)
+{
+  if (baseURL == NULL || found == NULL) {
+    return NULL;
+  }
+
+  linkscan_t* ls = malloc(sizeof(linkscan_t));
+  if (ls == NULL) {
+    return NULL;
+  }
+  ls->base = strdup(baseURL);
+  if (ls->base == NULL) {
+    free(ls);
+    return NULL;
+  }
+  ls->found = found;
+  ls->foundRaw = NULL;
+  ls->arg = arg;
+  linkscan_reset(ls);
+  return ls;
+}
+
+/**************** linkscan_newRaw() ****************/
+/* see linkscan.h for description */
+linkscan_t*
+linkscan_newRaw(void (*found)(void* arg, const char* href, size_t len), void* arg)
+{
+  if (found == NULL) {
+    return NULL;
+  }
+
+  linkscan_t* ls = malloc(sizeof(linkscan_t));
+  if (ls == NULL) {
+    return NULL;
+  }
+  ls->base = NULL;
+  ls->found = NULL;
+  ls->foundRaw = found;
+  ls->arg = arg;
+  linkscan_reset(ls);
+  return ls;
+}
+
+/**************** linkscan_feed() ****************/
+/* see linkscan.h for description */
+void
+linkscan_feed(void* scanner, const char* data, size_t len)
+{
+  linkscan_t* ls = scanner;
+  if (ls == NULL || data == NULL) {
+    return;
+  }
+
+  const char* p = data;
+  const char* end = data + len;
+  while (p < end) {
+    if (ls->state == LS_TEXT || ls->state == LS_SKIP) {
+      // skip ahead to the next tag, or past the end of this one
+      const char* mark = memchr(p, (ls->state == LS_TEXT) ? '<' : '>', end - p);
+      if (mark == NULL) {
+        return;
+      }
+      p = mark + 1;
+      ls->state = (ls->state == LS_TEXT) ? LS_OPEN : LS_TEXT;
+    } else if (step(ls, *p)) {
+      p++;
+    }
+  }
+}
+
+/**************** linkscan_reset() ****************/
+/* see linkscan.h for description */
+void
+linkscan_reset(linkscan_t* ls)
+{
+  if (ls != NULL) {
+    ls->state = LS_TEXT;
+    ls->nameLen = 0;
+    ls->dashes = 0;
+    ls->linked = ls->isHref = false;
+    ls->quote = 0;
+    ls->valueLen = 0;
+    ls->fragment = ls->overflow = false;
+  }
+}
+
+/**************** linkscan_delete() ****************/
+/* see linkscan.h for description */
+void
+linkscan_delete(linkscan_t* ls)
+{
+  if (ls != NULL) {
+    free(ls->base);
+    free(ls);
+  }
+}
+
+/**************** step ****************/
+/* Advance the scanner (inside a tag or comment) by one byte c.
+ * Returns true if c was used up; false if the new state must see c too.
+ */
+static bool
+step(linkscan_t* ls, const char c)
+{
+  const bool space = isspace((unsigned char)c);
+
+  switch (ls->state) {
+  case LS_OPEN:                 // just after '<'
+    if (isalpha((unsigned char)c)) {
+      ls->nameLen = 0;
+      addName(ls, c);
+      ls->state = LS_NAME;
+    } else if (c == '!') {
+      ls->dashes = 0;
+      ls->state = LS_BANG;
+    } else if (c == '/' || c == '?') {
+      ls->state = LS_SKIP;      // end tag or processing instruction
+    } else if (c != '<') {
+      ls->state = LS_TEXT;      // a bare '<' in the text
+    }
+    return true;
+
+  case LS_BANG:                 // after "<!": a comment, or a declaration
+    if (c == '-') {
+      if (++ls->dashes == 2) {
+        ls->dashes = 0;
+        ls->state = LS_COMMENT;
+      }
+    } else {
+      ls->state = (c == '>') ? LS_TEXT : LS_SKIP;
+    }
+    return true;
+
+  case LS_COMMENT:              // until "-->"
+    if (c == '-') {
+      ls->dashes++;
+    } else {
+      if (c == '>' && ls->dashes >= 2) {
+        ls->state = LS_TEXT;
+      }
+      ls->dashes = 0;
+    }
+    return true;
+
+  case LS_NAME:                 // tag name
+    if (isalnum((unsigned char)c)) {
+      addName(ls, c);
+      return true;
+    }
+    if (nameIs(ls, "a") || nameIs(ls, "area")) {
+      ls->linked = false;
+      ls->state = LS_ATTRS;
+      return false;
+    }
+    ls->state = (c == '>') ? LS_TEXT : LS_SKIP;
+    return true;
+
+  case LS_ATTRS:                // between attributes
+    if (c == '>') {
+      ls->state = LS_TEXT;
+    } else if (!space && c != '/') {
+      ls->nameLen = 0;
+      addName(ls, c);
+      ls->state = LS_ATTRNAME;
+    }
+    return true;
+
+  case LS_ATTRNAME:             // attribute name
+    if (c == '=') {
+      ls->isHref = !ls->linked && nameIs(ls, "href");
+      ls->state = LS_BEFOREVALUE;
+    } else if (space) {
+      ls->state = LS_AFTERNAME;
+    } else if (c == '>') {
+      ls->state = LS_TEXT;
+    } else if (c == '/') {
+      ls->state = LS_ATTRS;
+    } else {
+      addName(ls, c);
+    }
+    return true;
+
+  case LS_AFTERNAME:            // attribute name, then whitespace
+    if (space) {
+      return true;
+    }
+    if (c == '=') {
+      ls->isHref = !ls->linked && nameIs(ls, "href");
+      ls->state = LS_BEFOREVALUE;
+      return true;
+    }
+    ls->state = LS_ATTRS;       // that one had no value; c starts the next
+    return false;
+
+  case LS_BEFOREVALUE:          // after '='
+    if (space) {
+      return true;
+    }
+    ls->valueLen = 0;
+    ls->fragment = ls->overflow = false;
+    if (c == '>') {
+      endValue(ls);             // empty value
+      ls->state = LS_TEXT;
+      return true;
+    }
+    ls->state = LS_VALUE;
+    if (c == '"' || c == '\'') {
+      ls->quote = c;
+      return true;
+    }
+    ls->quote = 0;
+    return false;
+
+  case LS_VALUE:                // attribute value
+    if (ls->quote != 0 ? c == ls->quote : (space || c == '>')) {
+      endValue(ls);
+      ls->state = (ls->quote == 0 && c == '>') ? LS_TEXT : LS_ATTRS;
+    } else if (ls->isHref) {
+      addValue(ls, c);
+    }
+    return true;
+
+  default:
+    return true;
+  }
+}
+
+/**************** addName ****************/
+/* Append c, in lower case, to the name being read. */
+static void
+addName(linkscan_t* ls, const char c)
+{
+  if (ls->nameLen < MAX_NAME - 1) {
+    ls->name[ls->nameLen] = tolower((unsigned char)c);
+  }
+  if (ls->nameLen < MAX_NAME) {
+    ls->nameLen++;
+  }
+}
+
+/**************** nameIs ****************/
+/* Is the name just read exactly `name` (lower case, shorter than MAX_NAME)? */
+static bool
+nameIs(const linkscan_t* ls, const char* name)
+{
+  return (size_t)ls->nameLen == strlen(name)
+    && strncmp(ls->name, name, ls->nameLen) == 0;
+}
+
+/**************** addValue ****************/
+/* Append c to the href being read, dropping whitespace and everything
+ * from '#' on.
+ */
+static void
+addValue(linkscan_t* ls, const char c)
+{
+  if (ls->fragment || ls->overflow) {
+    return;
+  }
+  if (c == '#') {
+    ls->fragment = true;
+  } else if (!isspace((unsigned char)c)) {
+    if (ls->valueLen < MAX_HREF) {
+      ls->value[ls->valueLen++] = c;
+    } else {
+      ls->overflow = true;
+    }
+  }
+}
+
+/**************** endValue ****************/
+/* An attribute value has ended; if it was the tag's href, resolve it
+ * and report the link (or, if raw, just report it). An empty href is a
+ * link to the page's directory, as webpage_getNextURL has it; one that
+ * was only a #fragment is no link at all.
+ */
+static void
+endValue(linkscan_t* ls)
+{
+  if (!ls->isHref) {
+    return;
+  }
+  ls->isHref = false;
+  ls->linked = true;
+  if (ls->fragment && ls->valueLen == 0) {
+    return;
+  }
+  if (!ls->overflow && ls->foundRaw != NULL) {
+    (*ls->foundRaw)(ls->arg, ls->value, ls->valueLen);
+  } else if (!ls->overflow) {
+    char* url = resolveURL(ls->base, ls->value, ls->valueLen);
+    if (url != NULL) {
+      (*ls->found)(ls->arg, url);
+    }
+  }
+}
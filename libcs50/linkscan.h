@@ -0,0 +1,88 @@
+/*
+ * linkscan - incremental scanner for the links in an HTML page
+ *
+ * A *linkscan* finds the href of every <a> and <area> tag in a page fed
+ * to it in pieces, in whatever pieces the page arrives from the network,
+ * and reports each link as soon as the tag holding it has been read, so
+ * the caller can queue a page's first links while the rest of it is
+ * still on the way. A tag split across pieces is picked up where it left
+ * off; the scanner keeps only the tag it is in the middle of, never the
+ * page, so its memory does not grow with the size of the page.
+ *
+ * Links are resolved as webpage_getNextURL resolves them: whitespace and
+ * any #fragment dropped, bare #fragments and non-http absolute links
+ * skipped, and relative ones made absolute against the page's URL (see
+ * resolveURL), so an empty href is a link to the page's directory. Unlike
+ * webpage_getNextURL, it skips links inside <!-- comments -->, and
+ * leaves the page itself alone.
+ *
+ * Typical use, with webpage_fetchStream:
+ *   linkscan_t* ls = linkscan_new(webpage_getURL(page), found, arg);
+ *   if (webpage_fetchStream(page, linkscan_feed, ls)) { ... }
+ *   linkscan_delete(ls);
+ */
+
+#ifndef __LINKSCAN_H
+#define __LINKSCAN_H
+
+#include <stddef.h>
+
+/**************** global types ****************/
+typedef struct linkscan linkscan_t;  // opaque to users of the module
+
+/**************** functions ****************/
+
+/**************** linkscan_new ****************/
+/* Create a new scanner for a page.
+ *
+ * Caller provides:
+ *   baseURL: the page's URL, against which relative links are resolved;
+ *     we keep a copy;
+ *   found: called as found(arg, url) for each link, in page order, with
+ *     a new absolute URL string that found must eventually free.
+ * We return:
+ *   pointer to a new scanner, or NULL on error.
+ * Caller is responsible for:
+ *   later calling linkscan_delete.
+ */
+linkscan_t* linkscan_new(const char* baseURL,
+                         void (*found)(void* arg, char* url), void* arg);
+
+/**************** linkscan_newRaw ****************/
+/* Create a new scanner that reports each link as written, leaving its
+ * resolution to the caller (see resolveURL): for a caller that can often
+ * skip resolving a link, such as one that remembers links it has seen.
+ *
+ * Caller provides:
+ *   found: called as found(arg, href, len) for each link, in page order,
+ *     with its len characters, whitespace and any #fragment dropped (and
+ *     so possibly none, for an empty href; a bare #fragment is not
+ *     reported). href is not null-terminated, and is valid only
+ *     until found returns.
+ * We return:
+ *   pointer to a new scanner, or NULL on error.
+ * Caller is responsible for:
+ *   later calling linkscan_delete.
+ */
+linkscan_t* linkscan_newRaw(void (*found)(void* arg, const char* href, size_t len),
+                            void* arg);
+
+/**************** linkscan_feed ****************/
+/* Scan the next len bytes of the page, calling found for each link
+ * whose tag ends within them. (The parameter is void* so this function
+ * can be used directly as a body sink: see webpage_fetchStream and
+ * fetcher_submitStream.)
+ */
+void linkscan_feed(void* scanner, const char* data, size_t len);
+
+/**************** linkscan_reset ****************/
+/* Forget any partial tag and start over at the beginning of a page,
+ * as before a fresh fetch of the same page.
+ */
+void linkscan_reset(linkscan_t* ls);
+
+/**************** linkscan_delete ****************/
+/* Delete the scanner. */
+void linkscan_delete(linkscan_t* ls);
+
+#endif // __LINKSCAN_H
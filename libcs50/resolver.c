@@ -0,0 +1,257 @@
+/*
+ * resolver - thread-safe hostname-to-address cache
+ *
+ * See resolver.h for usage.
+ *
+ * The cache is a small fixed array searched linearly, like connpool;
+ * a crawl resolves only a handful of distinct hosts. When the array is
+ * full, the least recently used entry makes room.
+ *
+ * The lock is not held while getaddrinfo runs, so a slow lookup of one
+ * name never stalls threads fetching from hosts already in the cache.
+ * Two threads that miss on the same name at once both resolve it; the
+ * second answer simply overwrites the first.
+ */
+
+#define _GNU_SOURCE       // clock_gettime, getaddrinfo
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <pthread.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include "resolver.h"
+
+/**************** file-local global variables ****************/
+#define MAX_ENTRIES 128          // hostnames cached at once
+#define MAX_HOSTNAME 256         // longest hostname we cache
+
+/**************** local types ****************/
+typedef struct entry {
+  bool used;                     // false if the entry is empty
+  char hostname[MAX_HOSTNAME];
+  bool resolved;                 // false caches a failed lookup
+  struct in_addr addr;           // the address, if resolved
+  long expires;                  // when to look it up again (monotonic s)
+  long lastUsed;                 // for choosing an entry to replace
+} entry_t;
+
+static entry_t cache[MAX_ENTRIES];      // all empty to begin with
+static long numLookups = 0;
+static long numHits = 0;
+static pthread_mutex_t cacheLock = PTHREAD_MUTEX_INITIALIZER;
+
+/**************** local functions ****************/
+static bool findCached(const char* hostname, const long now, bool* resolved,
+                       struct in_addr* inaddr);
+static void fillAddr(struct sockaddr_in* addr, const struct in_addr* inaddr, const int port);
+static entry_t* findEntry(const char* hostname);
+static void storeEntry(const char* hostname, const bool resolved,
+                       const struct in_addr* addr, const long now);
+static bool isPermanent(const int rc);
+static long nowSec(void);
+
+/**************** resolver_lookup() ****************/
+/* see resolver.h for description */
+bool
+resolver_lookup(const char* hostname, const int port, struct sockaddr_in* addr)
+{
+  if (hostname == NULL || addr == NULL) {
+    return false;
+  }
+
+  long now = nowSec();
+  struct in_addr inaddr;
+  bool resolved;
+
+  if (!findCached(hostname, now, &resolved, &inaddr)) {
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* res = NULL;
+    int rc = getaddrinfo(hostname, NULL, &hints, &res);
+    resolved = (rc == 0 && res != NULL);
+    if (resolved) {
+      inaddr = ((struct sockaddr_in*) res->ai_addr)->sin_addr;
+    }
+    if (res != NULL) {
+      freeaddrinfo(res);
+    }
+
+    // a name that does not exist is remembered; a failure to get an
+    // answer at all (EAI_AGAIN and the like) may be gone by the retry
+    pthread_mutex_lock(&cacheLock);
+    numLookups++;
+    if (resolved || isPermanent(rc)) {
+      storeEntry(hostname, resolved, resolved ? &inaddr : NULL, now);
+    }
+    pthread_mutex_unlock(&cacheLock);
+  }
+
+  if (!resolved) {
+    return false;
+  }
+  fillAddr(addr, &inaddr, port);
+  return true;
+}
+
+/**************** resolver_cached() ****************/
+/* see resolver.h for description */
+bool
+resolver_cached(const char* hostname, const int port, struct sockaddr_in* addr,
+                bool* resolved)
+{
+  if (hostname == NULL || addr == NULL || resolved == NULL) {
+    return false;
+  }
+
+  struct in_addr inaddr;
+  if (!findCached(hostname, nowSec(), resolved, &inaddr)) {
+    return false;
+  }
+  if (*resolved) {
+    fillAddr(addr, &inaddr, port);
+  }
+  return true;
+}
+
+/**************** resolver_stats() ****************/
+/* see resolver.h for description */
+void
+resolver_stats(long* lookups, long* hits)
+{
+  pthread_mutex_lock(&cacheLock);
+  if (lookups != NULL) {
+    *lookups = numLookups;
+  }
+  if (hits != NULL) {
+    *hits = numHits;
+  }
+  pthread_mutex_unlock(&cacheLock);
+}
+
+/**************** resolver_clear() ****************/
+/* see resolver.h for description */
+void
+resolver_clear(void)
+{
+  pthread_mutex_lock(&cacheLock);
+  for (int i = 0; i < MAX_ENTRIES; i++) {
+    cache[i].used = false;
+  }
+  pthread_mutex_unlock(&cacheLock);
+}
+
+/**************** findCached ****************/
+/* If the cache has a current answer for hostname, count a lookup and a
+ * hit, set *resolved and (if resolved) *inaddr, and return true; else
+ * return false, counting nothing.
+ */
+static bool
+findCached(const char* hostname, const long now, bool* resolved, struct in_addr* inaddr)
+{
+  bool hit = false;
+  pthread_mutex_lock(&cacheLock);
+  entry_t* e = findEntry(hostname);
+  if (e != NULL && e->expires > now) {
+    numLookups++;
+    numHits++;
+    hit = true;
+    *resolved = e->resolved;
+    *inaddr = e->addr;
+    e->lastUsed = now;
+  }
+  pthread_mutex_unlock(&cacheLock);
+  return hit;
+}
+
+/**************** fillAddr ****************/
+/* Fill in *addr with inaddr and port (host byte order). */
+static void
+fillAddr(struct sockaddr_in* addr, const struct in_addr* inaddr, const int port)
+{
+  memset(addr, 0, sizeof(*addr));
+  addr->sin_family = AF_INET;
+  addr->sin_addr = *inaddr;
+  addr->sin_port = htons(port);
+}
+
+/**************** findEntry ****************/
+/* Return the entry for hostname, or NULL; caller holds cacheLock. */
+static entry_t*
+findEntry(const char* hostname)
+{
+  for (int i = 0; i < MAX_ENTRIES; i++) {
+    if (cache[i].used && strcmp(cache[i].hostname, hostname) == 0) {
+      return &cache[i];
+    }
+  }
+  return NULL;
+}
+
+/**************** storeEntry ****************/
+/* Record the outcome of resolving hostname, reusing its old entry, an
+ * empty one, or the least recently used one; caller holds cacheLock.
+ * Names too long for an entry are simply not cached.
+ */
+static void
+storeEntry(const char* hostname, const bool resolved,
+           const struct in_addr* addr, const long now)
+{
+  if (strlen(hostname) >= MAX_HOSTNAME) {
+    return;
+  }
+
+  entry_t* e = findEntry(hostname);
+  for (int i = 0; e == NULL && i < MAX_ENTRIES; i++) {
+    if (!cache[i].used) {
+      e = &cache[i];
+    }
+  }
+  if (e == NULL) {
+    e = &cache[0];              // full: replace the least recently used
+    for (int i = 1; i < MAX_ENTRIES; i++) {
+      if (cache[i].lastUsed < e->lastUsed) {
+        e = &cache[i];
+      }
+    }
+  }
+
+  e->used = true;
+  strcpy(e->hostname, hostname);
+  e->resolved = resolved;
+  if (resolved) {
+    e->addr = *addr;
+  }
+  e->expires = now + (resolved ? RESOLVER_TTL : RESOLVER_NEGATIVE_TTL);
+  e->lastUsed = now;
+}
+
+/**************** isPermanent ****************/
+/* Does getaddrinfo's error rc say the name has no address, rather than
+ * that no answer could be had just now?
+ */
+static bool
+isPermanent(const int rc)
+{
+#ifdef EAI_NODATA
+  if (rc == EAI_NODATA) {
+    return true;
+  }
+#endif
+  return rc == EAI_NONAME;
+}
+
+/**************** nowSec ****************/
+/* Return a monotonic clock reading in seconds. */
+static long
+nowSec(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec;
+}
@@ -0,0 +1,69 @@
+/*
+ * resolver - thread-safe hostname-to-address cache
+ *
+ * A crawl fetches many pages from few hosts, so resolving the hostname
+ * on every fetch (and again on every retry) repeats the same DNS work
+ * over and over. This module resolves names with getaddrinfo and keeps
+ * the answers, good and bad, for a while: a successful lookup is reused
+ * for RESOLVER_TTL seconds, and a name found not to exist (EAI_NONAME,
+ * EAI_NODATA) is not looked up again for RESOLVER_NEGATIVE_TTL. Other
+ * failures, such as EAI_AGAIN when the DNS server does not answer, are
+ * not cached, so the crawler's retry of the page asks again.
+ *
+ * The cache is one process-wide table protected by a mutex; lookups may
+ * come from any number of threads. It also counts lookups and cache hits,
+ * so callers can report how much resolution work it saved.
+ */
+
+#ifndef __RESOLVER_H
+#define __RESOLVER_H
+
+#include <stdbool.h>
+#include <netinet/in.h>
+
+/**************** global constants ****************/
+#define RESOLVER_TTL 300           // seconds to trust a resolved address
+#define RESOLVER_NEGATIVE_TTL 30   // seconds to remember a name that does not exist
+
+/**************** functions ****************/
+
+/**************** resolver_lookup ****************/
+/* Resolve hostname to an IPv4 address, from the cache if we can.
+ *
+ * Caller provides:
+ *   hostname, non-NULL; port, in host byte order; addr, to fill in.
+ * We return:
+ *   true if hostname resolved, filling in *addr with its address and port;
+ *   false if it did not (now, or, for a name that does not exist,
+ *   within the last RESOLVER_NEGATIVE_TTL seconds).
+ */
+bool resolver_lookup(const char* hostname, const int port, struct sockaddr_in* addr);
+
+/**************** resolver_cached ****************/
+/* Answer from the cache alone, never waiting on the DNS: for a caller
+ * that must not block, such as fetcher's event loop, which hands misses
+ * to a thread of its own that calls resolver_lookup.
+ *
+ * Caller provides:
+ *   hostname, non-NULL; port, in host byte order; addr, to fill in;
+ *   resolved, to fill in.
+ * We return:
+ *   true if the cache has a current answer for hostname, setting
+ *   *resolved to whether the name resolved, and if it did, filling in
+ *   *addr with its address and port (a lookup answered from the cache);
+ *   false if it has none (and count nothing).
+ */
+bool resolver_cached(const char* hostname, const int port, struct sockaddr_in* addr,
+                     bool* resolved);
+
+/**************** resolver_stats ****************/
+/* Report how many lookups have been made and how many of them were
+ * answered from the cache. Either pointer may be NULL.
+ */
+void resolver_stats(long* lookups, long* hits);
+
+/**************** resolver_clear ****************/
+/* Forget every cached answer (the counters are kept). */
+void resolver_clear(void);
+
+#endif // __RESOLVER_H
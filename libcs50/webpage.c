@@ -21,7 +21,14 @@
 #include <ctype.h>
 #include <stdbool.h>
 #include <netdb.h>
-#include "file.h"
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <time.h>
+#include <fcntl.h>
+#include "http.h"
+#include "hrefscan.h"
+#include "connpool.h"
+#include "resolver.h"
 #include "webpage.h"
 #include "mem.h"
 
@@ -44,20 +51,30 @@ typedef struct webpage {
   char* html;                              // html code of the page
   size_t html_len;                         // length of html code
   int depth;                               // depth of crawl
+  int status;                              // HTTP status of last fetch
+  char* etag;                              // validators of last fetch,
+  char* lastModified;                      // or NULL
+  webpage_timing_t timing;                 // phases of last fetch
 } webpage_t;
 
 /* *********************************************************************** */
 /* Private function prototypes */
 
-static FILE* connectToHost(const char* hostname, const int port);
-static inline bool isBlankLine(const char* line);
-static char* removeDotSegments(char* input);
-static void removeWhitespace(char* str);
+static int connectToHost(const char* hostname, const int port,
+                         webpage_timing_t* timing);
+static void setBlockingTimeouts(const int sock);
+static long nowUs(void);
+static http_result_t exchange(const int sock, const char* request,
+                              webpage_timing_t* timing,
+                              http_response_t* resp);
+static bool isKnownExtension(const char* ext, const size_t len);
+static bool isDotSegment(const char* seg, const size_t len);
+static size_t segmentEnd(const char* url, const size_t seg, const size_t pathEnd);
+static bool isPathEnd(const char c);
+static size_t removeWhitespace(char* str);
 static char* fixRelativeURL(char* base, char* rel, size_t len);
 static bool parseURL(const char* str, struct URL* url);
 static void freeURL(struct URL url);
-static bool burstURL(const char* url, char** hostname, 
-                     int* port, char** pathname);
 #ifdef DEBUG
 static void printURL(struct URL url);
 #endif // DEBUG
@@ -65,8 +82,9 @@ static void printURL(struct URL url);
 /* *********************************************************************** */
 /* Private global variables */
 
-static const int MAX_TRY = 3;    // maximum attempts to fetch
-static const int HTTP_PORT = 80; // default web server port
+static const int FETCH_TIMEOUT = 30; // seconds a read or write may block
+static const char* internalPrefix = INTERNAL_PREFIX;  // see setInternalPrefix
+static size_t internalPrefixLen = sizeof(INTERNAL_PREFIX) - 1;
 
 static const char* EXTS[] = {  // valid extensions
   "html",
@@ -91,6 +109,18 @@ char* webpage_getHTML(const webpage_t* page)  {
 char* webpage_getURL(const webpage_t* page)   { 
   return page ? page->url   : NULL; 
 }
+int   webpage_getStatus(const webpage_t* page) {
+  return page ? page->status : 0;
+}
+char* webpage_getETag(const webpage_t* page) {
+  return page ? page->etag : NULL;
+}
+char* webpage_getLastModified(const webpage_t* page) {
+  return page ? page->lastModified : NULL;
+}
+webpage_timing_t webpage_getTiming(const webpage_t* page) {
+  return page ? page->timing : (webpage_timing_t){ 0 };
+}
 
 /**************** webpage_new ****************/
 /* see webpage.h for documentation */
@@ -107,6 +137,10 @@ webpage_new(char* url, const int depth, char* html)
   page->depth = depth;
   page->html = html;
   page->html_len = html ? strlen(html) : 0;
+  page->status = 0;
+  page->etag = NULL;
+  page->lastModified = NULL;
+  page->timing = (webpage_timing_t){ 0 };
 
   return page;
 }
@@ -120,6 +154,8 @@ webpage_delete(void* data)
   if (page != NULL) {
     if (page->url) free(page->url);
     if (page->html) free(page->html);
+    free(page->etag);
+    free(page->lastModified);
     free(page);
   }
 }
@@ -136,13 +172,23 @@ webpage_delete(void* data)
  * Pseudocode:
  *     1. check for valid page 
  *     2. parse url into hostname, port, and filename
- *     3. open a connection to the given host
+ *     3. reuse an idle connection to the given host, or open one
  *     4. send http request
  *     5. fetch html response
- *     6. cleanup
+ *     6. return the connection to the pool if the server allows; cleanup
  */
 bool 
 webpage_fetch(webpage_t* page)
+{
+  return webpage_fetchStream(page, NULL, NULL);
+}
+
+/***************** webpage_fetchStream ******************************/
+/* see webpage.h for documentation */
+bool
+webpage_fetchStream(webpage_t* page,
+                    void (*sink)(void* arg, const char* data, size_t len),
+                    void* arg)
 {
   // check webpage structure - must have URL and not yet have HTML
   if (page == NULL || page->url == NULL || page->html != NULL) {
@@ -154,76 +200,147 @@ webpage_fetch(webpage_t* page)
   char* hostname; // will be initialized by burstURL
   int port;       // will be initialized by burstURL
   char* pathname; // will be initialized by burstURL
-  if (!burstURL(page->url, &hostname, &port, &pathname)) {
+  if (!http_burstURL(page->url, &hostname, &port, &pathname)) {
     return false;
   }
 
-  // attempt to connect to server 
-  FILE* http_fp = NULL; 
-  for (int try = 0;  http_fp == NULL && try < MAX_TRY; try++) {
-    // open connection - exit on error
-    http_fp = connectToHost(hostname, port);
-
-#ifndef NOSLEEP // CS50 students: please don't turn off the sleep!
-    sleep(1);   // sleep one second between fetches, to lighten load on server
-#endif
-  }
-
-  // failed to connect?
-  if (http_fp == NULL) {
+  char* request = http_formatConditionalRequest(hostname, pathname,
+                                                page->etag, page->lastModified);
+  free(pathname);
+  if (request == NULL) {
+    free(hostname);
     return false;
   }
 
-  // prepare and send HTTP request; receive response
-  char* httpResponse = NULL;
-  const char* httpFormat =
-    "GET %s HTTP/1.1\r\nHost: %s\r\nConnection: close\r\n\r\n";
-  if (fprintf(http_fp, httpFormat, pathname, hostname) >= 0) {
-    // ensure stdio buffer is flushed to socket
-    fflush(http_fp);
-    // read the server's response
-    httpResponse = file_readLine(http_fp);
+  http_response_t resp;
+  http_response_init(&resp);
+  http_response_setSink(&resp, sink, arg);
+  http_result_t result = HTTP_ERROR;
+  webpage_timing_t timing = { 0 };
+
+  // prefer an idle kept-alive connection to this server; the server may
+  // have closed it meanwhile, so if it yields no response at all,
+  // fall back to a fresh connection
+  int sock = connpool_get(hostname, port);
+  if (sock >= 0) {
+    setBlockingTimeouts(sock);
+    result = exchange(sock, request, &timing, &resp);
+    if (result == HTTP_ERROR && resp.bytesIn == 0) {
+      close(sock);
+      sock = -1;
+      http_response_free(&resp);
+      http_response_init(&resp);
+      http_response_setSink(&resp, sink, arg);
+    }
   }
 
-  free(hostname);
-  free(pathname);
+  if (sock < 0) {
+    // attempt to connect to server
+    sock = connectToHost(hostname, port, &timing);
+    if (sock >= 0) {
+      result = exchange(sock, request, &timing, &resp);
+    }
+  }
+  free(request);
 
   // did we succeed? check the response
+  timing.bytes = resp.bytesIn;
+  page->timing = timing;
+  page->status = resp.status;
   bool success = false;
-
-  if (httpResponse != NULL) {
-    // check response code to see whether we succeeded
-    int httpResponseCode = 0;
-    if (sscanf(httpResponse, "HTTP/1.1 %d", &httpResponseCode) == 1
-        && httpResponseCode == 200) {
-      // success! ignore the rest of the header, then grab the page
-      // read lines until we read a blank line or fail to read a line
-      char* line = file_readLine(http_fp);
-      while (line != NULL && !isBlankLine(line)) {
-        free(line);
-        line = file_readLine(http_fp);
-      }
-      // did we exit the loop because we read an empty line?
-      if (line != NULL) {
-        free(line); // the blank line
-
-        // then grab everything else - that should be the page content
-        char* html = file_readFile(http_fp);
-        if (html != NULL) {
-          page->html = html;
-          success = true;
-        } 
-      }
+  if (result == HTTP_DONE && http_response_ok(&resp)) {
+    char* html = http_response_takeBody(&resp);
+    if (html != NULL) {
+      page->html = html;
+      page->html_len = strlen(html);
+      webpage_setValidators(page, resp.etag, resp.lastModified);
+      success = true;
     }
-    free(httpResponse);
   }
 
-  // clean up
-  fclose(http_fp);
+  // clean up, keeping the connection if the server allows
+  if (sock >= 0) {
+    if (result == HTTP_DONE && http_response_reusable(&resp)) {
+      connpool_put(hostname, port, sock);
+    } else {
+      close(sock);
+    }
+  }
+  http_response_free(&resp);
+  free(hostname);
 
   return success;
 }
 
+/**************** webpage_setHTML ****************/
+/* see webpage.h for documentation */
+bool
+webpage_setHTML(webpage_t* page, char* html)
+{
+  if (page == NULL || html == NULL || page->html != NULL) {
+    return false;
+  }
+  page->html = html;
+  page->html_len = strlen(html);
+  return true;
+}
+
+/**************** webpage_takeHTML ****************/
+/* see webpage.h for documentation */
+char*
+webpage_takeHTML(webpage_t* page)
+{
+  if (page == NULL) {
+    return NULL;
+  }
+  char* html = page->html;
+  page->html = NULL;
+  page->html_len = 0;
+  return html;
+}
+
+/**************** webpage_setStatus ****************/
+/* see webpage.h for documentation */
+void
+webpage_setStatus(webpage_t* page, const int status)
+{
+  if (page != NULL) {
+    page->status = status;
+  }
+}
+
+/**************** webpage_setTiming ****************/
+/* see webpage.h for documentation */
+void
+webpage_setTiming(webpage_t* page, const webpage_timing_t* timing)
+{
+  if (page != NULL && timing != NULL) {
+    page->timing = *timing;
+  }
+}
+
+/**************** webpage_setValidators ****************/
+/* see webpage.h for documentation */
+bool
+webpage_setValidators(webpage_t* page, const char* etag, const char* lastModified)
+{
+  if (page == NULL) {
+    return false;
+  }
+  free(page->etag);
+  free(page->lastModified);
+  page->etag = (etag != NULL) ? strdup(etag) : NULL;
+  page->lastModified = (lastModified != NULL) ? strdup(lastModified) : NULL;
+  if ((etag != NULL && page->etag == NULL)
+      || (lastModified != NULL && page->lastModified == NULL)) {
+    free(page->etag);
+    free(page->lastModified);
+    page->etag = page->lastModified = NULL;
+    return false;
+  }
+  return true;
+}
+
 /**************** webpage_getNextWord ****************/
 /* see webpage.h for usage documentation.
  *
@@ -315,123 +432,67 @@ webpage_getNextWord(webpage_t* page, int* pos)
  * Pseudocode:
  *     1. check arguments
  *     2. if *pos = 0 (first call for this page): remove whitespace from html
- *     3. find hyperlink starting tags "<a" or "<A"
- *     4. find next href attribute "href="
- *     5. find next end tag ">"
- *     6. check that href comes before end tag
- *     7. deal with quoted and unquoted urls
- *     8. determine if url is absolute
- *     9. fixup relative links
- *    10. update *pos to position after the URL
- *    11. create new character buffer for result and return it
+ *     3. find the next href of an "<a" tag with hrefscan_next
+ *     4. determine if url is absolute
+ *     5. skip absolute links that are not http, and go on past their tag
+ *     6. fixup relative links
+ *     7. update *pos to position after the URL
+ *     8. create new character buffer for result and return it
  */
 char* 
 webpage_getNextURL(webpage_t* page, int* pos)
 {
   // make sure we have text and base url, and valid arg
-  if (page == NULL || page->html == NULL || page->url == NULL || pos == NULL) {
+  if (page == NULL || page->html == NULL || page->url == NULL || pos == NULL
+      || *pos < 0) {
     return NULL;
   }
 
   char* html = page->html;                 // the html document
-  char* base_url = page->url;              // the base URL for this html
-  int bad_link;                            // is this link ill formatted?
-  int relative;                            // is this link relative?
-  char delim;                              // url delimiter: ' ', ''', '"'
-  char* lnk;                               // hyperlink tags
-  char* href;                              // href in a tag
-  char* end;                               // end of hyperlink tag or url
-  char* ptr;                               // absolute vs. relative
-  char* hash;                              // hash mark character
+  hrefscan_link_t link;                    // where the next href lies
+  char* href;                              // its text
+  bool relative;                           // is this link relative?
 
   // condense html, makes parsing easier
   if (*pos == 0) {
-    removeWhitespace(html);
+    page->html_len = removeWhitespace(html);
   }
 
-  // parse for hyperlinks
-  do {
-    relative = 0;                        // assume absolute link
-    bad_link = 0;                        // assume valid link
-
-    // find tag "<a" or "<A""
-    lnk = strcasestr(&html[*pos], "<a");
-
-    // no more links on this page
-    if (!lnk) { return NULL; }
-
-    // find next href after hyperlink tag
-    href = strcasestr(lnk, "href=");
-
-    // no more links on this page
-    if (!href) { return NULL; }
-
-    // find end of hyperlink tag
-    end = strchr(lnk, '>');
-
-    // if the href we have is outside the current tag, continue
-    if (end && (end < href)) {
-      bad_link = 1; (*pos) += 2; continue;
-    }
-
-    // move href to beginning of url
-    href+=5;
-
-    // something went wrong, just continue
-    if (!href) { bad_link=1; (*pos) += 2; continue; }
-
-    // is the url quoted?
-    if (*href == '\'' || *href == '"') {  // yes, href="url" or href='url'
-      delim = *(href++);               // remember delimiter
-      end = strchr(href, delim);       // find next of same delimiter
-    } else {             // no, href=url
-      end = strchr(href, '>');         // hope: <a ... href=url>
-      // since we've stripped whitespace
-      // this could mangle things like:
-      // <a ... href=url name=val>
-    }
-
-    // if there is a # before the end of the url, exclude the #fragment
-    hash = strchr(href, '#');
-    if (hash && hash < end) {
-      end = hash;
-    }
-
-    // if we don't know where to end the url, continue
-    if (!end) {
-      bad_link = 1; (*pos) += 2; continue;
+  // parse for hyperlinks, skipping those we can't follow
+  size_t from = *pos;
+  while (true) {
+    if (!hrefscan_next(html, page->html_len, from, &link)) {
+      return NULL;                         // no more links on this page
     }
+    href = html + link.start;
 
-    // have a link now
-    if (*href == '#') {                   // internal reference
-      bad_link = 1; (*pos) += 2; continue;
+    // is the url absolute, i.e, ':' must precede any '/' or '?'
+    size_t scheme = 0;
+    while (scheme < link.len && strchr(":/?", href[scheme]) == NULL) {
+      scheme++;
     }
-
-    // is the url absolute, i.e, ':' must precede any '/', '?', or '#'
-    ptr = strpbrk(href, ":/?#");
-    if (!ptr || *ptr != ':') { 
-      relative = 1; 
-    } else if (strncasecmp(href, "http", 4)) { // absolute, but not http(s)
-      bad_link = 1; (*pos) += 2; continue;
+    relative = (scheme == link.len || href[scheme] != ':');
+    if (relative || strncasecmp(href, "http", 4) == 0) {
+      break;
     }
-  } while (bad_link);                       // keep parsing
+    from = link.tag + 2;                   // absolute, but not http(s)
+  }
 
   // update position after the end of the url
-  *pos = end - html;
+  *pos = link.end;
 
   // have a good link now
   if (relative) {                           // need to fixup relative links
-    char* result = fixRelativeURL(base_url, href, end - href);
-    return result; // may be NULL if Fixup failed.
+    return fixRelativeURL(page->url, href, link.len); // may be NULL if Fixup failed.
   } else {
     // create new buffer
-    char* result = calloc(end-href+1, sizeof(char));
+    char* result = calloc(link.len + 1, sizeof(char));
     if (result == NULL) {
       // out of memory
       return NULL;
     } else {
       // copy over absolute url
-      strncpy(result, href, end - href);
+      strncpy(result, href, link.len);
       return result;
     }
   }
@@ -440,15 +501,6 @@ webpage_getNextURL(webpage_t* page, int* pos)
 /******************** normalizeURL *******************************/
 /* Normalize the url according to RFC 3986 chapter 3.
  * see webpage.h for documentation.
- *
- * Pseudocode:
- *     1. check arguments
- *     2. try to parse url
- *     3. check any file extensions
- *     4. clear the url
- *     5. remove dot segments and lowercase scheme and host
- *     6. allocate space for the new url string
- *     7. assemble the new url from pieces
  */
 char*
 normalizeURL(const char* url)
@@ -457,78 +509,145 @@ normalizeURL(const char* url)
     return NULL;
   }
 
-  // try to parse the url
-  struct URL tmp;               // pieces of the parsed url
-  if (!parseURL(url, &tmp)) {
-    freeURL(tmp);
+  // the result is no longer than url
+  size_t size = strlen(url) + 1;
+  char* result = malloc(size);
+  if (result == NULL) {
     return NULL;
   }
+  if (!normalizeURLInto(url, result, size)) {
+    free(result);
+    return NULL;
+  }
+  return result;
+}
 
-  // check file extension
-  if (tmp.path != NULL) {               // if we have a path
-    char* dot = strrchr(tmp.path, '.');   // where is last '.' within string
-    char* slash = strrchr(tmp.path, '/'); // where is last '/' within string
-
-    // We expect to see URL of form /path/to/file.ext
-    if (dot != NULL && slash != NULL && dot > slash) {
-      char* ext = dot+1;                  // extension begins after '.'
+/******************** normalizeURLInto *******************************/
+/* see webpage.h for documentation.
+ *
+ * Pseudocode:
+ *     1. check arguments
+ *     2. find where the scheme, user, host, and path end
+ *     3. check any file extension
+ *     4. if the url is already normalized, copy it as it is
+ *     5. else lowercase scheme and host, and remove dot segments
+ *
+ * Nothing is written until the url is known to be good, and the write
+ * position never passes the read position, so buf may be url itself.
+ */
+bool
+normalizeURLInto(const char* url, char* buf, const size_t size)
+{
+  if (url == NULL || buf == NULL) {
+    return false;
+  }
 
-      // check against list of known extensions
-      if (strlen(ext) > 0) {
-        bool isKnownExt = false;      // is the extension valid?
-        for (int i = 0; EXTS[i] != NULL; i++) {
-          if (strncasecmp(ext, EXTS[i], strlen(EXTS[i])) == 0) {
-            isKnownExt = true;
-            break;
-          }
-        }
+  // absolute url, i.e., ':' must precede any '/', '?', or '#'
+  bool normal = true;                         // is it normalized already?
+  size_t schemeEnd = 0;
+  for (; url[schemeEnd] != ':'; schemeEnd++) {
+    if (isPathEnd(url[schemeEnd]) || url[schemeEnd] == '/') {
+      return false;
+    }
+    normal = normal && !(url[schemeEnd] >= 'A' && url[schemeEnd] <= 'Z');
+  }
+  schemeEnd++;                                // consume ':'
+  if (strncmp(url + schemeEnd, "//", 2) == 0) {
+    schemeEnd += 2;                           // consume "//"
+  }
 
-        // no recognized extension found
-        if (!isKnownExt) {
-          freeURL(tmp);
-          return NULL;
-        }
+  // [user@]host runs to the first '/', which starts the path; a url with
+  // no path, or with a query or fragment before it, can't be normalized
+  size_t hostStart = schemeEnd;
+  bool haveUser = false, upperHost = false;
+  size_t pathStart = schemeEnd;
+  for (; url[pathStart] != '/'; pathStart++) {
+    if (isPathEnd(url[pathStart])) {
+      return false;
+    }
+    if (url[pathStart] == '@' && !haveUser) {
+      haveUser = true;                        // what came before is user
+      hostStart = pathStart + 1;
+      upperHost = false;
+    } else if (url[pathStart] >= 'A' && url[pathStart] <= 'Z') {
+      upperHost = true;
+    }
+  }
+  normal = normal && !upperHost;
+
+  // the path runs to any query or fragment; note any . or .. segment,
+  // and the last '.' in the last segment
+  size_t pathEnd = pathStart;
+  size_t slash = pathStart;                   // the last '/'
+  size_t dot = 0;                             // the last '.'
+  for (; ; pathEnd++) {
+    char c = url[pathEnd];
+    if (isPathEnd(c) || (c == '/' && pathEnd > pathStart)) {
+      if (isDotSegment(url + slash + 1, pathEnd - slash - 1)) {
+        normal = false;
+      }
+      if (c != '/') {
+        break;
       }
+      slash = pathEnd;
+    } else if (c == '.') {
+      dot = pathEnd;
     }
   }
 
-  // Allocate space for resulting URL - which will be no longer than url.
-  char* result = malloc(strlen(url)+1);
-  if (result == NULL) {
-    freeURL(tmp);
-    return NULL;
-  } else {
-    // initialize it to empty string
-    *result = '\0';
+  // check any extension, after that '.'
+  if (dot > slash && dot + 1 < pathEnd
+      && !isKnownExtension(url + dot + 1, pathEnd - dot - 1)) {
+    return false;
   }
 
-  // put normalized url back together
-  if (tmp.scheme) {                         // scheme
-    strcat(result, tmp.scheme);
+  // the result is no longer than url, but it must fit
+  size_t len = pathEnd + strlen(url + pathEnd);
+  if (size <= len) {
+    return false;
   }
-  if (tmp.user) {                           // user
-    strcat(result, tmp.user);
+
+  if (normal) {
+    if (buf != url) {
+      memcpy(buf, url, len + 1);
+    }
+    return true;
   }
-  if (tmp.host) {                           // host
-    strcat(result, tmp.host);
+
+  // lowercase scheme and host, but not user
+  for (size_t i = 0; i < pathStart; i++) {
+    bool lower = (i < schemeEnd || i >= hostStart);
+    buf[i] = lower ? tolower((unsigned char)url[i]) : url[i];
   }
-  if (tmp.path) {                           // path
-    // remove . and .. segments
-    char* path = removeDotSegments(tmp.path);
-    if (path == NULL) {
-      freeURL(tmp);
-      return NULL;
+
+  // remove . and .. segments, as in RFC 3986 section 5.2.4: a segment at
+  // a time, each starting with its '/'
+  size_t out = pathStart;
+  for (size_t seg = pathStart; seg < pathEnd; ) {
+    size_t next = segmentEnd(url, seg, pathEnd);
+    size_t segLen = next - seg - 1;
+    if (isDotSegment(url + seg + 1, segLen)) {
+      if (segLen == 2) {
+        // ".." removes the last segment of the output, and its '/'
+        while (out > pathStart) {
+          out--;
+          if (buf[out] == '/') {
+            break;
+          }
+        }
+      }
+      if (next == pathEnd) {
+        buf[out++] = '/';                   // the path ends in a directory
+      }
     } else {
-      strcat(result, path);
-      free(path);
+      memmove(buf + out, url + seg, next - seg);
+      out += next - seg;
     }
+    seg = next;
   }
-  if (tmp.query) {                          // query
-    strcat(result, tmp.query);
-  }
-  if (tmp.fragment) {                       // fragment
-    strcat(result, tmp.fragment);
-  }
+
+  // query and fragment, and the terminating null, as they are
+  memmove(buf + out, url + pathEnd, len - pathEnd + 1);
 
 #ifdef REMOVE_SLASH
   // Remove trailing slash [DFK 2017].
@@ -537,16 +656,15 @@ normalizeURL(const char* url)
   // but doing so actually prevents the crawler from following the 
   // server's implicit redirect to http://www.cs.dartmouth.edu/index.html
   // So, I've decided not to include it.
-  if (*result != '\0') {
-    char* last = result + strlen(result) - 1;
+  if (*buf != '\0') {
+    char* last = buf + strlen(buf) - 1;
     if (*last == '/'){
       *last = '\0';
     }
   }
 #endif // REMOVE_SLASH
 
-  freeURL(tmp);
-  return result;
+  return true;
 }
 
 /***********************************************************************
@@ -558,7 +676,49 @@ isInternalURL(const char* url)
   if (url == NULL) {
     return false;
   } else {
-    return (strncmp(url, INTERNAL_PREFIX, strlen(INTERNAL_PREFIX)) == 0);
+    return (strncmp(url, internalPrefix, internalPrefixLen) == 0);
+  }
+}
+
+/***********************************************************************
+ * setInternalPrefix - see webpage.h for interface description.
+ */
+void
+setInternalPrefix(const char* prefix)
+{
+  internalPrefix = (prefix != NULL) ? prefix : INTERNAL_PREFIX;
+  internalPrefixLen = strlen(internalPrefix);
+}
+
+
+/***********************************************************************
+ * resolveURL - see webpage.h for interface description.
+ *
+ * Absolute means that a ':' precedes any '/', '?', or '#', as in
+ * webpage_getNextURL.
+ */
+char*
+resolveURL(const char* base, const char* href, const size_t len)
+{
+  if (base == NULL || href == NULL || (len > 0 && href[0] == '#')) {
+    return NULL;
+  }
+  if (len == 0) {
+    href = "";                             // the page's own directory
+  }
+
+  size_t i = 0;
+  while (i < len && strchr(":/?#", href[i]) == NULL) {
+    i++;
+  }
+  if (i == len || href[i] != ':') {
+    // relative
+    return fixRelativeURL((char*)base, (char*)href, len);
+  } else if (len < 4 || strncasecmp(href, "http", 4) != 0) {
+    // absolute, but not http(s)
+    return NULL;
+  } else {
+    return strndup(href, len);
   }
 }
 
@@ -746,6 +906,53 @@ parseURL(const char* str, struct URL* url)
   return true;                                // if we got this far, good
 }
 
+/* ****************** isKnownExtension ***************************** */
+/* Is ext, of len characters, one of EXTS? As in the original
+ * normalizeURL, it need only begin with one, in any case.
+ */
+static bool
+isKnownExtension(const char* ext, const size_t len)
+{
+  for (int i = 0; EXTS[i] != NULL; i++) {
+    size_t extLen = strlen(EXTS[i]);
+    if (len >= extLen && strncasecmp(ext, EXTS[i], extLen) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/* ****************** isDotSegment ***************************** */
+/* Is the path segment seg, of len characters, "." or ".."? */
+static bool
+isDotSegment(const char* seg, const size_t len)
+{
+  return (len == 1 && seg[0] == '.')
+    || (len == 2 && seg[0] == '.' && seg[1] == '.');
+}
+
+/* ****************** isPathEnd ***************************** */
+/* Does c end the path of a url: a query, a fragment, or the end? */
+static bool
+isPathEnd(const char c)
+{
+  return c == '\0' || c == '?' || c == '#';
+}
+
+/* ****************** segmentEnd ***************************** */
+/* Return where the path segment starting with the '/' at url[seg] ends:
+ * at the next '/', or at pathEnd.
+ */
+static size_t
+segmentEnd(const char* url, const size_t seg, const size_t pathEnd)
+{
+  size_t end = seg + 1;
+  while (end < pathEnd && url[end] != '/') {
+    end++;
+  }
+  return end;
+}
+
 /* ****************** freeURL ***************************** */
 /* free the members of the URL struct - but not the struct itself.
  */
@@ -779,253 +986,112 @@ printURL(struct URL url)
 }
 #endif // DEBUG
 
-/* ****************** burstURL ********************* */
-/* Burst the URL into components (hostname, port, pathname).
- *
- * Input: URL, assumed non-NULL and already normalized.
- * 
- * Output: fill in the other parameters:
- *   a pointer to new string containing the hostname
- *   an integer representing the port
- *   a pointer to new string containing the pathname.
- * and
- *   return true if successful. 
- * 
- * If success, the hostname and pathname must be free'd later.
- * Each string is allocated enough space to hold the whole URL, 
- * which is more than necessary, allowing a little growth if needed.
- * 
- * burstURL is much simpler than parseURL and is used by 
- * webpage_fetch because it can't handle anything other than simple
- * http://hostname[:port][/path] forms of URL anyway.
- */
-static bool
-burstURL(const char* url, char** hostname, int* port, char** pathname)
-{
-  // make plenty of space for the resulting strings
-  int length = strlen(url);
-
-  // initialize hostname to empty string
-  *hostname = calloc(sizeof(char), length); // initialized to all nulls
-  if (*hostname == NULL) {
-    return false;
-  }
-
-  // initialize pathname to slash
-  *pathname = calloc(sizeof(char), length); // initialized to all nulls
-  if (*pathname == NULL) {
-    free(*hostname);
-    return false;
-  } else {
-    **pathname = '/';
-  }
-
-  // initialize port to default port
-  *port = HTTP_PORT;
-
-  // parse various forms of the URL
-  if (sscanf(url, "http://%[^:]:%d/%s", *hostname, port, *pathname+1) == 3) {
-    return true;
-  } else if (sscanf(url, "http://%[^/]/%s", *hostname, *pathname+1) == 2) {
-    return true;
-  } else if (sscanf(url, "http://%[^:]:%d", *hostname, port) == 2) {
-    return true;
-  } else if (sscanf(url, "http://%[^/]/", *hostname) == 1) {
-    return true;
-  } else if (sscanf(url, "http://%s", *hostname) == 1) {
-    return true;
-  } else {
-    free(*hostname); *hostname = NULL;
-    free(*pathname); *pathname = NULL;
-    return false;
-  }
-}
-
-
 /* ********************* connectToHost ************************** */
-/* Connect to the given hostname and port, 
- * returning an open FILE* for the socket,
- * or NULL on failure.
+/* Connect to the given hostname and port,
+ * returning an open socket with read and write timeouts set,
+ * or -1 on failure. Notes the time each step took in timing.
  */
-static FILE* 
-connectToHost(const char* hostname, const int port)
+static int
+connectToHost(const char* hostname, const int port, webpage_timing_t* timing)
 {
-  // Look up the hostname specified on command line
-  struct hostent *hostp = gethostbyname(hostname);
-  if (hostp == NULL) {
-    return NULL;
-  }
-
-  // Initialize fields of the server address
+  // Look up the hostname, usually in the resolver cache
   struct sockaddr_in server;  // address of the server
-  server.sin_family = AF_INET;
-  bcopy(hostp->h_addr_list[0], &server.sin_addr, hostp->h_length);
-  server.sin_port = htons(port);
+  long start = nowUs();
+  bool found = resolver_lookup(hostname, port, &server);
+  long looked = nowUs();
+  timing->dns = looked - start;
+  if (!found) {
+    return -1;
+  }
 
   // Create socket (a file descriptor)
   int comm_sock = socket(AF_INET, SOCK_STREAM, 0);
   if (comm_sock < 0) {
-    return NULL;
+    return -1;
   }
 
-  // And connect that socket to that server   
+  // And connect that socket to that server
   if (connect(comm_sock, (struct sockaddr *) &server, sizeof(server)) < 0) {
-    return NULL;
-  }
-
-  // to make it easier to work with, switch to stdio
-  FILE* http_fp = fdopen(comm_sock, "r+");
-  if (http_fp == NULL) {
-    return NULL;
+    close(comm_sock);
+    return -1;
   }
+  timing->connect = nowUs() - looked;
 
-  return http_fp;
+  setBlockingTimeouts(comm_sock);
+  return comm_sock;
 }
 
-
-/* ***************************************************************** */
-/*
- * removeDotSegments - removes . and .. segments from url paths
- * @input: the character buffer to cleanse
- *
- * Returns a newly allocated character buffer with . and .. segments removed
- * according to the algorithm in RFC 3986 section 5.2.4 "Remove Dot Segments".
- * See: http://www.ietf.org/rfc/rfc1738.txt
- *
- * Should have no use outside of this file, thus declared static.
- *
- * Implementation adapted for CS50 TSE Crawler from the cURL library:
- *
- * Copyright (c) 1996 - 2014, Daniel Stenberg, <daniel@haxx.se>.
- *
- * All rights reserved.
- *
- * Permission to use, copy, modify, and distribute this software for any purpose
- * with or without fee is hereby granted, provided that the above copyright
- * notice and this permission notice appear in all copies.
- *
- * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
- * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
- * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF THIRD PARTY RIGHTS. IN
- * NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
- * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
- * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
- * OR OTHER DEALINGS IN THE SOFTWARE.
- *
- * Except as contained in this notice, the name of a copyright holder shall not
- * be used in advertising or otherwise to promote the sale, use or other dealings
- * in this Software without prior written authorization of the copyright holder.
+/* ********************* setBlockingTimeouts ************************** */
+/* Put the socket in blocking mode (a pooled connection may come from the
+ * non-blocking fetcher), with read and write timeouts so a stalled
+ * server can't hang the fetch forever.
  */
-static char* 
-removeDotSegments(char* input)
+static void
+setBlockingTimeouts(const int sock)
 {
-  size_t in_len;                           // input length
-  size_t copy_len;                         // copy length
-  char* copy;                              // copy of input that is modified
-  char* copyptr;                           // handle for free'ing copy'
-  char* out;                               // output buffer
-  char* outptr;                            // pointer to current write point
-
-  if (!input || strlen(input) < 1)
-    return NULL;
-
-  // save lengths
-  in_len = copy_len = strlen(input);
-
-  // create output buffer
-  out = outptr = calloc(in_len + 1, sizeof(char));
-  if (!out)
-    return NULL; /* out of memory */
-
-  // copy the input buffer
-  copy = copyptr = strdup(input);
-  if (!copy) {
-    free(out);
-    return NULL;
+  int flags = fcntl(sock, F_GETFL);
+  if (flags >= 0 && (flags & O_NONBLOCK)) {
+    fcntl(sock, F_SETFL, flags & ~O_NONBLOCK);
   }
 
-  // 2.  While the input buffer is not empty, loop as follows:
-  do {
-    // A. If the input buffer begins with a prefix of "../" or "./",
-    //    then remove that prefix from the input buffer; otherwise,
-    if (!strncmp("./", copy, 2)) {
-      copy += 2;
-      copy_len -= 2;
-    }
-    else if (!strncmp("../", copy, 3)) {
-      copy += 3;
-      copy_len -= 3;
-    }
+  struct timeval timeout = { FETCH_TIMEOUT, 0 };
+  setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+}
 
-    // B. if the input buffer begins with a prefix of "/./" or "/.",
-    //    where "." is a complete path segment, then replace that
-    //    prefix with "/" in the input buffer; otherwise,
-    else if (!strncmp("/./", copy, 3)) {
-      copy += 2;
-      copy_len -= 2;
-    }
-    else if (!strcmp("/.", copy)) {
-      copy[1] = '/';
-      copy++;
-      copy_len -= 1;
-    }
+/* ********************* nowUs ************************** */
+/* Return a monotonic clock reading in microseconds. */
+static long
+nowUs(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000L + ts.tv_nsec / 1000L;
+}
 
-    // C. if the input buffer begins with a prefix of "/../" or "/..",
-    //    where ".." is a complete path segment, then replace that
-    //    prefix with "/" in the input buffer and remove the last
-    //    segment and its preceding "/" (if any) from the output
-    //    buffer; otherwise,
-    else if (!strncmp("/../", copy, 4)) {
-      copy += 3;
-      copy_len -= 3;
-
-      // remove the last segment
-      while (outptr > out) {
-        outptr--;
-        if (*outptr == '/')
-          break;
-      }
-      *outptr = 0;
-    }
-    else if (!strcmp("/..", copy)) {
-      copy[2] = '/';
-      copy += 2;
-      copy_len -= 2;
-
-      // remove the last segment
-      while (outptr > out) {
-        outptr--;
-        if (*outptr == '/')
-          break;
-      }
-      *outptr = 0;
+/* ********************* exchange ************************** */
+/* Send the request on the socket and read the response into resp,
+ * in large blocks, parsing as it arrives; note in timing how long the
+ * first byte took to come, and then the rest.
+ * Returns HTTP_DONE when the response is complete, else HTTP_ERROR.
+ */
+static http_result_t
+exchange(const int sock, const char* request, webpage_timing_t* timing,
+         http_response_t* resp)
+{
+  size_t len = strlen(request);
+  for (size_t off = 0; off < len; ) {
+    ssize_t n = send(sock, request + off, len - off, MSG_NOSIGNAL);
+    if (n <= 0) {
+      return HTTP_ERROR;
     }
+    off += n;
+  }
 
-    // D. if the input buffer consists only of "." or "..", then remove
-    //    that from the input buffer; otherwise, */
-    else if (!strcmp(".", copy) || !strcmp("..", copy)) {
-      *copy = 0;
+  http_result_t result = HTTP_MORE;
+  char buf[16384];
+  long sent = nowUs(), first = 0;
+  while (result == HTTP_MORE) {
+    ssize_t n = read(sock, buf, sizeof(buf));
+    if (n > 0 && first == 0) {
+      first = nowUs();
+      timing->firstByte = first - sent;
     }
-
-    // E. move the first path segment in the input buffer to the end of
-    //    the output buffer, including the initial "/" character (if
-    //    any) and any subsequent characters up to, but not including,
-    //    the next "/" character or the end of the input buffer. */
-    else {
-      do {
-        *outptr++ = *copy++;
-        copy_len--;
-      } while (*copy && (*copy != '/'));
-      *outptr = '\0';
+    if (n > 0) {
+      result = http_response_feed(resp, buf, n);
+    } else if (n == 0) {
+      result = http_response_eof(resp);
+    } else {
+      result = HTTP_ERROR;      // includes timeout
     }
-  } while (*copy != '\0');    // keep going
-
-  // cleanup copy
-  free(copyptr);
-
-  return out;
+  }
+  if (first != 0) {
+    timing->body = nowUs() - first;
+  }
+  return result;
 }
 
+
 /* ***************************************************************** */
 /*
  * fixRelativeURL - resolves a relative url to an absolute url
@@ -1122,11 +1188,11 @@ fixRelativeURL(char* base, char* rel, size_t len)
  *
  * Eliminates whitespace by shifting and condensing all the non-whitespace
  * toward the beginning of the buffer. This does not alter the size of the
- * buffer.
+ * buffer. Returns the length of what is left.
  *
  * Should have no use outside of this file, thus declared static.
  */
-static void
+static size_t
 removeWhitespace(char* str)
 {
   char* prev;                              // previous whitespace
@@ -1138,19 +1204,6 @@ removeWhitespace(char* str)
   do {
     while (isspace(*cur)) cur++;           // consume any whitespace
   } while ((*prev++ = *cur++));            // condense to front of str
-}
 
-/* **************** isBlankLine ******************/
-/* Input: line, a non-NULL pointer to a string.
- * Return true if the string is pointing to a blank line, that is, 
- * an empty string, or
- * with only newline (LF), only carriage return (CR), or only CRLF.
- */
-static inline bool
-isBlankLine(const char* line)
-{
-  return (   (line[0] == '\0')
-             || (strcmp(line, "\n") == 0) 
-             || (strcmp(line, "\r") == 0) 
-             || (strcmp(line, "\r\n") == 0));
+  return prev - 1 - str;
 }
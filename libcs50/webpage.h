@@ -33,10 +33,28 @@
  */
 typedef struct webpage webpage_t;
 
+/* webpage_timing_t: how the last fetch of a page went, phase by phase, in
+ * microseconds. A phase that did not happen is 0: dns and connect, for
+ * instance, when the fetch reused a pooled connection.
+ */
+typedef struct webpage_timing {
+  long dns;             // looking up the server
+  long connect;         // opening the connection
+  long firstByte;       // from sending the request to the first byte back
+  long body;            // from the first byte back to the last
+  long bytes;           // bytes received, headers and all, as sent
+} webpage_timing_t;
+
 /* getter methods */
 int   webpage_getDepth(const webpage_t* page);
 char* webpage_getURL(const webpage_t* page);
 char* webpage_getHTML(const webpage_t* page);
+int   webpage_getStatus(const webpage_t* page); // HTTP status of last fetch,
+                                                // or 0 if no response came
+char* webpage_getETag(const webpage_t* page);   // validators of last fetch,
+char* webpage_getLastModified(const webpage_t* page); // or NULL if none
+webpage_timing_t webpage_getTiming(const webpage_t* page); // of last fetch,
+                                                // or all 0 if none
 
 /**************** webpage_new ****************/
 /* Allocate and initialize a new webpage_t structure.
@@ -99,6 +117,22 @@ void webpage_delete(void* data);
  *  }
  *  webpage_delete(page);
  *
+ * Politeness:
+ *   We make one attempt, right away, and never sleep. Pacing requests to
+ *   a server, and deciding whether and when to retry a failed fetch, are
+ *   up to the caller (the crawler's politeness scheduler does both).
+ *
+ * Conditional fetch:
+ *   If the page has validators (see webpage_setValidators), we ask for
+ *   the page only if it has changed since they were issued. If the server
+ *   answers 304 Not Modified, we return false with webpage_getStatus(page)
+ *   == 304 and page->html still NULL. After a successful fetch, the page
+ *   holds the validators the server sent with it, if any.
+ *
+ * Compression:
+ *   Built with zlib, we offer to take the page gzip- or deflate-encoded,
+ *   and inflate it as it arrives; page->html always holds it decoded.
+ *
  * Limitations:
  *   * can only handle http (not https or other schemes)
  *   * can only handle URLs of form http://host[:port][/pathname]
@@ -106,6 +140,69 @@ void webpage_delete(void* data);
  */
 bool webpage_fetch(webpage_t* page);
 
+/***************** webpage_fetchStream ******************************/
+/* like webpage_fetch, but also pass the HTML (decoded, if it came
+ * compressed) to sink(arg, data, len) piece by piece while it is still arriving, so the caller can work on
+ * the start of a page (e.g., feed it to a linkscan) before the end has
+ * come. The pieces are not NUL-terminated. If the fetch fails partway,
+ * sink may already have seen part of the page.
+ * webpage_fetch(page) is webpage_fetchStream(page, NULL, NULL).
+ */
+bool webpage_fetchStream(webpage_t* page,
+                         void (*sink)(void* arg, const char* data, size_t len),
+                         void* arg);
+
+/***************** webpage_setHTML ******************************/
+/* store html, fetched by some other means, into page->html
+ *
+ * Caller provides
+ *   page, a valid webpage_t* whose html is still NULL, and
+ *   html, a non-NULL pointer to malloc'd memory.
+ *
+ * We return:
+ *   true if html was stored; false if any argument is invalid.
+ *   On success the webpage adopts html and will free it in webpage_delete.
+ *
+ * This exists for fetch engines outside this module, such as fetcher.
+ */
+bool webpage_setHTML(webpage_t* page, char* html);
+
+/***************** webpage_takeHTML ******************************/
+/* take page->html away from page, for the caller to keep
+ *
+ * We return:
+ *   the page's html, or NULL if page is NULL or has none;
+ *   page->html is NULL from then on.
+ *
+ * Caller is responsible for:
+ *   eventually free()ing the html returned.
+ *
+ * This lets a page's html move on (say, to be saved) without a copy.
+ */
+char* webpage_takeHTML(webpage_t* page);
+
+/***************** webpage_setStatus ******************************/
+/* record the HTTP status code of a fetch made by some other means
+ * (0 if no response arrived), for webpage_getStatus.
+ */
+void webpage_setStatus(webpage_t* page, const int status);
+
+/***************** webpage_setValidators ******************************/
+/* store copies of the page's validators, an ETag and a Last-Modified date
+ * (either may be NULL), replacing any it has; see webpage_fetch.
+ *
+ * We return:
+ *   true on success; false if page is NULL or out of memory, in which
+ *   case the page is left with no validators.
+ */
+bool webpage_setValidators(webpage_t* page, const char* etag, const char* lastModified);
+
+/***************** webpage_setTiming ******************************/
+/* record how a fetch made by some other means went, phase by phase,
+ * for webpage_getTiming. A NULL page is ignored.
+ */
+void webpage_setTiming(webpage_t* page, const webpage_timing_t* timing);
+
 
 /**************** webpage_getNextWord ***********************************/
 /* return the next word from page->html[pos]
@@ -195,6 +292,52 @@ char* webpage_getNextURL(webpage_t* page, int* pos);
  */
 char* normalizeURL(const char* url);
 
+/***********************************************************************
+ * normalizeURLInto - normalizes the url into a buffer, without malloc
+ *
+ * Caller provides:
+ *    url: string containing absolute url to normalize;
+ *    buf: where to put the normalized url; may be url itself, to
+ *         normalize it in place;
+ *    size: bytes in buf, which must be at least strlen(url)+1 (the
+ *         normalized url is never longer than url).
+ *
+ * Returns:
+ *  true, with the normalized url in buf, if it could be normalized;
+ *  false, leaving buf as it was, if normalizeURL would return NULL, or
+ *  if buf is too small.
+ *
+ * A url that is normalized already (lowercase scheme and host, no . or
+ * .. path segments), as most links are, is just copied. normalizeURL
+ * is this, into a buffer it allocates.
+ *
+ * Usage example: (the crawler, normalizing each link in place)
+ *   if (normalizeURLInto(url, url, strlen(url)+1)) { ... }
+ */
+bool normalizeURLInto(const char* url, char* buf, const size_t size);
+
+/***********************************************************************
+ * resolveURL - returns the absolute url of a link found in a page
+ *
+ * Caller provides:
+ *    base: the (absolute) url of the page the link was found in;
+ *    href: the link as written, without whitespace or #fragment;
+ *    len: the number of characters of href to use.
+ *
+ * Returns:
+ *  a new string with href made absolute against base (an empty href
+ *    gives base's directory), or
+ *  NULL if href is a #fragment, or
+ *  NULL if href is absolute but not http(s), or
+ *  NULL if cannot allocate new memory.
+ *
+ * Caller is responsible for:
+ *  eventually free()ing the returned string.
+ *
+ * This is the same resolution webpage_getNextURL does for each link.
+ */
+char* resolveURL(const char* base, const char* href, const size_t len);
+
 
 /***********************************************************************
  * isInternalURL - verify whether the given url is 'internal' to CS50
@@ -206,10 +349,24 @@ char* normalizeURL(const char* url);
  *   true if the url is non-NULL and "internal",
  *   false otherwise.
  *
- * "internal" means that the normalized url begins with INTERNAL_PREFIX.
+ * "internal" means that the normalized url begins with INTERNAL_PREFIX,
+ * or with the prefix given to setInternalPrefix.
  */
 bool isInternalURL(const char* url);
 
+/***********************************************************************
+ * setInternalPrefix - make isInternalURL accept a different site
+ *
+ * Caller provides:
+ *   prefix: the start of every internal url, such as
+ *   "http://localhost:8080/tse/" for a stand-in server; or NULL to go
+ *   back to INTERNAL_PREFIX. The string is not copied, so it must stay
+ *   valid while in use.
+ *
+ * Not thread-safe; call it before any crawling starts.
+ */
+void setInternalPrefix(const char* prefix);
+
 // All normalized URLs beginning with this prefix are considered "internal"
 static const
 char INTERNAL_PREFIX[] = "http://cs50tse.cs.dartmouth.edu/tse/";
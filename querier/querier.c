@@ -12,6 +12,9 @@
 #include "../libcs50/set.h"
 #include "../libcs50/file.h"
 #include "../libcs50/mem.h"
+#include "../libcs50/webpage.h"
+#include "../common/pagedir.h"
+#include "../common/pagepack.h"
 #include <ctype.h>
 #include <stdbool.h>
 #include <string.h>
@@ -37,7 +40,7 @@ static void ctrs_merge_helper(void* arg, const int docID, const int score);
 static void ctrs_intersect(counters_t* result, counters_t* ctrsA, counters_t* ctrsB);
 static void ctrs_intersect_helper(void* arg, const int docID, const int score);
 static counters_t* bnf(hashtable_t* index, char* words[], int word_count);
-static void print_max(counters_t* ctrs, const char* pageDirectory);
+static void print_max(counters_t* ctrs, pagepack_t* pages);
 static void find_max(void* arg, const int docID, const int score);
 static void print_curr_max(void* arg, const int docID, const int score);
 static void itemdelete(void* item);
@@ -53,20 +56,28 @@ int main(int argc, char *argv[])
   FILE* fp;
   char file[300];
   char file2[300];
+  char file3[300];
   snprintf(file, sizeof(file), "%s/.crawler", argv[1]);
   snprintf(file2, sizeof(file2), "%s/1", argv[1]);
+  snprintf(file3, sizeof(file3), "%s/.pack", argv[1]); //or the pages may be packed
   if ((fp=fopen(file, "r")) == NULL) {
     fprintf(stderr, "pageDirectory formatted incorrectly.\n");
     return 2;
   }
   fclose(fp);
 
-  if ((fp=fopen(file2, "r")) == NULL) {
+  if ((fp=fopen(file2, "r")) == NULL && (fp=fopen(file3, "r")) == NULL) {
     fprintf(stderr, "pageDirectory formatted incorrectly.\n");
     return 3;
   }
   fclose(fp);
 
+  pagepack_t* pages = pagepack_open(argv[1]); //reads the pages, packed or one file per docID
+  if (pages == NULL) {
+    fprintf(stderr, "pageDirectory formatted incorrectly.\n");
+    return 3;
+  }
+
   if ((fp=fopen(argv[2], "r")) == NULL) {
     fprintf(stderr, "indexFilename invalid.\n");
     return 4;
@@ -97,13 +108,14 @@ int main(int argc, char *argv[])
       }
       printf("\n");
       counters_t* search = bnf(table, words, word_count); //scores each document into a counters struct
-      print_max(search, argv[1]); //prints scores in descending order
+      print_max(search, pages); //prints scores in descending order
       counters_delete(search);
     }
     printf("\n");
     printf("Query? ");    
   }
   hashtable_delete(table, itemdelete);
+  pagepack_close(pages);
   return 0;
 }
 
@@ -181,15 +193,21 @@ static bool index_loader(hashtable_t* ht, char* filename)
 {
   FILE* fp = fopen(filename, "r");
   char word[20];
+  file_reader_t* reader = file_reader_new(fp); //reads the file in large blocks
+  if (reader == NULL) {
+    fprintf(stderr, "Fatal error: file_reader_new failed.\n");
+    fclose(fp);
+    return false;
+  }
   char* line;
-  while ((line = file_readLine(fp)) != NULL) { //for each line in the index file
+  while ((line = file_reader_line(reader, NULL)) != NULL) { //for each line in the index file
     int loc = 0;
     int docID; 
     int cnt;
     bool test1 = true;
     counters_t* ctrs = counters_new(); //we wanna make a new counters for a word
     if (ctrs == NULL) {
-      mem_free(line);
+      file_reader_delete(reader);
       fprintf(stderr, "Fatal error: counters_new failed.\n");
       fclose(fp);
       return false;
@@ -201,7 +219,7 @@ static bool index_loader(hashtable_t* ht, char* filename)
       test1 = counters_set(ctrs, docID, cnt); //set the counters
       if (!test1) { //if this didn't work, indexFilename isn't formatted correctly.
         fprintf(stderr, "indexFilename formatted incorrectly.\n");
-	mem_free(line);
+	file_reader_delete(reader);
 	fclose(fp);
 	counters_delete(ctrs);
 	return test1;
@@ -210,13 +228,13 @@ static bool index_loader(hashtable_t* ht, char* filename)
     test1 = hashtable_insert(ht, word, ctrs); //insert it to the hashtable
     if (!test1) { //same deal, just safety checks
       fprintf(stderr, "indexFilename formatted incorrectly.\n");
-      mem_free(line);
+      file_reader_delete(reader);
       fclose(fp);
       counters_delete(ctrs);
       return test1;
     }
-    mem_free(line);
   }
+  file_reader_delete(reader);
   fclose(fp);
   return true;
 }
@@ -343,7 +361,7 @@ static counters_t* bnf(hashtable_t* index, char* words[], int word_count)
  * First, finds the largest possible score. 
  * Then, runs a loop in descending order starting with that score.
  */
-static void print_max(counters_t* ctrs, const char* pageDirectory) 
+static void print_max(counters_t* ctrs, pagepack_t* pages) 
 {
   int curr_max = 0;
   counters_iterate(ctrs, &curr_max, find_max); //stores highest score
@@ -358,16 +376,13 @@ static void print_max(counters_t* ctrs, const char* pageDirectory)
     counters_iterate(ctrs, pair, print_curr_max); //runs helper to find the closest match to score, saves docID
     if (pair->docID != 0) { //if it found a match, we wanna first print it with the url, and then look for all other matches before descending
       while (pair->docID != 0) {
-        char url[200];
-	snprintf(url, sizeof(url), "%s/%d", pageDirectory, pair->docID); //builds path
-        FILE* fp;
-	fp = fopen(url, "r");
-	char* line = file_readLine(fp); //first line is url, read it
-	printf(" %s", line); //prints the url
+        pagedir_view_t view;
+	if (pagepack_map(pages, pair->docID, &view)) { //a view of the page, plain, compressed, or packed
+	  printf(" %.*s", (int)view.urlLen, view.url); //prints the url
+	  pagedir_unmap(&view);
+	}
         printf("\n");
 	pair->docID = 0;
-	mem_free(line);
-	fclose(fp);
 	counters_iterate(ctrs, pair, print_curr_max); //run iterate with same score
       }
     }